@@ -23,143 +23,316 @@
   Cambridge, MA 02139, USA.
   --------------------------------------------------------------------*/
 
-
-
 #include "uniquestr.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <limits.h>
 #include <string.h>
-#include <math.h>
 
 #include "mem.h"
 
-typedef struct string_link_tag string_link_t;
+// Interned strings live in chunks of this size. Strings that would waste
+// too much of a chunk get a chunk of their own
+enum { ARENA_CHUNK_SIZE = 64 * 1024 };
+enum { ARENA_LARGE_STRING = ARENA_CHUNK_SIZE / 4 };
 
-struct string_link_tag
+typedef struct arena_chunk_tag arena_chunk_t;
+struct arena_chunk_tag
 {
-    unsigned int hash;
-    const char *string;
-    string_link_t *next;
+    arena_chunk_t *next;
+    size_t size;
+    size_t used;
+    char data[];
 };
 
-enum { HASH_LENGTH = 76003 };
+// Open addressing with linear probing. The hash and the length are kept in
+// the entry so most mismatches are discarded without touching the string
+typedef struct string_entry_tag
+{
+    const char *string;
+    uint32_t hash;
+    uint32_t length;
+} string_entry_t;
+
+// The table is split in shards selected by the upper bits of the hash.
+// Shards are independent, so in thread-safe mode each one has its own lock
+enum { NUM_SHARDS_LOG2 = 4 };
+enum { NUM_SHARDS = 1 << NUM_SHARDS_LOG2 };
+enum { INITIAL_SHARD_CAPACITY = 4096 };
+
+typedef struct string_shard_tag
+{
+    string_entry_t *entries;
+    uint32_t capacity; // Always a power of two
+    uint32_t count;
+
+    arena_chunk_t *current_chunk;
+    arena_chunk_t *chunks;
+
+    unsigned long long bytes_used;
+
+    volatile int lock;
+} string_shard_t;
+
+static string_shard_t shards[NUM_SHARDS];
+static char thread_safe = 0;
+
+void uniquestr_set_thread_safe(char enabled)
+{
+    thread_safe = enabled;
+}
+
+static inline void shard_lock(string_shard_t *shard)
+{
+    if (!thread_safe)
+        return;
+    while (__sync_lock_test_and_set(&shard->lock, 1))
+    {
+        while (shard->lock)
+            ;
+    }
+}
 
-static string_link_t *hash_table[HASH_LENGTH];
-static unsigned long long int bytes_used = 0;
+static inline void shard_unlock(string_shard_t *shard)
+{
+    if (!thread_safe)
+        return;
+    __sync_lock_release(&shard->lock);
+}
 
 unsigned long long int char_trie_used_memory(void)
 {
-    return bytes_used;
+    unsigned long long int result = 0;
+    int i;
+    for (i = 0; i < NUM_SHARDS; i++)
+    {
+        result += shards[i].bytes_used;
+    }
+    return result;
+}
+
+static inline uint64_t load_word(const char *p)
+{
+    uint64_t w;
+    memcpy(&w, p, sizeof(w));
+    return w;
 }
 
-static unsigned int hash_string(const char *string)
+static inline uint64_t mix_word(uint64_t hash, uint64_t word)
 {
-    unsigned int hash = 0;
-    const char *p;
+    return ((hash << 5) | (hash >> 59)) ^ word;
+}
 
-    for (p = string; *p; p++)
-        hash = ((hash << 5) + hash) ^ *p;
+// Hashes eight bytes at a time. The final mix spreads the entropy to the
+// upper bits (used to select the shard) and the lower bits (the index)
+static uint64_t hash_string_n(const char *string, size_t length)
+{
+    const uint64_t k = UINT64_C(0x517cc1b727220a95);
+    uint64_t hash = length * k;
+
+    const char *p = string;
+    size_t remaining = length;
+    while (remaining >= sizeof(uint64_t))
+    {
+        hash = mix_word(hash, load_word(p)) * k;
+        p += sizeof(uint64_t);
+        remaining -= sizeof(uint64_t);
+    }
+
+    if (remaining > 0)
+    {
+        uint64_t tail = 0;
+        memcpy(&tail, p, remaining);
+        hash = mix_word(hash, tail) * k;
+    }
+
+    hash ^= hash >> 33;
+    hash *= UINT64_C(0xff51afd7ed558ccd);
+    hash ^= hash >> 33;
 
     return hash;
 }
 
-const char *uniquestr(const char *string)
+static const char *arena_copy(string_shard_t *shard, const char *string, size_t length)
+{
+    size_t needed = length + 1;
+
+    arena_chunk_t *chunk = shard->current_chunk;
+    if (chunk == NULL
+            || chunk->size - chunk->used < needed)
+    {
+        size_t size = ARENA_CHUNK_SIZE;
+        if (needed > ARENA_LARGE_STRING)
+            size = needed;
+
+        chunk = (arena_chunk_t*)xmalloc(sizeof(*chunk) + size);
+        chunk->size = size;
+        chunk->used = 0;
+        chunk->next = shard->chunks;
+        shard->chunks = chunk;
+        shard->bytes_used += sizeof(*chunk) + size;
+
+        // Keep filling the current chunk if this one is exclusive for the
+        // large string
+        if (size == ARENA_CHUNK_SIZE)
+            shard->current_chunk = chunk;
+    }
+
+    char *result = chunk->data + chunk->used;
+    memcpy(result, string, length);
+    result[length] = '\0';
+    chunk->used += needed;
+
+    return result;
+}
+
+static void shard_grow(string_shard_t *shard)
+{
+    uint32_t new_capacity = shard->capacity == 0 ? INITIAL_SHARD_CAPACITY : 2 * shard->capacity;
+    string_entry_t *new_entries = NEW_VEC0(string_entry_t, new_capacity);
+    uint32_t mask = new_capacity - 1;
+
+    uint32_t i;
+    for (i = 0; i < shard->capacity; i++)
+    {
+        string_entry_t *entry = &shard->entries[i];
+        if (entry->string == NULL)
+            continue;
+
+        uint32_t index = entry->hash & mask;
+        while (new_entries[index].string != NULL)
+            index = (index + 1) & mask;
+        new_entries[index] = *entry;
+    }
+
+    shard->bytes_used += (unsigned long long)(new_capacity - shard->capacity) * sizeof(string_entry_t);
+
+    DELETE(shard->entries);
+    shard->entries = new_entries;
+    shard->capacity = new_capacity;
+}
+
+const char *uniquestr_n(const char *string, size_t length)
 {
     if (string == NULL)
         return NULL;
 
-    unsigned int hash = hash_string(string);
-    unsigned int hash_index = hash % (sizeof(hash_table) / sizeof(hash_table[0]));
-    string_link_t *p, *p_prev = 0, *new_link;
+    uint64_t full_hash = hash_string_n(string, length);
+    uint32_t hash = (uint32_t)full_hash;
+    string_shard_t *shard = &shards[full_hash >> (64 - NUM_SHARDS_LOG2)];
 
-    for (p = hash_table[hash_index]; p; p_prev = p, p = p->next)
+    shard_lock(shard);
+
+    // Keep the load factor below 3/4
+    if (4 * (shard->count + 1) > 3 * shard->capacity)
+        shard_grow(shard);
+
+    uint32_t mask = shard->capacity - 1;
+    uint32_t index = hash & mask;
+    string_entry_t *entry;
+    for (entry = &shard->entries[index];
+            entry->string != NULL;
+            index = (index + 1) & mask, entry = &shard->entries[index])
     {
-        if (p->hash == hash && !strcmp(p->string, string))
+        if (entry->hash == hash
+                && entry->length == length
+                && memcmp(entry->string, string, length) == 0)
         {
-            if (p != hash_table[hash_index])
-            {
-                p_prev->next = p->next;
-                p->next = hash_table[hash_index];
-                hash_table[hash_index] = p;
-            }
-
-            return p->string;
+            const char *result = entry->string;
+            shard_unlock(shard);
+            return result;
         }
     }
 
-    bytes_used += sizeof(string_link_t) + strlen(string) + 1;
+    entry->string = arena_copy(shard, string, length);
+    entry->hash = hash;
+    entry->length = length;
+    shard->count++;
 
-    new_link = NEW(string_link_t);
-    new_link->string = xstrdup(string); 
-    new_link->hash = hash; 
-    new_link->next = hash_table[hash_index];
-    hash_table[hash_index] = new_link; 
+    const char *result = entry->string;
+    shard_unlock(shard);
 
-    return new_link->string;
+    return result;
+}
+
+const char *uniquestr(const char *string)
+{
+    if (string == NULL)
+        return NULL;
+
+    return uniquestr_n(string, strlen(string));
 }
 
 void uniquestr_stats(void)
 {
-    unsigned long long bucket_length[HASH_LENGTH];
     unsigned long long number_of_strings = 0;
     unsigned long long number_of_bytes = 0;
-
-    int i, j;
-    for (i = 0; i < HASH_LENGTH; i++)
+    unsigned long long number_of_slots = 0;
+    unsigned long long arena_bytes = 0;
+    unsigned long long arena_chunks = 0;
+    unsigned long long sum_probes = 0;
+    unsigned long long max_probe = 0;
+    unsigned long long min_shard = ULLONG_MAX;
+    unsigned long long max_shard = 0;
+
+    int i;
+    for (i = 0; i < NUM_SHARDS; i++)
     {
-        string_link_t *p = hash_table[i];
+        string_shard_t *shard = &shards[i];
+
+        number_of_slots += shard->capacity;
+        if (shard->count < min_shard)
+            min_shard = shard->count;
+        if (shard->count > max_shard)
+            max_shard = shard->count;
 
-        j = 0;
-        while (p != NULL)
+        uint32_t mask = shard->capacity - 1;
+        uint32_t j;
+        for (j = 0; j < shard->capacity; j++)
         {
-            // fprintf(stderr, "%d.%d |%s|\n", i, j, p->string);
+            string_entry_t *entry = &shard->entries[j];
+            if (entry->string == NULL)
+                continue;
+
             number_of_strings++;
-            number_of_bytes += strlen(p->string) + 1; // +1 for NULL
+            number_of_bytes += entry->length + 1; // +1 for NULL
 
-            p = p->next;
-            j++;
+            // Distance from the home slot
+            unsigned long long probe = (j - (entry->hash & mask)) & mask;
+            sum_probes += probe;
+            if (probe > max_probe)
+                max_probe = probe;
         }
 
-        bucket_length[i] = j;
-    }
-
-    unsigned long long max_bucket = 0;
-    unsigned long long min_bucket = ULLONG_MAX;
-    unsigned long long sum_buckets = 0;
-    unsigned long long num_empty_buckets = 0;
-
-    for (i = 0; i < HASH_LENGTH; i++)
-    {
-        if (bucket_length[i] >= max_bucket)
-            max_bucket = bucket_length[i];
-        if (bucket_length[i] <= min_bucket)
-            min_bucket = bucket_length[i];
-
-        sum_buckets += bucket_length[i];
-
-        num_empty_buckets += (bucket_length[i] == 0);
+        arena_chunk_t *chunk;
+        for (chunk = shard->chunks; chunk != NULL; chunk = chunk->next)
+        {
+            arena_chunks++;
+            arena_bytes += chunk->size;
+        }
     }
 
-    float avg_bucket = 0.0f;
-    avg_bucket = ((float)sum_buckets / (float)HASH_LENGTH);
+    float avg_probe = 0.0f;
+    if (number_of_strings > 0)
+        avg_probe = (float)sum_probes / (float)number_of_strings;
 
-    float stddev_bucket = 0.0f;
-    for (i = 0; i < HASH_LENGTH; i++)
-    {
-        stddev_bucket += fabsf(bucket_length[i] - avg_bucket);
-    }
-    stddev_bucket = sqrtf(stddev_bucket / (float)(HASH_LENGTH - 1));
+    float load_factor = 0.0f;
+    if (number_of_slots > 0)
+        load_factor = (float)number_of_strings / (float)number_of_slots;
 
     fprintf(stderr, "String table statistics\n");
     fprintf(stderr, "=======================\n\n");
 
-    fprintf(stderr, "Size of hash: %d\n", HASH_LENGTH);
+    fprintf(stderr, "Number of shards: %d%s\n", NUM_SHARDS, thread_safe ? " (thread-safe)" : "");
+    fprintf(stderr, "Number of slots: %llu\n", number_of_slots);
     fprintf(stderr, "Number of strings: %llu\n", number_of_strings);
+    fprintf(stderr, "Load factor: %.2f\n", load_factor);
+    fprintf(stderr, "Minimum strings in a shard: %llu\n", min_shard);
+    fprintf(stderr, "Maximum strings in a shard: %llu\n", max_shard);
+    fprintf(stderr, "Average probe distance: %.2f\n", avg_probe);
+    fprintf(stderr, "Maximum probe distance: %llu\n", max_probe);
     fprintf(stderr, "Number of bytes taken by the strings: %llu\n", number_of_bytes);
-    fprintf(stderr, "Number of empty buckets: %llu\n", num_empty_buckets);
-    fprintf(stderr, "Minimum bucket length: %llu\n", min_bucket);
-    fprintf(stderr, "Maximum bucket length: %llu\n", max_bucket);
-    fprintf(stderr, "Average bucket length: %.2f\n", avg_bucket);
-    fprintf(stderr, "StdDev  bucket length: %.2f\n", stddev_bucket);
+    fprintf(stderr, "Number of arena chunks: %llu\n", arena_chunks);
+    fprintf(stderr, "Number of bytes in arena chunks: %llu\n", arena_bytes);
 }
@@ -31,6 +31,7 @@
 #define UNIQUESTR_H
 
 #include "libutils-common.h"
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -39,6 +40,14 @@ extern "C" {
 #define uniqstr uniquestr
 LIBUTILS_EXTERN const char *uniquestr(const char*);
 
+// Like uniquestr but for the first 'length' characters of 'string', which
+// need not be NUL-terminated. These characters must not contain a NUL
+LIBUTILS_EXTERN const char *uniquestr_n(const char* string, size_t length);
+
+// Enables locking of the string table so uniquestr can be called
+// concurrently. Must be enabled before any thread starts interning
+LIBUTILS_EXTERN void uniquestr_set_thread_safe(char enabled);
+
 #define UNIQUESTR_LITERAL(literal) \
   ({ static const char* _cached_uniquestr = NULL; \
      if (_cached_uniquestr == NULL)  _cached_uniquestr = uniquestr(literal); \
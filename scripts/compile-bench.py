@@ -0,0 +1,287 @@
+#!/usr/bin/env python
+#
+# Compile-time benchmark harness
+#
+# Runs every entry of a corpus file through the driver and records the wall
+# time, the peak RSS, the per-phase timings and the lexer throughput reported
+# by --compile-stats.
+# Results are compared against a stored baseline and the script fails when
+# any of them regresses beyond the given thresholds.
+#
+# Corpus file format, one benchmark per line (# starts a comment):
+#
+#   <name> <profile> <input file> [extra driver flags...]
+#
+# Input files are relative to the directory of the corpus file and may be
+# bzip2-compressed (*.bz2).
+
+from __future__ import print_function
+
+import bz2
+import json
+import optparse
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+def load_corpus(filename):
+    corpus = []
+    base_dir = os.path.dirname(os.path.abspath(filename))
+    f = open(filename)
+    for (line_num, line) in enumerate(f.readlines()):
+        line = line.strip()
+        if line == "" or line[0] == "#":
+            continue
+        fields = line.split()
+        if len(fields) < 3:
+            sys.stderr.write("%s:%d: invalid benchmark line\n" % (filename, line_num + 1))
+            sys.exit(2)
+        corpus.append({
+            "name" : fields[0],
+            "profile" : fields[1],
+            "input" : os.path.normpath(os.path.join(base_dir, fields[2])),
+            "flags" : fields[3:]})
+    f.close()
+    return corpus
+
+def load_baseline(filename):
+    if not os.path.exists(filename):
+        return {}
+    f = open(filename)
+    baseline = json.load(f)
+    f.close()
+    return baseline.get("benchmarks", {})
+
+def prepare_input(bench, work_dir):
+    input_file = bench["input"]
+    if not input_file.endswith(".bz2"):
+        return input_file
+    # The driver infers the language from the extension so keep it
+    uncompressed = os.path.join(work_dir, os.path.basename(input_file)[:-len(".bz2")])
+    src = bz2.BZ2File(input_file)
+    dest = open(uncompressed, "wb")
+    shutil.copyfileobj(src, dest)
+    dest.close()
+    src.close()
+    return uncompressed
+
+def run_once(driver, config_dir, bench, input_file, work_dir):
+    stats_file = os.path.join(work_dir, "compile-stats.json")
+    if os.path.exists(stats_file):
+        os.remove(stats_file)
+
+    command = [driver,
+            "--config-dir=%s" % config_dir,
+            "--profile=%s" % bench["profile"],
+            "--output-dir=%s" % work_dir,
+            "--compile-stats=%s" % stats_file,
+            "-y",
+            "-o", os.path.join(work_dir, "output")] \
+            + bench["flags"] + [input_file]
+
+    devnull = open(os.devnull, "w")
+    # A pipe would block the compiler once its diagnostics fill the pipe
+    # buffer, since we only read them after the child has finished
+    stderr_file = tempfile.TemporaryFile(dir=work_dir)
+    start = time.time()
+    process = subprocess.Popen(command, cwd=work_dir, stdout=devnull, stderr=stderr_file)
+    # wait4 gives us the resource usage of this child only
+    (pid, status, rusage) = os.wait4(process.pid, 0)
+    wall_time = time.time() - start
+    devnull.close()
+
+    stderr_file.seek(0)
+    stderr_output = stderr_file.read()
+    stderr_file.close()
+    # Keep the Popen object from reaping an already reaped child
+    process.returncode = os.WEXITSTATUS(status) if os.WIFEXITED(status) else -1
+
+    if process.returncode != 0:
+        sys.stderr.write("Benchmark '%s' failed: %s\n%s\n"
+                % (bench["name"], " ".join(command), stderr_output.decode("utf-8", "replace")))
+        return None
+
+    phases = {}
+    lexer_bytes = 0
+    lexer_seconds = 0.0
+    if os.path.exists(stats_file):
+        f = open(stats_file)
+        stats = json.load(f)
+        f.close()
+        for tu in stats.get("translation_units", []):
+            for (category, seconds) in tu.get("seconds", {}).items():
+                phases[category] = phases.get(category, 0.0) + seconds
+            for phase in tu.get("phases", []):
+                key = "phase:" + phase["name"]
+                phases[key] = phases.get(key, 0.0) + phase["seconds"]
+            lexer = tu.get("lexer", {})
+            lexer_bytes += lexer.get("bytes", 0)
+            lexer_seconds += lexer.get("seconds", 0.0)
+
+    result = {
+            "wall_seconds" : wall_time,
+            # ru_maxrss is reported in kilobytes in Linux
+            "peak_rss_kb" : rusage.ru_maxrss,
+            "phases" : phases}
+    if lexer_seconds > 0.0:
+        result["lexer_mb_per_second"] = lexer_bytes / (1024.0 * 1024.0) / lexer_seconds
+    return result
+
+def median(values):
+    values = sorted(values)
+    n = len(values)
+    if n % 2 == 1:
+        return values[n // 2]
+    return (values[n // 2 - 1] + values[n // 2]) / 2.0
+
+def run_benchmark(options, bench):
+    work_dir = tempfile.mkdtemp(prefix="mcxx-bench-")
+    try:
+        input_file = prepare_input(bench, work_dir)
+        runs = []
+        for i in range(options.repeat):
+            run = run_once(options.driver, options.config_dir, bench, input_file, work_dir)
+            if run is None:
+                return None
+            runs.append(run)
+    finally:
+        shutil.rmtree(work_dir, ignore_errors=True)
+
+    # The median filters out the noise of a loaded machine, peak RSS is
+    # almost deterministic so the maximum is enough
+    phase_names = set()
+    for run in runs:
+        phase_names.update(run["phases"].keys())
+    phases = {}
+    for name in phase_names:
+        phases[name] = median([run["phases"].get(name, 0.0) for run in runs])
+
+    result = {
+            "wall_seconds" : median([run["wall_seconds"] for run in runs]),
+            "peak_rss_kb" : max([run["peak_rss_kb"] for run in runs]),
+            "phases" : phases}
+    throughputs = [run["lexer_mb_per_second"] for run in runs if "lexer_mb_per_second" in run]
+    if throughputs:
+        result["lexer_mb_per_second"] = median(throughputs)
+    return result
+
+def exceeds(current, base, threshold_percent, minimum):
+    # Tiny values are dominated by noise, do not report them
+    if current < minimum and base < minimum:
+        return False
+    return current > base * (1.0 + threshold_percent / 100.0)
+
+def compare(options, name, result, base):
+    regressions = []
+    if exceeds(result["wall_seconds"], base["wall_seconds"], options.time_threshold, options.min_seconds):
+        regressions.append("wall time %.3fs -> %.3fs" % (base["wall_seconds"], result["wall_seconds"]))
+    if exceeds(result["peak_rss_kb"], base["peak_rss_kb"], options.rss_threshold, 0):
+        regressions.append("peak RSS %d KB -> %d KB" % (base["peak_rss_kb"], result["peak_rss_kb"]))
+    base_phases = base.get("phases", {})
+    for phase in sorted(result["phases"].keys()):
+        if phase not in base_phases:
+            continue
+        if exceeds(result["phases"][phase], base_phases[phase], options.phase_threshold, options.min_seconds):
+            regressions.append("%s %.3fs -> %.3fs" % (phase, base_phases[phase], result["phases"][phase]))
+    # Throughput regresses when it goes down
+    if "lexer_mb_per_second" in result and "lexer_mb_per_second" in base:
+        if result["lexer_mb_per_second"] < base["lexer_mb_per_second"] * (1.0 - options.lexer_threshold / 100.0):
+            regressions.append("lexer %.1f MB/s -> %.1f MB/s"
+                    % (base["lexer_mb_per_second"], result["lexer_mb_per_second"]))
+    return regressions
+
+def main():
+    parser = optparse.OptionParser(usage="%prog [options] <corpus file>")
+    parser.add_option("--driver", help="Driver executable (e.g. src/driver/plaincxx)")
+    parser.add_option("--config-dir", help="Configuration directory of the driver")
+    parser.add_option("--baseline", help="Baseline JSON file")
+    parser.add_option("--output", help="Write the results of this run to this JSON file")
+    parser.add_option("--update-baseline", action="store_true", default=False,
+            help="Store the results of this run as the new baseline")
+    parser.add_option("--repeat", type="int", default=3,
+            help="Number of runs of each benchmark [default: %default]")
+    parser.add_option("--time-threshold", type="float", default=10.0,
+            help="Allowed wall time increase in percent [default: %default]")
+    parser.add_option("--rss-threshold", type="float", default=10.0,
+            help="Allowed peak RSS increase in percent [default: %default]")
+    parser.add_option("--phase-threshold", type="float", default=20.0,
+            help="Allowed per-phase time increase in percent [default: %default]")
+    parser.add_option("--lexer-threshold", type="float", default=20.0,
+            help="Allowed lexer throughput decrease in percent [default: %default]")
+    parser.add_option("--min-seconds", type="float", default=0.05,
+            help="Times below this are not considered regressions [default: %default]")
+    parser.add_option("--only", action="append", default=[],
+            help="Only run this benchmark (can be repeated)")
+
+    (options, args) = parser.parse_args()
+    if len(args) != 1 or options.driver is None or options.config_dir is None:
+        parser.print_help()
+        return 2
+    if options.repeat < 1:
+        parser.error("--repeat must be at least 1")
+
+    corpus = load_corpus(args[0])
+    if options.only:
+        corpus = [bench for bench in corpus if bench["name"] in options.only]
+
+    baseline = {}
+    if options.baseline is not None:
+        baseline = load_baseline(options.baseline)
+
+    results = {}
+    failed = []
+    regressed = []
+    for bench in corpus:
+        name = bench["name"]
+        result = run_benchmark(options, bench)
+        if result is None:
+            failed.append(name)
+            continue
+        results[name] = result
+
+        status = "new"
+        regressions = []
+        if name in baseline:
+            regressions = compare(options, name, result, baseline[name])
+            status = "REGRESSED" if regressions else "ok"
+        print("%-32s %9.3fs %10d KB  %s" % (name, result["wall_seconds"], result["peak_rss_kb"], status))
+        for regression in regressions:
+            print("    %s" % regression)
+        if regressions:
+            regressed.append(name)
+
+    report = {"benchmarks" : results}
+    if options.output is not None:
+        f = open(options.output, "w")
+        json.dump(report, f, indent=2, sort_keys=True)
+        f.close()
+
+    if options.update_baseline:
+        if options.baseline is None:
+            parser.error("--update-baseline requires --baseline")
+        if failed:
+            sys.stderr.write("Not updating the baseline because some benchmarks failed\n")
+            return 1
+        # Keep the entries of the benchmarks we did not run this time
+        merged = load_baseline(options.baseline)
+        merged.update(results)
+        f = open(options.baseline, "w")
+        json.dump({"benchmarks" : merged}, f, indent=2, sort_keys=True)
+        f.write("\n")
+        f.close()
+        print("Baseline '%s' updated" % options.baseline)
+        return 0
+
+    if failed:
+        print("Failed benchmarks: %s" % " ".join(failed))
+    if regressed:
+        print("Regressed benchmarks: %s" % " ".join(regressed))
+    if failed or regressed:
+        return 1
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
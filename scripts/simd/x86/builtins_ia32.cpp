@@ -59,6 +59,8 @@ GENERATE_MANY(double)
 #define END
 
 #define VECTOR_INTRINSICS_LIST \
+VECTOR_INTRIN(__builtin_cpu_init) \
+VECTOR_INTRIN(__builtin_cpu_supports) \
 VECTOR_INTRIN(__builtin_ia32_addcarryx_u32) \
 VECTOR_INTRIN(__builtin_ia32_addcarryx_u64) \
 VECTOR_INTRIN(__builtin_ia32_addpd) \
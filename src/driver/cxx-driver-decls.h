@@ -183,6 +183,8 @@ typedef struct debug_options_tag
     char show_template_packs;
     char vectorization_verbose;
     char stats_string_table;
+    char lowering_stats;
+    char keep_parse_tree;
 } debug_options_t;
 
 extern debug_options_t debug_options;
@@ -360,6 +362,10 @@ typedef struct parameter_linker_command_tag
 
 typedef const char* (*print_vector_type_fun)(const decl_context_t*, type_t*, print_symbol_callback_t, void*);
 
+// Defaults of --constexpr-depth and --constexpr-steps
+#define DEFAULT_CONSTEXPR_MAX_DEPTH 512
+#define DEFAULT_CONSTEXPR_MAX_STEPS 1048576
+
 typedef struct compilation_configuration_tag
 {
     const char *configuration_name;
@@ -405,6 +411,16 @@ typedef struct compilation_configuration_tag
     int input_column_width;
     int output_column_width;
 
+    // Limits of the evaluation of constexpr calls in a constant expression
+    int constexpr_max_depth;
+    int constexpr_max_steps;
+
+    // Index the nodecl tree by node kind while running the compiler phases
+    char nodecl_index;
+
+    // Run consecutive fusable phases in a single traversal
+    char fuse_phases;
+
     // Disable Fortran intrinsics
     int num_disabled_intrinsics;
     const char ** disabled_intrinsics_list;
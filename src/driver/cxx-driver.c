@@ -83,6 +83,8 @@
 #include "cxx-nodecl-checker.h"
 #include "cxx-limits.h"
 #include "cxx-diagnostic.h"
+#include "cxx-compile-stats.h"
+#include "cxx-nodecl-index.h"
 // It does not include any C++ code in the header
 #include "cxx-compilerphases.hpp"
 #include "cxx-codegen.h"
@@ -133,6 +135,14 @@
 "  --output-dir=<dir>       Prettyprinted files will be left in\n" \
 "                           directory <dir>. Otherwise the input\n" \
 "                           file directory is used\n" \
+"  --compile-stats=<file>   Writes a JSON report of the compilation\n" \
+"                           time and nodecl nodes spent in every\n" \
+"                           declaration, instantiation and phase\n" \
+"  --nodecl-index           Keeps an index of the nodes of each kind\n" \
+"                           while the compiler phases run so they\n" \
+"                           can find them without walking the tree\n" \
+"  --fuse-phases            Runs consecutive phases that support it\n" \
+"                           in a single traversal of the tree\n" \
 "  --debug-flags=<flags>    Comma-separated list of flags for used\n" \
 "                           when debugging. Valid flags can be listed\n" \
 "                           with --help-debug-flags\n" \
@@ -173,6 +183,13 @@
 "                           cannot be checked compilation fails.\n" \
 "  --disable-gxx-traits     Disables g++ 4.3 type traits. Required\n" \
 "                           if you use g++ 4.2 or previous.\n" \
+"  --constexpr-depth=<n>    Maximum nesting of constexpr calls\n" \
+"                           when evaluating a constant expression\n" \
+"                           (default 512)\n" \
+"  --constexpr-steps=<n>    Maximum number of constexpr calls and\n" \
+"                           statements evaluated for a constant\n" \
+"                           expression\n" \
+"                           (default 1048576)\n" \
 "  --env=<env-name>         Sets <env-name> as the specific\n" \
 "                           environment. Use --list-env to show\n" \
 "                           currently supported environments\n" \
@@ -372,7 +389,10 @@ typedef enum
     OPTION_UNDEFINED = 1024,
     // Keep the following options sorted (but leave OPTION_UNDEFINED as is)
     OPTION_ALWAYS_PREPROCESS,
+    OPTION_COMPILE_STATS,
     OPTION_CONFIG_DIR,
+    OPTION_CONSTEXPR_DEPTH,
+    OPTION_CONSTEXPR_STEPS,
     OPTION_DEBUG_FLAG,
     OPTION_DISABLE_FILE_LOCKING,
     OPTION_DISABLE_GXX_TRAITS,
@@ -404,6 +424,7 @@ typedef enum
     OPTION_FORTRAN_PREPROCESSOR,
     OPTION_FORTRAN_PRESCANNER,
     OPTION_FORTRAN_REAL_KIND,
+    OPTION_FUSE_PHASES,
     OPTION_HELP_DEBUG_FLAGS,
     OPTION_HELP_TARGET_OPTIONS,
     OPTION_IFORT_COMPATIBILITY,
@@ -416,6 +437,7 @@ typedef enum
     OPTION_LIST_VECTOR_FLAVORS,
     OPTION_MODULE_OUT_PATTERN,
     OPTION_NATIVE_COMPILER_NAME,
+    OPTION_NODECL_INDEX,
     OPTION_NO_OPENMP,
     OPTION_NO_WHOLE_FILE,
     OPTION_OPENCL_OPTIONS,
@@ -460,6 +482,9 @@ struct command_line_long_options command_line_long_options[] =
     {"profile", CLP_REQUIRED_ARGUMENT, OPTION_PROFILE},
 
     {"output-dir",  CLP_REQUIRED_ARGUMENT, OPTION_OUTPUT_DIRECTORY},
+    {"compile-stats", CLP_REQUIRED_ARGUMENT, OPTION_COMPILE_STATS},
+    {"nodecl-index", CLP_NO_ARGUMENT, OPTION_NODECL_INDEX},
+    {"fuse-phases", CLP_NO_ARGUMENT, OPTION_FUSE_PHASES},
     {"cc", CLP_REQUIRED_ARGUMENT, OPTION_NATIVE_COMPILER_NAME},
     {"cxx", CLP_REQUIRED_ARGUMENT, OPTION_NATIVE_COMPILER_NAME},
     {"cpp", CLP_REQUIRED_ARGUMENT, OPTION_PREPROCESSOR_NAME},
@@ -473,6 +498,8 @@ struct command_line_long_options command_line_long_options[] =
     {"typecheck", CLP_NO_ARGUMENT, OPTION_TYPECHECK},
     {"pp-stdout", CLP_NO_ARGUMENT, OPTION_PREPROCESSOR_USES_STDOUT},
     {"disable-gxx-traits", CLP_NO_ARGUMENT, OPTION_DISABLE_GXX_TRAITS},
+    {"constexpr-depth", CLP_REQUIRED_ARGUMENT, OPTION_CONSTEXPR_DEPTH},
+    {"constexpr-steps", CLP_REQUIRED_ARGUMENT, OPTION_CONSTEXPR_STEPS},
     {"pass-through", CLP_NO_ARGUMENT, OPTION_PASS_THROUGH}, 
     {"disable-sizeof", CLP_NO_ARGUMENT, OPTION_DISABLE_SIZEOF},
     {"env", CLP_REQUIRED_ARGUMENT, OPTION_SET_ENVIRONMENT},
@@ -699,6 +726,8 @@ int main(int argc, char* argv[])
         stats_string_table();
     }
 
+    compile_stats_write_report();
+
     return compilation_process.execution_result;
 }
 
@@ -1138,6 +1167,21 @@ int parse_arguments(int argc, const char* argv[],
                         CURRENT_CONFIGURATION->do_not_link = 1;
                         break;
                     }
+                case OPTION_COMPILE_STATS:
+                    {
+                        compile_stats_set_output_filename(parameter_info.argument);
+                        break;
+                    }
+                case OPTION_NODECL_INDEX:
+                    {
+                        CURRENT_CONFIGURATION->nodecl_index = 1;
+                        break;
+                    }
+                case OPTION_FUSE_PHASES:
+                    {
+                        CURRENT_CONFIGURATION->fuse_phases = 1;
+                        break;
+                    }
                 case OPTION_PROFILE :
                 case OPTION_CONFIG_DIR:
                     {
@@ -1350,6 +1394,30 @@ int parse_arguments(int argc, const char* argv[],
                         CURRENT_CONFIGURATION->disable_gxx_type_traits = 1;
                         break;
                     }
+                case OPTION_CONSTEXPR_DEPTH:
+                    {
+                        CURRENT_CONFIGURATION->constexpr_max_depth = atoi(parameter_info.argument);
+                        if (CURRENT_CONFIGURATION->constexpr_max_depth <= 0)
+                        {
+                            fprintf(stderr, "%s: invalid value '%s' for --constexpr-depth\n",
+                                    compilation_process.exec_basename,
+                                    parameter_info.argument);
+                            return 1;
+                        }
+                        break;
+                    }
+                case OPTION_CONSTEXPR_STEPS:
+                    {
+                        CURRENT_CONFIGURATION->constexpr_max_steps = atoi(parameter_info.argument);
+                        if (CURRENT_CONFIGURATION->constexpr_max_steps <= 0)
+                        {
+                            fprintf(stderr, "%s: invalid value '%s' for --constexpr-steps\n",
+                                    compilation_process.exec_basename,
+                                    parameter_info.argument);
+                            return 1;
+                        }
+                        break;
+                    }
                 case OPTION_ENABLE_MS_BUILTIN:
                     {
                         CURRENT_CONFIGURATION->enable_ms_builtin_types = 1;
@@ -2697,6 +2765,9 @@ static void initialize_default_values(void)
     CURRENT_CONFIGURATION->input_column_width = 72;
     CURRENT_CONFIGURATION->output_column_width = 132;
 
+    CURRENT_CONFIGURATION->constexpr_max_depth = DEFAULT_CONSTEXPR_MAX_DEPTH;
+    CURRENT_CONFIGURATION->constexpr_max_steps = DEFAULT_CONSTEXPR_MAX_STEPS;
+
     // Add openmp as an implicitly enabled
     // SMATEO: is this suff needed anymore??
     //
@@ -3213,6 +3284,8 @@ static void compile_every_translation_unit_aux_(int num_translation_units,
                 // Initialize diagnostics
                 diagnostics_reset();
 
+                compile_stats_begin_translation_unit(translation_unit->input_filename);
+
                 // Fill the context with initial information
                 initialize_semantic_analysis(translation_unit, parsed_filename);
 
@@ -3285,6 +3358,8 @@ static void compile_every_translation_unit_aux_(int num_translation_units,
                 // * TL::run and TL::phase_cleanup
                 compiler_phases_execution(CURRENT_CONFIGURATION, translation_unit, parsed_filename);
 
+                compile_stats_end_translation_unit();
+
                 // * print ast if requested
                 if (debug_options.print_nodecl_graphviz)
                 {
@@ -3448,8 +3523,15 @@ static void compiler_phases_execution(
     timing_t time_phases;
     timing_start(&time_phases);
 
+    if (config->nodecl_index)
+    {
+        nodecl_index_begin(translation_unit->nodecl);
+    }
+
     start_compiler_phase_execution(config, translation_unit);
 
+    nodecl_index_end();
+
     timing_end(&time_phases);
 
     if (CURRENT_CONFIGURATION->verbose)
@@ -3469,6 +3551,7 @@ static void parse_translation_unit(translation_unit_t* translation_unit, const c
     }
 
     timing_start(&timing_parsing);
+    compile_stats_push_category(COMPILE_STATS_PARSING);
 
     AST parsed_tree = NULL;
 
@@ -3500,6 +3583,7 @@ static void parse_translation_unit(translation_unit_t* translation_unit, const c
     // The filename can be used in the future (e.g. in tl-nanos.cpp)
     ast_set_locus(translation_unit->parsed_tree, make_locus(translation_unit->input_filename, 0, 0));
     
+    compile_stats_pop_category();
     timing_end(&timing_parsing);
 
     if (CURRENT_CONFIGURATION->verbose)
@@ -3541,6 +3625,7 @@ static void semantic_analysis(translation_unit_t* translation_unit, const char*
     timing_t timing_semantic;
 
     timing_start(&timing_semantic);
+    compile_stats_push_category(COMPILE_STATS_BUILD_SCOPE);
     nodecl_t nodecl;
     if (IS_C_LANGUAGE
             || IS_CXX_LANGUAGE)
@@ -3556,6 +3641,7 @@ static void semantic_analysis(translation_unit_t* translation_unit, const char*
         internal_error("%s: invalid language kind\n", 
                 parsed_filename);
     }
+    compile_stats_pop_category();
     timing_end(&timing_semantic);
 
     // This may have been extended during prerun
@@ -3607,6 +3693,15 @@ static void semantic_analysis(translation_unit_t* translation_unit, const char*
                 timing_elapsed(&timing_check_tree));
     }
 
+    if (debug_options.keep_parse_tree)
+    {
+        if (CURRENT_CONFIGURATION->verbose)
+        {
+            fprintf(stderr, "Keeping parse tree\n");
+        }
+        return;
+    }
+
     timing_t timing_free_tree;
     if (CURRENT_CONFIGURATION->verbose)
     {
@@ -5349,6 +5444,8 @@ static void print_memory_report(void)
             sizeof(scope_entry_t));
     fprintf(stderr, "Size of entity specifiers (bytes): %zd\n",
             sizeof(entity_specifiers_t));
+    fprintf(stderr, "Size of cold entity specifiers (bytes): %zd\n",
+            sizeof(entity_specifiers_cold_t));
     fprintf(stderr, "Size of a context (bytes): %zd\n",
             sizeof(const decl_context_t*));
     fprintf(stderr, "Size of a type (bytes): %zd\n",
@@ -5379,11 +5476,29 @@ static void print_memory_report(void)
         translation_unit_t* translation_unit = file_process->translation_unit;
 
         compute_tree_breakdown(translation_unit->parsed_tree, children_count, children_real_count, &num_nodes);
+        compute_tree_breakdown(nodecl_get_ast(translation_unit->nodecl), children_count, children_real_count, &num_nodes);
     }
 
     fprintf(stderr, " - AST node size (bytes): %d\n", ast_node_size());
     fprintf(stderr, " - Total number of AST nodes: %d\n", num_nodes);
 
+    unsigned long long live_nodes = 0, peak_live_nodes = 0, pool_bytes = 0;
+    ast_node_stats(&live_nodes, &peak_live_nodes, &pool_bytes);
+    fprintf(stderr, " - Live AST nodes: %llu\n", live_nodes);
+    fprintf(stderr, " - Peak of live AST nodes: %llu\n", peak_live_nodes);
+
+#ifdef COMPACT_AST_NODES
+    {
+        char pool_str[256];
+#ifdef HAVE_MALLINFO
+        print_human(pool_str, pool_bytes);
+#else
+        sprintf(pool_str, "%llu", pool_bytes);
+#endif
+        fprintf(stderr, " - Size of the AST node pool: %s\n", pool_str);
+    }
+#endif
+
     for (i = 0; i < MCXX_MAX_AST_CHILDREN + 1; i++)
     {
         fprintf(stderr, " - Nodes with %d children: %d\n", i, children_count[i]);
@@ -57,6 +57,9 @@ compilation_configuration_t* new_compilation_configuration(
     result->input_column_width = 72;
     result->output_column_width = 132;
 
+    result->constexpr_max_depth = DEFAULT_CONSTEXPR_MAX_DEPTH;
+    result->constexpr_max_steps = DEFAULT_CONSTEXPR_MAX_STEPS;
+
     return result;
 }
 
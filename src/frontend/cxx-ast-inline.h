@@ -30,10 +30,19 @@
 
 #include "mem.h"
 #include "cxx-process.h"
+#include "cxx-nodecl-index.h"
 #include <stdint.h>
 
 MCXX_BEGIN_DECLS
 
+#ifdef COMPACT_AST_NODES
+// Nodes are allocated from a pool and refer to each other using 32-bit
+// indices into it. Index 0 is never used so it stands for NULL
+typedef uint32_t ast_ref_t;
+#else
+typedef struct AST_tag* ast_ref_t;
+#endif
+
 // Definition of the type
 typedef
 struct AST_tag
@@ -44,31 +53,113 @@ struct AST_tag
     // This is a bitmap for the sons
     unsigned int bitmap_sons:MCXX_MAX_AST_CHILDREN;
 
-    // Number of ambiguities of this node
-    int num_ambig;
+    // Set by ast_free, some trees are DAGs
+    unsigned int being_freed:1;
 
-    // Parent node
-    struct AST_tag* parent;
+    // Used by ast_discarded_free to mark the nodes still in use
+    unsigned int reachable:1;
 
-    // Node locus
-    const locus_t* locus;
+    // This node was an ambiguity whose discarded interpretations have not
+    // been freed yet
+    unsigned int has_discarded:1;
 
-    // Textual information linked to the node
-    // normally the symbol or the literal
-    const char* text;
+#ifdef COMPACT_AST_NODES
+    // This node is in the free list of the pool
+    unsigned int released:1;
+#endif
+
+    union
+    {
+        // Number of ambiguities of this node (AST_AMBIGUITY)
+        int num_ambig;
+        // Position of this node in its list descriptor (AST_NODE_LIST)
+        int list_seq;
+    };
+
+#ifdef COMPACT_AST_NODES
+    // Index of this node in the pool
+    ast_ref_t self;
+#endif
+
+    // Parent node
+    ast_ref_t parent;
 
     union
     {
-        // The children of this tree (except for AST_AMBIGUITY)
-        struct AST_tag** children;
+        // The children of this tree (except for AST_AMBIGUITY). Child i
+        // is always in children[i] so no separate array is needed
+        ast_ref_t children[MCXX_MAX_AST_CHILDREN];
         // When type == AST_AMBIGUITY, all intepretations are here
         struct AST_tag** ambig;
     };
 
+    union
+    {
+        // Node locus (except for AST_NODE_LIST)
+        const locus_t* locus;
+        // When type == AST_NODE_LIST, descriptor shared by all the nodes of
+        // the chain. Lists have a calculated locus so we reuse the field
+        struct ast_list_info_tag* list_info;
+    };
+
+    // Textual information linked to the node
+    // normally the symbol or the literal
+    const char* text;
+
     // This is used by nodecl trees
     struct nodecl_expr_info_tag* expr_info;
 } AST_node_t;
 
+#ifdef COMPACT_AST_NODES
+enum
+{
+    AST_POOL_CHUNK_BITS = 12,
+    AST_POOL_CHUNK_SIZE = 1 << AST_POOL_CHUNK_BITS
+};
+
+// Chunks of the pool. They never move, only this table does
+LIBMCXX_EXTERN AST_node_t** ast_pool_chunks;
+
+static inline AST ast_ref_to_node(ast_ref_t ref)
+{
+    if (ref == 0)
+        return NULL;
+    return &ast_pool_chunks[ref >> AST_POOL_CHUNK_BITS][ref & (AST_POOL_CHUNK_SIZE - 1)];
+}
+
+static inline ast_ref_t ast_node_to_ref(const_AST a)
+{
+    if (a == NULL)
+        return 0;
+    return a->self;
+}
+#else
+static inline AST ast_ref_to_node(ast_ref_t ref)
+{
+    return ref;
+}
+
+static inline ast_ref_t ast_node_to_ref(const_AST a)
+{
+    return (AST)a;
+}
+#endif
+
+// *dest = *src but keeping what identifies dest
+static inline void ast_node_assign(AST dest, const_AST src)
+{
+    unsigned int has_discarded = dest->has_discarded;
+#ifdef COMPACT_AST_NODES
+    ast_ref_t self = dest->self;
+    *dest = *src;
+    dest->self = self;
+#else
+    *dest = *src;
+#endif
+    dest->being_freed = 0;
+    dest->has_discarded = has_discarded;
+}
+
 
 static inline node_t ast_get_kind(const_AST a)
 {
@@ -77,7 +168,7 @@ static inline node_t ast_get_kind(const_AST a)
 
 static inline AST ast_get_parent(const_AST a)
 {
-    return a->parent;
+    return ast_ref_to_node(a->parent);
 }
 
 static inline unsigned int ast_get_line(const_AST a)
@@ -102,32 +193,22 @@ static inline void ast_set_text(AST a, const char* str)
 
 static inline void ast_set_kind(AST a, node_t node_type)
 {
-    a->node_type = node_type;
-}
-
-static inline int ast_bitmap_to_index(unsigned int bitmap, int num)
-{
-    ERROR_CONDITION(((1 << num) & bitmap) == 0,
-            "Invalid bitmap!", 0);
-#if HAVE__BUILTIN_POPCOUNT
-    bitmap = bitmap & (~(~0U << num));
-    return __builtin_popcount(bitmap);
-#else
-    int i;
-    int s = 0;
-    for (i = 0; i < num; i++)
+    if (a->node_type == AST_NODE_LIST
+            && node_type != AST_NODE_LIST)
     {
-        s += bitmap & 1;
-        bitmap = bitmap >> 1;
+        ast_list_release_info(a);
+        a->locus = NULL;
     }
+    else if (a->node_type != AST_NODE_LIST
+            && node_type == AST_NODE_LIST)
+    {
+        a->list_info = NULL;
+        a->list_seq = 0;
+    }
+    a->node_type = node_type;
 
-    return s;
-#endif
-}
-
-ALWAYS_INLINE static inline int ast_son_num_to_son_index(const_AST a, int num_son)
-{
-    return ast_bitmap_to_index(a->bitmap_sons, num_son);
+    if (nodecl_index_active)
+        nodecl_index_update(a);
 }
 
 ALWAYS_INLINE static inline char ast_has_son(const_AST a, int son)
@@ -139,7 +220,7 @@ ALWAYS_INLINE static inline AST ast_get_child(const_AST a, int num_child)
 {
     if (ast_has_son(a, num_child))
     {
-        return a->children[ast_son_num_to_son_index(a, num_child)];
+        return ast_ref_to_node(a->children[num_child]);
     }
     else
     {
@@ -149,7 +230,7 @@ ALWAYS_INLINE static inline AST ast_get_child(const_AST a, int num_child)
 
 static inline void ast_set_parent(AST a, AST parent)
 {
-    a->parent = parent;
+    a->parent = ast_node_to_ref(parent);
 }
 
 static inline int ast_count_bitmap(unsigned int bitmap)
@@ -173,37 +254,24 @@ static inline AST ast_make(node_t type, int __num_children UNUSED_PARAMETER,
         AST child0, AST child1, AST child2, AST child3, 
         const locus_t* location, const char *text)
 {
-    AST result = NEW(AST_node_t);
-    // ERROR_CONDITION(result & 0x1 != 0, "Invalid pointer for AST", 0);
+    // The node is zeroed so the parent and the absent children are NULL
+    AST result = ast_node_alloc();
 
     result->node_type = type;
 
-    int num_children = 0;
-    unsigned int bitmap_sons = 0;
-
-    result->bitmap_sons = bitmap_sons;
-    result->parent = NULL;
-    result->locus = location;
+    if (type != AST_NODE_LIST)
+    {
+        result->locus = location;
+    }
 
     result->text = text;
 
-    bitmap_sons =
-        (!!child0)
-        | (!!child1 << 1)
-        | (!!child2 << 2)
-        | (!!child3 << 3);
-    num_children = ast_count_bitmap(bitmap_sons);
-
-    result->bitmap_sons = bitmap_sons;
-    result->children = NEW_VEC(AST, num_children);
-
-    int idx = 0;
 #define ADD_SON(n) \
     if (child##n != NULL) \
     { \
-        result->children[idx] = child##n; \
-        child##n->parent = result; \
-        idx++; \
+        result->bitmap_sons |= (1 << n); \
+        result->children[n] = ast_node_to_ref(child##n); \
+        ast_set_parent(child##n, result); \
     }
 
     ADD_SON(0);
@@ -212,21 +280,15 @@ static inline AST ast_make(node_t type, int __num_children UNUSED_PARAMETER,
     ADD_SON(3);
 #undef ADD_SON
 
-    result->expr_info = NULL;
+    if (nodecl_index_active)
+        nodecl_index_add_tree(result);
 
     return result;
 }
 
-// This function works both for shrinking or widening
-static inline void ast_reallocate_children(AST a, int num_child, AST new_child)
+// Updates the child slot and the bitmap, nothing else
+static inline void ast_store_child(AST a, int num_child, AST new_child)
 {
-    // Reallocate childrens
-    // Save the old children array
-    AST* old_children = a->children;
-    // And the old children bitmap
-    unsigned int old_bitmap = a->bitmap_sons;
-
-    // Enable or disable this new son depending on it being null
     if (new_child != NULL)
     {
         a->bitmap_sons = (a->bitmap_sons | (1 << num_child));
@@ -235,58 +297,25 @@ static inline void ast_reallocate_children(AST a, int num_child, AST new_child)
     {
         a->bitmap_sons = (a->bitmap_sons & (~(1 << num_child)));
     }
-
-    a->children = NEW_VEC(AST, ast_count_bitmap(a->bitmap_sons));
-
-    // Now for every old son, update the new children
-    int i;
-    for (i = 0; i < MCXX_MAX_AST_CHILDREN; i++)
-    {
-        // Note that when shrinking the node ast_has_son
-        // will always return false for num_child.
-        if (ast_has_son(a, i))
-        {
-            if (i == num_child)
-            {
-                // The new son
-                a->children[ast_son_num_to_son_index(a, i)] = new_child;
-            }
-            else
-            {
-                // Old sons that are updated their position
-                a->children[ast_son_num_to_son_index(a, i)] = 
-                    old_children[ast_bitmap_to_index(old_bitmap, i)];
-            }
-        }
-    }
-
-    // Now DELETE the old children (if any)
-    if (old_children != NULL)
-        DELETE(old_children);
+    a->children[num_child] = ast_node_to_ref(new_child);
 }
 
 static inline void ast_set_child_but_parent(AST a, int num_child, AST new_child)
 {
-    if (new_child == NULL)
+    if (nodecl_index_active
+            && new_child != NULL)
     {
-        if (ast_has_son(a, num_child))
-        {
-            // Shrink the node if we have it
-            ast_reallocate_children(a, num_child, new_child);
-        }
+        nodecl_index_attach(a, new_child);
     }
-    else
+
+    if (num_child == 0
+            && a->node_type == AST_NODE_LIST)
     {
-        if (ast_has_son(a, num_child))
-        {
-            a->children[ast_son_num_to_son_index(a, num_child)] = new_child;
-        }
-        else
-        {
-            // This will widen the node
-            ast_reallocate_children(a, num_child, new_child);
-        }
+        // The chain of this list is about to change
+        ast_list_update_info(a, new_child);
     }
+
+    ast_store_child(a, num_child, new_child);
 }
 
 static inline void ast_set_child(AST a, int num_child, AST new_child)
@@ -294,7 +323,7 @@ static inline void ast_set_child(AST a, int num_child, AST new_child)
     ast_set_child_but_parent(a, num_child, new_child);
     if (new_child != NULL)
     {
-        new_child->parent = a;
+        ast_set_parent(new_child, a);
     }
 }
 
@@ -311,6 +340,11 @@ static inline AST ast_list(AST list, AST last_elem)
     AST a = ast_make(AST_NODE_LIST, 2, list, last_elem, NULL, NULL, 
             NULL, /* lists have a calculated locus not a physical one */
             ast_get_text(last_elem));
+    if (list != NULL)
+    {
+        // If 'list' is the last node of a described chain this is O(1)
+        ast_list_update_info(a, list);
+    }
     return a;
 }
 
@@ -319,23 +353,6 @@ static inline AST ast_list_leaf(AST a)
     return ast_list(NULL, a);
 }
 
-static inline AST ast_list_head(const_AST list)
-{
-    if (list == NULL)
-        return NULL;
-
-    if (ASTKind(list) != AST_NODE_LIST)
-        return NULL;
-
-    const_AST iter;
-    for_each_element(list, iter)
-    {
-        return (AST)iter;
-    }
-
-    return NULL;
-}
-
 static inline AST ast_list_concat(AST before, AST after)
 {
     if (before == NULL)
@@ -447,7 +464,9 @@ static inline AST ast_make_ambiguous(AST son0, AST son1)
         result->ambig = NEW_VEC(AST, result->num_ambig);
         result->ambig[0] = son0;
         result->ambig[1] = son1;
-        result->locus = son0->locus;
+        // Lists do not have a physical locus
+        if (ASTKind(son0) != AST_NODE_LIST)
+            result->locus = son0->locus;
 
         return result;
     }
@@ -455,7 +474,21 @@ static inline AST ast_make_ambiguous(AST son0, AST son1)
 
 static inline void ast_replace(AST dest, const_AST src)
 {
-    *dest = *src;
+    if (ASTKind(dest) == AST_NODE_LIST)
+    {
+        // The chain where dest was is going to change
+        ast_list_release_info(dest);
+    }
+    ast_node_assign(dest, src);
+    if (ASTKind(dest) == AST_NODE_LIST)
+    {
+        // dest is not the node described by the descriptor of src
+        dest->list_info = NULL;
+        dest->list_seq = 0;
+    }
+
+    if (nodecl_index_active)
+        nodecl_index_update(dest);
 }
 
 static inline void ast_free(AST a)
@@ -463,14 +496,28 @@ static inline void ast_free(AST a)
     if (a == NULL)
         return;
 
-    // Already visited. See below
-    if (__builtin_expect(((((intptr_t)a->parent) & 0x1) == 0x1), 0))
+    // Already visited, avoids infinite recursion under the presence of
+    // cycles
+    if (__builtin_expect(a->being_freed, 0))
         return;
 
-    // Tag this node as visited to avoid infinite recursion under the presence
-    // of cycles (note that this works as long as AST pointers are at least
-    // aligned to two bytes)
-    a->parent = (struct AST_tag*)(((intptr_t)a->parent) | 0x1);
+    if (a->has_discarded)
+    {
+        // The interpretations discarded inside this tree may share nodes
+        // with it
+        ast_free_with_discarded(a);
+        return;
+    }
+
+    a->being_freed = 1;
+
+    if (nodecl_index_active)
+        nodecl_index_remove(a);
+
+    if (ast_get_kind(a) == AST_NODE_LIST)
+    {
+        ast_list_release_info(a);
+    }
 
     if (ast_get_kind(a) == AST_AMBIGUITY)
     {
@@ -479,6 +526,7 @@ static inline void ast_free(AST a)
         {
             ast_free(ast_get_ambiguity(a, i));
         }
+        DELETE(a->ambig);
     }
     else
     {
@@ -490,10 +538,7 @@ static inline void ast_free(AST a)
     }
 
     DELETE(a->expr_info);
-    DELETE(a->children);
-    // Clear the node for safety
-    // __builtin_memset(a, 0, sizeof(*a));
-    DELETE(a);
+    ast_node_release(a);
 }
 
 static inline void ast_replace_with_ambiguity(AST a, int n)
@@ -512,19 +557,23 @@ static inline void ast_replace_with_ambiguity(AST a, int n)
     // }
 
     AST chosen_ambig = ast_get_ambiguity(a, n);
+    AST* ambig = a->ambig;
+    int num_ambig = a->num_ambig;
     ast_replace(a, chosen_ambig);
 
     // Correctly relink to the parent
     ast_set_parent(a, parent);
     ast_fix_parents_inside_intepretation(a);
 
+    if (ast_discarded_tracking > 0)
+        ast_discard_interpretations(a, ambig, num_ambig, n);
+
     // if (!ASTCheck(a))
     // {
     //     internal_error("*** INCONSISTENT TREE DETECTED IN DISAMBIGUATED TREE %p ***\n", a);
     // }
 }
 
-static inline AST ast_list_head(const_AST list);
 static inline const locus_t* ast_get_locus(const_AST a)
 {
     if (a == NULL)
@@ -216,9 +216,18 @@ char ast_check_list_tree(const_AST a)
 
 static void ast_copy_one_node(AST dest, AST orig)
 {
-    *dest = *orig;
+    ast_node_assign(dest, orig);
     dest->bitmap_sons = 0;
-    dest->children = 0;
+    memset(dest->children, 0, sizeof(dest->children));
+    if (ast_get_kind(dest) == AST_NODE_LIST)
+    {
+        // The copy does not belong to the chain of orig
+        dest->list_info = NULL;
+        dest->list_seq = 0;
+    }
+
+    if (nodecl_index_active)
+        nodecl_index_update(dest);
 }
 
 AST ast_duplicate_one_node(AST orig)
@@ -234,7 +243,7 @@ AST ast_copy(const_AST a)
     if (a == NULL)
         return NULL;
 
-    AST result = NEW0(AST_node_t);
+    AST result = ast_node_alloc();
 
     ast_copy_one_node(result, (AST)a);
 
@@ -251,11 +260,6 @@ AST ast_copy(const_AST a)
     }
     else
     {
-        result->bitmap_sons = a->bitmap_sons;
-        int num_children = ast_count_bitmap(result->bitmap_sons);
-
-        result->children = NEW_VEC(AST, num_children);
-
         for (i = 0; i < MCXX_MAX_AST_CHILDREN; i++)
         {
             AST c = ast_copy(ast_get_child(a, i));
@@ -269,7 +273,10 @@ AST ast_copy(const_AST a)
         result->text = a->text;
     }
 
-    result->parent = NULL;
+    ast_set_parent(result, NULL);
+
+    if (nodecl_index_active)
+        nodecl_index_add_tree(result);
 
     return result;
 }
@@ -279,6 +286,875 @@ AST ast_copy_for_instantiation(const_AST a)
     return ast_copy(a);
 }
 
+/*
+   Node allocation
+ */
+static unsigned long long ast_live_nodes = 0;
+static unsigned long long ast_peak_live_nodes = 0;
+
+#ifdef COMPACT_AST_NODES
+AST_node_t** ast_pool_chunks = NULL;
+static int ast_pool_num_chunks = 0;
+// Index 0 stands for NULL so it is never handed out
+static ast_ref_t ast_pool_next_index = 1;
+// Released nodes are chained through their parent
+static ast_ref_t ast_pool_free_list = 0;
+
+AST ast_node_alloc(void)
+{
+    ast_ref_t self;
+    if (ast_pool_free_list != 0)
+    {
+        self = ast_pool_free_list;
+        ast_pool_free_list = ast_ref_to_node(self)->parent;
+    }
+    else
+    {
+        ERROR_CONDITION(ast_pool_next_index == 0, "Too many AST nodes for 32-bit indices", 0);
+
+        self = ast_pool_next_index;
+        ast_pool_next_index++;
+
+        if ((int)(self >> AST_POOL_CHUNK_BITS) == ast_pool_num_chunks)
+        {
+            ast_pool_num_chunks++;
+            ast_pool_chunks = NEW_REALLOC(AST_node_t*, ast_pool_chunks, ast_pool_num_chunks);
+            ast_pool_chunks[ast_pool_num_chunks - 1] = NEW_VEC(AST_node_t, AST_POOL_CHUNK_SIZE);
+        }
+    }
+
+    AST result = ast_ref_to_node(self);
+    memset(result, 0, sizeof(*result));
+    result->self = self;
+
+    ast_live_nodes++;
+    if (ast_live_nodes > ast_peak_live_nodes)
+        ast_peak_live_nodes = ast_live_nodes;
+
+    return result;
+}
+
+void ast_node_release(AST a)
+{
+    ERROR_CONDITION(a->released, "AST node released twice", 0);
+
+    // Keep being_freed set, ast_free may reach this node again
+    a->released = 1;
+    a->parent = ast_pool_free_list;
+    ast_pool_free_list = a->self;
+
+    ast_live_nodes--;
+}
+#else
+AST ast_node_alloc(void)
+{
+    ast_live_nodes++;
+    if (ast_live_nodes > ast_peak_live_nodes)
+        ast_peak_live_nodes = ast_live_nodes;
+
+    return NEW0(AST_node_t);
+}
+
+void ast_node_release(AST a)
+{
+    ast_live_nodes--;
+    DELETE(a);
+}
+#endif
+
+void ast_node_stats(unsigned long long* live_nodes,
+        unsigned long long* peak_live_nodes,
+        unsigned long long* pool_bytes)
+{
+    *live_nodes = ast_live_nodes;
+    *peak_live_nodes = ast_peak_live_nodes;
+#ifdef COMPACT_AST_NODES
+    *pool_bytes = (unsigned long long)ast_pool_num_chunks * AST_POOL_CHUNK_SIZE * sizeof(AST_node_t);
+#else
+    // Nodes are not allocated in a pool
+    *pool_bytes = 0;
+#endif
+}
+
+/*
+   Discarded interpretations
+
+   ast_replace_with_ambiguity overwrites the ambiguous node with the chosen
+   interpretation, so the other interpretations and the root of the chosen
+   one become unreachable. They cannot be freed right away: interpretations
+   may share nodes and nested ambiguities are solved while the enclosing ones
+   are still being checked. Instead they are recorded here and freed once
+   the enclosing declaration has been completely analyzed
+ */
+typedef enum ast_discarded_kind_tag
+{
+    // An interpretation that was not chosen
+    AST_DISCARDED_INTERPRETATION = 0,
+    // Root of the chosen interpretation, its children now belong to the
+    // resolved node
+    AST_DISCARDED_SHELL
+} ast_discarded_kind_t;
+
+typedef struct ast_discarded_tag
+{
+    // The node that was resolved. NULL if the entry is no longer valid
+    AST resolved;
+    AST node;
+    ast_discarded_kind_t kind;
+} ast_discarded_t;
+
+int ast_discarded_tracking = 0;
+
+static ast_discarded_t* ast_discarded = NULL;
+static int ast_num_discarded = 0;
+static int ast_discarded_capacity = 0;
+
+static void ast_discarded_add(AST resolved, AST node, ast_discarded_kind_t kind)
+{
+    if (ast_num_discarded == ast_discarded_capacity)
+    {
+        ast_discarded_capacity = 2 * ast_discarded_capacity + 64;
+        ast_discarded = NEW_REALLOC(ast_discarded_t, ast_discarded, ast_discarded_capacity);
+    }
+    ast_discarded[ast_num_discarded].resolved = resolved;
+    ast_discarded[ast_num_discarded].node = node;
+    ast_discarded[ast_num_discarded].kind = kind;
+    ast_num_discarded++;
+}
+
+void ast_discard_interpretations(AST resolved, AST* ambig, int num_ambig, int chosen)
+{
+    int i;
+    for (i = 0; i < num_ambig; i++)
+    {
+        if (ambig[i] == NULL)
+            continue;
+        ast_discarded_add(resolved, ambig[i],
+                i == chosen ? AST_DISCARDED_SHELL : AST_DISCARDED_INTERPRETATION);
+    }
+    resolved->has_discarded = 1;
+    DELETE(ambig);
+}
+
+// Frees a single node, its children are not considered
+static void ast_release_one_node(AST a)
+{
+    if (nodecl_index_active)
+        nodecl_index_remove(a);
+
+    if (ASTKind(a) == AST_NODE_LIST)
+        ast_list_release_info(a);
+    else if (ASTKind(a) == AST_AMBIGUITY)
+        DELETE(a->ambig);
+
+    DELETE(a->expr_info);
+    ast_node_release(a);
+}
+
+int ast_discarded_begin(void)
+{
+    ast_discarded_tracking++;
+    return ast_num_discarded;
+}
+
+static void ast_mark_reachable(AST a)
+{
+    if (a == NULL
+            || a->reachable)
+        return;
+    a->reachable = 1;
+
+    int i;
+    if (ASTKind(a) == AST_AMBIGUITY)
+    {
+        for (i = 0; i < a->num_ambig; i++)
+            ast_mark_reachable(a->ambig[i]);
+    }
+    else
+    {
+        for (i = 0; i < MCXX_MAX_AST_CHILDREN; i++)
+            ast_mark_reachable(ast_get_child(a, i));
+    }
+}
+
+// Clears the mark and relinks to 'a' the children whose parent is going to
+// be freed. This happens when the parent of a shared node was in a
+// discarded interpretation
+static void ast_unmark_reachable(AST a)
+{
+    if (a == NULL
+            || !a->reachable)
+        return;
+    a->reachable = 0;
+
+    int i;
+    if (ASTKind(a) == AST_AMBIGUITY)
+    {
+        for (i = 0; i < a->num_ambig; i++)
+        {
+            AST interpretation = a->ambig[i];
+            if (interpretation == NULL)
+                continue;
+            if (ASTParent(interpretation) != NULL
+                    && ASTParent(interpretation)->being_freed)
+                ast_set_parent(interpretation, ASTParent(a));
+            ast_unmark_reachable(interpretation);
+        }
+    }
+    else
+    {
+        for (i = 0; i < MCXX_MAX_AST_CHILDREN; i++)
+        {
+            AST child = ast_get_child(a, i);
+            if (child == NULL)
+                continue;
+            if (ASTParent(child) != NULL
+                    && ASTParent(child)->being_freed)
+                ast_set_parent(child, a);
+            ast_unmark_reachable(child);
+        }
+    }
+}
+
+typedef struct ast_node_set_tag
+{
+    AST* nodes;
+    int num_nodes;
+    int capacity;
+} ast_node_set_t;
+
+static void ast_node_set_add(ast_node_set_t* set, AST a)
+{
+    if (set->num_nodes == set->capacity)
+    {
+        set->capacity = 2 * set->capacity + 64;
+        set->nodes = NEW_REALLOC(AST, set->nodes, set->capacity);
+    }
+    set->nodes[set->num_nodes] = a;
+    set->num_nodes++;
+}
+
+static void ast_collect_unreachable(AST a, char with_children, ast_node_set_t* collected)
+{
+    if (a == NULL
+            || a->reachable
+            || a->being_freed)
+        return;
+    a->being_freed = 1;
+    ast_node_set_add(collected, a);
+
+    if (!with_children)
+        return;
+
+    int i;
+    if (ASTKind(a) == AST_AMBIGUITY)
+    {
+        for (i = 0; i < a->num_ambig; i++)
+            ast_collect_unreachable(a->ambig[i], /* with_children */ 1, collected);
+    }
+    else
+    {
+        for (i = 0; i < MCXX_MAX_AST_CHILDREN; i++)
+            ast_collect_unreachable(ast_get_child(a, i), /* with_children */ 1, collected);
+    }
+}
+
+// Collects everything reachable from 'a', including the interpretations
+// discarded when solving the ambiguities inside it
+static void ast_collect_for_free(AST a, char with_children, ast_node_set_t* collected)
+{
+    if (a == NULL
+            || a->being_freed)
+        return;
+    a->being_freed = 1;
+    ast_node_set_add(collected, a);
+
+    int i;
+    if (a->has_discarded)
+    {
+        // This only happens with trees freed during the analysis (e.g.
+        // internally parsed ones) so the entries are usually the last ones
+        for (i = ast_num_discarded - 1; i >= 0; i--)
+        {
+            if (ast_discarded[i].resolved != a)
+                continue;
+
+            AST node = ast_discarded[i].node;
+            char is_interpretation = (ast_discarded[i].kind == AST_DISCARDED_INTERPRETATION);
+            ast_discarded[i].resolved = NULL;
+            ast_discarded[i].node = NULL;
+
+            ast_collect_for_free(node, /* with_children */ is_interpretation, collected);
+        }
+    }
+
+    if (!with_children)
+        return;
+
+    if (ASTKind(a) == AST_AMBIGUITY)
+    {
+        for (i = 0; i < a->num_ambig; i++)
+            ast_collect_for_free(a->ambig[i], /* with_children */ 1, collected);
+    }
+    else
+    {
+        for (i = 0; i < MCXX_MAX_AST_CHILDREN; i++)
+            ast_collect_for_free(ast_get_child(a, i), /* with_children */ 1, collected);
+    }
+}
+
+void ast_free_with_discarded(AST a)
+{
+    ast_node_set_t collected = { NULL, 0, 0 };
+    ast_collect_for_free(a, /* with_children */ 1, &collected);
+
+    int i;
+    for (i = 0; i < collected.num_nodes; i++)
+        ast_release_one_node(collected.nodes[i]);
+
+    DELETE(collected.nodes);
+}
+
+void ast_discarded_free(AST keep, int watermark)
+{
+    ERROR_CONDITION(ast_discarded_tracking <= 0, "Discarded interpretations are not being tracked", 0);
+    ERROR_CONDITION(watermark > ast_num_discarded, "Invalid watermark", 0);
+    ast_discarded_tracking--;
+
+    if (watermark == ast_num_discarded)
+        return;
+
+    ast_node_set_t roots = { NULL, 0, 0 };
+    ast_node_set_add(&roots, keep);
+    // Interpretations recorded before the watermark belong to an enclosing
+    // declaration that is still being analyzed, leave them alone
+    int i;
+    for (i = 0; i < watermark; i++)
+    {
+        if (ast_discarded[i].node != NULL)
+            ast_node_set_add(&roots, ast_discarded[i].node);
+    }
+
+    for (i = 0; i < roots.num_nodes; i++)
+        ast_mark_reachable(roots.nodes[i]);
+
+    ast_node_set_t collected = { NULL, 0, 0 };
+    for (;;)
+    {
+        for (i = watermark; i < ast_num_discarded; i++)
+        {
+            if (ast_discarded[i].node == NULL)
+                continue;
+            ast_collect_unreachable(ast_discarded[i].node,
+                    /* with_children */ ast_discarded[i].kind == AST_DISCARDED_INTERPRETATION,
+                    &collected);
+        }
+
+        // A resolved node that is not reachable from 'keep' and that is not
+        // part of a discarded interpretation is referenced from elsewhere
+        // (e.g. a copy kept in a nodecl), whatever it reaches must be kept
+        char more_roots = 0;
+        for (i = watermark; i < ast_num_discarded; i++)
+        {
+            AST resolved = ast_discarded[i].resolved;
+            if (resolved != NULL
+                    && !resolved->reachable
+                    && !resolved->being_freed)
+            {
+                ast_node_set_add(&roots, resolved);
+                ast_mark_reachable(resolved);
+                more_roots = 1;
+            }
+        }
+
+        if (!more_roots)
+            break;
+
+        // Collect again with the new roots
+        int j;
+        for (j = 0; j < collected.num_nodes; j++)
+            collected.nodes[j]->being_freed = 0;
+        collected.num_nodes = 0;
+    }
+
+    for (i = 0; i < roots.num_nodes; i++)
+        ast_unmark_reachable(roots.nodes[i]);
+
+    for (i = watermark; i < ast_num_discarded; i++)
+    {
+        AST resolved = ast_discarded[i].resolved;
+        if (resolved != NULL
+                && !resolved->being_freed)
+            resolved->has_discarded = 0;
+    }
+
+    for (i = 0; i < collected.num_nodes; i++)
+    {
+        AST a = collected.nodes[i];
+        if (a->has_discarded)
+        {
+            // Resolved in an enclosing declaration. Its interpretations are
+            // kept alive by the roots above, just forget about them
+            int j;
+            for (j = 0; j < watermark; j++)
+            {
+                if (ast_discarded[j].resolved == a)
+                {
+                    ast_discarded[j].resolved = NULL;
+                    ast_discarded[j].node = NULL;
+                }
+            }
+        }
+        ast_release_one_node(a);
+    }
+
+    DELETE(collected.nodes);
+    DELETE(roots.nodes);
+
+    ast_num_discarded = watermark;
+}
+
+/*
+   List descriptors
+
+   A list is a left-recursive chain of AST_NODE_LIST nodes where child 0 is
+   the previous list node and child 1 the element. The top node is usually
+   the only one referenced from outside, so head, length and indexing used to
+   walk the whole chain.
+
+   All the list nodes of a chain share a descriptor that keeps them in an
+   array (with room at both ends) indexed by the sequence number stored in
+   each node. Descriptors are created lazily when first queried and kept up
+   to date while the chain grows by its ends. Any other change of the chain
+   invalidates the descriptor. A node is described only if its descriptor is
+   valid and its slot in the array is the node itself, so bitwise copies of
+   list nodes are never described.
+ */
+typedef struct ast_list_info_tag ast_list_info_t;
+struct ast_list_info_tag
+{
+    // nodes[seq - base] is the node with sequence number seq
+    AST* nodes;
+    int capacity;
+    int base;
+
+    // nodes[first] is the head and nodes[first + count - 1] is the tail
+    int first;
+    int count;
+
+    // Number of list nodes whose list_info is this descriptor
+    int refcount;
+};
+
+static ast_list_info_t* ast_list_info_new(int num_nodes)
+{
+    ast_list_info_t* info = NEW0(ast_list_info_t);
+
+    info->capacity = 2 * num_nodes + 8;
+    info->nodes = NEW_VEC(AST, info->capacity);
+    // Favour appending
+    info->first = info->capacity / 4;
+    info->base = 0;
+    info->count = 0;
+
+    return info;
+}
+
+static void ast_list_info_invalidate(ast_list_info_t* info)
+{
+    DELETE(info->nodes);
+    info->nodes = NULL;
+    info->capacity = 0;
+    info->first = 0;
+    info->count = 0;
+}
+
+static void ast_list_info_unref(ast_list_info_t* info)
+{
+    ERROR_CONDITION(info->refcount <= 0, "Invalid reference count of list descriptor", 0);
+    info->refcount--;
+    if (info->refcount == 0)
+    {
+        DELETE(info->nodes);
+        DELETE(info);
+    }
+}
+
+static void ast_list_info_set(AST list, ast_list_info_t* info, int seq)
+{
+    if (list->list_info != info)
+    {
+        ast_list_info_t* previous_info = list->list_info;
+
+        info->refcount++;
+        list->list_info = info;
+
+        if (previous_info != NULL)
+            ast_list_info_unref(previous_info);
+    }
+    list->list_seq = seq;
+}
+
+static ast_list_info_t* ast_list_info_get_valid(const_AST list)
+{
+    ast_list_info_t* info = list->list_info;
+    if (info == NULL
+            || info->nodes == NULL)
+        return NULL;
+
+    int idx = list->list_seq - info->base;
+    if (idx < info->first
+            || idx >= info->first + info->count
+            || info->nodes[idx] != list)
+        return NULL;
+
+    return info;
+}
+
+static inline AST ast_list_info_head(ast_list_info_t* info)
+{
+    return info->nodes[info->first];
+}
+
+static inline AST ast_list_info_tail(ast_list_info_t* info)
+{
+    return info->nodes[info->first + info->count - 1];
+}
+
+// Makes sure there are at least 'front' free slots before the head and
+// 'back' free slots after the tail. Sequence numbers do not change
+static void ast_list_info_reserve(ast_list_info_t* info, int front, int back)
+{
+    int free_back = info->capacity - (info->first + info->count);
+    if (info->first >= front
+            && free_back >= back)
+        return;
+
+    int new_capacity = 2 * (info->count + front + back) + 8;
+    AST* new_nodes = NEW_VEC(AST, new_capacity);
+
+    int spare = new_capacity - (info->count + front + back);
+    int new_first = front + spare / 4;
+
+    memcpy(&new_nodes[new_first], &info->nodes[info->first], info->count * sizeof(*new_nodes));
+
+    // Keep the sequence number of the head
+    info->base = info->base + info->first - new_first;
+    info->first = new_first;
+    info->capacity = new_capacity;
+
+    DELETE(info->nodes);
+    info->nodes = new_nodes;
+}
+
+static void ast_list_info_push_back(ast_list_info_t* info, AST list)
+{
+    ast_list_info_reserve(info, 0, 1);
+
+    int idx = info->first + info->count;
+    info->nodes[idx] = list;
+    info->count++;
+
+    ast_list_info_set(list, info, info->base + idx);
+}
+
+static void ast_list_info_push_front(ast_list_info_t* info, AST list)
+{
+    ast_list_info_reserve(info, 1, 0);
+
+    info->first--;
+    info->nodes[info->first] = list;
+    info->count++;
+
+    ast_list_info_set(list, info, info->base + info->first);
+}
+
+// Joins the chains of 'before' and 'after' (the tail of 'before' is the
+// previous node of the head of 'after'). The nodes of the shortest one are
+// moved, so building a list by concatenation is O(n log n) overall
+static void ast_list_info_merge(ast_list_info_t* before, ast_list_info_t* after)
+{
+    ast_list_info_t* moved;
+    if (after->count <= before->count)
+    {
+        moved = after;
+        // Moving the nodes drops the references, keep it alive meanwhile
+        moved->refcount++;
+
+        int i;
+        for (i = moved->first; i < moved->first + moved->count; i++)
+        {
+            ast_list_info_push_back(before, moved->nodes[i]);
+        }
+    }
+    else
+    {
+        moved = before;
+        moved->refcount++;
+
+        int i;
+        for (i = moved->first + moved->count - 1; i >= moved->first; i--)
+        {
+            ast_list_info_push_front(after, moved->nodes[i]);
+        }
+    }
+
+    ast_list_info_invalidate(moved);
+    ast_list_info_unref(moved);
+}
+
+static ast_list_info_t* ast_list_get_info(const_AST list)
+{
+    ast_list_info_t* info = ast_list_info_get_valid(list);
+    if (info != NULL)
+        return info;
+
+    // Walk down the chain until the head or until the tail of a described
+    // chain, which we can extend
+    int path_capacity = 64;
+    int path_length = 0;
+    AST* path = NEW_VEC(AST, path_capacity);
+
+    AST it = (AST)list;
+    for (;;)
+    {
+        if (ASTKind(it) != AST_NODE_LIST)
+        {
+            // Not a proper chain (e.g. an ambiguity inside an unsolved tree)
+            DELETE(path);
+            return NULL;
+        }
+
+        ast_list_info_t* current_info = ast_list_info_get_valid(it);
+        if (current_info != NULL)
+        {
+            if (ast_list_info_tail(current_info) == it)
+            {
+                info = current_info;
+                break;
+            }
+            // 'it' is in the middle of a chain that now continues along a
+            // different path. The nodes below will be added to the new one
+            ast_list_info_invalidate(current_info);
+        }
+
+        if (path_length == path_capacity)
+        {
+            path_capacity *= 2;
+            path = NEW_REALLOC(AST, path, path_capacity);
+        }
+        path[path_length] = it;
+        path_length++;
+
+        it = ASTSon0(it);
+        if (it == NULL)
+            break;
+    }
+
+    if (info == NULL)
+    {
+        info = ast_list_info_new(path_length);
+    }
+
+    int i;
+    for (i = path_length - 1; i >= 0; i--)
+    {
+        ast_list_info_push_back(info, path[i]);
+    }
+
+    DELETE(path);
+
+    return info;
+}
+
+void ast_list_update_info(AST list, AST new_previous)
+{
+    ast_list_info_t* info = ast_list_info_get_valid(list);
+    if (info == NULL)
+    {
+        // The node is not described so no chain breaks. Appending to the
+        // tail of a described chain
+        if (new_previous != NULL
+                && ASTKind(new_previous) == AST_NODE_LIST)
+        {
+            ast_list_info_t* previous_info = ast_list_info_get_valid(new_previous);
+            if (previous_info != NULL
+                    && ast_list_info_tail(previous_info) == new_previous)
+            {
+                ast_list_info_push_back(previous_info, list);
+            }
+        }
+        return;
+    }
+
+    AST old_previous = ASTSon0(list);
+    if (old_previous == new_previous)
+        return;
+
+    if (old_previous == NULL
+            && new_previous != NULL
+            && ASTKind(new_previous) == AST_NODE_LIST)
+    {
+        // 'list' is the head of its chain, concatenating (or prepending if
+        // new_previous is a single node)
+        ast_list_info_t* previous_info = ast_list_get_info(new_previous);
+
+        // Describing new_previous may have invalidated the descriptor of
+        // list if they share nodes
+        if (previous_info != NULL
+                && previous_info != info
+                && ast_list_info_get_valid(list) == info
+                && ast_list_info_tail(previous_info) == new_previous)
+        {
+            ast_list_info_merge(previous_info, info);
+            return;
+        }
+    }
+    else if (new_previous == NULL
+            && info->count > 1
+            && ast_list_info_head(info) == old_previous
+            && info->nodes[info->first + 1] == list)
+    {
+        // Removing the head
+        info->nodes[info->first] = NULL;
+        info->first++;
+        info->count--;
+
+        ast_list_info_t* head_info = old_previous->list_info;
+        old_previous->list_info = NULL;
+        old_previous->list_seq = 0;
+        ast_list_info_unref(head_info);
+        return;
+    }
+
+    ast_list_info_t* current_info = ast_list_info_get_valid(list);
+    if (current_info != NULL)
+        ast_list_info_invalidate(current_info);
+}
+
+void ast_list_release_info(AST list)
+{
+    ast_list_info_t* info = list->list_info;
+    if (info == NULL)
+        return;
+
+    if (ast_list_info_get_valid(list) == info)
+        ast_list_info_invalidate(info);
+
+    list->list_info = NULL;
+    list->list_seq = 0;
+    ast_list_info_unref(info);
+}
+
+AST ast_list_head(const_AST list)
+{
+    if (list == NULL)
+        return NULL;
+
+    if (ASTKind(list) != AST_NODE_LIST)
+        return NULL;
+
+    ast_list_info_t* info = ast_list_get_info(list);
+    if (info != NULL)
+        return ast_list_info_head(info);
+
+    const_AST iter;
+    for_each_element(list, iter)
+    {
+        return (AST)iter;
+    }
+
+    return NULL;
+}
+
+int ast_list_length(const_AST list)
+{
+    if (list == NULL)
+        return 0;
+
+    ERROR_CONDITION(ASTKind(list) != AST_NODE_LIST, "Invalid list", 0);
+
+    ast_list_info_t* info = ast_list_get_info(list);
+    if (info != NULL)
+        return list->list_seq - (info->base + info->first) + 1;
+
+    int n = 0;
+    const_AST iter;
+    for_each_element(list, iter)
+    {
+        n++;
+    }
+
+    return n;
+}
+
+AST ast_list_nth(const_AST list, int n)
+{
+    if (list == NULL
+            || n < 0)
+        return NULL;
+
+    ERROR_CONDITION(ASTKind(list) != AST_NODE_LIST, "Invalid list", 0);
+
+    ast_list_info_t* info = ast_list_get_info(list);
+    if (info != NULL)
+    {
+        int idx = info->first + n;
+        if (idx > list->list_seq - info->base)
+            return NULL;
+        return info->nodes[idx];
+    }
+
+    const_AST iter;
+    for_each_element(list, iter)
+    {
+        if (n == 0)
+            return (AST)iter;
+        n--;
+    }
+
+    return NULL;
+}
+
+void ast_list_append_in_place(AST list, AST last_element)
+{
+    ERROR_CONDITION(ASTKind(list) != AST_NODE_LIST, "Invalid list", 0);
+    ERROR_CONDITION(last_element == NULL, "Invalid tree", 0);
+
+    // A new node takes the place of 'list' in the chain and 'list' becomes
+    // the new tail
+    AST previous = ASTSon0(list);
+    AST old_last = ASTSon1(list);
+
+    ast_list_info_t* info = ast_list_info_get_valid(list);
+
+    AST moved = ast_make(AST_NODE_LIST, 2, previous, old_last, NULL, NULL,
+            NULL, ast_get_text(old_last));
+
+    if (info != NULL)
+    {
+        if (ast_list_info_tail(info) == list)
+        {
+            int seq = list->list_seq;
+            info->nodes[seq - info->base] = moved;
+            ast_list_info_set(moved, info, seq);
+
+            ast_list_info_push_back(info, list);
+        }
+        else
+        {
+            // There are list nodes after 'list', they now have one element more
+            ast_list_info_invalidate(info);
+        }
+    }
+
+    // The descriptor is already up to date, do not use ast_set_child here
+    ast_store_child(list, 0, moved);
+    ast_set_parent(moved, list);
+
+    ast_set_child(list, 1, last_element);
+}
+
 void ast_list_split_head_tail(AST list, AST *head, AST* tail)
 {
     if (list == NULL)
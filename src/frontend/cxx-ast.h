@@ -116,11 +116,35 @@ static inline AST ast_list_leaf(AST elem);
 static inline AST ast_list(AST previous_list, AST last_element);
 
 // Returns the head of a list
-static inline AST ast_list_head(const_AST list);
+LIBMCXX_EXTERN AST ast_list_head(const_AST list);
+
+// Returns the number of elements of a list
+LIBMCXX_EXTERN int ast_list_length(const_AST list);
+
+// Returns the list node of the element 'n' of a list (0 is the head) or NULL
+// if there is no such element
+LIBMCXX_EXTERN AST ast_list_nth(const_AST list, int n);
 
 // Concatenates two lists
 static inline AST ast_list_concat(AST before, AST after);
 
+// Appends last_element to list keeping 'list' as the last node of the chain,
+// so references to 'list' see the new element
+LIBMCXX_EXTERN void ast_list_append_in_place(AST list, AST last_element);
+
+// List nodes of a chain share a descriptor which gives constant time head,
+// length and random access. Appending, prepending and concatenating keep it
+// up to date in (amortized) constant time, other changes discard it and it
+// will be recomputed lazily
+//
+// These two are only meant to be used by the tree manipulation routines
+//
+// Called whenever the previous list node (child 0) of list is going to be
+// new_previous
+LIBMCXX_EXTERN void ast_list_update_info(AST list, AST new_previous);
+// Called when the list node is going to stop being a list node of its chain
+LIBMCXX_EXTERN void ast_list_release_info(AST list);
+
 // Splits a list in two parts, head (a list containing only the first element)
 // and tail (a list of the remainder elements)
 LIBMCXX_EXTERN void ast_list_split_head_tail(AST list, AST *head, AST* tail);
@@ -191,6 +215,25 @@ static inline void ast_set_expr_info(AST a, struct nodecl_expr_info_tag*);
 
 // Used by memory report
 static inline int ast_node_size(void);
+LIBMCXX_EXTERN void ast_node_stats(unsigned long long* live_nodes,
+        unsigned long long* peak_live_nodes,
+        unsigned long long* pool_bytes);
+
+// Allocation of the nodes themselves. The returned node is zeroed
+LIBMCXX_EXTERN AST ast_node_alloc(void);
+LIBMCXX_EXTERN void ast_node_release(AST a);
+
+// Discarded interpretations of ambiguities. While tracking is enabled
+// ast_replace_with_ambiguity records them instead of leaking them and
+// ast_discarded_free releases those recorded since 'watermark' that are not
+// reachable from 'keep'
+LIBMCXX_EXTERN int ast_discarded_tracking;
+LIBMCXX_EXTERN int ast_discarded_begin(void);
+LIBMCXX_EXTERN void ast_discarded_free(AST keep, int watermark);
+LIBMCXX_EXTERN void ast_discard_interpretations(AST resolved,
+        AST* ambig, int num_ambig, int chosen);
+// Used by ast_free when a resolved node goes away before ast_discarded_free
+LIBMCXX_EXTERN void ast_free_with_discarded(AST a);
 
 /*
  * Macros
@@ -63,6 +63,7 @@
 #include "cxx-codegen.h"
 #include "cxx-placeholders.h"
 #include "cxx-driver-utils.h"
+#include "cxx-compile-stats.h"
 
 #ifdef EXTRAE_ENABLED
 #include "extrae_user_events.h"
@@ -842,13 +843,27 @@ void build_scope_declaration_sequence(AST list,
     AST iter;
     for_each_element(list, iter)
     {
+        // Interpretations discarded while analyzing this declaration are
+        // freed as soon as it has been completely analyzed
+        int discarded_watermark = 0;
+        if (!debug_options.keep_parse_tree)
+            discarded_watermark = ast_discarded_begin();
+
         nodecl_t current_nodecl_output_list = nodecl_null();
+        compile_stats_begin_entity(COMPILE_STATS_ENTITY_DECLARATION,
+                /* name */ NULL,
+                ast_get_locus(ASTSon1(iter)),
+                COMPILE_STATS_BUILD_SCOPE);
         build_scope_declaration(ASTSon1(iter), decl_context, &current_nodecl_output_list, 
                 /* declared_symbols */ NULL, /* gather_decl_spec_list_t */ NULL);
+        compile_stats_end_entity();
 
         current_nodecl_output_list = nodecl_concat_lists(flush_instantiated_entities(),
                 current_nodecl_output_list);
 
+        if (!debug_options.keep_parse_tree)
+            ast_discarded_free(ASTSon1(iter), discarded_watermark);
+
         *nodecl_output_list = nodecl_concat_lists(*nodecl_output_list, current_nodecl_output_list);
     }
 }
@@ -3902,6 +3917,7 @@ static void gather_type_spec_from_friend_elaborated_class_specifier_common(
         // going to change its type
         scope_entry_t* new_dep = NEW0(scope_entry_t);
         *new_dep = *entry;
+        symbol_entity_specs_unshare_cold(new_dep);
         new_dep->type_information = set_dependent_entry_kind(entry->type_information, class_kind);
         new_dep->decl_context = decl_context;
 
@@ -4727,6 +4743,7 @@ static void gather_type_spec_from_elaborated_class_specifier(AST a,
                 scope_entry_t* old_entry = entry;
                 entry = NEW0(scope_entry_t);
                 *entry = *old_entry;
+                symbol_entity_specs_unshare_cold(entry);
 
                 keep_extra_attributes_in_symbol(entry, &class_gather_info);
             }
@@ -10125,6 +10142,7 @@ void gather_type_spec_from_class_specifier(AST a, type_t** type_info,
                     class_entry->symbol_name);
 
             *injected_symbol = *class_entry;
+            symbol_entity_specs_unshare_cold(injected_symbol);
             // the injected class name is logically in the class-scope
             injected_symbol->decl_context = inner_decl_context;
             injected_symbol->do_not_print = 1;
@@ -16254,8 +16272,7 @@ static void check_constexpr_function_statement_list(nodecl_t statement_list,
                 || kind == NODECL_CXX_USING_NAMESPACE)
         {
             if (kind == NODECL_CXX_DECL
-                    || kind == NODECL_CXX_DEF
-                    || kind == NODECL_OBJECT_INIT)
+                    || kind == NODECL_CXX_DEF)
             {
                 scope_entry_t* sym = nodecl_get_symbol(nodecl);
                 if (sym->kind == SK_VARIABLE)
@@ -16271,6 +16288,10 @@ static void check_constexpr_function_statement_list(nodecl_t statement_list,
                 }
             }
         }
+        else if (kind == NODECL_OBJECT_INIT)
+        {
+            // The variable is checked in its NODECL_CXX_DEF
+        }
         else if (kind == NODECL_RETURN_STATEMENT)
         {
             (*num_seen_returns)++;
@@ -16290,6 +16311,7 @@ static void check_constexpr_function_statement_list(nodecl_t statement_list,
                     num_invalid_initializations);
         }
         else if (kind == NODECL_WHILE_STATEMENT
+                || kind == NODECL_FOR_STATEMENT
                 || kind == NODECL_CASE_STATEMENT
                 || kind == NODECL_SWITCH_STATEMENT)
         {
@@ -16330,7 +16352,10 @@ static void check_constexpr_function_statement_list(nodecl_t statement_list,
             (*num_seen_other_statements)++;
             (*num_try_blocks)++;
         }
-        else if (kind == NODECL_EXPRESSION_STATEMENT)
+        else if (kind == NODECL_EXPRESSION_STATEMENT
+                || kind == NODECL_EMPTY_STATEMENT
+                || kind == NODECL_BREAK_STATEMENT
+                || kind == NODECL_CONTINUE_STATEMENT)
         {
             (*num_seen_other_statements)++;
         }
@@ -17077,6 +17102,10 @@ static void build_scope_function_definition_body(
         gather_decl_spec_t* gather_info,
         nodecl_t *nodecl_output)
 {
+    compile_stats_begin_entity(COMPILE_STATS_ENTITY_FUNCTION_DEFINITION,
+            compile_stats_enabled() ? get_qualified_symbol_name(entry, entry->decl_context) : NULL,
+            ast_get_locus(function_definition),
+            COMPILE_STATS_BUILD_SCOPE);
 
     // If the return type or the type of any argument is a class type, it must
     // be a complete type
@@ -17362,6 +17391,8 @@ static void build_scope_function_definition_body(
 
     *nodecl_output = nodecl_make_list_1(nodecl_function_def);
     symbol_entity_specs_set_function_code(entry, nodecl_function_def);
+
+    compile_stats_end_entity();
 }
 
 
@@ -2269,11 +2269,7 @@ static const_value_t* const_value_make_string_using_cstring(const char* literal,
     result->value.m->num_elements = num_elements + (add_null ? 1 : 0);
 
     // Make sure the input is OK
-    char tmp[num_elements + 1];
-    strncpy(tmp, literal, num_elements);
-    tmp[num_elements] = '\0';
-
-    result->value.m->c_str = uniquestr(tmp);
+    result->value.m->c_str = uniquestr_n(literal, strnlen(literal, num_elements));
 
     return const_value_return_unique(result);
 }
@@ -4516,9 +4512,8 @@ const char* unsigned_int128_to_str(unsigned __int128 i, char neg)
     }
 
     ERROR_CONDITION(len >= MAX_DIGITS, "Too many digits", 0);
-    result[len] = '\0';
 
-    return uniquestr(result);
+    return uniquestr_n(result, len);
 }
 
 const char* signed_int128_to_str(signed __int128 i)
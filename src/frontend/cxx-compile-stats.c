@@ -0,0 +1,560 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2015 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/time.h>
+
+#include "cxx-compile-stats.h"
+#include "cxx-process.h"
+#include "cxx-utils.h"
+#include "cxx-locus.h"
+#include "uniquestr.h"
+#include "string_utils.h"
+#include "dhash_ptr.h"
+#include "mem.h"
+
+unsigned long long compile_stats_nodecl_counter = 0;
+unsigned long long compile_stats_nodes_visited = 0;
+
+static const char* compile_stats_filename = NULL;
+
+// Keep these sorted alphabetically, they are emitted in this order
+static const char* category_names[COMPILE_STATS_NUM_CATEGORIES] =
+{
+    [COMPILE_STATS_BUILD_SCOPE] = "build_scope_seconds",
+    [COMPILE_STATS_EXPRESSION_CHECK] = "expression_check_seconds",
+    [COMPILE_STATS_INSTANTIATION] = "instantiation_seconds",
+    [COMPILE_STATS_PARSING] = "parsing_seconds",
+    [COMPILE_STATS_PHASES] = "phases_seconds",
+};
+
+static compile_stats_category_t sorted_categories[COMPILE_STATS_NUM_CATEGORIES] =
+{
+    COMPILE_STATS_BUILD_SCOPE,
+    COMPILE_STATS_EXPRESSION_CHECK,
+    COMPILE_STATS_INSTANTIATION,
+    COMPILE_STATS_PARSING,
+    COMPILE_STATS_PHASES,
+};
+
+static const char* entity_kind_names[] =
+{
+    [COMPILE_STATS_ENTITY_DECLARATION] = "declaration",
+    [COMPILE_STATS_ENTITY_FUNCTION_DEFINITION] = "function_definition",
+    [COMPILE_STATS_ENTITY_CLASS_INSTANTIATION] = "class_instantiation",
+    [COMPILE_STATS_ENTITY_FUNCTION_INSTANTIATION] = "function_instantiation",
+};
+
+typedef struct stats_entity_tag
+{
+    compile_stats_entity_kind_t kind;
+    const char* name;
+    const char* locus;
+
+    double seconds[COMPILE_STATS_NUM_CATEGORIES];
+    unsigned long long nodecl_nodes;
+} stats_entity_t;
+
+typedef struct stats_phase_tag
+{
+    const char* name;
+    double seconds;
+    unsigned long long nodecl_nodes;
+    unsigned long long nodes_visited;
+} stats_phase_t;
+
+typedef struct stats_translation_unit_tag
+{
+    const char* filename;
+
+    // Everything not attributed to a declaration or an instantiation
+    stats_entity_t global;
+
+    dhash_ptr_t* entity_map;
+    int num_entities;
+    stats_entity_t** entities;
+
+    int num_phases;
+    stats_phase_t** phases;
+
+    unsigned long long lexer_bytes;
+    unsigned long long lexer_tokens;
+    double lexer_seconds;
+} stats_translation_unit_t;
+
+static int num_translation_units = 0;
+static stats_translation_unit_t** translation_units = NULL;
+static stats_translation_unit_t* current_translation_unit = NULL;
+
+typedef struct stats_frame_tag
+{
+    // May be NULL when we are not compiling any translation unit
+    stats_entity_t* entity;
+    compile_stats_category_t category;
+} stats_frame_t;
+
+static int num_frames = 0;
+static int max_frames = 0;
+static stats_frame_t* frames = NULL;
+
+static double last_switch_time = 0.0;
+static unsigned long long last_switch_nodecl_counter = 0;
+
+static stats_phase_t* current_phase = NULL;
+static double current_phase_start_time = 0.0;
+static unsigned long long current_phase_start_nodecl_counter = 0;
+static unsigned long long current_phase_start_nodes_visited = 0;
+
+static double current_time(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+void compile_stats_set_output_filename(const char* filename)
+{
+    compile_stats_filename = uniquestr(filename);
+}
+
+char compile_stats_enabled(void)
+{
+    return compile_stats_filename != NULL;
+}
+
+// Charges the time and nodes elapsed since the last push or pop to the
+// innermost frame
+static void charge_innermost_frame(void)
+{
+    double now = current_time();
+
+    if (num_frames > 0
+            && frames[num_frames - 1].entity != NULL)
+    {
+        stats_frame_t* frame = &frames[num_frames - 1];
+
+        frame->entity->seconds[frame->category] += now - last_switch_time;
+        frame->entity->nodecl_nodes += compile_stats_nodecl_counter - last_switch_nodecl_counter;
+    }
+
+    last_switch_time = now;
+    last_switch_nodecl_counter = compile_stats_nodecl_counter;
+}
+
+static void push_frame(stats_entity_t* entity, compile_stats_category_t category)
+{
+    charge_innermost_frame();
+
+    if (num_frames == max_frames)
+    {
+        max_frames = 2 * max_frames + 16;
+        frames = NEW_REALLOC(stats_frame_t, frames, max_frames);
+    }
+
+    frames[num_frames].entity = entity;
+    frames[num_frames].category = category;
+    num_frames++;
+}
+
+static void pop_frame(void)
+{
+    ERROR_CONDITION(num_frames == 0, "Unbalanced compile statistics", 0);
+
+    charge_innermost_frame();
+    num_frames--;
+}
+
+void compile_stats_begin_translation_unit(const char* filename)
+{
+    if (!compile_stats_enabled())
+        return;
+
+    ERROR_CONDITION(current_translation_unit != NULL,
+            "Nested translation units in compile statistics", 0);
+
+    stats_translation_unit_t* tu = NEW0(stats_translation_unit_t);
+    tu->filename = uniquestr(filename);
+    tu->entity_map = dhash_ptr_new(5);
+
+    P_LIST_ADD(translation_units, num_translation_units, tu);
+
+    charge_innermost_frame();
+    current_translation_unit = tu;
+}
+
+void compile_stats_end_translation_unit(void)
+{
+    if (!compile_stats_enabled())
+        return;
+
+    charge_innermost_frame();
+    current_translation_unit = NULL;
+}
+
+static stats_entity_t* get_entity(compile_stats_entity_kind_t kind,
+        const char* name,
+        const locus_t* locus)
+{
+    if (current_translation_unit == NULL)
+        return NULL;
+
+    const char* locus_str = locus_to_str(locus);
+    if (name == NULL)
+        name = "";
+
+    const char* key = NULL;
+    uniquestr_sprintf(&key, "%s|%s|%s", entity_kind_names[kind], name, locus_str);
+
+    stats_entity_t* entity = (stats_entity_t*)dhash_ptr_query(current_translation_unit->entity_map, key);
+    if (entity == NULL)
+    {
+        entity = NEW0(stats_entity_t);
+        entity->kind = kind;
+        entity->name = uniquestr(name);
+        entity->locus = locus_str;
+
+        dhash_ptr_insert(current_translation_unit->entity_map, key, entity);
+        P_LIST_ADD(current_translation_unit->entities,
+                current_translation_unit->num_entities,
+                entity);
+    }
+
+    return entity;
+}
+
+void compile_stats_begin_entity(compile_stats_entity_kind_t kind,
+        const char* name,
+        const locus_t* locus,
+        compile_stats_category_t category)
+{
+    if (!compile_stats_enabled())
+        return;
+
+    push_frame(get_entity(kind, name, locus), category);
+}
+
+void compile_stats_end_entity(void)
+{
+    if (!compile_stats_enabled())
+        return;
+
+    pop_frame();
+}
+
+void compile_stats_push_category(compile_stats_category_t category)
+{
+    if (!compile_stats_enabled())
+        return;
+
+    stats_entity_t* entity = NULL;
+    if (num_frames > 0)
+        entity = frames[num_frames - 1].entity;
+    else if (current_translation_unit != NULL)
+        entity = &current_translation_unit->global;
+
+    push_frame(entity, category);
+}
+
+void compile_stats_pop_category(void)
+{
+    if (!compile_stats_enabled())
+        return;
+
+    pop_frame();
+}
+
+static stats_phase_t* get_phase(const char* phase_name)
+{
+    phase_name = uniquestr(phase_name);
+
+    int i;
+    for (i = 0; i < current_translation_unit->num_phases; i++)
+    {
+        if (current_translation_unit->phases[i]->name == phase_name)
+            return current_translation_unit->phases[i];
+    }
+
+    stats_phase_t* phase = NEW0(stats_phase_t);
+    phase->name = phase_name;
+    P_LIST_ADD(current_translation_unit->phases,
+            current_translation_unit->num_phases,
+            phase);
+
+    return phase;
+}
+
+void compile_stats_begin_phase(const char* phase_name)
+{
+    if (!compile_stats_enabled())
+        return;
+
+    ERROR_CONDITION(current_phase != NULL, "Nested phases in compile statistics", 0);
+
+    current_phase = NULL;
+    if (current_translation_unit != NULL)
+    {
+        current_phase = get_phase(phase_name);
+    }
+
+    compile_stats_push_category(COMPILE_STATS_PHASES);
+
+    current_phase_start_time = last_switch_time;
+    current_phase_start_nodecl_counter = last_switch_nodecl_counter;
+    current_phase_start_nodes_visited = compile_stats_nodes_visited;
+}
+
+void compile_stats_end_phase(void)
+{
+    if (!compile_stats_enabled())
+        return;
+
+    compile_stats_pop_category();
+
+    if (current_phase != NULL)
+    {
+        current_phase->seconds += last_switch_time - current_phase_start_time;
+        current_phase->nodecl_nodes += last_switch_nodecl_counter - current_phase_start_nodecl_counter;
+        current_phase->nodes_visited += compile_stats_nodes_visited - current_phase_start_nodes_visited;
+    }
+    current_phase = NULL;
+}
+
+void compile_stats_add_lexer(unsigned long long bytes,
+        unsigned long long tokens,
+        double seconds)
+{
+    if (!compile_stats_enabled()
+            || current_translation_unit == NULL)
+        return;
+
+    current_translation_unit->lexer_bytes += bytes;
+    current_translation_unit->lexer_tokens += tokens;
+    current_translation_unit->lexer_seconds += seconds;
+}
+
+static double entity_total_seconds(const stats_entity_t* entity)
+{
+    double result = 0.0;
+    int i;
+    for (i = 0; i < COMPILE_STATS_NUM_CATEGORIES; i++)
+        result += entity->seconds[i];
+
+    return result;
+}
+
+// Most expensive first. Ties are broken by name and locus to keep the
+// report stable
+static int compare_entities(const void* p1, const void* p2)
+{
+    const stats_entity_t* e1 = *(const stats_entity_t**)p1;
+    const stats_entity_t* e2 = *(const stats_entity_t**)p2;
+
+    double t1 = entity_total_seconds(e1);
+    double t2 = entity_total_seconds(e2);
+
+    if (t1 > t2)
+        return -1;
+    else if (t1 < t2)
+        return 1;
+
+    int c = strcmp(e1->name, e2->name);
+    if (c != 0)
+        return c;
+
+    return strcmp(e1->locus, e2->locus);
+}
+
+static int compare_phases(const void* p1, const void* p2)
+{
+    const stats_phase_t* ph1 = *(const stats_phase_t**)p1;
+    const stats_phase_t* ph2 = *(const stats_phase_t**)p2;
+
+    if (ph1->seconds > ph2->seconds)
+        return -1;
+    else if (ph1->seconds < ph2->seconds)
+        return 1;
+
+    return strcmp(ph1->name, ph2->name);
+}
+
+static void write_json_string(FILE* f, const char* str)
+{
+    fputc('"', f);
+    const char* p;
+    for (p = str; *p != '\0'; p++)
+    {
+        switch (*p)
+        {
+            case '"': fputs("\\\"", f); break;
+            case '\\': fputs("\\\\", f); break;
+            case '\n': fputs("\\n", f); break;
+            case '\t': fputs("\\t", f); break;
+            default:
+                {
+                    if ((unsigned char)*p < 0x20)
+                        fprintf(f, "\\u%04x", (unsigned char)*p);
+                    else
+                        fputc(*p, f);
+                    break;
+                }
+        }
+    }
+    fputc('"', f);
+}
+
+static void write_categories(FILE* f, const double seconds[COMPILE_STATS_NUM_CATEGORIES],
+        const char* indent, int first, int last)
+{
+    int i;
+    for (i = first; i <= last; i++)
+    {
+        compile_stats_category_t c = sorted_categories[i];
+        fprintf(f, "%s\"%s\": %.6f,\n", indent, category_names[c], seconds[c]);
+    }
+}
+
+static void write_entity(FILE* f, const stats_entity_t* entity, char is_last)
+{
+    const char* indent = "          ";
+
+    fprintf(f, "        {\n");
+    // build_scope_seconds, expression_check_seconds, instantiation_seconds
+    write_categories(f, entity->seconds, indent, 0, 2);
+    fprintf(f, "%s\"kind\": \"%s\",\n", indent, entity_kind_names[entity->kind]);
+    fprintf(f, "%s\"locus\": ", indent);
+    write_json_string(f, entity->locus);
+    fprintf(f, ",\n%s\"name\": ", indent);
+    write_json_string(f, entity->name);
+    fprintf(f, ",\n%s\"nodecl_nodes\": %llu,\n", indent, entity->nodecl_nodes);
+    // parsing_seconds, phases_seconds
+    write_categories(f, entity->seconds, indent, 3, 4);
+    fprintf(f, "%s\"total_seconds\": %.6f\n", indent, entity_total_seconds(entity));
+    fprintf(f, "        }%s\n", is_last ? "" : ",");
+}
+
+static void write_translation_unit(FILE* f, stats_translation_unit_t* tu, char is_last)
+{
+    qsort(tu->entities, tu->num_entities, sizeof(*tu->entities), compare_entities);
+    qsort(tu->phases, tu->num_phases, sizeof(*tu->phases), compare_phases);
+
+    // Totals of the whole translation unit
+    double seconds[COMPILE_STATS_NUM_CATEGORIES];
+    unsigned long long nodecl_nodes = tu->global.nodecl_nodes;
+    memcpy(seconds, tu->global.seconds, sizeof(seconds));
+
+    int i, j;
+    for (i = 0; i < tu->num_entities; i++)
+    {
+        for (j = 0; j < COMPILE_STATS_NUM_CATEGORIES; j++)
+            seconds[j] += tu->entities[i]->seconds[j];
+        nodecl_nodes += tu->entities[i]->nodecl_nodes;
+    }
+
+    double total_seconds = 0.0;
+    for (j = 0; j < COMPILE_STATS_NUM_CATEGORIES; j++)
+        total_seconds += seconds[j];
+
+    fprintf(f, "    {\n");
+    fprintf(f, "      \"entities\": [\n");
+    for (i = 0; i < tu->num_entities; i++)
+    {
+        write_entity(f, tu->entities[i], i == tu->num_entities - 1);
+    }
+    fprintf(f, "      ],\n");
+
+    fprintf(f, "      \"file\": ");
+    write_json_string(f, tu->filename);
+    fprintf(f, ",\n");
+
+    double lexer_mb_per_second = 0.0;
+    if (tu->lexer_seconds > 0.0)
+        lexer_mb_per_second = (tu->lexer_bytes / (1024.0 * 1024.0)) / tu->lexer_seconds;
+    fprintf(f, "      \"lexer\": { \"bytes\": %llu, \"mb_per_second\": %.3f, \"seconds\": %.6f, \"tokens\": %llu },\n",
+            tu->lexer_bytes,
+            lexer_mb_per_second,
+            tu->lexer_seconds,
+            tu->lexer_tokens);
+
+    fprintf(f, "      \"nodecl_nodes\": %llu,\n", nodecl_nodes);
+
+    fprintf(f, "      \"phases\": [\n");
+    for (i = 0; i < tu->num_phases; i++)
+    {
+        fprintf(f, "        { \"name\": ");
+        write_json_string(f, tu->phases[i]->name);
+        fprintf(f, ", \"nodecl_nodes\": %llu, \"nodes_visited\": %llu, \"seconds\": %.6f }%s\n",
+                tu->phases[i]->nodecl_nodes,
+                tu->phases[i]->nodes_visited,
+                tu->phases[i]->seconds,
+                i == tu->num_phases - 1 ? "" : ",");
+    }
+    fprintf(f, "      ],\n");
+
+    fprintf(f, "      \"seconds\": {\n");
+    for (j = 0; j < COMPILE_STATS_NUM_CATEGORIES; j++)
+    {
+        compile_stats_category_t c = sorted_categories[j];
+        // Drop the '_seconds' suffix, it is redundant here
+        int length = strlen(category_names[c]) - strlen("_seconds");
+        fprintf(f, "        \"%.*s\": %.6f%s\n",
+                length, category_names[c], seconds[c],
+                j == COMPILE_STATS_NUM_CATEGORIES - 1 ? "" : ",");
+    }
+    fprintf(f, "      },\n");
+
+    fprintf(f, "      \"total_seconds\": %.6f\n", total_seconds);
+    fprintf(f, "    }%s\n", is_last ? "" : ",");
+}
+
+void compile_stats_write_report(void)
+{
+    if (!compile_stats_enabled())
+        return;
+
+    FILE* f = fopen(compile_stats_filename, "w");
+    if (f == NULL)
+    {
+        fatal_error("error: cannot open compile statistics file '%s'. %s\n",
+                compile_stats_filename,
+                strerror(errno));
+    }
+
+    fprintf(f, "{\n");
+    fprintf(f, "  \"translation_units\": [\n");
+    int i;
+    for (i = 0; i < num_translation_units; i++)
+    {
+        write_translation_unit(f, translation_units[i], i == num_translation_units - 1);
+    }
+    fprintf(f, "  ]\n");
+    fprintf(f, "}\n");
+
+    fclose(f);
+}
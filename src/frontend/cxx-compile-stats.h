@@ -0,0 +1,95 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2015 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+#ifndef CXX_COMPILE_STATS_H
+#define CXX_COMPILE_STATS_H
+
+#include "libmcxx-common.h"
+#include "cxx-macros.h"
+#include "cxx-locus.h"
+
+MCXX_BEGIN_DECLS
+
+// Compile-time statistics enabled with --compile-stats=FILE
+//
+// Time is attributed exclusively: while a nested entity or category is
+// active the enclosing one does not accumulate time nor nodecl nodes
+typedef enum compile_stats_category_tag
+{
+    COMPILE_STATS_PARSING = 0,
+    COMPILE_STATS_BUILD_SCOPE,
+    COMPILE_STATS_EXPRESSION_CHECK,
+    COMPILE_STATS_INSTANTIATION,
+    COMPILE_STATS_PHASES,
+    COMPILE_STATS_NUM_CATEGORIES
+} compile_stats_category_t;
+
+typedef enum compile_stats_entity_kind_tag
+{
+    COMPILE_STATS_ENTITY_DECLARATION = 0,
+    COMPILE_STATS_ENTITY_FUNCTION_DEFINITION,
+    COMPILE_STATS_ENTITY_CLASS_INSTANTIATION,
+    COMPILE_STATS_ENTITY_FUNCTION_INSTANTIATION,
+} compile_stats_entity_kind_t;
+
+// Incremented every time a nodecl node is created
+extern unsigned long long compile_stats_nodecl_counter;
+
+// Incremented for every node walked by the nodecl visitors and by
+// nodecl_index_find_all, reported per phase as nodes_visited
+LIBMCXX_EXTERN unsigned long long compile_stats_nodes_visited;
+
+void compile_stats_set_output_filename(const char* filename);
+char compile_stats_enabled(void);
+
+void compile_stats_begin_translation_unit(const char* filename);
+void compile_stats_end_translation_unit(void);
+
+// 'name' is only computed by the callers when compile_stats_enabled()
+void compile_stats_begin_entity(compile_stats_entity_kind_t kind,
+        const char* name,
+        const locus_t* locus,
+        compile_stats_category_t category);
+void compile_stats_end_entity(void);
+
+void compile_stats_push_category(compile_stats_category_t category);
+void compile_stats_pop_category(void);
+
+void compile_stats_begin_phase(const char* phase_name);
+void compile_stats_end_phase(void);
+
+// Called by the lexers once they reach the end of a source file. The time
+// spent in the lexer is also part of parsing_seconds
+void compile_stats_add_lexer(unsigned long long bytes,
+        unsigned long long tokens,
+        double seconds);
+
+// Writes the JSON report of every translation unit compiled so far
+void compile_stats_write_report(void);
+
+MCXX_END_DECLS
+
+#endif // CXX_COMPILE_STATS_H
@@ -47,11 +47,14 @@
 #include "cxx-entrylist.h"
 #include "cxx-limits.h"
 #include "cxx-diagnostic.h"
+#include "cxx-compile-stats.h"
 #include "cxx-codegen.h"
 #include "cxx-instantiation.h"
 #include "cxx-intelsupport.h"
+#include "red_black_tree.h"
 #include <ctype.h>
 #include <string.h>
+#include <stdint.h>
 
 #include <math.h>
 #include <errno.h>
@@ -562,18 +565,23 @@ static char c_check_expression(AST expression, const decl_context_t* decl_contex
 
 char check_expression(AST expression, const decl_context_t* decl_context, nodecl_t* nodecl_output)
 {
+    char result = 0;
+    compile_stats_push_category(COMPILE_STATS_EXPRESSION_CHECK);
     if (IS_C_LANGUAGE || IS_CXX_LANGUAGE)
     {
-        return c_check_expression(expression, decl_context, nodecl_output);
+        result = c_check_expression(expression, decl_context, nodecl_output);
     }
     else if (IS_FORTRAN_LANGUAGE)
     {
-        return fortran_check_expression(expression, decl_context, nodecl_output);
+        result = fortran_check_expression(expression, decl_context, nodecl_output);
     }
     else
     {
         internal_error("Code unreachable", 0);
     }
+    compile_stats_pop_category();
+
+    return result;
 }
 
 char check_expression_must_be_constant(AST a, const decl_context_t* decl_context, nodecl_t* nodecl_output)
@@ -1386,9 +1394,7 @@ static const char* process_integer_literal(const char* literal,
             }
         }
     }
-    tmp[j] = '\0';
-
-    return uniquestr(tmp);
+    return uniquestr_n(tmp, j);
 }
 
 // Given a decimal literal computes the type due to its lexic form
@@ -26308,6 +26314,11 @@ constexpr_function_set_constants_of_arguments(
 #undef ERROR_MESSAGE_THIS
 }
 
+// Nesting and number of constexpr calls of the outermost evaluation
+static int constexpr_call_depth = 0;
+static int constexpr_call_steps = 0;
+static char constexpr_call_limit_exceeded = 0;
+
 static const_value_t* evaluate_constexpr_constructor(
         scope_entry_t* entry,
         nodecl_t converted_arg_list,
@@ -26587,6 +26598,655 @@ static const_value_t* evaluate_constexpr_constructor(
     return structured_value;
 }
 
+static char constexpr_call_check_limits(scope_entry_t* entry,
+        const locus_t* locus);
+
+// Interpreter of the body of relaxed (C++14) constexpr functions. Locals and
+// parameters live in the top of the stacked_map_of_values, expressions
+// without side effects are evaluated by instantiating them
+typedef
+enum constexpr_exec_tag
+{
+    CONSTEXPR_EXEC_NORMAL = 0,
+    CONSTEXPR_EXEC_BREAK,
+    CONSTEXPR_EXEC_CONTINUE,
+    CONSTEXPR_EXEC_RETURN,
+    CONSTEXPR_EXEC_FAILED,
+} constexpr_exec_t;
+
+typedef
+struct constexpr_interpreter_tag
+{
+    scope_entry_t* entry;
+    const locus_t* locus;
+    instantiation_symbol_map_t* instantiation_symbol_map;
+    const_value_t* returned_value;
+} constexpr_interpreter_t;
+
+static constexpr_exec_t constexpr_exec_statement(constexpr_interpreter_t* interp,
+        nodecl_t statement);
+static constexpr_exec_t constexpr_exec_statement_list(constexpr_interpreter_t* interp,
+        nodecl_t statement_list);
+static const_value_t* constexpr_eval_expression(constexpr_interpreter_t* interp,
+        nodecl_t expr);
+
+// Only scalar locals and parameters of the current call can be modified
+static scope_entry_t* constexpr_eval_get_modified_variable(
+        constexpr_interpreter_t* interp,
+        nodecl_t lhs)
+{
+    if (nodecl_get_kind(lhs) != NODECL_SYMBOL)
+        return NULL;
+
+    scope_entry_t* sym = instantiation_symbol_try_to_map(
+            interp->instantiation_symbol_map,
+            nodecl_get_symbol(lhs));
+
+    if (sym->kind != SK_VARIABLE
+            || is_any_reference_type(sym->type_information)
+            || is_const_qualified_type(sym->type_information)
+            || !(is_integral_type(sym->type_information)
+                || is_floating_type(sym->type_information))
+            || stacked_map_of_values_get_value(sym) == NULL)
+        return NULL;
+
+    return sym;
+}
+
+static const_value_t* constexpr_eval_convert_to_variable_type(
+        const_value_t* value,
+        scope_entry_t* sym)
+{
+    type_t* t = sym->type_information;
+    if (is_bool_type(t))
+    {
+        return const_value_get_integer(
+                const_value_is_nonzero(value),
+                type_get_size(t),
+                /* signed */ 1);
+    }
+    else if (is_floating_type(t))
+    {
+        return const_value_cast_to_floating_type_value(value, t);
+    }
+    else
+    {
+        return const_value_cast_to_bytes(value,
+                type_get_size(t),
+                is_signed_integral_type(t));
+    }
+}
+
+static const_value_t* constexpr_eval_assignment(constexpr_interpreter_t* interp,
+        nodecl_t expr)
+{
+    scope_entry_t* sym = constexpr_eval_get_modified_variable(interp,
+            nodecl_get_child(expr, 0));
+    if (sym == NULL)
+        return NULL;
+
+    const_value_t* rhs = constexpr_eval_expression(interp, nodecl_get_child(expr, 1));
+    if (rhs == NULL
+            || !(const_value_is_integer(rhs)
+                || const_value_is_floating(rhs)))
+        return NULL;
+
+    const_value_t* lhs = stacked_map_of_values_get_value(sym);
+    const_value_t* result = NULL;
+    switch (nodecl_get_kind(expr))
+    {
+        case NODECL_ASSIGNMENT:
+            result = rhs;
+            break;
+        case NODECL_ADD_ASSIGNMENT:
+            result = const_value_add(lhs, rhs);
+            break;
+        case NODECL_MINUS_ASSIGNMENT:
+            result = const_value_sub(lhs, rhs);
+            break;
+        case NODECL_MUL_ASSIGNMENT:
+            result = const_value_mul(lhs, rhs);
+            break;
+        case NODECL_DIV_ASSIGNMENT:
+        case NODECL_MOD_ASSIGNMENT:
+            {
+                if (const_value_is_integer(rhs)
+                        && const_value_is_zero(rhs))
+                    return NULL;
+                if (nodecl_get_kind(expr) == NODECL_DIV_ASSIGNMENT)
+                    result = const_value_div(lhs, rhs);
+                else if (const_value_is_integer(lhs)
+                        && const_value_is_integer(rhs))
+                    result = const_value_mod(lhs, rhs);
+                else
+                    return NULL;
+                break;
+            }
+        case NODECL_BITWISE_SHL_ASSIGNMENT:
+        case NODECL_BITWISE_SHR_ASSIGNMENT:
+        case NODECL_ARITHMETIC_SHR_ASSIGNMENT:
+            {
+                if (!const_value_is_integer(lhs)
+                        || !const_value_is_integer(rhs))
+                    return NULL;
+                cvalue_int_t shift = const_value_cast_to_cvalue_int(rhs);
+                if (shift < 0
+                        || shift >= type_get_size(sym->type_information) * 8)
+                    return NULL;
+                if (nodecl_get_kind(expr) == NODECL_BITWISE_SHL_ASSIGNMENT)
+                    result = const_value_bitshl(lhs, rhs);
+                else
+                    result = const_value_shr(lhs, rhs);
+                break;
+            }
+        case NODECL_BITWISE_AND_ASSIGNMENT:
+        case NODECL_BITWISE_OR_ASSIGNMENT:
+        case NODECL_BITWISE_XOR_ASSIGNMENT:
+            {
+                if (!const_value_is_integer(lhs)
+                        || !const_value_is_integer(rhs))
+                    return NULL;
+                if (nodecl_get_kind(expr) == NODECL_BITWISE_AND_ASSIGNMENT)
+                    result = const_value_bitand(lhs, rhs);
+                else if (nodecl_get_kind(expr) == NODECL_BITWISE_OR_ASSIGNMENT)
+                    result = const_value_bitor(lhs, rhs);
+                else
+                    result = const_value_bitxor(lhs, rhs);
+                break;
+            }
+        default:
+            internal_error("Unexpected node '%s'\n",
+                    ast_print_node_type(nodecl_get_kind(expr)));
+    }
+
+    result = constexpr_eval_convert_to_variable_type(result, sym);
+    stacked_map_of_values_set_value(sym, result);
+
+    return result;
+}
+
+static const_value_t* constexpr_eval_increment(constexpr_interpreter_t* interp,
+        nodecl_t expr)
+{
+    scope_entry_t* sym = constexpr_eval_get_modified_variable(interp,
+            nodecl_get_child(expr, 0));
+    if (sym == NULL
+            || is_bool_type(sym->type_information))
+        return NULL;
+
+    const_value_t* old_value = stacked_map_of_values_get_value(sym);
+    const_value_t* one = const_value_get_signed_int(1);
+
+    const_value_t* new_value = NULL;
+    if (nodecl_get_kind(expr) == NODECL_PREINCREMENT
+            || nodecl_get_kind(expr) == NODECL_POSTINCREMENT)
+        new_value = const_value_add(old_value, one);
+    else
+        new_value = const_value_sub(old_value, one);
+
+    new_value = constexpr_eval_convert_to_variable_type(new_value, sym);
+    stacked_map_of_values_set_value(sym, new_value);
+
+    if (nodecl_get_kind(expr) == NODECL_POSTINCREMENT
+            || nodecl_get_kind(expr) == NODECL_POSTDECREMENT)
+        return old_value;
+    else
+        return new_value;
+}
+
+static const_value_t* constexpr_eval_expression(constexpr_interpreter_t* interp,
+        nodecl_t expr)
+{
+    switch (nodecl_get_kind(expr))
+    {
+        case NODECL_ASSIGNMENT:
+        case NODECL_ADD_ASSIGNMENT:
+        case NODECL_MINUS_ASSIGNMENT:
+        case NODECL_MUL_ASSIGNMENT:
+        case NODECL_DIV_ASSIGNMENT:
+        case NODECL_MOD_ASSIGNMENT:
+        case NODECL_BITWISE_SHL_ASSIGNMENT:
+        case NODECL_BITWISE_SHR_ASSIGNMENT:
+        case NODECL_ARITHMETIC_SHR_ASSIGNMENT:
+        case NODECL_BITWISE_AND_ASSIGNMENT:
+        case NODECL_BITWISE_OR_ASSIGNMENT:
+        case NODECL_BITWISE_XOR_ASSIGNMENT:
+            {
+                return constexpr_eval_assignment(interp, expr);
+            }
+        case NODECL_PREINCREMENT:
+        case NODECL_POSTINCREMENT:
+        case NODECL_PREDECREMENT:
+        case NODECL_POSTDECREMENT:
+            {
+                return constexpr_eval_increment(interp, expr);
+            }
+        case NODECL_COMMA:
+            {
+                if (constexpr_eval_expression(interp, nodecl_get_child(expr, 0)) == NULL)
+                    return NULL;
+                return constexpr_eval_expression(interp, nodecl_get_child(expr, 1));
+            }
+        default:
+            {
+                // Side effects nested in other expressions are not constant
+                // so instantiating them fails
+                nodecl_t nodecl_evaluated_expr = instantiate_expression(expr,
+                        nodecl_retrieve_context(expr),
+                        interp->instantiation_symbol_map, /* pack_index */ -1);
+                return nodecl_get_constant(nodecl_evaluated_expr);
+            }
+    }
+}
+
+static constexpr_exec_t constexpr_exec_object_init(constexpr_interpreter_t* interp,
+        nodecl_t statement)
+{
+    scope_entry_t* sym = instantiation_symbol_try_to_map(
+            interp->instantiation_symbol_map,
+            nodecl_get_symbol(statement));
+
+    if (sym->kind != SK_VARIABLE
+            || nodecl_is_null(sym->value)
+            || is_any_reference_type(sym->type_information))
+        return CONSTEXPR_EXEC_FAILED;
+
+    nodecl_t nodecl_evaluated_expr = instantiate_expression(sym->value,
+            nodecl_retrieve_context(statement),
+            interp->instantiation_symbol_map, /* pack_index */ -1);
+    if (!nodecl_is_constant(nodecl_evaluated_expr))
+        return CONSTEXPR_EXEC_FAILED;
+
+    stacked_map_of_values_set_value(sym, nodecl_get_constant(nodecl_evaluated_expr));
+    return CONSTEXPR_EXEC_NORMAL;
+}
+
+// The condition of loops and selection statements
+static constexpr_exec_t constexpr_eval_condition(constexpr_interpreter_t* interp,
+        nodecl_t condition,
+        char *result)
+{
+    const_value_t* value = constexpr_eval_expression(interp, condition);
+    if (value == NULL)
+        return CONSTEXPR_EXEC_FAILED;
+
+    *result = const_value_is_nonzero(value);
+    return CONSTEXPR_EXEC_NORMAL;
+}
+
+// Statements after a break or a continue are not run. A break ends the
+// loop, a continue only this iteration
+#define CONSTEXPR_EXEC_LOOP_BODY(interp, body) \
+    { \
+        constexpr_exec_t body_result = constexpr_exec_statement_list(interp, body); \
+        if (body_result == CONSTEXPR_EXEC_BREAK) \
+            break; \
+        if (body_result == CONSTEXPR_EXEC_RETURN \
+                || body_result == CONSTEXPR_EXEC_FAILED) \
+            return body_result; \
+    }
+
+static constexpr_exec_t constexpr_exec_for_statement(constexpr_interpreter_t* interp,
+        nodecl_t statement)
+{
+    nodecl_t loop_control = nodecl_get_child(statement, 0);
+    if (nodecl_get_kind(loop_control) != NODECL_LOOP_CONTROL)
+        return CONSTEXPR_EXEC_FAILED;
+
+    nodecl_t nodecl_init = nodecl_get_child(loop_control, 0);
+    nodecl_t nodecl_cond = nodecl_get_child(loop_control, 1);
+    nodecl_t nodecl_next = nodecl_get_child(loop_control, 2);
+
+    int i, num_items = 0;
+    nodecl_t* init_list = nodecl_unpack_list(nodecl_init, &num_items);
+    for (i = 0; i < num_items; i++)
+    {
+        char ok;
+        if (nodecl_get_kind(init_list[i]) == NODECL_OBJECT_INIT)
+            ok = (constexpr_exec_object_init(interp, init_list[i]) == CONSTEXPR_EXEC_NORMAL);
+        else
+            ok = (constexpr_eval_expression(interp, init_list[i]) != NULL);
+
+        if (!ok)
+        {
+            DELETE(init_list);
+            return CONSTEXPR_EXEC_FAILED;
+        }
+    }
+    DELETE(init_list);
+
+    for (;;)
+    {
+        if (!nodecl_is_null(nodecl_cond))
+        {
+            char cond = 0;
+            if (constexpr_eval_condition(interp, nodecl_cond, &cond) != CONSTEXPR_EXEC_NORMAL)
+                return CONSTEXPR_EXEC_FAILED;
+            if (!cond)
+                break;
+        }
+
+        CONSTEXPR_EXEC_LOOP_BODY(interp, nodecl_get_child(statement, 1));
+
+        if (!nodecl_is_null(nodecl_next)
+                && constexpr_eval_expression(interp, nodecl_next) == NULL)
+            return CONSTEXPR_EXEC_FAILED;
+    }
+
+    return CONSTEXPR_EXEC_NORMAL;
+}
+
+// Case labels may be nested, as in 'case 1: case 2: s;'
+static char constexpr_switch_label_matches(nodecl_t statement,
+        const_value_t* value,
+        char match_default)
+{
+    for (;;)
+    {
+        node_t kind = nodecl_get_kind(statement);
+        if (kind == NODECL_CASE_STATEMENT)
+        {
+            nodecl_t case_list = nodecl_get_child(statement, 0);
+            if (!match_default
+                    && nodecl_list_length(case_list) == 1)
+            {
+                nodecl_t case_expr = nodecl_list_head(case_list);
+                if (nodecl_is_constant(case_expr)
+                        && const_value_is_nonzero(
+                            const_value_eq(nodecl_get_constant(case_expr), value)))
+                    return 1;
+            }
+        }
+        else if (kind == NODECL_DEFAULT_STATEMENT)
+        {
+            if (match_default)
+                return 1;
+        }
+        else
+        {
+            return 0;
+        }
+
+        nodecl_t labeled_statement = nodecl_get_child(statement, 1);
+        if (nodecl_list_length(labeled_statement) != 1)
+            return 0;
+        statement = nodecl_list_head(labeled_statement);
+    }
+}
+
+// Whether 'n' contains a label of the enclosing switch. Labels of nested
+// switches belong to them
+static char constexpr_switch_contains_label(nodecl_t n)
+{
+    if (nodecl_is_null(n))
+        return 0;
+
+    node_t kind = nodecl_get_kind(n);
+    if (kind == NODECL_CASE_STATEMENT
+            || kind == NODECL_DEFAULT_STATEMENT)
+        return 1;
+    if (kind == NODECL_SWITCH_STATEMENT)
+        return 0;
+
+    int i;
+    for (i = 0; i < MCXX_MAX_AST_CHILDREN; i++)
+    {
+        if (constexpr_switch_contains_label(nodecl_get_child(n, i)))
+            return 1;
+    }
+    return 0;
+}
+
+// Whether a statement of the body of the switch has labels nested in inner
+// statements, as in Duff's device. Only the chain of labels in front of the
+// statement is allowed
+static char constexpr_switch_has_nested_labels(nodecl_t statement)
+{
+    while (nodecl_get_kind(statement) == NODECL_CASE_STATEMENT
+            || nodecl_get_kind(statement) == NODECL_DEFAULT_STATEMENT)
+    {
+        nodecl_t labeled_statement = nodecl_get_child(statement, 1);
+        if (nodecl_list_length(labeled_statement) != 1)
+            return constexpr_switch_contains_label(labeled_statement);
+        statement = nodecl_list_head(labeled_statement);
+    }
+
+    return constexpr_switch_contains_label(statement);
+}
+
+// Only labels directly in the body of the switch are considered, a switch
+// with labels nested in inner statements is not evaluated
+static constexpr_exec_t constexpr_exec_switch_statement(constexpr_interpreter_t* interp,
+        nodecl_t statement)
+{
+    nodecl_t body = nodecl_get_child(statement, 1);
+    while (nodecl_list_length(body) == 1
+            && (nodecl_get_kind(nodecl_list_head(body)) == NODECL_CONTEXT
+                || nodecl_get_kind(nodecl_list_head(body)) == NODECL_COMPOUND_STATEMENT))
+    {
+        body = nodecl_get_child(nodecl_list_head(body), 0);
+    }
+
+    int i, num_items = 0;
+    nodecl_t* list = nodecl_unpack_list(body, &num_items);
+
+    for (i = 0; i < num_items; i++)
+    {
+        if (constexpr_switch_has_nested_labels(list[i]))
+        {
+            warn_printf_at(nodecl_get_locus(statement),
+                    "'switch' with labels nested in inner statements cannot be evaluated "
+                    "in a constant expression\n");
+            DELETE(list);
+            return CONSTEXPR_EXEC_FAILED;
+        }
+    }
+
+    const_value_t* value = constexpr_eval_expression(interp, nodecl_get_child(statement, 0));
+    if (value == NULL)
+    {
+        DELETE(list);
+        return CONSTEXPR_EXEC_FAILED;
+    }
+
+    int first = -1;
+    for (i = 0; i < num_items && first < 0; i++)
+    {
+        if (constexpr_switch_label_matches(list[i], value, /* match_default */ 0))
+            first = i;
+    }
+    for (i = 0; i < num_items && first < 0; i++)
+    {
+        if (constexpr_switch_label_matches(list[i], value, /* match_default */ 1))
+            first = i;
+    }
+
+    constexpr_exec_t result = CONSTEXPR_EXEC_NORMAL;
+    if (first >= 0)
+    {
+        for (i = first; i < num_items; i++)
+        {
+            result = constexpr_exec_statement(interp, list[i]);
+            if (result != CONSTEXPR_EXEC_NORMAL)
+                break;
+        }
+    }
+    DELETE(list);
+
+    // A break ends the switch, a continue belongs to the enclosing loop
+    if (result == CONSTEXPR_EXEC_BREAK)
+        result = CONSTEXPR_EXEC_NORMAL;
+
+    return result;
+}
+
+static constexpr_exec_t constexpr_exec_statement(constexpr_interpreter_t* interp,
+        nodecl_t statement)
+{
+    constexpr_call_steps++;
+    if (!constexpr_call_check_limits(interp->entry, interp->locus))
+        return CONSTEXPR_EXEC_FAILED;
+
+    switch (nodecl_get_kind(statement))
+    {
+        case NODECL_CONTEXT:
+        case NODECL_COMPOUND_STATEMENT:
+            {
+                return constexpr_exec_statement_list(interp, nodecl_get_child(statement, 0));
+            }
+        case NODECL_CASE_STATEMENT:
+        case NODECL_DEFAULT_STATEMENT:
+            {
+                // Reached when running the body of a switch
+                return constexpr_exec_statement_list(interp, nodecl_get_child(statement, 1));
+            }
+        case NODECL_EMPTY_STATEMENT:
+        case NODECL_CXX_DECL:
+        case NODECL_CXX_DEF:
+        case NODECL_CXX_USING_DECL:
+        case NODECL_CXX_USING_NAMESPACE:
+        case NODECL_CXX_STATIC_ASSERT:
+            {
+                // Variables are initialized in their NODECL_OBJECT_INIT
+                return CONSTEXPR_EXEC_NORMAL;
+            }
+        case NODECL_OBJECT_INIT:
+            {
+                return constexpr_exec_object_init(interp, statement);
+            }
+        case NODECL_EXPRESSION_STATEMENT:
+            {
+                if (constexpr_eval_expression(interp, nodecl_get_child(statement, 0)) == NULL)
+                    return CONSTEXPR_EXEC_FAILED;
+                return CONSTEXPR_EXEC_NORMAL;
+            }
+        case NODECL_RETURN_STATEMENT:
+            {
+                nodecl_t nodecl_returned_expression = nodecl_get_child(statement, 0);
+                if (nodecl_is_null(nodecl_returned_expression))
+                    return CONSTEXPR_EXEC_FAILED;
+
+                interp->returned_value = constexpr_eval_expression(interp, nodecl_returned_expression);
+                if (interp->returned_value == NULL)
+                    return CONSTEXPR_EXEC_FAILED;
+                return CONSTEXPR_EXEC_RETURN;
+            }
+        case NODECL_IF_ELSE_STATEMENT:
+            {
+                char cond = 0;
+                if (constexpr_eval_condition(interp, nodecl_get_child(statement, 0), &cond)
+                        != CONSTEXPR_EXEC_NORMAL)
+                    return CONSTEXPR_EXEC_FAILED;
+
+                if (cond)
+                    return constexpr_exec_statement_list(interp, nodecl_get_child(statement, 1));
+                else
+                    return constexpr_exec_statement_list(interp, nodecl_get_child(statement, 2));
+            }
+        case NODECL_WHILE_STATEMENT:
+            {
+                for (;;)
+                {
+                    char cond = 0;
+                    if (constexpr_eval_condition(interp, nodecl_get_child(statement, 0), &cond)
+                            != CONSTEXPR_EXEC_NORMAL)
+                        return CONSTEXPR_EXEC_FAILED;
+                    if (!cond)
+                        break;
+
+                    CONSTEXPR_EXEC_LOOP_BODY(interp, nodecl_get_child(statement, 1));
+                }
+                return CONSTEXPR_EXEC_NORMAL;
+            }
+        case NODECL_DO_STATEMENT:
+            {
+                for (;;)
+                {
+                    CONSTEXPR_EXEC_LOOP_BODY(interp, nodecl_get_child(statement, 0));
+
+                    char cond = 0;
+                    if (constexpr_eval_condition(interp, nodecl_get_child(statement, 1), &cond)
+                            != CONSTEXPR_EXEC_NORMAL)
+                        return CONSTEXPR_EXEC_FAILED;
+                    if (!cond)
+                        break;
+                }
+                return CONSTEXPR_EXEC_NORMAL;
+            }
+        case NODECL_FOR_STATEMENT:
+            {
+                return constexpr_exec_for_statement(interp, statement);
+            }
+        case NODECL_SWITCH_STATEMENT:
+            {
+                return constexpr_exec_switch_statement(interp, statement);
+            }
+        case NODECL_BREAK_STATEMENT:
+            {
+                return CONSTEXPR_EXEC_BREAK;
+            }
+        case NODECL_CONTINUE_STATEMENT:
+            {
+                return CONSTEXPR_EXEC_CONTINUE;
+            }
+        default:
+            {
+                DEBUG_CODE()
+                {
+                    fprintf(stderr, "EXPRTYPE: Statement '%s' cannot be evaluated in a constexpr function\n",
+                            ast_print_node_type(nodecl_get_kind(statement)));
+                }
+                return CONSTEXPR_EXEC_FAILED;
+            }
+    }
+}
+
+static constexpr_exec_t constexpr_exec_statement_list(constexpr_interpreter_t* interp,
+        nodecl_t statement_list)
+{
+    if (nodecl_is_null(statement_list))
+        return CONSTEXPR_EXEC_NORMAL;
+
+    int i, num_items = 0;
+    nodecl_t* list = nodecl_unpack_list(statement_list, &num_items);
+
+    constexpr_exec_t result = CONSTEXPR_EXEC_NORMAL;
+    for (i = 0; i < num_items && result == CONSTEXPR_EXEC_NORMAL; i++)
+    {
+        result = constexpr_exec_statement(interp, list[i]);
+    }
+    DELETE(list);
+
+    return result;
+}
+
+// Returns the value of the call or NULL if the body does not yield a
+// constant value. The parameters must already be in the stacked map
+static const_value_t* constexpr_function_interpret_body(
+        scope_entry_t* entry,
+        nodecl_t nodecl_function_code,
+        instantiation_symbol_map_t* instantiation_symbol_map,
+        const locus_t* locus)
+{
+    ERROR_CONDITION(nodecl_is_null(nodecl_function_code)
+            || nodecl_get_kind(nodecl_function_code) != NODECL_FUNCTION_CODE, "Invalid function code", 0);
+
+    constexpr_interpreter_t interp;
+    memset(&interp, 0, sizeof(interp));
+    interp.entry = entry;
+    interp.locus = locus;
+    interp.instantiation_symbol_map = instantiation_symbol_map;
+
+    constexpr_exec_t result = constexpr_exec_statement(&interp,
+            nodecl_get_child(nodecl_function_code, 0));
+
+    // Flowing off the end of the function does not give a value
+    if (result != CONSTEXPR_EXEC_RETURN)
+        return NULL;
+
+    return interp.returned_value;
+}
+
 static const_value_t* evaluate_constexpr_regular_function_call(
         scope_entry_t* entry,
         nodecl_t converted_arg_list,
@@ -26654,26 +27314,42 @@ static const_value_t* evaluate_constexpr_regular_function_call(
     nodecl_t nodecl_function_code = symbol_entity_specs_get_function_code(entry);
     ERROR_CONDITION(nodecl_is_null(nodecl_function_code), "Function lacks function code", 0);
 
-    nodecl_t nodecl_returned_expression =
-        constexpr_function_get_returned_expression(nodecl_function_code);
-
     instantiation_symbol_map_t* instantiation_symbol_map = NULL;
     if (symbol_entity_specs_get_is_member(entry))
     {
         instantiation_symbol_map = symbol_entity_specs_get_instantiation_symbol_map(entry);
     }
 
-    nodecl_t nodecl_evaluated_expr = instantiate_expression(nodecl_returned_expression,
-            nodecl_retrieve_context(nodecl_returned_expression),
-            instantiation_symbol_map, /* pack_index */ -1);
+    const_value_t* cval = NULL;
+    if (IS_CXX14_LANGUAGE)
+    {
+        // Relaxed constexpr functions may have locals, loops, etc.
+        cval = constexpr_function_interpret_body(entry,
+                nodecl_function_code,
+                instantiation_symbol_map,
+                locus);
+    }
+    else
+    {
+        nodecl_t nodecl_returned_expression =
+            constexpr_function_get_returned_expression(nodecl_function_code);
+
+        nodecl_t nodecl_evaluated_expr = instantiate_expression(nodecl_returned_expression,
+                nodecl_retrieve_context(nodecl_returned_expression),
+                instantiation_symbol_map, /* pack_index */ -1);
 
-    if (!nodecl_is_constant(nodecl_evaluated_expr))
+        cval = nodecl_get_constant(nodecl_evaluated_expr);
+    }
+
+    if (cval == NULL)
     {
         DEBUG_CODE()
         {
             fprintf(stderr, "EXPRTYPE: Evaluation of regular constexpr call did not give a constant value\n");
         }
-        if (check_expr_flags.must_be_constant)
+        if (check_expr_flags.must_be_constant
+                // Already diagnosed
+                && !constexpr_call_limit_exceeded)
         {
             error_printf_at(locus, "call to constexpr function '%s' in constant-expression did not yield a constant value\n",
                     print_decl_type_str(entry->type_information, entry->decl_context,
@@ -26681,11 +27357,154 @@ static const_value_t* evaluate_constexpr_regular_function_call(
         }
     }
 
-    const_value_t* cval = nodecl_get_constant(nodecl_evaluated_expr);
     stacked_map_of_values_pop();
     return cval;
 }
 
+// Constexpr calls are memoized per translation unit. Const values are
+// unique, so a call is identified by the function and the pointers of the
+// values of its arguments
+typedef
+struct constexpr_call_tag
+{
+    scope_entry_t* entry;
+    int num_arguments;
+    const_value_t** arguments;
+} constexpr_call_t;
+
+static int constexpr_call_compare(const void* p1, const void* p2)
+{
+    const constexpr_call_t* c1 = (const constexpr_call_t*)p1;
+    const constexpr_call_t* c2 = (const constexpr_call_t*)p2;
+
+    if (c1->entry != c2->entry)
+        return ((uintptr_t)c1->entry < (uintptr_t)c2->entry) ? -1 : 1;
+
+    if (c1->num_arguments != c2->num_arguments)
+        return (c1->num_arguments < c2->num_arguments) ? -1 : 1;
+
+    int i;
+    for (i = 0; i < c1->num_arguments; i++)
+    {
+        if (c1->arguments[i] != c2->arguments[i])
+            return ((uintptr_t)c1->arguments[i] < (uintptr_t)c2->arguments[i]) ? -1 : 1;
+    }
+
+    return 0;
+}
+
+static void constexpr_call_free(const void* p)
+{
+    constexpr_call_t* call = (constexpr_call_t*)p;
+    DELETE(call->arguments);
+    DELETE(call);
+}
+
+static rb_red_blk_tree* constexpr_call_memo = NULL;
+static translation_unit_t* constexpr_call_memo_translation_unit = NULL;
+
+// Returns NULL if the value of this call cannot be memoized
+static constexpr_call_t* constexpr_call_new(scope_entry_t* entry,
+        nodecl_t converted_arg_list)
+{
+    // The implicit argument is bound to a fresh temporary in every call
+    if (symbol_entity_specs_get_is_member(entry)
+            && !symbol_entity_specs_get_is_static(entry)
+            && !symbol_entity_specs_get_is_constructor(entry))
+        return NULL;
+
+    int num_arguments = 0;
+    nodecl_t* list_of_arguments = nodecl_unpack_list(converted_arg_list, &num_arguments);
+    argument_list_remove_default_arguments(list_of_arguments, num_arguments);
+
+    const_value_t** arguments = NEW_VEC0(const_value_t*, num_arguments);
+    int i;
+    for (i = 0; i < num_arguments; i++)
+    {
+        arguments[i] = nodecl_get_constant(list_of_arguments[i]);
+        if (arguments[i] == NULL)
+        {
+            // The evaluation will fail anyway
+            DELETE(arguments);
+            DELETE(list_of_arguments);
+            return NULL;
+        }
+    }
+    DELETE(list_of_arguments);
+
+    constexpr_call_t* call = NEW0(constexpr_call_t);
+    call->entry = entry;
+    call->num_arguments = num_arguments;
+    call->arguments = arguments;
+
+    return call;
+}
+
+static const_value_t* constexpr_call_memo_query(constexpr_call_t* call)
+{
+    if (constexpr_call_memo_translation_unit != CURRENT_COMPILED_FILE)
+    {
+        if (constexpr_call_memo != NULL)
+            rb_tree_destroy(constexpr_call_memo);
+        constexpr_call_memo = rb_tree_create(constexpr_call_compare, constexpr_call_free, NULL);
+        constexpr_call_memo_translation_unit = CURRENT_COMPILED_FILE;
+    }
+
+    rb_red_blk_node* n = rb_tree_query(constexpr_call_memo, call);
+    if (n == NULL)
+        return NULL;
+
+    return (const_value_t*)rb_node_get_info(n);
+}
+
+static char constexpr_call_check_limits(scope_entry_t* entry,
+        const locus_t* locus)
+{
+    if (constexpr_call_limit_exceeded)
+        return 0;
+
+    const char* option_name = NULL;
+    const char* limit_kind = NULL;
+    int limit = 0;
+    if (constexpr_call_depth >= CURRENT_CONFIGURATION->constexpr_max_depth)
+    {
+        option_name = "depth";
+        limit_kind = "nested calls";
+        limit = CURRENT_CONFIGURATION->constexpr_max_depth;
+    }
+    else if (constexpr_call_steps >= CURRENT_CONFIGURATION->constexpr_max_steps)
+    {
+        option_name = "steps";
+        limit_kind = "evaluation steps";
+        limit = CURRENT_CONFIGURATION->constexpr_max_steps;
+    }
+    else
+    {
+        return 1;
+    }
+
+    // Give up the whole evaluation, not only this call
+    constexpr_call_limit_exceeded = 1;
+
+    DEBUG_CODE()
+    {
+        fprintf(stderr, "EXPRTYPE: Evaluation of constexpr call to '%s' exceeds the limit of %d %s\n",
+                get_qualified_symbol_name(entry, entry->decl_context),
+                limit, limit_kind);
+    }
+    if (check_expr_flags.must_be_constant)
+    {
+        error_printf_at(locus, "evaluation of call to constexpr %s '%s' exceeds the limit "
+                "of %d %s (use --constexpr-%s=<n> to increase it)\n",
+                symbol_entity_specs_get_is_constructor(entry) ? "constructor" : "function",
+                print_decl_type_str(entry->type_information, entry->decl_context,
+                    get_qualified_symbol_name(entry, entry->decl_context)),
+                limit, limit_kind, option_name);
+    }
+
+    return 0;
+}
+
 static const_value_t* evaluate_constexpr_function_call(
         scope_entry_t* entry,
         nodecl_t converted_arg_list,
@@ -26700,6 +27519,38 @@ static const_value_t* evaluate_constexpr_function_call(
                     get_qualified_symbol_name(entry, entry->decl_context)));
     }
 
+    if (constexpr_call_depth == 0)
+    {
+        constexpr_call_steps = 0;
+        constexpr_call_limit_exceeded = 0;
+    }
+
+    constexpr_call_t* call = constexpr_call_new(entry, converted_arg_list);
+    if (call != NULL)
+    {
+        const_value_t* value = constexpr_call_memo_query(call);
+        if (value != NULL)
+        {
+            DEBUG_CODE()
+            {
+                fprintf(stderr, "EXPRTYPE: Reusing value '%s' of a previous evaluation\n",
+                        const_value_to_str(value));
+            }
+            constexpr_call_free(call);
+            return value;
+        }
+    }
+
+    if (!constexpr_call_check_limits(entry, locus))
+    {
+        if (call != NULL)
+            constexpr_call_free(call);
+        return NULL;
+    }
+
+    constexpr_call_depth++;
+    constexpr_call_steps++;
+
     const_value_t* value = NULL;
     if (symbol_entity_specs_get_is_constructor(entry))
     {
@@ -26718,6 +27569,17 @@ static const_value_t* evaluate_constexpr_function_call(
                 locus);
     }
 
+    constexpr_call_depth--;
+
+    if (call != NULL)
+    {
+        // Failed evaluations are not remembered so they are diagnosed again
+        if (value != NULL)
+            rb_tree_insert(constexpr_call_memo, call, value);
+        else
+            constexpr_call_free(call);
+    }
+
     return value;
 }
 
@@ -1,4 +1,23 @@
 {
+scope_entry_t* sym___builtin_cpu_init = new_symbol(decl_context, decl_context->current_scope, uniquestr("__builtin_cpu_init"));
+sym___builtin_cpu_init->kind = SK_FUNCTION;sym___builtin_cpu_init->do_not_print = 1;sym___builtin_cpu_init->locus = builtins_locus;
+sym___builtin_cpu_init->type_information = ({type_t* return_type = get_void_type();
+get_new_function_type(return_type, 0, 0, REF_QUALIFIER_NONE);
+})
+;
+symbol_entity_specs_set_is_builtin(sym___builtin_cpu_init, 1);
+}
+{
+scope_entry_t* sym___builtin_cpu_supports = new_symbol(decl_context, decl_context->current_scope, uniquestr("__builtin_cpu_supports"));
+sym___builtin_cpu_supports->kind = SK_FUNCTION;sym___builtin_cpu_supports->do_not_print = 1;sym___builtin_cpu_supports->locus = builtins_locus;
+sym___builtin_cpu_supports->type_information = ({type_t* return_type = get_signed_int_type();
+parameter_info_t p[1]; memset(p, 0, sizeof(p));p[0].type_info = get_pointer_type(get_const_qualified_type(get_char_type()));
+get_new_function_type(return_type, p, sizeof(p)/sizeof(p[0]), REF_QUALIFIER_NONE);
+})
+;
+symbol_entity_specs_set_is_builtin(sym___builtin_cpu_supports, 1);
+}
+{
 scope_entry_t* sym___builtin_ia32_addcarryx_u32 = new_symbol(decl_context, decl_context->current_scope, uniquestr("__builtin_ia32_addcarryx_u32"));
 sym___builtin_ia32_addcarryx_u32->kind = SK_FUNCTION;sym___builtin_ia32_addcarryx_u32->do_not_print = 1;sym___builtin_ia32_addcarryx_u32->locus = builtins_locus;
 sym___builtin_ia32_addcarryx_u32->type_information = ({type_t* return_type = get_unsigned_char_type();
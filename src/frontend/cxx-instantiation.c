@@ -44,6 +44,7 @@
 #include "cxx-graphviz.h"
 #include "cxx-diagnostic.h"
 #include "cxx-codegen.h"
+#include "cxx-compile-stats.h"
 
 #include "cxx-printscope.h"
 
@@ -59,6 +60,7 @@ static scope_entry_t* add_duplicate_member_to_class(
 
     *new_member = *member_of_template;
     symbol_clear_indirect_types(new_member);
+    symbol_entity_specs_unshare_cold(new_member);
 
     symbol_entity_specs_set_is_member(new_member, 1);
     symbol_entity_specs_set_is_instantiable(new_member, 0);
@@ -1393,6 +1395,7 @@ static void instantiate_dependent_friend_function(
                     scope_entry_t* new_entry = NEW0(scope_entry_t);
                     memcpy(new_entry, current_temp_param->entry, sizeof(*current_temp_param->entry));
                     symbol_clear_indirect_types(new_entry);
+                    symbol_entity_specs_unshare_cold(new_entry);
                     symbol_entity_specs_set_template_parameter_nesting(new_entry, 1);
                     current_temp_param->entry = new_entry;
                 }
@@ -1524,6 +1527,7 @@ static void instantiate_class_common(
                 inner_decl_context->current_scope, being_instantiated_sym->symbol_name);
 
         *injected_symbol = *being_instantiated_sym;
+        symbol_entity_specs_unshare_cold(injected_symbol);
         // the injected class name is logically in the class-scope
         injected_symbol->decl_context = inner_decl_context;
         injected_symbol->do_not_print = 1;
@@ -1766,6 +1770,10 @@ static void instantiate_specialized_template_class(type_t* selected_template,
     }
 
     diagnostic_context_push_instantiation(instantiation_header);
+    compile_stats_begin_entity(COMPILE_STATS_ENTITY_CLASS_INSTANTIATION,
+            compile_stats_enabled() ? print_type_str(being_instantiated, being_instantiated_sym->decl_context) : NULL,
+            locus,
+            COMPILE_STATS_INSTANTIATION);
 
     // Update the template parameter with the deduced template parameters
     decl_context_t* instantiation_context = decl_context_clone(being_instantiated_sym->decl_context);
@@ -1816,6 +1824,7 @@ static void instantiate_specialized_template_class(type_t* selected_template,
             inner_decl_context,
             locus);
 
+    compile_stats_end_entity();
     diagnostic_context_pop_and_commit();
 
     DEBUG_CODE()
@@ -2055,6 +2064,10 @@ static void instantiate_nontemplate_member_class_of_template_class(
         instantiation_header.data = p;
     }
     diagnostic_context_push_instantiation(instantiation_header);
+    compile_stats_begin_entity(COMPILE_STATS_ENTITY_CLASS_INSTANTIATION,
+            compile_stats_enabled() ? print_type_str(being_instantiated, being_instantiated_sym->decl_context) : NULL,
+            locus,
+            COMPILE_STATS_INSTANTIATION);
 
     instantiation_symbol_map_t* enclosing_instantiation_symbol_map = NULL;
     scope_entry_t* enclosing_class = named_type_get_symbol(symbol_entity_specs_get_class_type(being_instantiated_sym));
@@ -2069,6 +2082,7 @@ static void instantiate_nontemplate_member_class_of_template_class(
             inner_decl_context,
             locus);
 
+    compile_stats_end_entity();
     diagnostic_context_pop_and_commit();
 
     DEBUG_CODE()
@@ -2755,6 +2769,10 @@ static char instantiate_template_function_internal(scope_entry_t* entry, const l
         instantiation_header.data = p;
     }
     diagnostic_context_push_instantiation(instantiation_header);
+    compile_stats_begin_entity(COMPILE_STATS_ENTITY_FUNCTION_INSTANTIATION,
+            compile_stats_enabled() ? get_qualified_symbol_name(entry, entry->decl_context) : NULL,
+            locus,
+            COMPILE_STATS_INSTANTIATION);
 
     char was_instantiated = 0;
 
@@ -2823,6 +2841,7 @@ static char instantiate_template_function_internal(scope_entry_t* entry, const l
         entry->defined = 1;
     }
 
+    compile_stats_end_entity();
     diagnostic_context_pop_and_commit();
 
     num_being_instantiated_now--;
@@ -0,0 +1,570 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2015 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "cxx-nodecl-index.h"
+#include "cxx-ast.h"
+#include "cxx-nodecl.h"
+#include "cxx-driver.h"
+#include "cxx-compile-stats.h"
+#include "cxx-utils.h"
+#include "mem.h"
+
+/*
+   Nodecl index
+
+   Maps every node of the indexed tree to its kind and keeps, for every kind,
+   the nodes that have had it. Nodes are indexed when created and when they
+   are attached to an indexed node. A node is only indexed once the nodes
+   below it are, so indexing a subtree stops at the first indexed node.
+
+   Entries of a kind are not removed eagerly: a query first discards the
+   nodes that were freed or whose kind changed and then the ones that are not
+   reachable from the root anymore. The latter are kept since they may be
+   attached again later.
+ */
+
+char nodecl_index_active = 0;
+
+// Open addressing table from nodes to an integer
+typedef struct index_table_tag
+{
+    // Always a power of two
+    unsigned int capacity;
+    // Including removed entries
+    unsigned int num_used;
+    AST* keys;
+    int* values;
+} index_table_t;
+
+#define INDEX_TABLE_REMOVED ((AST)0x1)
+
+typedef struct index_bucket_tag
+{
+    int num_nodes;
+    int capacity;
+    AST* nodes;
+} index_bucket_t;
+
+typedef struct index_stack_tag
+{
+    int num_nodes;
+    int capacity;
+    AST* nodes;
+} index_stack_t;
+
+static AST index_root = NULL;
+// Kind of every indexed node
+static index_table_t index_kinds;
+static index_bucket_t index_buckets[AST_LAST_NODE];
+
+static index_stack_t index_stack;
+
+static unsigned int index_table_hash(const_AST a, unsigned int capacity)
+{
+    uint64_t h = (uint64_t)(uintptr_t)a;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return (unsigned int)h & (capacity - 1);
+}
+
+static void index_table_init(index_table_t* t, unsigned int capacity)
+{
+    t->capacity = capacity;
+    t->num_used = 0;
+    t->keys = NEW_VEC0(AST, capacity);
+    t->values = NEW_VEC(int, capacity);
+}
+
+static void index_table_destroy(index_table_t* t)
+{
+    DELETE(t->keys);
+    DELETE(t->values);
+    memset(t, 0, sizeof(*t));
+}
+
+static int* index_table_find(index_table_t* t, const_AST a)
+{
+    unsigned int mask = t->capacity - 1;
+    unsigned int i = index_table_hash(a, t->capacity);
+    for (;;)
+    {
+        if (t->keys[i] == a)
+            return &t->values[i];
+        if (t->keys[i] == NULL)
+            return NULL;
+        i = (i + 1) & mask;
+    }
+}
+
+static void index_table_insert(index_table_t* t, AST a, int value);
+
+static void index_table_rehash(index_table_t* t, unsigned int new_capacity)
+{
+    index_table_t old = *t;
+
+    index_table_init(t, new_capacity);
+    unsigned int i;
+    for (i = 0; i < old.capacity; i++)
+    {
+        if (old.keys[i] != NULL
+                && old.keys[i] != INDEX_TABLE_REMOVED)
+        {
+            index_table_insert(t, old.keys[i], old.values[i]);
+        }
+    }
+
+    index_table_destroy(&old);
+}
+
+// Inserts or updates 'a'
+static void index_table_insert(index_table_t* t, AST a, int value)
+{
+    if ((t->num_used + 1) * 4 > t->capacity * 3)
+    {
+        // Count the entries actually in use, removed ones are discarded
+        unsigned int num_items = 0, i;
+        for (i = 0; i < t->capacity; i++)
+        {
+            if (t->keys[i] != NULL
+                    && t->keys[i] != INDEX_TABLE_REMOVED)
+                num_items++;
+        }
+        index_table_rehash(t,
+                (num_items + 1) * 2 > t->capacity ? t->capacity * 2 : t->capacity);
+    }
+
+    unsigned int mask = t->capacity - 1;
+    unsigned int i = index_table_hash(a, t->capacity);
+    int first_removed = -1;
+    for (;;)
+    {
+        if (t->keys[i] == a)
+        {
+            t->values[i] = value;
+            return;
+        }
+        if (t->keys[i] == NULL)
+            break;
+        if (t->keys[i] == INDEX_TABLE_REMOVED
+                && first_removed < 0)
+            first_removed = i;
+        i = (i + 1) & mask;
+    }
+
+    if (first_removed >= 0)
+    {
+        i = first_removed;
+    }
+    else
+    {
+        t->num_used++;
+    }
+    t->keys[i] = a;
+    t->values[i] = value;
+}
+
+static void index_table_remove(index_table_t* t, const_AST a)
+{
+    unsigned int mask = t->capacity - 1;
+    unsigned int i = index_table_hash(a, t->capacity);
+    for (;;)
+    {
+        if (t->keys[i] == a)
+        {
+            t->keys[i] = INDEX_TABLE_REMOVED;
+            return;
+        }
+        if (t->keys[i] == NULL)
+            return;
+        i = (i + 1) & mask;
+    }
+}
+
+static void index_stack_push(index_stack_t* s, AST a)
+{
+    if (s->num_nodes == s->capacity)
+    {
+        s->capacity = (s->capacity == 0) ? 256 : s->capacity * 2;
+        s->nodes = NEW_REALLOC(AST, s->nodes, s->capacity);
+    }
+    s->nodes[s->num_nodes] = a;
+    s->num_nodes++;
+}
+
+static void index_bucket_add(AST a, node_t kind)
+{
+    // Lists are not searched by kind
+    if (kind == AST_NODE_LIST
+            || kind == AST_INVALID_NODE)
+        return;
+
+    index_bucket_t* bucket = &index_buckets[kind];
+    if (bucket->num_nodes == bucket->capacity)
+    {
+        bucket->capacity = (bucket->capacity == 0) ? 16 : bucket->capacity * 2;
+        bucket->nodes = NEW_REALLOC(AST, bucket->nodes, bucket->capacity);
+    }
+    bucket->nodes[bucket->num_nodes] = a;
+    bucket->num_nodes++;
+}
+
+void nodecl_index_add_tree(AST a)
+{
+    if (a == NULL)
+        return;
+
+    index_stack_t* stack = &index_stack;
+    int bottom = stack->num_nodes;
+    index_stack_push(stack, a);
+
+    while (stack->num_nodes > bottom)
+    {
+        stack->num_nodes--;
+        AST n = stack->nodes[stack->num_nodes];
+
+        node_t kind = ASTKind(n);
+        int* indexed_kind = index_table_find(&index_kinds, n);
+        if (indexed_kind != NULL)
+        {
+            // The nodes below it are already indexed
+            if (*indexed_kind != (int)kind)
+            {
+                *indexed_kind = kind;
+                index_bucket_add(n, kind);
+            }
+            continue;
+        }
+
+        index_table_insert(&index_kinds, n, kind);
+        index_bucket_add(n, kind);
+
+        if (kind == AST_AMBIGUITY)
+        {
+            int i;
+            for (i = 0; i < ast_get_num_ambiguities(n); i++)
+            {
+                index_stack_push(stack, ast_get_ambiguity(n, i));
+            }
+        }
+        else
+        {
+            int i;
+            for (i = 0; i < MCXX_MAX_AST_CHILDREN; i++)
+            {
+                AST child = ast_get_child(n, i);
+                if (child != NULL)
+                    index_stack_push(stack, child);
+            }
+        }
+    }
+}
+
+void nodecl_index_attach(AST parent, AST child)
+{
+    if (index_table_find(&index_kinds, parent) != NULL)
+    {
+        nodecl_index_add_tree(child);
+    }
+}
+
+void nodecl_index_update(AST a)
+{
+    int* indexed_kind = index_table_find(&index_kinds, a);
+    if (indexed_kind == NULL)
+        return;
+
+    node_t kind = ASTKind(a);
+    if (*indexed_kind != (int)kind)
+    {
+        *indexed_kind = kind;
+        index_bucket_add(a, kind);
+    }
+
+    if (kind != AST_AMBIGUITY)
+    {
+        int i;
+        for (i = 0; i < MCXX_MAX_AST_CHILDREN; i++)
+        {
+            nodecl_index_add_tree(ast_get_child(a, i));
+        }
+    }
+}
+
+void nodecl_index_remove(AST a)
+{
+    index_table_remove(&index_kinds, a);
+}
+
+void nodecl_index_begin(nodecl_t root)
+{
+    if (nodecl_index_active)
+        nodecl_index_end();
+
+    index_root = nodecl_get_ast(root);
+    index_table_init(&index_kinds, 1 << 16);
+    nodecl_index_add_tree(index_root);
+
+    nodecl_index_active = 1;
+}
+
+void nodecl_index_end(void)
+{
+    if (!nodecl_index_active)
+        return;
+
+    int i;
+    for (i = 0; i < AST_LAST_NODE; i++)
+    {
+        DELETE(index_buckets[i].nodes);
+    }
+    memset(index_buckets, 0, sizeof(index_buckets));
+
+    index_table_destroy(&index_kinds);
+    index_root = NULL;
+
+    nodecl_index_active = 0;
+}
+
+// Preorder walk used when the index cannot answer the query
+static nodecl_t* walk_find_all(AST tree, node_t kind, int* num_nodes)
+{
+    int num_result = 0, capacity = 16;
+    nodecl_t* result = NEW_VEC(nodecl_t, capacity);
+
+    *num_nodes = 0;
+    if (tree == NULL)
+        return result;
+
+    index_stack_t* stack = &index_stack;
+    int bottom = stack->num_nodes;
+    index_stack_push(stack, tree);
+
+    while (stack->num_nodes > bottom)
+    {
+        stack->num_nodes--;
+        AST n = stack->nodes[stack->num_nodes];
+        compile_stats_nodes_visited++;
+
+        if (ASTKind(n) == kind)
+        {
+            if (num_result == capacity)
+            {
+                capacity *= 2;
+                result = NEW_REALLOC(nodecl_t, result, capacity);
+            }
+            result[num_result] = _nodecl_wrap(n);
+            num_result++;
+        }
+
+        // Children are pushed in reverse order so child 0 is walked first.
+        // In a list this walks the elements from the head
+        int i;
+        for (i = MCXX_MAX_AST_CHILDREN - 1; i >= 0; i--)
+        {
+            AST child = ast_get_child(n, i);
+            if (child != NULL)
+                index_stack_push(stack, child);
+        }
+    }
+
+    *num_nodes = num_result;
+    return result;
+}
+
+enum
+{
+    // Values of the reachability table. Reachable nodes are later numbered
+    // in preorder starting from 1
+    INDEX_UNREACHABLE = -1,
+    INDEX_REACHABLE = 0,
+};
+
+typedef struct index_found_tag
+{
+    AST node;
+    int order;
+} index_found_t;
+
+static int index_found_compare(const void* p1, const void* p2)
+{
+    const index_found_t* f1 = (const index_found_t*)p1;
+    const index_found_t* f2 = (const index_found_t*)p2;
+
+    if (f1->order < f2->order)
+        return -1;
+    else if (f1->order > f2->order)
+        return 1;
+    return 0;
+}
+
+static nodecl_t* index_find_all(node_t kind, int* num_nodes)
+{
+    index_bucket_t* bucket = &index_buckets[kind];
+
+    // Discard the nodes that were freed or have changed their kind
+    int i, num_candidates = 0;
+    for (i = 0; i < bucket->num_nodes; i++)
+    {
+        AST n = bucket->nodes[i];
+        int* indexed_kind = index_table_find(&index_kinds, n);
+        if (indexed_kind != NULL
+                && *indexed_kind == (int)kind)
+        {
+            bucket->nodes[num_candidates] = n;
+            num_candidates++;
+        }
+    }
+    bucket->num_nodes = num_candidates;
+
+    // A candidate is in the tree if following the parents we reach the root
+    // and every node is a child of its parent. Only indexed parents are
+    // followed as the parent of a detached node may have been freed
+    index_table_t reachable;
+    unsigned int capacity = 64;
+    while (capacity < (unsigned int)num_candidates * 8)
+        capacity *= 2;
+    index_table_init(&reachable, capacity);
+    index_table_insert(&reachable, index_root, INDEX_REACHABLE);
+
+    index_stack_t* path = &index_stack;
+    int bottom = path->num_nodes;
+    for (i = 0; i < num_candidates; i++)
+    {
+        AST n = bucket->nodes[i];
+        int status;
+        for (;;)
+        {
+            int* known = index_table_find(&reachable, n);
+            if (known != NULL)
+            {
+                status = *known;
+                break;
+            }
+
+            compile_stats_nodes_visited++;
+            index_stack_push(path, n);
+
+            AST parent = ASTParent(n);
+            if (parent == NULL
+                    || index_table_find(&index_kinds, parent) == NULL
+                    || ASTKind(parent) == AST_AMBIGUITY
+                    || ast_num_of_given_child(parent, n) < 0)
+            {
+                status = INDEX_UNREACHABLE;
+                break;
+            }
+            n = parent;
+        }
+
+        while (path->num_nodes > bottom)
+        {
+            path->num_nodes--;
+            index_table_insert(&reachable, path->nodes[path->num_nodes], status);
+        }
+    }
+
+    // Number the reachable nodes in preorder. This only walks the nodes
+    // that lead to a candidate
+    index_stack_t* stack = &index_stack;
+    int order = 0;
+    index_stack_push(stack, index_root);
+    while (stack->num_nodes > bottom)
+    {
+        stack->num_nodes--;
+        AST n = stack->nodes[stack->num_nodes];
+
+        order++;
+        *index_table_find(&reachable, n) = order;
+
+        for (i = MCXX_MAX_AST_CHILDREN - 1; i >= 0; i--)
+        {
+            AST child = ast_get_child(n, i);
+            if (child == NULL)
+                continue;
+            int* status = index_table_find(&reachable, child);
+            if (status != NULL
+                    && *status == INDEX_REACHABLE)
+                index_stack_push(stack, child);
+        }
+    }
+
+    index_found_t* found = NEW_VEC(index_found_t, num_candidates + 1);
+    int num_found = 0;
+    for (i = 0; i < num_candidates; i++)
+    {
+        AST n = bucket->nodes[i];
+        int status = *index_table_find(&reachable, n);
+        if (status > 0)
+        {
+            found[num_found].node = n;
+            found[num_found].order = status;
+            num_found++;
+        }
+    }
+    index_table_destroy(&reachable);
+
+    qsort(found, num_found, sizeof(*found), index_found_compare);
+
+    nodecl_t* result = NEW_VEC(nodecl_t, num_found + 1);
+    int num_result = 0;
+    for (i = 0; i < num_found; i++)
+    {
+        // A node may appear more than once in the bucket
+        if (i > 0
+                && found[i].order == found[i - 1].order)
+            continue;
+        result[num_result] = _nodecl_wrap(found[i].node);
+        num_result++;
+    }
+    DELETE(found);
+
+    *num_nodes = num_result;
+    return result;
+}
+
+nodecl_t* nodecl_index_find_all(nodecl_t tree, node_t kind, int* num_nodes)
+{
+    AST root;
+    if (nodecl_is_null(tree))
+        root = nodecl_get_ast(CURRENT_COMPILED_FILE->nodecl);
+    else
+        root = nodecl_get_ast(tree);
+
+    if (nodecl_index_active
+            && root == index_root
+            && kind != AST_NODE_LIST)
+    {
+        return index_find_all(kind, num_nodes);
+    }
+
+    return walk_find_all(root, kind, num_nodes);
+}
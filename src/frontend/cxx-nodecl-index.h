@@ -0,0 +1,74 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2015 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+#ifndef CXX_NODECL_INDEX_H
+#define CXX_NODECL_INDEX_H
+
+#include "libmcxx-common.h"
+#include "cxx-macros.h"
+#include "cxx-ast-decls.h"
+#include "cxx-nodecl-decls.h"
+#include "cxx-asttype.h"
+
+MCXX_BEGIN_DECLS
+
+// Index from node kind to the nodes of the translation unit, enabled with
+// --nodecl-index while the compiler phases run
+//
+// The tree manipulation routines keep it up to date, so it may contain nodes
+// that are not part of the tree anymore. Queries only return the ones that
+// are still reachable from the root of the tree following the parent links,
+// so these must be consistent (as ast_check requires) when querying
+LIBMCXX_EXTERN char nodecl_index_active;
+
+// Indexes every node of the tree and starts tracking changes
+LIBMCXX_EXTERN void nodecl_index_begin(nodecl_t root);
+// Stops tracking changes and frees the index
+LIBMCXX_EXTERN void nodecl_index_end(void);
+
+// These are only meant to be used by the tree manipulation routines and must
+// only be called when nodecl_index_active
+//
+// Called for new nodes, indexes 'a' and the nodes below it
+LIBMCXX_EXTERN void nodecl_index_add_tree(AST a);
+// Called when 'child' is going to be a child of 'parent'
+LIBMCXX_EXTERN void nodecl_index_attach(AST parent, AST child);
+// Called when the kind or the children of 'a' have been changed in place
+LIBMCXX_EXTERN void nodecl_index_update(AST a);
+// Called when 'a' is going to be freed
+LIBMCXX_EXTERN void nodecl_index_remove(AST a);
+
+// Returns a new array with the nodes of kind 'kind' found in 'tree', in the
+// same order as a preorder walk. If 'tree' is null the tree of the current
+// translation unit is used. Only the whole translation unit is answered by
+// the index, other trees are walked. Like the nodecl visitors this does not
+// look into the initializers of the symbols of NODECL_OBJECT_INIT
+LIBMCXX_EXTERN nodecl_t* nodecl_index_find_all(nodecl_t tree, node_t kind, int* num_nodes);
+
+MCXX_END_DECLS
+
+#endif // CXX_NODECL_INDEX_H
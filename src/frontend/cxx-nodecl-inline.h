@@ -309,11 +309,7 @@ static inline nodecl_t* nodecl_unpack_list(nodecl_t n, int *num_items)
     AST list = nodecl_get_ast(n);
     ERROR_CONDITION(ASTKind(list) != AST_NODE_LIST, "Cannot unpack non-list node", 0);
     AST it;
-    int num_elements = 0;
-    for_each_element(list, it)
-    {
-        num_elements++;
-    }
+    int num_elements = ast_list_length(list);
 
     nodecl_t* output = NEW_VEC(nodecl_t, num_elements);
 
@@ -334,16 +330,8 @@ static inline int nodecl_list_length(nodecl_t list)
         return 0;
 
     ERROR_CONDITION(!nodecl_is_list(list), "Invalid list", 0);
-    AST a = nodecl_get_ast(list);
-
-    int n = 0;
-    AST it = NULL;
-    for_each_element(a, it)
-    {
-        n++;
-    }
 
-    return n;
+    return ast_list_length(nodecl_get_ast(list));
 }
 
 static inline nodecl_t nodecl_list_head(nodecl_t list)
@@ -351,13 +339,35 @@ static inline nodecl_t nodecl_list_head(nodecl_t list)
     ERROR_CONDITION(nodecl_is_null(list), "Invalid list", 0);
     AST a = nodecl_get_ast(list);
     ERROR_CONDITION(ASTKind(a) != AST_NODE_LIST, "Cannot get head of non list", 0);
-    AST it;
-    for_each_element(a, it)
-    {
-        AST head = ASTSon1(it);
-        return _nodecl_wrap(head);
-    }
-    return nodecl_null();
+
+    return _nodecl_wrap(ASTSon1(ast_list_head(a)));
+}
+
+static inline nodecl_t nodecl_list_nth_node(nodecl_t list, int n)
+{
+    if (nodecl_is_null(list))
+        return nodecl_null();
+
+    ERROR_CONDITION(!nodecl_is_list(list), "Invalid list", 0);
+
+    return _nodecl_wrap(ast_list_nth(nodecl_get_ast(list), n));
+}
+
+static inline nodecl_t nodecl_list_nth(nodecl_t list, int n)
+{
+    nodecl_t node = nodecl_list_nth_node(list, n);
+    if (nodecl_is_null(node))
+        return nodecl_null();
+
+    return nodecl_get_child(node, 1);
+}
+
+static inline void nodecl_list_append_in_place(nodecl_t list, nodecl_t element)
+{
+    ERROR_CONDITION(!nodecl_is_list(list), "Invalid list", 0);
+    ERROR_CONDITION(nodecl_is_null(element), "Invalid element", 0);
+
+    ast_list_append_in_place(nodecl_get_ast(list), nodecl_get_ast(element));
 }
 
 static inline node_t nodecl_get_kind(nodecl_t n)
@@ -120,6 +120,17 @@ static inline nodecl_t* nodecl_unpack_list(nodecl_t n, int *num_items);
 // Length of a list
 static inline int nodecl_list_length(nodecl_t list);
 
+// Returns the element 'n' of a list (0 is the head) or nodecl_null() if
+// there is no such element
+static inline nodecl_t nodecl_list_nth(nodecl_t list, int n);
+
+// Like nodecl_list_nth but returns the list node holding the element
+static inline nodecl_t nodecl_list_nth_node(nodecl_t list, int n);
+
+// Appends element to a nonnull list without changing the node that
+// represents the list, so it is visible to all the references to it
+static inline void nodecl_list_append_in_place(nodecl_t list, nodecl_t element);
+
 // Wrap (use sparingly)
 static inline nodecl_t _nodecl_wrap(AST);
 
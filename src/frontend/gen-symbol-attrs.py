@@ -40,6 +40,9 @@ if (len(sys.argv) >= 3):
 else:
   op = "entity_specifiers"
 
+# Names of the attributes stored in entity_specifiers_cold_t
+cold_attributes = set([])
+
 def loadlines(f):
     lines = f.readlines()
     result = []
@@ -47,6 +50,22 @@ def loadlines(f):
         l = l.strip(" \n")
         if l[0] == '#':
             continue
+        fields = l.split("|")
+        # The optional STORAGE field is removed here so the rest of the
+        # script always sees four fields
+        if len(fields) == 5:
+            storage = fields[4].strip()
+            if storage == "cold":
+                name = fields[2]
+                if name[0] == "*":
+                    name = name[1:]
+                cold_attributes.add(name)
+                # Arrays may name their counter explicitly
+                for n in name.split(","):
+                    cold_attributes.add(n)
+            elif storage != "hot":
+                raise Exception, "Invalid storage '%s'" % (storage)
+            l = string.join(fields[0:4], "|")
         result.append(l)
     return result
 
@@ -134,6 +153,7 @@ def print_entity_specifiers(lines):
     indent = " " * 4
     current_language = "all"
     decls = []
+    cold_decls = []
     for l in lines:
       fields = l.split("|");
       (_type,language,name,description) = fields
@@ -144,7 +164,10 @@ def print_entity_specifiers(lines):
       if (language != current_language) :
           current_language = language
       descr = description.strip(" \n")
-      decls += print_type_and_name(_type, name)
+      if name in cold_attributes:
+          cold_decls += print_type_and_name(_type, name)
+      else:
+          decls += print_type_and_name(_type, name)
 
     print """
 #ifndef CXX_ENTITY_SPECIFIERS_H
@@ -154,7 +177,18 @@ def print_entity_specifiers(lines):
 
 // Include this file only from cxx-scope-decls.h and not from anywhere else
 
-typedef struct entity_specifiers_tag\n{"""
+// Rarely set attributes. Allocated the first time one of them is set
+typedef struct entity_specifiers_cold_tag\n{"""
+
+    for tk in [TypeKind.OTHER, TypeKind.POINTER, TypeKind.INTEGER, TypeKind.BIT]:
+       for d in cold_decls:
+         (typename, name, suffix, k) = d
+         if k == tk:
+             print indent + typename + " " + name + suffix + ";"
+
+    print "} entity_specifiers_cold_t;"
+    print ""
+    print "typedef struct entity_specifiers_tag\n{"
 
     for tk in [TypeKind.OTHER, TypeKind.POINTER, TypeKind.INTEGER, TypeKind.BIT]:
        for d in decls:
@@ -162,10 +196,29 @@ typedef struct entity_specifiers_tag\n{"""
          if k == tk:
              print indent + typename + " " + name + suffix + ";"
 
+    print indent + "entity_specifiers_cold_t* _cold;"
     print "} entity_specifiers_t;"
     print ""
     print "#endif"
 
+def get_array_names(name):
+    field_names = name.split(",")
+    if (len(field_names) == 1):
+       return ("num_" + name, name)
+    elif (len(field_names) == 2):
+        return (field_names[0], field_names[1])
+    else:
+        raise Exception("Invalid number of fields in array name. Only 1 or 2 comma-separated are allowed")
+
+# Expressions used to read and to write an attribute of symbol 's'
+def field_access(name, attr_name, s = "s"):
+    if name in cold_attributes:
+        return ("symbol_entity_specs_cold_ro(%s)->%s" % (s, attr_name),
+                "symbol_entity_specs_cold_rw(%s)->%s" % (s, attr_name))
+    else:
+        return ("%s->_entity_specs.%s" % (s, attr_name),
+                "%s->_entity_specs.%s" % (s, attr_name))
+
 def print_getters_setters(lines):
     print """
 #ifndef CXX_ENTITY_SPECIFIERS_OPS_H
@@ -181,6 +234,32 @@ def print_getters_setters(lines):
 
 // Include this file only from cxx-scope-decls.h and not from anywhere else
 
+// Cold attributes of a symbol that has not set any of them are read from here
+static inline const entity_specifiers_cold_t* symbol_entity_specs_cold_ro(scope_entry_t* s)
+{
+    static entity_specifiers_cold_t empty_cold;
+    if (s->_entity_specs._cold == NULL)
+        return &empty_cold;
+    return s->_entity_specs._cold;
+}
+
+static inline entity_specifiers_cold_t* symbol_entity_specs_cold_rw(scope_entry_t* s)
+{
+    if (s->_entity_specs._cold == NULL)
+        s->_entity_specs._cold = NEW0(entity_specifiers_cold_t);
+    return s->_entity_specs._cold;
+}
+
+// Symbols copied as a whole (*dest = *source) must not share the cold
+// attributes, otherwise setting one of them would change both symbols
+static inline void symbol_entity_specs_unshare_cold(scope_entry_t* s)
+{
+    if (s->_entity_specs._cold == NULL)
+        return;
+    entity_specifiers_cold_t* cold = NEW(entity_specifiers_cold_t);
+    *cold = *s->_entity_specs._cold;
+    s->_entity_specs._cold = cold;
+}
 """
     current_language = "all"
     decls = []
@@ -196,22 +275,24 @@ def print_getters_setters(lines):
          if len(decls) != 1:
              raise Exception("Expecting one declaration")
          (typename, name, suffix, k) = decls[0]
+         (ro, rw) = field_access(name, name)
          print "// Single value attribute: '%s' " % (name)
-         print "static inline %s symbol_entity_specs_get_%s(scope_entry_t* s)\n{\n    return s->_entity_specs.%s;\n}" % (typename, name, name)
-         print "static inline void symbol_entity_specs_set_%s(scope_entry_t* s, %s v)\n{\n    s->_entity_specs.%s = v;\n}" % (name, typename, name)
+         print "static inline %s symbol_entity_specs_get_%s(scope_entry_t* s)\n{\n    return %s;\n}" % (typename, name, ro)
+         if name in cold_attributes and k != TypeKind.OTHER:
+             # Setting a cold attribute to its default value does not need
+             # the cold attributes to be allocated
+             if _type == "nodecl":
+                 is_default = "v.tree == NULL"
+             else:
+                 is_default = "!v"
+             print "static inline void symbol_entity_specs_set_%s(scope_entry_t* s, %s v)\n{\n    if (s->_entity_specs._cold == NULL\n            && %s)\n        return;\n    %s = v;\n}" % (name, typename, is_default, rw)
+         else:
+             print "static inline void symbol_entity_specs_set_%s(scope_entry_t* s, %s v)\n{\n    %s = v;\n}" % (name, typename, rw)
          print ""
       # Compound types
       elif _type.startswith("array"):
           type_name = get_up_to_matching_paren(_type[len("array"):])
-          field_names = name.split(",")
-          if (len(field_names) == 1):
-             num_name = "num_" + name
-             list_name = name
-          elif (len(field_names) == 2):
-              num_name = field_names[0]
-              list_name = field_names[1]
-          else:
-              raise Exception("Invalid number of fields in array name. Only 1 or 2 comma-separated are allowed")
+          (num_name, list_name) = get_array_names(name)
 
           decls = print_type_and_name(type_name, "")
           if len(decls) != 1:
@@ -221,29 +302,38 @@ def print_getters_setters(lines):
           # These types cannot be compared in C
           cannot_be_compared = ["function_parameter_info_t", "gcc_attribute_t"]
 
+          (num_ro, num_rw) = field_access(list_name, num_name)
+          (list_ro, list_rw) = field_access(list_name, list_name)
+
           print "// Multiple value attribute: '%s' " % (list_name)
           if num_name != "num_" + name:
               print "// Note: The number of values of this attribute is stored in attribute '%s'" % (num_name)
           
-          print "static inline int symbol_entity_specs_get_%s(scope_entry_t* s)\n{\n    return s->_entity_specs.%s;\n}" % (num_name, num_name)
-          print "static inline %s symbol_entity_specs_get_%s_num(scope_entry_t* s, int i)\n{\n    ERROR_CONDITION(i >= s->_entity_specs.%s,\n        \"Invalid index %%d >= %%d\",\n        i, s->_entity_specs.%s);\n    return s->_entity_specs.%s[i];\n}" % (type_name, list_name, num_name, num_name, list_name)
-          print "static inline void symbol_entity_specs_set_%s_num(scope_entry_t* s, int i, %s v)\n{\n    ERROR_CONDITION(i >= s->_entity_specs.%s,\n        \"Invalid index %%d >= %%d\",\n         i, s->_entity_specs.%s);\n    s->_entity_specs.%s[i] = v;\n}" % (list_name, type_name, num_name, num_name, list_name)
-          print "static inline void symbol_entity_specs_append_%s(scope_entry_t* s, %s item)\n{\n    P_LIST_ADD(s->_entity_specs.%s, s->_entity_specs.%s, item);\n}" % (list_name, type_name, list_name, num_name)
+          print "static inline int symbol_entity_specs_get_%s(scope_entry_t* s)\n{\n    return %s;\n}" % (num_name, num_ro)
+          print "static inline %s symbol_entity_specs_get_%s_num(scope_entry_t* s, int i)\n{\n    ERROR_CONDITION(i >= %s,\n        \"Invalid index %%d >= %%d\",\n        i, %s);\n    return %s[i];\n}" % (type_name, list_name, num_ro, num_ro, list_ro)
+          print "static inline void symbol_entity_specs_set_%s_num(scope_entry_t* s, int i, %s v)\n{\n    ERROR_CONDITION(i >= %s,\n        \"Invalid index %%d >= %%d\",\n         i, %s);\n    %s[i] = v;\n}" % (list_name, type_name, num_ro, num_ro, list_rw)
+          print "static inline void symbol_entity_specs_append_%s(scope_entry_t* s, %s item)\n{\n    P_LIST_ADD(%s, %s, item);\n}" % (list_name, type_name, list_rw, num_rw)
           if type_name not in cannot_be_compared:
-              print "static inline void symbol_entity_specs_remove_%s(scope_entry_t* s, %s item)\n{\n    P_LIST_REMOVE(s->_entity_specs.%s, s->_entity_specs.%s, item);\n}" % (list_name, type_name, list_name, num_name)
-              print "static inline void symbol_entity_specs_insert_%s(scope_entry_t* s, %s item)\n{\n    P_LIST_ADD_ONCE(s->_entity_specs.%s, s->_entity_specs.%s, item);\n}" % (list_name, type_name, list_name, num_name)
-          print "static inline void symbol_entity_specs_remove_%s_cmp(scope_entry_t* s, %s item,\n        char (*cmp)(%s, %s))\n{\n    P_LIST_REMOVE_FUN(s->_entity_specs.%s, s->_entity_specs.%s, item, cmp);\n}" % (list_name, type_name, type_name, type_name, list_name, num_name)
-          print "static inline void symbol_entity_specs_insert_%s_cmp(scope_entry_t* s, %s item,\n        char (*cmp)(%s, %s))\n{\n    P_LIST_ADD_ONCE_FUN(s->_entity_specs.%s, s->_entity_specs.%s, item, cmp);\n}" % (list_name, type_name, type_name, type_name, list_name, num_name)
+              print "static inline void symbol_entity_specs_remove_%s(scope_entry_t* s, %s item)\n{\n    P_LIST_REMOVE(%s, %s, item);\n}" % (list_name, type_name, list_rw, num_rw)
+              print "static inline void symbol_entity_specs_insert_%s(scope_entry_t* s, %s item)\n{\n    P_LIST_ADD_ONCE(%s, %s, item);\n}" % (list_name, type_name, list_rw, num_rw)
+          print "static inline void symbol_entity_specs_remove_%s_cmp(scope_entry_t* s, %s item,\n        char (*cmp)(%s, %s))\n{\n    P_LIST_REMOVE_FUN(%s, %s, item, cmp);\n}" % (list_name, type_name, type_name, type_name, list_rw, num_rw)
+          print "static inline void symbol_entity_specs_insert_%s_cmp(scope_entry_t* s, %s item,\n        char (*cmp)(%s, %s))\n{\n    P_LIST_ADD_ONCE_FUN(%s, %s, item, cmp);\n}" % (list_name, type_name, type_name, type_name, list_rw, num_rw)
           print "static inline void symbol_entity_specs_add_%s(scope_entry_t* s, %s item)\n{\n    symbol_entity_specs_append_%s(s, item);\n}" % (list_name, type_name, list_name)
-          print "static inline void symbol_entity_specs_reserve_%s(scope_entry_t* s, int num)\n{\n    s->_entity_specs.%s = num;\n    s->_entity_specs.%s = NEW_VEC0(%s, num);\n}" % (list_name, num_name, list_name, type_name)
-          # print "static inline void symbol_entity_specs_clear_%s(scope_entry_t* s)\n{\n    s->_entity_specs.%s = NULL;\n    s->_entity_specs.%s = 0;\n}" % (list_name, list_name, num_name)
-          print "static inline void symbol_entity_specs_free_%s(scope_entry_t* s)\n{\n    s->_entity_specs.%s = 0;\n    DELETE(s->_entity_specs.%s);\n    s->_entity_specs.%s = NULL;\n}" % (list_name, num_name, list_name, list_name)
-          print "static inline void symbol_entity_specs_copy_%s_from(scope_entry_t* dest, scope_entry_t* source)\n{\n    symbol_entity_specs_reserve_%s(dest, source->_entity_specs.%s);\n    memcpy(dest->_entity_specs.%s,\n        source->_entity_specs.%s,\n        dest->_entity_specs.%s\n        * (sizeof (*(dest->_entity_specs.%s))));\n} " % (list_name, list_name, num_name, list_name, list_name, num_name, list_name)
+          if list_name in cold_attributes:
+              print "static inline void symbol_entity_specs_reserve_%s(scope_entry_t* s, int num)\n{\n    if (s->_entity_specs._cold == NULL\n            && num == 0)\n        return;\n    %s = num;\n    %s = NEW_VEC0(%s, num);\n}" % (list_name, num_rw, list_rw, type_name)
+              print "static inline void symbol_entity_specs_free_%s(scope_entry_t* s)\n{\n    if (s->_entity_specs._cold == NULL)\n        return;\n    %s = 0;\n    DELETE(%s);\n    %s = NULL;\n}" % (list_name, num_rw, list_rw, list_rw)
+          else:
+              print "static inline void symbol_entity_specs_reserve_%s(scope_entry_t* s, int num)\n{\n    %s = num;\n    %s = NEW_VEC0(%s, num);\n}" % (list_name, num_rw, list_rw, type_name)
+              print "static inline void symbol_entity_specs_free_%s(scope_entry_t* s)\n{\n    %s = 0;\n    DELETE(%s);\n    %s = NULL;\n}" % (list_name, num_rw, list_rw, list_rw)
+          (dest_list_ro, dest_list_rw) = field_access(list_name, list_name, "dest")
+          (source_list_ro, source_list_rw) = field_access(list_name, list_name, "source")
+          print "static inline void symbol_entity_specs_copy_%s_from(scope_entry_t* dest, scope_entry_t* source)\n{\n    int num = symbol_entity_specs_get_%s(source);\n    symbol_entity_specs_reserve_%s(dest, num);\n    if (num == 0)\n        return;\n    memcpy(%s,\n        %s,\n        num\n        * (sizeof (*(%s))));\n} " % (list_name, num_name, list_name, dest_list_rw, source_list_ro, source_list_ro)
           print ""
 
     print "static inline void symbol_entity_specs_copy_from(scope_entry_t* dest, scope_entry_t* source)"
     print "{"
     print "    dest->_entity_specs = source->_entity_specs;"
+    print "    symbol_entity_specs_unshare_cold(dest);"
     # Now copy every list
     for l in lines:
       fields = l.split("|");
@@ -251,16 +341,7 @@ def print_getters_setters(lines):
       if name[0] == "*":
           name = name[1:]
       if _type.startswith("array"):
-          type_name = get_up_to_matching_paren(_type[len("array"):])
-          field_names = name.split(",")
-          if (len(field_names) == 1):
-             num_name = "num_" + name
-             list_name = name
-          elif (len(field_names) == 2):
-              num_name = field_names[0]
-              list_name = field_names[1]
-          else:
-              raise Exception("Invalid number of fields in array name. Only 1 or 2 comma-separated are allowed")
+          (num_name, list_name) = get_array_names(name)
           print "    symbol_entity_specs_copy_%s_from(dest, source);" % (list_name)
     print "}"
     print ""
@@ -273,17 +354,10 @@ def print_getters_setters(lines):
       if name[0] == "*":
           name = name[1:]
       if _type.startswith("array"):
-          type_name = get_up_to_matching_paren(_type[len("array"):])
-          field_names = name.split(",")
-          if (len(field_names) == 1):
-             num_name = "num_" + name
-             list_name = name
-          elif (len(field_names) == 2):
-              num_name = field_names[0]
-              list_name = field_names[1]
-          else:
-              raise Exception("Invalid number of fields in array name. Only 1 or 2 comma-separated are allowed")
+          (num_name, list_name) = get_array_names(name)
           print "    symbol_entity_specs_free_%s(symbol);" % (list_name)
+    print "    DELETE(symbol->_entity_specs._cold);"
+    print "    symbol->_entity_specs._cold = NULL;"
     print "}"
 
     print "#endif"
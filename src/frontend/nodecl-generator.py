@@ -525,6 +525,7 @@ def generate_visitor_class_header(rule_map):
     print "#include <tl-objectlist.hpp>"
     print "#include <tl-nodecl.hpp>"
     print "#include \"cxx-utils.h\""
+    print "#include \"cxx-compile-stats.h\""
     print "#include \"mem.h\""
     print ""
     print "namespace Nodecl {"
@@ -653,6 +654,7 @@ def generate_visitor_class_header(rule_map):
     print """
     if (n.is_null())
         return Ret();
+    compile_stats_nodes_visited++;
     switch ((int)n.get_kind())
     {
         case AST_NODE_LIST: { TL::ObjectList<Ret> result; AST tree = nodecl_get_ast(n._n); AST it; for_each_element(tree, it) { AST elem = ASTSon1(it);
@@ -694,6 +696,7 @@ def generate_visitor_class_impl(rule_map):
     print """
     if (n.is_null())
         return;
+    compile_stats_nodes_visited++;
     switch ((int)n.get_kind())
     {
         case AST_NODE_LIST: { AST tree = nodecl_get_ast(n._n); AST it; for_each_element(tree, it) { AST elem = ASTSon1(it);
@@ -997,6 +1000,7 @@ def generate_routines_impl(rule_map):
    print "#include <stdlib.h>"
    print "#include \"cxx-nodecl-output.h\""
    print "#include \"cxx-exprtype.h\""
+   print "#include \"cxx-compile-stats.h\""
    print "#include \"cxx-utils.h\""
    print "#include \"mem.h\""
    print ""
@@ -1102,6 +1106,7 @@ def generate_routines_impl(rule_map):
        else:
           print "  result.tree = ASTMake%d(%s, %s, location, %s);" % (num_children, rhs_rule.name_to_underscore(), \
                  string.join(map(lambda x : x + ".tree", param_name_list), ", "), text_value);
+       print "  compile_stats_nodecl_counter++;"
 
        if rhs_rule.needs_symbol:
            print "  if (symbol == NULL) internal_error(\"Node requires a symbol. Location: %s\", locus_to_str(location));"
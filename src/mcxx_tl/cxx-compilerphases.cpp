@@ -43,9 +43,11 @@
 #include "cxx-driver.h"
 #include "cxx-utils.h"
 #include "cxx-diagnostic.h"
+#include "cxx-compile-stats.h"
 #include "cxx-nodecl-checker.h"
 #include "cxx-compilerphases.hpp"
 #include "tl-compilerphase.hpp"
+#include "tl-compilerpipeline.hpp"
 #include "tl-setdto-phase.hpp"
 #include "tl-objectlist.hpp"
 #include "tl-builtin.hpp"
@@ -103,7 +105,9 @@ namespace TL
                         fprintf(stderr, "COMPILERPHASES: Execution of pre_run of phase '%s'\n", phase->get_phase_name().c_str());
                     }
 
+                    compile_stats_begin_phase((phase->get_phase_name() + " (pre_run)").c_str());
                     phase->pre_run(dto);
+                    compile_stats_end_phase();
 
                     if (phase->get_phase_status() != CompilerPhase::PHASE_STATUS_OK)
                     {
@@ -154,7 +158,7 @@ namespace TL
 
                 for (compiler_phases_list_t::iterator it = compiler_phases_list.begin();
                         it != compiler_phases_list.end();
-                        it++)
+                        )
                 {
                     DEBUG_CODE()
                     {
@@ -169,20 +173,78 @@ namespace TL
                         fprintf(stderr, "COMPILERPHASES: DTO: No more keys\n");
                     }
 
-                    TL::CompilerPhase* phase = (*it);
+                    // Consecutive fusable phases share a single traversal
+                    // unless one depends on a previous one of the group
+                    compiler_phases_list_t group;
+                    PassManager pass_manager;
 
-                    DEBUG_CODE()
+                    FusablePhase* fusable_phase = dynamic_cast<FusablePhase*>(*it);
+                    group.push_back(*it);
+                    it++;
+                    if (CURRENT_CONFIGURATION->fuse_phases
+                            && fusable_phase != NULL)
                     {
-                        fprintf(stderr, "COMPILERPHASES: Running phase '%s'\n", phase->get_phase_name().c_str());
+                        pass_manager.add_phase(fusable_phase);
+                        while (it != compiler_phases_list.end()
+                                && (fusable_phase = dynamic_cast<FusablePhase*>(*it)) != NULL
+                                && pass_manager.can_fuse(fusable_phase))
+                        {
+                            pass_manager.add_phase(fusable_phase);
+                            group.push_back(*it);
+                            it++;
+                        }
                     }
 
-                    phase->run(dto);
+                    std::string group_name = group[0]->get_phase_name();
+                    if (group.size() == 1)
+                    {
+                        TL::CompilerPhase* phase = group[0];
 
-                    if (phase->get_phase_status() != CompilerPhase::PHASE_STATUS_OK)
+                        DEBUG_CODE()
+                        {
+                            fprintf(stderr, "COMPILERPHASES: Running phase '%s'\n", phase->get_phase_name().c_str());
+                        }
+
+                        compile_stats_begin_phase(phase->get_phase_name().c_str());
+                        phase->run(dto);
+                        compile_stats_end_phase();
+                    }
+                    else
                     {
-                        // Ideas to improve this are welcome :)
-                        fatal_error("Compiler phase '%s' notified that it did not end successfully. Ending compilation",
-                                phase->get_phase_name().c_str());
+                        group_name = pass_manager.get_name();
+
+                        DEBUG_CODE()
+                        {
+                            fprintf(stderr, "COMPILERPHASES: Running phases '%s'\n", group_name.c_str());
+                        }
+
+                        compile_stats_begin_phase(group_name.c_str());
+                        pass_manager.run(dto);
+                        compile_stats_end_phase();
+
+                        if (CURRENT_CONFIGURATION->verbose)
+                        {
+                            for (unsigned int i = 0; i < group.size(); i++)
+                            {
+                                fprintf(stderr, "Phase '%s' handled %llu nodes in '%s'\n",
+                                        group[i]->get_phase_name().c_str(),
+                                        pass_manager.get_nodes_handled(i),
+                                        group_name.c_str());
+                            }
+                        }
+                    }
+
+                    for (compiler_phases_list_t::iterator it_group = group.begin();
+                            it_group != group.end();
+                            it_group++)
+                    {
+                        TL::CompilerPhase* phase = (*it_group);
+                        if (phase->get_phase_status() != CompilerPhase::PHASE_STATUS_OK)
+                        {
+                            // Ideas to improve this are welcome :)
+                            fatal_error("Compiler phase '%s' notified that it did not end successfully. Ending compilation",
+                                    phase->get_phase_name().c_str());
+                        }
                     }
 
                     char there_were_errors = (diagnostics_get_error_count() != 0);
@@ -194,19 +256,19 @@ namespace TL
                     if (there_were_errors)
                     {
                         fatal_error("Compiler phase '%s' yielded diagnostic errors. Ending compilation",
-                                phase->get_phase_name().c_str());
+                                group_name.c_str());
                     }
 
                     DEBUG_CODE()
                     {
-                        fprintf(stderr, "COMPILERPHASES: Phase '%s' has been run\n", phase->get_phase_name().c_str());
+                        fprintf(stderr, "COMPILERPHASES: Phase '%s' has been run\n", group_name.c_str());
                     }
 
                     // For consistency, check the tree
                     DEBUG_CODE()
                     {
                         fprintf(stderr, "COMPILERPHASES: Checking tree after execution of phase '%s'\n",
-                                phase->get_phase_name().c_str());
+                                group_name.c_str());
 
                     }
 
@@ -214,30 +276,36 @@ namespace TL
                     if (!ast_check(nodecl_get_ast(translation_unit->nodecl)))
                     {
                         internal_error("Phase '%s' rendered the AST invalid. Ending compilation\n",
-                                phase->get_phase_name().c_str());
+                                group_name.c_str());
                     }
                     else
                     {
                         DEBUG_CODE()
                         {
                             fprintf(stderr, "COMPILERPHASES: Tree seems fine after execution of phase '%s'\n",
-                                    phase->get_phase_name().c_str());
+                                    group_name.c_str());
 
                         }
                     }
                     nodecl_check_tree(nodecl_get_ast(translation_unit->nodecl));
 
-                    DEBUG_CODE()
-                    {
-                        fprintf(stderr, "COMPILERPHASES: Running phase cleanup of phase '%s'\n",
-                                phase->get_phase_name().c_str());
-                    }
-                    // Invoke file cleanup for phase
-                    phase->phase_cleanup(dto);
-                    DEBUG_CODE()
+                    for (compiler_phases_list_t::iterator it_group = group.begin();
+                            it_group != group.end();
+                            it_group++)
                     {
-                        fprintf(stderr, "COMPILERPHASES: Phase cleanup of phase '%s' finished\n",
-                                phase->get_phase_name().c_str());
+                        TL::CompilerPhase* phase = (*it_group);
+                        DEBUG_CODE()
+                        {
+                            fprintf(stderr, "COMPILERPHASES: Running phase cleanup of phase '%s'\n",
+                                    phase->get_phase_name().c_str());
+                        }
+                        // Invoke file cleanup for phase
+                        phase->phase_cleanup(dto);
+                        DEBUG_CODE()
+                        {
+                            fprintf(stderr, "COMPILERPHASES: Phase cleanup of phase '%s' finished\n",
+                                    phase->get_phase_name().c_str());
+                        }
                     }
                 }
 
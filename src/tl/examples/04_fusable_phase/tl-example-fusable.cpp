@@ -0,0 +1,68 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2015 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+#include "tl-example-fusable.hpp"
+#include "tl-nodecl.hpp"
+
+namespace TL {
+
+    FusableExamplePhase::FusableExamplePhase()
+        : _num_loops(0), _num_calls(0)
+    {
+        set_phase_name("Example of a fusable phase");
+
+        // Only these nodes will be passed to handle_node
+        handle_kind<Nodecl::ForStatement>();
+        handle_kind<Nodecl::WhileStatement>();
+        handle_kind<Nodecl::FunctionCall>();
+    }
+
+    FusableExamplePhase::~FusableExamplePhase()
+    {
+    }
+
+    void FusableExamplePhase::begin_tree(TL::DTO& dto)
+    {
+        _num_loops = 0;
+        _num_calls = 0;
+    }
+
+    void FusableExamplePhase::handle_node(const Nodecl::NodeclBase& node)
+    {
+        if (node.is<Nodecl::FunctionCall>())
+            _num_calls++;
+        else
+            _num_loops++;
+    }
+
+    void FusableExamplePhase::end_tree(TL::DTO& dto)
+    {
+        std::cerr << "There are " << _num_loops << " loops and "
+            << _num_calls << " function calls" << std::endl;
+    }
+}
+
+EXPORT_PHASE(TL::FusableExamplePhase);
@@ -0,0 +1,583 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+
+  This file is part of Mercurium C/C++ source-to-source compiler.
+
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+#include "hlt-loop-dependences.hpp"
+#include "tl-nodecl-utils.hpp"
+#include "tl-alias-analysis.hpp"
+
+#include "cxx-cexpr.h"
+
+namespace TL { namespace HLT {
+
+    LoopDependences::LoopDependences()
+        : _statements(), _written_symbols(), _ignored_symbols(),
+        _writes_unknown_memory(false)
+    {
+    }
+
+    namespace {
+
+        struct InnerLoopsVisitor : public Nodecl::ExhaustiveVisitor<void>
+        {
+            std::set<TL::Symbol>& _induction_vars;
+
+            InnerLoopsVisitor(std::set<TL::Symbol>& induction_vars)
+                : _induction_vars(induction_vars)
+            {
+            }
+
+            virtual void visit(const Nodecl::ForStatement& node)
+            {
+                TL::ForStatement for_stmt(node);
+                if (for_stmt.is_omp_valid_loop())
+                    _induction_vars.insert(for_stmt.get_induction_variable());
+
+                walk(node.get_loop_header());
+                walk(node.get_statement());
+            }
+        };
+
+        bool is_side_effect_free(Nodecl::NodeclBase called)
+        {
+            called = called.no_conv();
+            if (!called.is<Nodecl::Symbol>())
+                return false;
+
+            TL::ObjectList<TL::GCCAttribute> gcc_attrs = called.get_symbol().get_gcc_attributes();
+            for (TL::ObjectList<TL::GCCAttribute>::iterator it = gcc_attrs.begin();
+                    it != gcc_attrs.end();
+                    it++)
+            {
+                std::string name = it->get_attribute_name();
+                if (name == "const" || name == "__const__"
+                        || name == "pure" || name == "__pure__")
+                    return true;
+            }
+            return false;
+        }
+
+        bool is_integer_constant(Nodecl::NodeclBase n)
+        {
+            return n.is_constant() && const_value_is_integer(n.get_constant());
+        }
+
+        int sign(int n)
+        {
+            return (n > 0) - (n < 0);
+        }
+
+        bool uses_written_memory(Nodecl::NodeclBase n,
+                const std::set<TL::Symbol>& written_symbols,
+                bool writes_unknown_memory)
+        {
+            if (n.is_null())
+                return false;
+
+            if (n.is<Nodecl::Symbol>())
+                return written_symbols.find(n.get_symbol()) != written_symbols.end();
+
+            if (n.is<Nodecl::FunctionCall>()
+                    || n.is<Nodecl::VirtualFunctionCall>())
+                return true;
+
+            if (writes_unknown_memory
+                    && (n.is<Nodecl::ArraySubscript>()
+                        || n.is<Nodecl::Dereference>()
+                        || n.is<Nodecl::ClassMemberAccess>()))
+                return true;
+
+            Nodecl::NodeclBase::Children children = n.children();
+            for (Nodecl::NodeclBase::Children::iterator it = children.begin();
+                    it != children.end();
+                    it++)
+            {
+                if (uses_written_memory(*it, written_symbols, writes_unknown_memory))
+                    return true;
+            }
+            return false;
+        }
+    }
+
+    void LoopDependences::add_ignored_symbol(TL::Symbol sym)
+    {
+        _ignored_symbols.insert(sym);
+    }
+
+    int LoopDependences::add_statement(Nodecl::NodeclBase stmt,
+            const TL::ObjectList<Nodecl::NodeclBase>& loops)
+    {
+        ERROR_CONDITION(loops.empty(), "A statement must be enclosed by a loop", 0);
+        ERROR_CONDITION(!_statements.empty()
+                && _statements[0].induction_vars.size() != loops.size(),
+                "All the statements must be enclosed by the same number of loops", 0);
+
+        Statement s;
+        for (TL::ObjectList<Nodecl::NodeclBase>::const_iterator it = loops.begin();
+                it != loops.end();
+                it++)
+        {
+            TL::ForStatement for_stmt(it->as<Nodecl::ForStatement>());
+            ERROR_CONDITION(!for_stmt.is_omp_valid_loop()
+                    || !is_integer_constant(for_stmt.get_step()),
+                    "Only loops with a constant step can be analyzed", 0);
+
+            s.induction_vars.append(for_stmt.get_induction_variable());
+            s.steps.append(const_value_cast_to_signed_int(for_stmt.get_step().get_constant()));
+
+            _ignored_symbols.insert(for_stmt.get_induction_variable());
+        }
+        s.scope = loops.back().retrieve_context();
+
+        // Induction variables of inner loops are private to them
+        InnerLoopsVisitor inner_loops(_ignored_symbols);
+        inner_loops.walk(stmt);
+
+        collect_accesses(stmt, /* is_write */ false, s);
+
+        _statements.append(s);
+        return _statements.size() - 1;
+    }
+
+    void LoopDependences::collect_accesses(Nodecl::NodeclBase n, bool is_write, Statement& stmt)
+    {
+        if (n.is_null())
+            return;
+
+        if (n.is<Nodecl::Conversion>()
+                || n.is<Nodecl::ParenthesizedExpression>())
+        {
+            collect_accesses(n.children()[0], is_write, stmt);
+        }
+        else if (n.is<Nodecl::Symbol>()
+                || n.is<Nodecl::ArraySubscript>()
+                || n.is<Nodecl::Dereference>()
+                || n.is<Nodecl::ClassMemberAccess>())
+        {
+            add_access(n, is_write, stmt);
+        }
+        else if (Nodecl::Utils::nodecl_is_assignment_op(n))
+        {
+            Nodecl::NodeclBase lhs = n.children()[0];
+            collect_accesses(lhs, /* is_write */ true, stmt);
+            // Compound assignments also read the left hand side
+            if (!n.is<Nodecl::Assignment>())
+                collect_accesses(lhs, /* is_write */ false, stmt);
+            collect_accesses(n.children()[1], /* is_write */ false, stmt);
+        }
+        else if (n.is<Nodecl::Preincrement>()
+                || n.is<Nodecl::Postincrement>()
+                || n.is<Nodecl::Predecrement>()
+                || n.is<Nodecl::Postdecrement>())
+        {
+            collect_accesses(n.children()[0], /* is_write */ true, stmt);
+            collect_accesses(n.children()[0], /* is_write */ false, stmt);
+        }
+        else if (n.is<Nodecl::Reference>())
+        {
+            // The address may be used later to modify the object
+            collect_accesses(n.children()[0], /* is_write */ true, stmt);
+        }
+        else if (n.is<Nodecl::FunctionCall>()
+                || n.is<Nodecl::VirtualFunctionCall>())
+        {
+            if (!is_side_effect_free(n.children()[0]))
+                add_unknown_access(n, stmt);
+            collect_accesses(n.children()[1], /* is_write */ false, stmt);
+        }
+        else if (n.is<Nodecl::ObjectInit>())
+        {
+            collect_accesses(n.get_symbol().get_value(), /* is_write */ false, stmt);
+        }
+        else
+        {
+            Nodecl::NodeclBase::Children children = n.children();
+            for (Nodecl::NodeclBase::Children::iterator it = children.begin();
+                    it != children.end();
+                    it++)
+            {
+                collect_accesses(*it, /* is_write */ false, stmt);
+            }
+        }
+    }
+
+    void LoopDependences::add_access(Nodecl::NodeclBase n, bool is_write, Statement& stmt)
+    {
+        Access access;
+        access.expr = n;
+        access.is_write = is_write;
+        access.is_unknown = false;
+
+        Nodecl::NodeclBase base = n;
+        while (base.is<Nodecl::ArraySubscript>())
+        {
+            // Outer subscripts come first
+            TL::ObjectList<Nodecl::NodeclBase> subscripts =
+                base.as<Nodecl::ArraySubscript>().get_subscripts().as<Nodecl::List>().to_object_list();
+            access.subscripts = subscripts.append(access.subscripts);
+
+            for (TL::ObjectList<Nodecl::NodeclBase>::iterator it = subscripts.begin();
+                    it != subscripts.end();
+                    it++)
+            {
+                collect_accesses(*it, /* is_write */ false, stmt);
+            }
+
+            base = base.as<Nodecl::ArraySubscript>().get_subscripted().no_conv();
+        }
+        access.base = base;
+
+        if (base.is<Nodecl::Symbol>())
+        {
+            TL::Symbol sym = base.get_symbol();
+            if (!sym.is_variable()
+                    || _ignored_symbols.find(sym) != _ignored_symbols.end()
+                    || sym.get_scope().scope_is_enclosed_by(stmt.scope))
+                return;
+
+            if (is_write)
+                _written_symbols.insert(sym);
+
+            if (n.is<Nodecl::ArraySubscript>()
+                    && sym.get_type().no_ref().is_pointer())
+            {
+                Access pointer;
+                pointer.expr = base;
+                pointer.base = base;
+                pointer.is_write = false;
+                pointer.is_unknown = false;
+                stmt.accesses.append(pointer);
+            }
+        }
+        else
+        {
+            if (is_write)
+                _writes_unknown_memory = true;
+
+            if (base.is<Nodecl::Dereference>())
+            {
+                collect_accesses(base.as<Nodecl::Dereference>().get_rhs(), /* is_write */ false, stmt);
+            }
+            else if (base.is<Nodecl::ClassMemberAccess>())
+            {
+                collect_accesses(base.as<Nodecl::ClassMemberAccess>().get_lhs(), /* is_write */ false, stmt);
+            }
+            else
+            {
+                collect_accesses(base, /* is_write */ false, stmt);
+            }
+        }
+
+        stmt.accesses.append(access);
+    }
+
+    void LoopDependences::add_unknown_access(Nodecl::NodeclBase n, Statement& stmt)
+    {
+        Access access;
+        access.expr = n;
+        access.is_write = true;
+        access.is_unknown = true;
+        stmt.accesses.append(access);
+
+        _writes_unknown_memory = true;
+    }
+
+    LoopDependences::SubscriptForm LoopDependences::classify_subscript(
+            Nodecl::NodeclBase n, const Statement& stmt) const
+    {
+        SubscriptForm form;
+        form.kind = SubscriptForm::UNKNOWN;
+        form.level = -1;
+        form.value = 0;
+
+        n = n.no_conv();
+        while (n.is<Nodecl::ParenthesizedExpression>())
+            n = n.as<Nodecl::ParenthesizedExpression>().get_nest().no_conv();
+
+        if (is_integer_constant(n))
+        {
+            form.kind = SubscriptForm::CONSTANT;
+            form.value = const_value_cast_to_signed_int(n.get_constant());
+            return form;
+        }
+
+        // iv, iv + c, c + iv, iv - c
+        Nodecl::NodeclBase induction_var = n;
+        int offset = 0;
+        if (n.is<Nodecl::Add>())
+        {
+            Nodecl::NodeclBase lhs = n.as<Nodecl::Add>().get_lhs();
+            Nodecl::NodeclBase rhs = n.as<Nodecl::Add>().get_rhs();
+            if (is_integer_constant(rhs))
+            {
+                induction_var = lhs;
+                offset = const_value_cast_to_signed_int(rhs.get_constant());
+            }
+            else if (is_integer_constant(lhs))
+            {
+                induction_var = rhs;
+                offset = const_value_cast_to_signed_int(lhs.get_constant());
+            }
+        }
+        else if (n.is<Nodecl::Minus>())
+        {
+            Nodecl::NodeclBase rhs = n.as<Nodecl::Minus>().get_rhs();
+            if (is_integer_constant(rhs))
+            {
+                induction_var = n.as<Nodecl::Minus>().get_lhs();
+                offset = -const_value_cast_to_signed_int(rhs.get_constant());
+            }
+        }
+
+        induction_var = induction_var.no_conv();
+        if (!induction_var.is<Nodecl::Symbol>())
+            return form;
+
+        for (unsigned int level = 0; level < stmt.induction_vars.size(); level++)
+        {
+            if (stmt.induction_vars[level] == induction_var.get_symbol())
+            {
+                form.kind = SubscriptForm::INDUCTION;
+                form.level = level;
+                form.value = offset;
+                break;
+            }
+        }
+        return form;
+    }
+
+    bool LoopDependences::test_accesses(const Access& source, const Statement& source_stmt,
+            const Access& sink, const Statement& sink_stmt,
+            DirectionVector& directions) const
+    {
+        int num_levels = source_stmt.induction_vars.size();
+        directions = DirectionVector(num_levels, DEPENDENCE_ANY);
+
+        if (source.is_unknown || sink.is_unknown)
+            return true;
+
+        bool same_object;
+        if (source.base.is<Nodecl::Symbol>()
+                && sink.base.is<Nodecl::Symbol>())
+        {
+            same_object = (source.base.get_symbol() == sink.base.get_symbol());
+        }
+        else
+        {
+            same_object = Nodecl::Utils::structurally_equal_nodecls(
+                    source.base, sink.base, /* skip_conversion_nodecls */ true);
+        }
+
+        if (!same_object)
+        {
+            return !TL::Analysis::accesses_may_be_alias(source.expr, sink.expr).is_false();
+        }
+
+        if (source.subscripts.size() != sink.subscripts.size())
+            return true;
+
+        TL::ObjectList<bool> has_distance(num_levels, false);
+        TL::ObjectList<int> distance(num_levels, 0);
+        for (unsigned int dim = 0; dim < source.subscripts.size(); dim++)
+        {
+            SubscriptForm source_form = classify_subscript(source.subscripts[dim], source_stmt);
+            SubscriptForm sink_form = classify_subscript(sink.subscripts[dim], sink_stmt);
+
+            if (source_form.kind == SubscriptForm::INDUCTION
+                    && sink_form.kind == SubscriptForm::INDUCTION
+                    && source_form.level == sink_form.level)
+            {
+                // x + c1 == y + c2  ->  y - x == c1 - c2
+                int level = source_form.level;
+                int current_distance = source_form.value - sink_form.value;
+                if (current_distance % source_stmt.steps[level] != 0)
+                    return false;
+
+                if (has_distance[level]
+                        && distance[level] != current_distance)
+                    return false;
+
+                has_distance[level] = true;
+                distance[level] = current_distance;
+            }
+            else if (source_form.kind == SubscriptForm::CONSTANT
+                    && sink_form.kind == SubscriptForm::CONSTANT)
+            {
+                if (source_form.value != sink_form.value)
+                    return false;
+            }
+            // Other combinations do not constrain the iterations
+        }
+
+        for (int level = 0; level < num_levels; level++)
+        {
+            if (!has_distance[level])
+                continue;
+
+            int iteration_distance = sign(distance[level]) * sign(source_stmt.steps[level]);
+            if (iteration_distance > 0)
+                directions[level] = DEPENDENCE_LT;
+            else if (iteration_distance < 0)
+                directions[level] = DEPENDENCE_GT;
+            else
+                directions[level] = DEPENDENCE_EQ;
+        }
+        return true;
+    }
+
+    bool LoopDependences::is_invariant(Nodecl::NodeclBase n) const
+    {
+        return !uses_written_memory(n, _written_symbols, _writes_unknown_memory);
+    }
+
+    TL::ObjectList<DirectionVector> LoopDependences::get_dependences(int source, int sink) const
+    {
+        const Statement& source_stmt = _statements[source];
+        const Statement& sink_stmt = _statements[sink];
+
+        TL::ObjectList<DirectionVector> result;
+        for (TL::ObjectList<Access>::const_iterator it = source_stmt.accesses.begin();
+                it != source_stmt.accesses.end();
+                it++)
+        {
+            for (TL::ObjectList<Access>::const_iterator it2 = sink_stmt.accesses.begin();
+                    it2 != sink_stmt.accesses.end();
+                    it2++)
+            {
+                if (!it->is_write && !it2->is_write)
+                    continue;
+
+                DirectionVector directions;
+                if (test_accesses(*it, source_stmt, *it2, sink_stmt, directions))
+                    result.append(directions);
+            }
+        }
+        return result;
+    }
+
+    TL::ObjectList<TL::ObjectList<int> > LoopDependences::expand(const DirectionVector& v)
+    {
+        TL::ObjectList<TL::ObjectList<int> > result(1);
+        for (DirectionVector::const_iterator it = v.begin(); it != v.end(); it++)
+        {
+            TL::ObjectList<TL::ObjectList<int> > next;
+            for (TL::ObjectList<TL::ObjectList<int> >::iterator it2 = result.begin();
+                    it2 != result.end();
+                    it2++)
+            {
+                for (int direction = -1; direction <= 1; direction++)
+                {
+                    int mask = (direction < 0) ? DEPENDENCE_GT
+                        : ((direction > 0) ? DEPENDENCE_LT : DEPENDENCE_EQ);
+                    if ((*it & mask) == 0)
+                        continue;
+
+                    TL::ObjectList<int> current = *it2;
+                    current.append(direction);
+                    next.append(current);
+                }
+            }
+            result = next;
+        }
+        return result;
+    }
+
+    int LoopDependences::lexicographic_sign(const TL::ObjectList<int>& v)
+    {
+        for (TL::ObjectList<int>::const_iterator it = v.begin(); it != v.end(); it++)
+        {
+            if (*it != 0)
+                return *it;
+        }
+        return 0;
+    }
+
+    bool LoopDependences::permutation_is_legal(const TL::ObjectList<int>& permutation) const
+    {
+        for (unsigned int source = 0; source < _statements.size(); source++)
+        for (unsigned int sink = 0; sink < _statements.size(); sink++)
+        {
+            TL::ObjectList<DirectionVector> dependences = get_dependences(source, sink);
+            for (TL::ObjectList<DirectionVector>::iterator it = dependences.begin();
+                    it != dependences.end();
+                    it++)
+            {
+                TL::ObjectList<TL::ObjectList<int> > directions = expand(*it);
+                for (TL::ObjectList<TL::ObjectList<int> >::iterator it2 = directions.begin();
+                        it2 != directions.end();
+                        it2++)
+                {
+                    // Other directions are the dependences from sink to source
+                    if (lexicographic_sign(*it2) <= 0)
+                        continue;
+
+                    TL::ObjectList<int> permuted;
+                    for (TL::ObjectList<int>::const_iterator it3 = permutation.begin();
+                            it3 != permutation.end();
+                            it3++)
+                    {
+                        permuted.append((*it2)[*it3]);
+                    }
+
+                    if (lexicographic_sign(permuted) < 0)
+                        return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool LoopDependences::is_fully_permutable() const
+    {
+        for (unsigned int source = 0; source < _statements.size(); source++)
+        for (unsigned int sink = 0; sink < _statements.size(); sink++)
+        {
+            TL::ObjectList<DirectionVector> dependences = get_dependences(source, sink);
+            for (TL::ObjectList<DirectionVector>::iterator it = dependences.begin();
+                    it != dependences.end();
+                    it++)
+            {
+                TL::ObjectList<TL::ObjectList<int> > directions = expand(*it);
+                for (TL::ObjectList<TL::ObjectList<int> >::iterator it2 = directions.begin();
+                        it2 != directions.end();
+                        it2++)
+                {
+                    if (lexicographic_sign(*it2) <= 0)
+                        continue;
+
+                    for (TL::ObjectList<int>::iterator it3 = it2->begin();
+                            it3 != it2->end();
+                            it3++)
+                    {
+                        if (*it3 < 0)
+                            return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+} }
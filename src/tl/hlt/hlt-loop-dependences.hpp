@@ -0,0 +1,143 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+
+  This file is part of Mercurium C/C++ source-to-source compiler.
+
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+#ifndef HLT_LOOP_DEPENDENCES_HPP
+#define HLT_LOOP_DEPENDENCES_HPP
+
+#include "hlt-common.hpp"
+#include "tl-nodecl.hpp"
+#include "tl-objectlist.hpp"
+#include "tl-scope.hpp"
+
+#include <set>
+
+namespace TL { namespace HLT {
+
+    //! \addtogroup HLT High Level Transformations
+    //! @{
+
+    //! Direction of a dependence in one loop, in iteration order. LT means
+    //! that the sink runs in a later iteration than the source
+    enum DependenceDirection
+    {
+        DEPENDENCE_LT = 1 << 0,
+        DEPENDENCE_EQ = 1 << 1,
+        DEPENDENCE_GT = 1 << 2,
+        DEPENDENCE_ANY = DEPENDENCE_LT | DEPENDENCE_EQ | DEPENDENCE_GT
+    };
+
+    //! One mask of DependenceDirection per loop, outermost first
+    typedef TL::ObjectList<int> DirectionVector;
+
+    //! Conservative dependence test of the statements of a loop nest
+    /*!
+      Statements are registered along with the loops enclosing them, so
+      a level of the nest may be given by different loops (as it happens
+      when fusing). Subscripts of the form iv + c and constants are
+      tested, anything else is assumed to depend in any direction.
+      Accesses to different objects are disambiguated using the alias
+      analysis.
+
+      Induction variables of the loops and variables local to the
+      statements are not taken into account. Calls to functions that are
+      not 'const' nor 'pure' are assumed to access any memory.
+      */
+    class LIBHLT_CLASS LoopDependences
+    {
+        private:
+            struct Access
+            {
+                Nodecl::NodeclBase expr;
+                Nodecl::NodeclBase base;
+                TL::ObjectList<Nodecl::NodeclBase> subscripts;
+                bool is_write;
+                bool is_unknown;
+            };
+
+            struct Statement
+            {
+                TL::ObjectList<Access> accesses;
+                TL::ObjectList<TL::Symbol> induction_vars;
+                TL::ObjectList<int> steps;
+                TL::Scope scope;
+            };
+
+            struct SubscriptForm
+            {
+                enum Kind { INDUCTION, CONSTANT, UNKNOWN } kind;
+                int level;
+                int value;
+            };
+
+            TL::ObjectList<Statement> _statements;
+
+            std::set<TL::Symbol> _written_symbols;
+            std::set<TL::Symbol> _ignored_symbols;
+            bool _writes_unknown_memory;
+
+            void collect_accesses(Nodecl::NodeclBase n, bool is_write, Statement& stmt);
+            void add_access(Nodecl::NodeclBase n, bool is_write, Statement& stmt);
+            void add_unknown_access(Nodecl::NodeclBase n, Statement& stmt);
+
+            SubscriptForm classify_subscript(Nodecl::NodeclBase n, const Statement& stmt) const;
+            bool test_accesses(const Access& source, const Statement& source_stmt,
+                    const Access& sink, const Statement& sink_stmt,
+                    DirectionVector& directions) const;
+
+        public:
+            LoopDependences();
+
+            //! Accesses to 'sym' are not taken into account. Must be called
+            //! before registering the statements
+            void add_ignored_symbol(TL::Symbol sym);
+
+            //! Registers 'stmt', enclosed by 'loops' (outermost first), and returns its index
+            int add_statement(Nodecl::NodeclBase stmt, const TL::ObjectList<Nodecl::NodeclBase>& loops);
+
+            //! States whether 'n' does not use any variable written by the registered statements
+            bool is_invariant(Nodecl::NodeclBase n) const;
+
+            //! Direction vectors of the dependences from statement 'source' to statement 'sink'
+            TL::ObjectList<DirectionVector> get_dependences(int source, int sink) const;
+
+            //! States whether new loop k may be former loop permutation[k]
+            bool permutation_is_legal(const TL::ObjectList<int>& permutation) const;
+
+            //! States whether no dependence goes backwards in any loop, so the
+            //! loops can be tiled
+            bool is_fully_permutable() const;
+
+            //! Concrete directions (-1, 0 or 1 per level) represented by 'v'
+            static TL::ObjectList<TL::ObjectList<int> > expand(const DirectionVector& v);
+
+            //! Sign of the first nonzero direction of 'v', 0 if there is none
+            static int lexicographic_sign(const TL::ObjectList<int>& v);
+    };
+
+    //! @}
+} }
+
+#endif // HLT_LOOP_DEPENDENCES_HPP
@@ -0,0 +1,341 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+
+  This file is part of Mercurium C/C++ source-to-source compiler.
+
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+#include "hlt-loop-distribution.hpp"
+#include "hlt-loop-dependences.hpp"
+#include "hlt-utils.hpp"
+#include "tl-nodecl-utils.hpp"
+
+#include "cxx-cexpr.h"
+#include "cxx-diagnostic.h"
+
+namespace TL { namespace HLT {
+
+    LoopDistribution::LoopDistribution()
+        : Transform(), _loop(), _transformation(), _expanded_symbols()
+    {
+    }
+
+    LoopDistribution& LoopDistribution::set_loop(Nodecl::NodeclBase loop)
+    {
+        this->_loop = loop;
+        return *this;
+    }
+
+    LoopDistribution& LoopDistribution::set_expanded_symbols(const TL::ObjectList<TL::Symbol>& symbols)
+    {
+        this->_expanded_symbols = symbols;
+        return *this;
+    }
+
+    namespace {
+
+        bool uses_symbol(const Nodecl::NodeclBase& n, TL::Symbol sym)
+        {
+            if (n.is_null())
+                return false;
+
+            if ((n.is<Nodecl::Symbol>() || n.is<Nodecl::ObjectInit>())
+                    && n.get_symbol() == sym)
+                return true;
+
+            if (n.is<Nodecl::ObjectInit>())
+                return uses_symbol(n.get_symbol().get_value(), sym);
+
+            Nodecl::NodeclBase::Children children = n.children();
+            for (Nodecl::NodeclBase::Children::iterator it = children.begin();
+                    it != children.end();
+                    it++)
+            {
+                if (uses_symbol(*it, sym))
+                    return true;
+            }
+            return false;
+        }
+
+        // sym = expr, where expr does not use sym
+        bool is_plain_assignment_to(const Nodecl::NodeclBase& stmt, TL::Symbol sym)
+        {
+            if (!stmt.is<Nodecl::ExpressionStatement>())
+                return false;
+
+            Nodecl::NodeclBase expr = stmt.as<Nodecl::ExpressionStatement>().get_nest();
+            if (!expr.is<Nodecl::Assignment>())
+                return false;
+
+            Nodecl::NodeclBase lhs = expr.as<Nodecl::Assignment>().get_lhs().no_conv();
+            return lhs.is<Nodecl::Symbol>()
+                && lhs.get_symbol() == sym
+                && !uses_symbol(expr.as<Nodecl::Assignment>().get_rhs(), sym);
+        }
+
+        struct ExpandSymbolVisitor : public Nodecl::ExhaustiveVisitor<void>
+        {
+            TL::Symbol _sym;
+            TL::Symbol _expanded_sym;
+            Nodecl::NodeclBase _index;
+
+            ExpandSymbolVisitor(TL::Symbol sym, TL::Symbol expanded_sym, Nodecl::NodeclBase index)
+                : _sym(sym), _expanded_sym(expanded_sym), _index(index)
+            {
+            }
+
+            virtual void visit(const Nodecl::Symbol& node)
+            {
+                if (node.get_symbol() != _sym)
+                    return;
+
+                node.replace(
+                        Nodecl::ArraySubscript::make(
+                            _expanded_sym.make_nodecl(/* set_ref_type */ true),
+                            Nodecl::List::make(_index.shallow_copy()),
+                            _sym.get_type().no_ref().get_lvalue_reference_to()));
+            }
+        };
+    }
+
+    void LoopDistribution::distribute()
+    {
+        ERROR_CONDITION(this->_loop.is_null(), "No loop set", 0);
+
+        HLT::Utils::check_canonical_loop(this->_loop, "distribute");
+
+        Nodecl::ForStatement loop = this->_loop.as<Nodecl::ForStatement>();
+        TL::ForStatement for_stmt(loop);
+        TL::Symbol induction_var = for_stmt.get_induction_variable();
+        TL::Type induction_var_type = induction_var.get_type().no_ref();
+        Nodecl::NodeclBase lower_bound = for_stmt.get_lower_bound();
+        Nodecl::NodeclBase upper_bound = for_stmt.get_upper_bound();
+        Nodecl::NodeclBase step = for_stmt.get_step();
+        bool is_increasing = const_value_is_positive(step.get_constant());
+
+        TL::ObjectList<Nodecl::NodeclBase> stmts =
+            HLT::Utils::get_enclosed_statements(loop.get_statement());
+        for (TL::ObjectList<Nodecl::NodeclBase>::iterator it = stmts.begin();
+                it != stmts.end();
+                it++)
+        {
+            if (it->is<Nodecl::ObjectInit>()
+                    || it->is<Nodecl::CxxDef>()
+                    || it->is<Nodecl::CxxDecl>())
+            {
+                fatal_printf_at(it->get_locus(),
+                        "cannot distribute a loop whose body declares variables\n");
+            }
+        }
+
+        LoopDependences dependences;
+        // Expanded scalars become private to each iteration
+        for (TL::ObjectList<TL::Symbol>::iterator it = _expanded_symbols.begin();
+                it != _expanded_symbols.end();
+                it++)
+        {
+            dependences.add_ignored_symbol(*it);
+        }
+        for (TL::ObjectList<Nodecl::NodeclBase>::iterator it = stmts.begin();
+                it != stmts.end();
+                it++)
+        {
+            dependences.add_statement(*it, TL::ObjectList<Nodecl::NodeclBase>(1, _loop));
+        }
+
+        if (!dependences.is_invariant(lower_bound)
+                || !dependences.is_invariant(upper_bound))
+        {
+            fatal_printf_at(_loop.get_locus(),
+                    "cannot distribute a loop whose bounds are modified inside it\n");
+        }
+
+        // A statement cannot depend on a later statement of a previous iteration
+        for (unsigned int sink = 0; sink < stmts.size(); sink++)
+        for (unsigned int source = sink + 1; source < stmts.size(); source++)
+        {
+            TL::ObjectList<DirectionVector> dependence_list =
+                dependences.get_dependences(source, sink);
+            for (TL::ObjectList<DirectionVector>::iterator it = dependence_list.begin();
+                    it != dependence_list.end();
+                    it++)
+            {
+                if ((*it)[0] & DEPENDENCE_LT)
+                {
+                    fatal_printf_at(stmts[sink].get_locus(),
+                            "cannot distribute this loop: this statement depends on a later statement of a previous iteration\n");
+                }
+            }
+        }
+
+        TL::Scope distribution_scope = new_block_context(
+                loop.retrieve_context().get_decl_context());
+
+        TL::ObjectList<Nodecl::NodeclBase> transformation_stmts;
+        if (for_stmt.induction_variable_in_separate_scope())
+        {
+            induction_var.set_value(Nodecl::NodeclBase::null());
+            if (IS_CXX_LANGUAGE)
+            {
+                transformation_stmts.append(
+                        Nodecl::CxxDef::make(
+                            /* context-of-decl */ Nodecl::NodeclBase::null(),
+                            induction_var));
+            }
+        }
+
+        // (i - L) / S
+        Nodecl::NodeclBase expansion_index = induction_var.make_nodecl(/* set_ref_type */ true);
+        if (!lower_bound.is_constant()
+                || !const_value_is_zero(lower_bound.get_constant()))
+        {
+            expansion_index = Nodecl::ParenthesizedExpression::make(
+                    Nodecl::Minus::make(
+                        expansion_index,
+                        lower_bound.shallow_copy(),
+                        induction_var_type),
+                    induction_var_type);
+        }
+        if (!const_value_is_one(step.get_constant()))
+        {
+            expansion_index = Nodecl::Div::make(
+                    expansion_index,
+                    step.shallow_copy(),
+                    induction_var_type);
+        }
+
+        TL::ObjectList<TL::Symbol> expanded_vars;
+        TL::ObjectList<Nodecl::NodeclBase> post_transformation_stmts;
+        for (TL::ObjectList<TL::Symbol>::iterator it = _expanded_symbols.begin();
+                it != _expanded_symbols.end();
+                it++)
+        {
+            TL::Symbol sym = *it;
+            if (!sym.is_variable()
+                    || !sym.get_type().no_ref().is_scalar_type())
+            {
+                fatal_printf_at(_loop.get_locus(),
+                        "cannot expand '%s': it is not a scalar variable\n",
+                        sym.get_name().c_str());
+            }
+
+            if (!lower_bound.is_constant()
+                    || !upper_bound.is_constant())
+            {
+                fatal_printf_at(_loop.get_locus(),
+                        "cannot expand '%s': the loop bounds are not constant\n",
+                        sym.get_name().c_str());
+            }
+
+            for (TL::ObjectList<Nodecl::NodeclBase>::iterator it2 = stmts.begin();
+                    it2 != stmts.end();
+                    it2++)
+            {
+                if (!uses_symbol(*it2, sym))
+                    continue;
+
+                if (!is_plain_assignment_to(*it2, sym))
+                {
+                    fatal_printf_at(it2->get_locus(),
+                            "cannot expand '%s': it is used before being assigned in the loop body\n",
+                            sym.get_name().c_str());
+                }
+                break;
+            }
+
+            // (U - L + S) / S
+            int num_iterations = const_value_cast_to_signed_int(
+                    const_value_div(
+                        const_value_add(
+                            const_value_sub(
+                                upper_bound.get_constant(),
+                                lower_bound.get_constant()),
+                            step.get_constant()),
+                        step.get_constant()));
+            if (num_iterations < 1)
+                num_iterations = 1;
+
+            TL::Symbol expanded_var = distribution_scope.new_symbol(sym.get_name() + "_expanded");
+            symbol_entity_specs_set_is_user_declared(expanded_var.get_internal_symbol(), 1);
+            expanded_var.get_internal_symbol()->kind = SK_VARIABLE;
+            expanded_var.set_type(
+                    sym.get_type().no_ref().get_array_to(
+                        const_value_to_nodecl(const_value_get_signed_int(num_iterations)),
+                        distribution_scope));
+
+            transformation_stmts.append(Nodecl::ObjectInit::make(expanded_var));
+            expanded_vars.append(expanded_var);
+
+            // The scalar keeps the value of the last iteration
+            post_transformation_stmts.append(
+                    Nodecl::ExpressionStatement::make(
+                        Nodecl::Assignment::make(
+                            sym.make_nodecl(/* set_ref_type */ true),
+                            Nodecl::ArraySubscript::make(
+                                expanded_var.make_nodecl(/* set_ref_type */ true),
+                                Nodecl::List::make(
+                                    const_value_to_nodecl(
+                                        const_value_get_signed_int(num_iterations - 1))),
+                                sym.get_type().no_ref().get_lvalue_reference_to()),
+                            sym.get_type().no_ref().get_lvalue_reference_to())));
+        }
+
+        for (TL::ObjectList<Nodecl::NodeclBase>::iterator it = stmts.begin();
+                it != stmts.end();
+                it++)
+        {
+            TL::Scope loop_body_scope = new_block_context(distribution_scope.get_decl_context());
+
+            Nodecl::NodeclBase stmt_copy = Nodecl::Utils::deep_copy(*it, loop_body_scope);
+            for (unsigned int i = 0; i < _expanded_symbols.size(); i++)
+            {
+                ExpandSymbolVisitor expand_symbol(_expanded_symbols[i], expanded_vars[i], expansion_index);
+                expand_symbol.walk(stmt_copy);
+            }
+
+            transformation_stmts.append(
+                    Nodecl::ForStatement::make(
+                        HLT::Utils::make_loop_control(
+                            induction_var,
+                            lower_bound.shallow_copy(),
+                            upper_bound.shallow_copy(),
+                            step.shallow_copy(),
+                            is_increasing),
+                        HLT::Utils::make_loop_body(
+                            Nodecl::List::make(stmt_copy),
+                            loop_body_scope),
+                        /* loop-name */ Nodecl::NodeclBase::null()));
+        }
+
+        transformation_stmts.append(post_transformation_stmts);
+
+        _transformation =
+            Nodecl::List::make(
+                    Nodecl::Context::make(
+                        Nodecl::List::make(
+                            Nodecl::CompoundStatement::make(
+                                Nodecl::List::make(transformation_stmts),
+                                /* destructors */ Nodecl::NodeclBase::null())),
+                        distribution_scope));
+    }
+
+} }
@@ -0,0 +1,77 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+
+  This file is part of Mercurium C/C++ source-to-source compiler.
+
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+#ifndef HLT_DISTRIBUTION_HPP
+#define HLT_DISTRIBUTION_HPP
+
+#include "tl-nodecl.hpp"
+#include "hlt-transform.hpp"
+
+namespace TL
+{
+    namespace HLT
+    {
+        //! \addtogroup HLT High Level Transformations
+        //! @{
+
+        //! Distributes a regular loop over the statements of its body
+        /*!
+          Every statement of the body gets its own loop, keeping the
+          original order of the statements.
+
+          Scalars written by a statement and read by a later one can be
+          expanded into an array with one element per iteration. This
+          requires a loop with constant bounds whose body assigns the scalar
+          before using it. After the loops the scalar gets the value of the
+          last iteration.
+
+          Distribution is not legal if a statement depends on a later
+          statement of a previous iteration.
+          */
+        class LIBHLT_CLASS LoopDistribution : public Transform
+        {
+            private:
+                Nodecl::NodeclBase _loop, _transformation;
+                TL::ObjectList<TL::Symbol> _expanded_symbols;
+            public:
+                LoopDistribution();
+
+                // Properties
+                LoopDistribution& set_loop(Nodecl::NodeclBase loop);
+                LoopDistribution& set_expanded_symbols(const TL::ObjectList<TL::Symbol>& symbols);
+
+                // Action
+                void distribute();
+
+                // Results
+                Nodecl::NodeclBase get_whole_transformation() const { return _transformation; }
+        };
+
+        //! @}
+    }
+}
+
+#endif // HLT_DISTRIBUTION_HPP
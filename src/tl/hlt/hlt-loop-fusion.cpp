@@ -0,0 +1,275 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+
+  This file is part of Mercurium C/C++ source-to-source compiler.
+
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+#include "hlt-loop-fusion.hpp"
+#include "hlt-loop-dependences.hpp"
+#include "hlt-utils.hpp"
+#include "tl-nodecl-utils.hpp"
+
+#include "cxx-cexpr.h"
+#include "cxx-diagnostic.h"
+
+namespace TL { namespace HLT {
+
+    LoopFusion::LoopFusion()
+        : Transform(), _statements(), _transformation()
+    {
+    }
+
+    LoopFusion& LoopFusion::set_statements(const TL::ObjectList<Nodecl::NodeclBase>& statements)
+    {
+        this->_statements = statements;
+        return *this;
+    }
+
+    LoopFusion& LoopFusion::set_pragma_context(const TL::Scope& context)
+    {
+        this->_pragma_context = context;
+        return *this;
+    }
+
+    void LoopFusion::fuse()
+    {
+        TL::ObjectList<Nodecl::NodeclBase> loops;
+        int last_loop_position = -1;
+        for (unsigned int i = 0; i < _statements.size(); i++)
+        {
+            if (_statements[i].is<Nodecl::ForStatement>())
+            {
+                loops.append(_statements[i]);
+                last_loop_position = i;
+            }
+        }
+
+        ERROR_CONDITION(loops.size() < 2, "At least two loops are needed", 0);
+
+        for (TL::ObjectList<Nodecl::NodeclBase>::iterator it = loops.begin();
+                it != loops.end();
+                it++)
+        {
+            HLT::Utils::check_canonical_loop(*it, "fuse");
+        }
+
+        Nodecl::ForStatement first_loop = loops[0].as<Nodecl::ForStatement>();
+        TL::ForStatement first_for_stmt(first_loop);
+
+        TL::ObjectList<TL::Symbol> induction_vars;
+        for (TL::ObjectList<Nodecl::NodeclBase>::iterator it = loops.begin();
+                it != loops.end();
+                it++)
+        {
+            induction_vars.insert(
+                    TL::ForStatement(it->as<Nodecl::ForStatement>()).get_induction_variable());
+        }
+
+        LoopDependences dependences;
+
+        // Indexes in 'dependences' of the loops and of the statements moved
+        // before the fused loop, along with the number of loops preceding them
+        TL::ObjectList<int> loop_indexes;
+        TL::ObjectList<Nodecl::NodeclBase> moved_stmts;
+        TL::ObjectList<int> moved_stmt_indexes;
+        TL::ObjectList<int> moved_stmt_previous_loops;
+
+        TL::ObjectList<Nodecl::NodeclBase> pre_transformation_stmts;
+        TL::ObjectList<Nodecl::NodeclBase> trailing_stmts;
+        for (int i = 0; i < (int)_statements.size(); i++)
+        {
+            Nodecl::NodeclBase stmt = _statements[i];
+            if (stmt.is<Nodecl::ForStatement>())
+            {
+                TL::ForStatement for_stmt(stmt.as<Nodecl::ForStatement>());
+                if (!Nodecl::Utils::structurally_equal_nodecls(
+                            for_stmt.get_lower_bound(), first_for_stmt.get_lower_bound(),
+                            /* skip_conversion_nodecls */ true)
+                        || !Nodecl::Utils::structurally_equal_nodecls(
+                            for_stmt.get_upper_bound(), first_for_stmt.get_upper_bound(),
+                            /* skip_conversion_nodecls */ true)
+                        || !const_value_is_zero(
+                            const_value_sub(
+                                for_stmt.get_step().get_constant(),
+                                first_for_stmt.get_step().get_constant())))
+                {
+                    fatal_printf_at(stmt.get_locus(),
+                            "cannot fuse loops with different iteration spaces\n");
+                }
+
+                loop_indexes.append(
+                        dependences.add_statement(
+                            for_stmt.get_statement(),
+                            TL::ObjectList<Nodecl::NodeclBase>(1, stmt)));
+            }
+            else if (loop_indexes.empty())
+            {
+                pre_transformation_stmts.append(stmt.shallow_copy());
+            }
+            else if (i > last_loop_position)
+            {
+                trailing_stmts.append(stmt.shallow_copy());
+            }
+            else
+            {
+                TL::ObjectList<TL::Symbol> used_symbols = Nodecl::Utils::get_all_symbols(stmt);
+                for (TL::ObjectList<TL::Symbol>::iterator it = used_symbols.begin();
+                        it != used_symbols.end();
+                        it++)
+                {
+                    if (induction_vars.contains(*it))
+                    {
+                        fatal_printf_at(stmt.get_locus(),
+                                "cannot fuse loops separated by a statement that uses the induction variable '%s'\n",
+                                it->get_name().c_str());
+                    }
+                }
+
+                // The loop only gives the scope of the statement, which does not
+                // use its induction variable
+                moved_stmt_indexes.append(
+                        dependences.add_statement(
+                            stmt,
+                            TL::ObjectList<Nodecl::NodeclBase>(1, loops[loop_indexes.size() - 1])));
+                moved_stmts.append(stmt);
+                moved_stmt_previous_loops.append(loop_indexes.size());
+                pre_transformation_stmts.append(stmt.shallow_copy());
+            }
+        }
+
+        if (!dependences.is_invariant(first_for_stmt.get_lower_bound())
+                || !dependences.is_invariant(first_for_stmt.get_upper_bound()))
+        {
+            fatal_printf_at(first_loop.get_locus(),
+                    "cannot fuse loops whose bounds are modified inside them\n");
+        }
+
+        // Statements between the loops are run before all of them
+        for (unsigned int stmt = 0; stmt < moved_stmt_indexes.size(); stmt++)
+        for (int loop = 0; loop < moved_stmt_previous_loops[stmt]; loop++)
+        {
+            if (!dependences.get_dependences(loop_indexes[loop], moved_stmt_indexes[stmt]).empty()
+                    || !dependences.get_dependences(moved_stmt_indexes[stmt], loop_indexes[loop]).empty())
+            {
+                fatal_printf_at(moved_stmts[stmt].get_locus(),
+                        "cannot fuse loops separated by a statement that depends on a previous loop\n");
+            }
+        }
+
+        // An iteration of a loop cannot depend on a later iteration of a
+        // previous loop
+        for (unsigned int source = 0; source < loops.size(); source++)
+        for (unsigned int sink = source + 1; sink < loops.size(); sink++)
+        {
+            TL::ObjectList<DirectionVector> dependence_list =
+                dependences.get_dependences(loop_indexes[source], loop_indexes[sink]);
+            for (TL::ObjectList<DirectionVector>::iterator it = dependence_list.begin();
+                    it != dependence_list.end();
+                    it++)
+            {
+                if ((*it)[0] & DEPENDENCE_GT)
+                {
+                    fatal_printf_at(loops[sink].get_locus(),
+                            "cannot fuse this loop: it depends on later iterations of a previous loop\n");
+                }
+            }
+        }
+
+        TL::Symbol induction_var = first_for_stmt.get_induction_variable();
+        Nodecl::NodeclBase step = first_for_stmt.get_step();
+
+        TL::Scope fusion_scope = new_block_context(_pragma_context.get_decl_context());
+        TL::Scope fused_body_scope = new_block_context(fusion_scope.get_decl_context());
+
+        TL::ObjectList<Nodecl::NodeclBase> transformation_stmts = pre_transformation_stmts;
+        TL::ObjectList<Nodecl::NodeclBase> post_transformation_stmts;
+        Nodecl::List fused_body;
+        for (TL::ObjectList<Nodecl::NodeclBase>::iterator it = loops.begin();
+                it != loops.end();
+                it++)
+        {
+            TL::ForStatement for_stmt(it->as<Nodecl::ForStatement>());
+            TL::Symbol current_induction_var = for_stmt.get_induction_variable();
+
+            Nodecl::Utils::SimpleSymbolMap symbol_map;
+            symbol_map.add_map(current_induction_var, induction_var);
+
+            Nodecl::NodeclBase body_copy = Nodecl::Utils::deep_copy(
+                    for_stmt.get_statement(), fused_body_scope, symbol_map);
+            fused_body.append(body_copy.as<Nodecl::List>());
+
+            if (current_induction_var == induction_var)
+            {
+                if (for_stmt.induction_variable_in_separate_scope())
+                {
+                    induction_var.set_value(Nodecl::NodeclBase::null());
+                    if (IS_CXX_LANGUAGE)
+                    {
+                        transformation_stmts.append(
+                                Nodecl::CxxDef::make(
+                                    /* context-of-decl */ Nodecl::NodeclBase::null(),
+                                    induction_var));
+                    }
+                }
+            }
+            else if (!for_stmt.induction_variable_in_separate_scope())
+            {
+                // This induction variable is no longer updated by the loop
+                Nodecl::NodeclBase expr =
+                    HLT::Utils::compute_induction_variable_final_expr(*it);
+
+                post_transformation_stmts.append(
+                        Nodecl::ExpressionStatement::make(
+                            Nodecl::Assignment::make(
+                                current_induction_var.make_nodecl(/* set_ref_type */ true),
+                                expr,
+                                current_induction_var.get_type().no_ref().get_lvalue_reference_to())));
+            }
+        }
+
+        Nodecl::NodeclBase fused_loop =
+            Nodecl::ForStatement::make(
+                    HLT::Utils::make_loop_control(
+                        induction_var,
+                        first_for_stmt.get_lower_bound().shallow_copy(),
+                        first_for_stmt.get_upper_bound().shallow_copy(),
+                        step.shallow_copy(),
+                        const_value_is_positive(step.get_constant())),
+                    HLT::Utils::make_loop_body(fused_body, fused_body_scope),
+                    /* loop-name */ Nodecl::NodeclBase::null());
+
+        transformation_stmts.append(fused_loop);
+        transformation_stmts.append(post_transformation_stmts);
+        transformation_stmts.append(trailing_stmts);
+
+        _transformation =
+            Nodecl::List::make(
+                    Nodecl::Context::make(
+                        Nodecl::List::make(
+                            Nodecl::CompoundStatement::make(
+                                Nodecl::List::make(transformation_stmts),
+                                /* destructors */ Nodecl::NodeclBase::null())),
+                        fusion_scope));
+    }
+
+} }
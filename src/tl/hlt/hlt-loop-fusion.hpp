@@ -0,0 +1,79 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+
+  This file is part of Mercurium C/C++ source-to-source compiler.
+
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+#ifndef HLT_FUSION_HPP
+#define HLT_FUSION_HPP
+
+#include "tl-nodecl.hpp"
+#include "tl-scope.hpp"
+#include "hlt-transform.hpp"
+
+namespace TL
+{
+    namespace HLT
+    {
+        //! \addtogroup HLT High Level Transformations
+        //! @{
+
+        //! Fuses consecutive regular loops into a single one
+        /*!
+          The loops must have the same iteration space. The body of the
+          fused loop is the sequence of the original bodies, where the
+          induction variables of the loops are replaced by the one of the
+          first loop.
+
+          Fusion is not legal if an iteration of a loop depends on a later
+          iteration of a previous loop.
+
+          Statements between the loops are moved before the fused loop, so
+          they must not depend on the loops preceding them. Statements after
+          the last loop are kept after the fused loop.
+          */
+        class LIBHLT_CLASS LoopFusion : public Transform
+        {
+            private:
+                TL::ObjectList<Nodecl::NodeclBase> _statements;
+                Nodecl::NodeclBase _transformation;
+                TL::Scope _pragma_context;
+            public:
+                LoopFusion();
+
+                // Properties
+                LoopFusion& set_statements(const TL::ObjectList<Nodecl::NodeclBase>& statements);
+                LoopFusion& set_pragma_context(const TL::Scope& context);
+
+                // Action
+                void fuse();
+
+                // Results
+                Nodecl::NodeclBase get_whole_transformation() const { return _transformation; }
+        };
+
+        //! @}
+    }
+}
+
+#endif // HLT_FUSION_HPP
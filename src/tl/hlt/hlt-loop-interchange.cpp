@@ -0,0 +1,192 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+
+  This file is part of Mercurium C/C++ source-to-source compiler.
+
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+#include "hlt-loop-interchange.hpp"
+#include "hlt-loop-dependences.hpp"
+#include "hlt-utils.hpp"
+#include "tl-nodecl-utils.hpp"
+
+#include "cxx-cexpr.h"
+#include "cxx-diagnostic.h"
+
+namespace TL { namespace HLT {
+
+    LoopInterchange::LoopInterchange()
+        : Transform(), _loop(), _transformation(), _permutation()
+    {
+    }
+
+    LoopInterchange& LoopInterchange::set_loop(Nodecl::NodeclBase loop)
+    {
+        this->_loop = loop;
+        return *this;
+    }
+
+    LoopInterchange& LoopInterchange::set_permutation(const TL::ObjectList<int>& permutation)
+    {
+        this->_permutation = permutation;
+
+        int depth = _permutation.size();
+        TL::ObjectList<bool> used(depth, false);
+        for (int i = 0; i < depth; i++)
+        {
+            ERROR_CONDITION(_permutation[i] < 0 || _permutation[i] >= depth
+                    || used[_permutation[i]],
+                    "Invalid permutation", 0);
+            used[_permutation[i]] = true;
+        }
+
+        return *this;
+    }
+
+    void LoopInterchange::interchange()
+    {
+        ERROR_CONDITION(this->_loop.is_null(), "No loop set", 0);
+        ERROR_CONDITION(this->_permutation.empty(), "No permutation set", 0);
+
+        int depth = _permutation.size();
+        TL::ObjectList<Nodecl::NodeclBase> nest = HLT::Utils::get_perfect_loop_nest(_loop, depth);
+        if ((int)nest.size() < depth)
+        {
+            fatal_printf_at(_loop.get_locus(),
+                    "cannot interchange %d loop(s): only %d perfectly nested loop(s) found\n",
+                    depth, (int)nest.size());
+        }
+
+        for (TL::ObjectList<Nodecl::NodeclBase>::iterator it = nest.begin();
+                it != nest.end();
+                it++)
+        {
+            HLT::Utils::check_canonical_loop(*it, "interchange");
+        }
+        HLT::Utils::check_rectangular_loop_nest(nest, "interchange");
+
+        Nodecl::NodeclBase innermost_body = nest.back().as<Nodecl::ForStatement>().get_statement();
+
+        LoopDependences dependences;
+        dependences.add_statement(innermost_body, nest);
+
+        for (int i = 0; i < depth; i++)
+        {
+            TL::ForStatement for_stmt(nest[i].as<Nodecl::ForStatement>());
+            if (!dependences.is_invariant(for_stmt.get_lower_bound())
+                    || !dependences.is_invariant(for_stmt.get_upper_bound()))
+            {
+                fatal_printf_at(nest[i].get_locus(),
+                        "cannot interchange a loop whose bounds are modified inside the nest\n");
+            }
+        }
+
+        if (!dependences.permutation_is_legal(_permutation))
+        {
+            fatal_printf_at(_loop.get_locus(),
+                    "cannot interchange this loop nest: a dependence would be violated\n");
+        }
+
+        TL::Scope interchange_scope = new_block_context(
+                _loop.retrieve_context().get_decl_context());
+
+        TL::ObjectList<TL::Scope> body_scopes;
+        TL::Scope current_scope = interchange_scope;
+        for (int i = 0; i < depth; i++)
+        {
+            current_scope = new_block_context(current_scope.get_decl_context());
+            body_scopes.append(current_scope);
+        }
+
+        TL::ObjectList<Nodecl::NodeclBase> transformation_stmts;
+        for (int i = 0; i < depth; i++)
+        {
+            TL::ForStatement for_stmt(nest[i].as<Nodecl::ForStatement>());
+            TL::Symbol induction_var = for_stmt.get_induction_variable();
+
+            if (for_stmt.induction_variable_in_separate_scope())
+            {
+                induction_var.set_value(Nodecl::NodeclBase::null());
+                if (IS_CXX_LANGUAGE)
+                {
+                    transformation_stmts.append(
+                            Nodecl::CxxDef::make(
+                                /* context-of-decl */ Nodecl::NodeclBase::null(),
+                                induction_var));
+                }
+            }
+            else
+            {
+                // Each loop now finishes in a different place
+                Nodecl::NodeclBase expr =
+                    HLT::Utils::compute_induction_variable_final_expr(nest[i]);
+
+                _post_transformation_stmts.append(
+                        Nodecl::ExpressionStatement::make(
+                            Nodecl::Assignment::make(
+                                induction_var.make_nodecl(/* set_ref_type */ true),
+                                expr,
+                                induction_var.get_type().no_ref().get_lvalue_reference_to())));
+            }
+        }
+
+        Nodecl::NodeclBase body = HLT::Utils::make_loop_body(
+                Nodecl::Utils::deep_copy(innermost_body, body_scopes.back()),
+                body_scopes.back());
+
+        Nodecl::NodeclBase interchanged_loop;
+        for (int i = depth - 1; i >= 0; i--)
+        {
+            TL::ForStatement for_stmt(nest[_permutation[i]].as<Nodecl::ForStatement>());
+            Nodecl::NodeclBase step = for_stmt.get_step();
+
+            interchanged_loop = Nodecl::ForStatement::make(
+                    HLT::Utils::make_loop_control(
+                        for_stmt.get_induction_variable(),
+                        for_stmt.get_lower_bound().shallow_copy(),
+                        for_stmt.get_upper_bound().shallow_copy(),
+                        step.shallow_copy(),
+                        const_value_is_positive(step.get_constant())),
+                    body,
+                    /* loop-name */ Nodecl::NodeclBase::null());
+
+            if (i > 0)
+            {
+                body = HLT::Utils::make_loop_body(
+                        Nodecl::List::make(interchanged_loop),
+                        body_scopes[i - 1]);
+            }
+        }
+
+        transformation_stmts.append(interchanged_loop);
+
+        _transformation =
+            Nodecl::List::make(
+                    Nodecl::Context::make(
+                        Nodecl::List::make(
+                            Nodecl::CompoundStatement::make(
+                                Nodecl::List::make(transformation_stmts),
+                                /* destructors */ Nodecl::NodeclBase::null())),
+                        interchange_scope));
+    }
+
+} }
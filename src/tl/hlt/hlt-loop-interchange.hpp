@@ -0,0 +1,75 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+
+  This file is part of Mercurium C/C++ source-to-source compiler.
+
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+#ifndef HLT_INTERCHANGE_HPP
+#define HLT_INTERCHANGE_HPP
+
+#include "tl-nodecl.hpp"
+#include "hlt-transform.hpp"
+
+namespace TL
+{
+    namespace HLT
+    {
+        //! \addtogroup HLT High Level Transformations
+        //! @{
+
+        //! Permutes the loops of a perfect nest of regular loops
+        /*!
+          The permutation states, for every level of the resulting nest,
+          which loop of the original nest goes there. Permutation (1, 0)
+          interchanges the loops of a two-level nest.
+
+          The nest must be rectangular and the permutation cannot reverse
+          the direction of any dependence.
+          */
+        class LIBHLT_CLASS LoopInterchange : public Transform
+        {
+            private:
+                Nodecl::NodeclBase _loop, _transformation;
+                TL::ObjectList<int> _permutation;
+                Nodecl::List _post_transformation_stmts;
+            public:
+                LoopInterchange();
+
+                // Properties
+                LoopInterchange& set_loop(Nodecl::NodeclBase loop);
+                //! Zero-based permutation
+                LoopInterchange& set_permutation(const TL::ObjectList<int>& permutation);
+
+                // Action
+                void interchange();
+
+                // Results
+                Nodecl::NodeclBase get_whole_transformation() const { return _transformation; }
+                Nodecl::NodeclBase get_post_transformation_stmts() const { return _post_transformation_stmts; }
+        };
+
+        //! @}
+    }
+}
+
+#endif // HLT_INTERCHANGE_HPP
@@ -0,0 +1,144 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+
+  This file is part of Mercurium C/C++ source-to-source compiler.
+
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+#include "hlt-loop-stripmine.hpp"
+#include "hlt-utils.hpp"
+#include "tl-nodecl-utils.hpp"
+
+#include "cxx-cexpr.h"
+
+namespace TL { namespace HLT {
+
+    LoopStripmine::LoopStripmine()
+        : Transform(), _loop(), _transformation(), _strip_size()
+    {
+    }
+
+    LoopStripmine& LoopStripmine::set_loop(Nodecl::NodeclBase loop)
+    {
+        this->_loop = loop;
+        return *this;
+    }
+
+    LoopStripmine& LoopStripmine::set_strip_size(Nodecl::NodeclBase strip_size)
+    {
+        this->_strip_size = strip_size;
+        return *this;
+    }
+
+    void LoopStripmine::stripmine()
+    {
+        ERROR_CONDITION(this->_loop.is_null(), "No loop set", 0);
+        ERROR_CONDITION(this->_strip_size.is_null(), "No strip size set", 0);
+
+        HLT::Utils::check_canonical_loop(this->_loop, "strip-mine");
+
+        Nodecl::ForStatement loop = this->_loop.as<Nodecl::ForStatement>();
+        TL::ForStatement for_stmt(loop);
+        TL::Symbol induction_var = for_stmt.get_induction_variable();
+        TL::Type induction_var_type = induction_var.get_type().no_ref();
+        Nodecl::NodeclBase step = for_stmt.get_step();
+        bool is_increasing = const_value_is_positive(step.get_constant());
+
+        TL::Scope orig_loop_scope = loop.retrieve_context();
+        TL::Scope stripmine_scope = new_block_context(orig_loop_scope.get_decl_context());
+        TL::Scope strip_loop_scope = new_block_context(stripmine_scope.get_decl_context());
+        TL::Scope element_loop_scope = new_block_context(strip_loop_scope.get_decl_context());
+
+        TL::Symbol strip_var = stripmine_scope.new_symbol(induction_var.get_name() + "_strip");
+        symbol_entity_specs_set_is_user_declared(strip_var.get_internal_symbol(), 1);
+        strip_var.get_internal_symbol()->kind = SK_VARIABLE;
+        strip_var.set_type(induction_var_type);
+
+        // for (i = i_strip; i <= min(U, i_strip + (N-1)*S); i += S)
+        Nodecl::NodeclBase element_loop =
+            Nodecl::ForStatement::make(
+                    HLT::Utils::make_loop_control(
+                        induction_var,
+                        strip_var.make_nodecl(/* set_ref_type */ true),
+                        HLT::Utils::compute_strip_upper_bound(
+                            strip_var, for_stmt.get_upper_bound(), _strip_size, step),
+                        step.shallow_copy(),
+                        is_increasing),
+                    HLT::Utils::make_loop_body(
+                        Nodecl::Utils::deep_copy(loop.get_statement(), element_loop_scope),
+                        element_loop_scope),
+                    /* loop-name */ Nodecl::NodeclBase::null());
+
+        // for (i_strip = L; i_strip <= U; i_strip += N*S)
+        Nodecl::NodeclBase strip_loop =
+            Nodecl::ForStatement::make(
+                    HLT::Utils::make_loop_control(
+                        strip_var,
+                        for_stmt.get_lower_bound().shallow_copy(),
+                        for_stmt.get_upper_bound().shallow_copy(),
+                        HLT::Utils::compute_strip_step(_strip_size, step, induction_var_type),
+                        is_increasing),
+                    HLT::Utils::make_loop_body(
+                        Nodecl::List::make(element_loop),
+                        strip_loop_scope),
+                    /* loop-name */ Nodecl::NodeclBase::null());
+
+        TL::ObjectList<Nodecl::NodeclBase> transformation_stmts;
+        if (for_stmt.induction_variable_in_separate_scope())
+        {
+            induction_var.set_value(Nodecl::NodeclBase::null());
+            if (IS_CXX_LANGUAGE)
+            {
+                transformation_stmts.append(
+                        Nodecl::CxxDef::make(
+                            /* context-of-decl */ Nodecl::NodeclBase::null(),
+                            induction_var));
+            }
+        }
+        else
+        {
+            // The loop may not run any strip
+            Nodecl::NodeclBase expr =
+                HLT::Utils::compute_induction_variable_final_expr(loop);
+
+            _post_transformation_stmts.append(
+                    Nodecl::ExpressionStatement::make(
+                        Nodecl::Assignment::make(
+                            induction_var.make_nodecl(/* set_ref_type */ true),
+                            expr,
+                            induction_var_type.get_lvalue_reference_to())));
+        }
+
+        transformation_stmts.append(Nodecl::ObjectInit::make(strip_var));
+        transformation_stmts.append(strip_loop);
+
+        _transformation =
+            Nodecl::List::make(
+                    Nodecl::Context::make(
+                        Nodecl::List::make(
+                            Nodecl::CompoundStatement::make(
+                                Nodecl::List::make(transformation_stmts),
+                                /* destructors */ Nodecl::NodeclBase::null())),
+                        stripmine_scope));
+    }
+
+} }
@@ -0,0 +1,85 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+
+  This file is part of Mercurium C/C++ source-to-source compiler.
+
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+#ifndef HLT_STRIPMINE_HPP
+#define HLT_STRIPMINE_HPP
+
+#include "tl-nodecl.hpp"
+#include "hlt-transform.hpp"
+
+namespace TL
+{
+    namespace HLT
+    {
+        //! \addtogroup HLT High Level Transformations
+        //! @{
+
+        //! Strip-mines a regular loop
+        /*!
+          The iteration space of the loop is split in strips of a given
+          size. An outer loop traverses the strips and the original loop
+          traverses the iterations of one strip.
+
+          \code
+          for (i = L; i <= U; i += S)
+          \endcode
+
+          becomes
+
+          \code
+          for (i_strip = L; i_strip <= U; i_strip += N*S)
+            for (i = i_strip; i <= min(U, i_strip + (N-1)*S); i += S)
+          \endcode
+
+          Strip-mining does not change the order of the iterations so it is
+          always legal.
+          */
+        class LIBHLT_CLASS LoopStripmine : public Transform
+        {
+            private:
+                Nodecl::NodeclBase _loop, _transformation;
+                Nodecl::NodeclBase _strip_size;
+                Nodecl::List _post_transformation_stmts;
+            public:
+                LoopStripmine();
+
+                // Properties
+                LoopStripmine& set_loop(Nodecl::NodeclBase loop);
+                LoopStripmine& set_strip_size(Nodecl::NodeclBase strip_size);
+
+                // Action
+                void stripmine();
+
+                // Results
+                Nodecl::NodeclBase get_whole_transformation() const { return _transformation; }
+                Nodecl::NodeclBase get_post_transformation_stmts() const { return _post_transformation_stmts; }
+        };
+
+        //! @}
+    }
+}
+
+#endif // HLT_STRIPMINE_HPP
@@ -0,0 +1,218 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+
+  This file is part of Mercurium C/C++ source-to-source compiler.
+
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+#include "hlt-loop-tiling.hpp"
+#include "hlt-loop-dependences.hpp"
+#include "hlt-utils.hpp"
+#include "tl-nodecl-utils.hpp"
+
+#include "cxx-cexpr.h"
+#include "cxx-diagnostic.h"
+
+namespace TL { namespace HLT {
+
+    LoopTiling::LoopTiling()
+        : Transform(), _loop(), _transformation(), _tile_sizes()
+    {
+    }
+
+    LoopTiling& LoopTiling::set_loop(Nodecl::NodeclBase loop)
+    {
+        this->_loop = loop;
+        return *this;
+    }
+
+    LoopTiling& LoopTiling::set_tile_sizes(const TL::ObjectList<Nodecl::NodeclBase>& tile_sizes)
+    {
+        this->_tile_sizes = tile_sizes;
+        return *this;
+    }
+
+    void LoopTiling::tile()
+    {
+        ERROR_CONDITION(this->_loop.is_null(), "No loop set", 0);
+        ERROR_CONDITION(this->_tile_sizes.empty(), "No tile sizes set", 0);
+
+        int depth = _tile_sizes.size();
+        TL::ObjectList<Nodecl::NodeclBase> nest = HLT::Utils::get_perfect_loop_nest(_loop, depth);
+        if ((int)nest.size() < depth)
+        {
+            fatal_printf_at(_loop.get_locus(),
+                    "cannot tile %d loop(s): only %d perfectly nested loop(s) found\n",
+                    depth, (int)nest.size());
+        }
+
+        for (TL::ObjectList<Nodecl::NodeclBase>::iterator it = nest.begin();
+                it != nest.end();
+                it++)
+        {
+            HLT::Utils::check_canonical_loop(*it, "tile");
+        }
+        HLT::Utils::check_rectangular_loop_nest(nest, "tile");
+
+        Nodecl::NodeclBase innermost_body = nest.back().as<Nodecl::ForStatement>().get_statement();
+
+        LoopDependences dependences;
+        dependences.add_statement(innermost_body, nest);
+
+        for (int i = 0; i < depth; i++)
+        {
+            TL::ForStatement for_stmt(nest[i].as<Nodecl::ForStatement>());
+            if (!dependences.is_invariant(for_stmt.get_lower_bound())
+                    || !dependences.is_invariant(for_stmt.get_upper_bound())
+                    || !dependences.is_invariant(_tile_sizes[i]))
+            {
+                fatal_printf_at(nest[i].get_locus(),
+                        "cannot tile a loop whose bounds or tile size are modified inside the nest\n");
+            }
+        }
+
+        if (!dependences.is_fully_permutable())
+        {
+            fatal_printf_at(_loop.get_locus(),
+                    "cannot tile this loop nest: a dependence would be violated\n");
+        }
+
+        /*
+           { // <- tiling_scope
+             for (i_tile ...)
+             { // <- body_scopes[0]
+               for (j_tile ...)
+               { // <- body_scopes[1]
+                 for (i ...)
+                 { // <- body_scopes[2]
+                   for (j ...)
+                   { // <- body_scopes[3]
+                     original body
+                   }
+                 }
+               }
+             }
+           }
+         */
+        TL::Scope tiling_scope = new_block_context(
+                _loop.retrieve_context().get_decl_context());
+
+        TL::ObjectList<TL::Scope> body_scopes;
+        TL::Scope current_scope = tiling_scope;
+        for (int i = 0; i < 2 * depth; i++)
+        {
+            current_scope = new_block_context(current_scope.get_decl_context());
+            body_scopes.append(current_scope);
+        }
+
+        TL::ObjectList<Nodecl::NodeclBase> transformation_stmts;
+        TL::ObjectList<Nodecl::NodeclBase> loop_controls(2 * depth);
+        for (int i = 0; i < depth; i++)
+        {
+            TL::ForStatement for_stmt(nest[i].as<Nodecl::ForStatement>());
+            TL::Symbol induction_var = for_stmt.get_induction_variable();
+            TL::Type induction_var_type = induction_var.get_type().no_ref();
+            Nodecl::NodeclBase step = for_stmt.get_step();
+            bool is_increasing = const_value_is_positive(step.get_constant());
+
+            TL::Symbol tile_var = tiling_scope.new_symbol(induction_var.get_name() + "_tile");
+            symbol_entity_specs_set_is_user_declared(tile_var.get_internal_symbol(), 1);
+            tile_var.get_internal_symbol()->kind = SK_VARIABLE;
+            tile_var.set_type(induction_var_type);
+
+            // for (i_tile = L; i_tile <= U; i_tile += T*S)
+            loop_controls[i] = HLT::Utils::make_loop_control(
+                    tile_var,
+                    for_stmt.get_lower_bound().shallow_copy(),
+                    for_stmt.get_upper_bound().shallow_copy(),
+                    HLT::Utils::compute_strip_step(_tile_sizes[i], step, induction_var_type),
+                    is_increasing);
+
+            // for (i = i_tile; i <= min(U, i_tile + (T-1)*S); i += S)
+            loop_controls[depth + i] = HLT::Utils::make_loop_control(
+                    induction_var,
+                    tile_var.make_nodecl(/* set_ref_type */ true),
+                    HLT::Utils::compute_strip_upper_bound(
+                        tile_var, for_stmt.get_upper_bound(), _tile_sizes[i], step),
+                    step.shallow_copy(),
+                    is_increasing);
+
+            if (for_stmt.induction_variable_in_separate_scope())
+            {
+                induction_var.set_value(Nodecl::NodeclBase::null());
+                if (IS_CXX_LANGUAGE)
+                {
+                    transformation_stmts.append(
+                            Nodecl::CxxDef::make(
+                                /* context-of-decl */ Nodecl::NodeclBase::null(),
+                                induction_var));
+                }
+            }
+            else
+            {
+                Nodecl::NodeclBase expr =
+                    HLT::Utils::compute_induction_variable_final_expr(nest[i]);
+
+                _post_transformation_stmts.append(
+                        Nodecl::ExpressionStatement::make(
+                            Nodecl::Assignment::make(
+                                induction_var.make_nodecl(/* set_ref_type */ true),
+                                expr,
+                                induction_var_type.get_lvalue_reference_to())));
+            }
+
+            transformation_stmts.append(Nodecl::ObjectInit::make(tile_var));
+        }
+
+        Nodecl::NodeclBase body = HLT::Utils::make_loop_body(
+                Nodecl::Utils::deep_copy(innermost_body, body_scopes.back()),
+                body_scopes.back());
+
+        Nodecl::NodeclBase tiled_loop;
+        for (int i = 2 * depth - 1; i >= 0; i--)
+        {
+            tiled_loop = Nodecl::ForStatement::make(
+                    loop_controls[i],
+                    body,
+                    /* loop-name */ Nodecl::NodeclBase::null());
+
+            if (i > 0)
+            {
+                body = HLT::Utils::make_loop_body(
+                        Nodecl::List::make(tiled_loop),
+                        body_scopes[i - 1]);
+            }
+        }
+
+        transformation_stmts.append(tiled_loop);
+
+        _transformation =
+            Nodecl::List::make(
+                    Nodecl::Context::make(
+                        Nodecl::List::make(
+                            Nodecl::CompoundStatement::make(
+                                Nodecl::List::make(transformation_stmts),
+                                /* destructors */ Nodecl::NodeclBase::null())),
+                        tiling_scope));
+    }
+
+} }
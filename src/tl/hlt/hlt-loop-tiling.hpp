@@ -0,0 +1,87 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+
+  This file is part of Mercurium C/C++ source-to-source compiler.
+
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+#ifndef HLT_TILING_HPP
+#define HLT_TILING_HPP
+
+#include "tl-nodecl.hpp"
+#include "hlt-transform.hpp"
+
+namespace TL
+{
+    namespace HLT
+    {
+        //! \addtogroup HLT High Level Transformations
+        //! @{
+
+        //! Tiles (blocks) a perfect nest of regular loops
+        /*!
+          Every loop of the nest is strip-mined and the loops that traverse
+          the strips are moved outside the nest.
+
+          \code
+          for (i = 0; i < N; i++)
+            for (j = 0; j < M; j++)
+          \endcode
+
+          tiled with sizes (T1, T2) becomes
+
+          \code
+          for (i_tile = 0; i_tile <= N-1; i_tile += T1)
+            for (j_tile = 0; j_tile <= M-1; j_tile += T2)
+              for (i = i_tile; i <= min(N-1, i_tile + T1-1); i++)
+                for (j = j_tile; j <= min(M-1, j_tile + T2-1); j++)
+          \endcode
+
+          The nest must be rectangular and fully permutable, i.e. no
+          dependence may go backwards in any of the tiled loops.
+          */
+        class LIBHLT_CLASS LoopTiling : public Transform
+        {
+            private:
+                Nodecl::NodeclBase _loop, _transformation;
+                TL::ObjectList<Nodecl::NodeclBase> _tile_sizes;
+                Nodecl::List _post_transformation_stmts;
+            public:
+                LoopTiling();
+
+                // Properties
+                LoopTiling& set_loop(Nodecl::NodeclBase loop);
+                LoopTiling& set_tile_sizes(const TL::ObjectList<Nodecl::NodeclBase>& tile_sizes);
+
+                // Action
+                void tile();
+
+                // Results
+                Nodecl::NodeclBase get_whole_transformation() const { return _transformation; }
+                Nodecl::NodeclBase get_post_transformation_stmts() const { return _post_transformation_stmts; }
+        };
+
+        //! @}
+    }
+}
+
+#endif // HLT_TILING_HPP
@@ -30,6 +30,12 @@
 #include "hlt-loop-unroll.hpp"
 #include "hlt-loop-normalize.hpp"
 #include "hlt-loop-collapse.hpp"
+#include "hlt-loop-stripmine.hpp"
+#include "hlt-loop-tiling.hpp"
+#include "hlt-loop-interchange.hpp"
+#include "hlt-loop-fusion.hpp"
+#include "hlt-loop-distribution.hpp"
+#include "hlt-utils.hpp"
 #include "tl-nodecl-utils.hpp"
 #include "cxx-cexpr.h"
 #include "cxx-diagnostic.h"
@@ -66,6 +72,46 @@ HLTPragmaPhase::HLTPragmaPhase()
                 this,
                 std::placeholders::_1)
             );
+
+    register_construct("hlt", "stripmine");
+    dispatcher("hlt").statement.post["stripmine"].connect(
+            std::bind(
+                &HLTPragmaPhase::do_loop_stripmine,
+                this,
+                std::placeholders::_1)
+            );
+
+    register_construct("hlt", "tile");
+    dispatcher("hlt").statement.post["tile"].connect(
+            std::bind(
+                &HLTPragmaPhase::do_loop_tile,
+                this,
+                std::placeholders::_1)
+            );
+
+    register_construct("hlt", "interchange");
+    dispatcher("hlt").statement.post["interchange"].connect(
+            std::bind(
+                &HLTPragmaPhase::do_loop_interchange,
+                this,
+                std::placeholders::_1)
+            );
+
+    register_construct("hlt", "fuse");
+    dispatcher("hlt").statement.post["fuse"].connect(
+            std::bind(
+                &HLTPragmaPhase::do_loop_fuse,
+                this,
+                std::placeholders::_1)
+            );
+
+    register_construct("hlt", "distribute");
+    dispatcher("hlt").statement.post["distribute"].connect(
+            std::bind(
+                &HLTPragmaPhase::do_loop_distribute,
+                this,
+                std::placeholders::_1)
+            );
 }
 
 void HLTPragmaPhase::run(TL::DTO& dto)
@@ -92,6 +138,74 @@ namespace {
         return stmt;
     }
 
+    // Integer expressions of the parameter of the construct, e.g. tile(16, 32)
+    bool get_integer_parameters(
+            const TL::PragmaCustomStatement& construct,
+            const std::string& name,
+            TL::ObjectList<Nodecl::NodeclBase>& expr_list)
+    {
+        TL::PragmaCustomParameter clause = construct.get_pragma_line().get_parameter();
+        if (clause.is_defined())
+            expr_list = clause.get_arguments_as_expressions();
+
+        if (expr_list.empty())
+        {
+            error_printf_at(construct.get_locus(),
+                    "'%s' construct requires at least one argument\n",
+                    name.c_str());
+            return false;
+        }
+
+        for (TL::ObjectList<Nodecl::NodeclBase>::iterator it = expr_list.begin();
+                it != expr_list.end();
+                it++)
+        {
+            if (!is_any_int_type(it->get_type().no_ref().get_internal_type()))
+            {
+                error_printf_at(construct.get_locus(),
+                        "arguments of '%s' construct must be integer expressions\n",
+                        name.c_str());
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool check_language(
+            const TL::PragmaCustomStatement& construct,
+            const std::string& name)
+    {
+        if (IS_FORTRAN_LANGUAGE)
+        {
+            error_printf_at(construct.get_locus(),
+                    "'%s' construct is only supported in C/C++\n",
+                    name.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    bool check_sizes(
+            const TL::PragmaCustomStatement& construct,
+            const std::string& name,
+            const TL::ObjectList<Nodecl::NodeclBase>& expr_list)
+    {
+        for (TL::ObjectList<Nodecl::NodeclBase>::const_iterator it = expr_list.begin();
+                it != expr_list.end();
+                it++)
+        {
+            if (it->is_constant()
+                    && !const_value_is_positive(it->get_constant()))
+            {
+                error_printf_at(construct.get_locus(),
+                        "non-positive size is not allowed in '%s' construct\n",
+                        name.c_str());
+                return false;
+            }
+        }
+        return true;
+    }
+
 }
 
 void HLTPragmaPhase::do_loop_unroll(TL::PragmaCustomStatement construct)
@@ -205,6 +319,202 @@ void HLTPragmaPhase::do_loop_collapse(TL::PragmaCustomStatement construct)
     }
 }
 
+void HLTPragmaPhase::do_loop_stripmine(TL::PragmaCustomStatement construct)
+{
+    TL::ObjectList<Nodecl::NodeclBase> expr_list;
+    if (!check_language(construct, "stripmine")
+            || !get_integer_parameters(construct, "stripmine", expr_list)
+            || !check_sizes(construct, "stripmine", expr_list))
+        return;
+
+    if (expr_list.size() != 1)
+    {
+        error_printf_at(construct.get_locus(),
+                "'stripmine' construct needs exactly one argument\n");
+        return;
+    }
+
+    HLT::LoopStripmine loop_stripmine;
+    loop_stripmine
+        .set_loop(get_statement_from_pragma(construct))
+        .set_strip_size(expr_list[0]);
+
+    loop_stripmine.stripmine();
+    info_printf_at(construct.get_locus(), "loop strip-mined\n");
+
+    Nodecl::NodeclBase transformed_code = loop_stripmine.get_whole_transformation();
+    construct.replace(transformed_code);
+
+    Nodecl::NodeclBase posterior_stmts = loop_stripmine.get_post_transformation_stmts();
+    Nodecl::Utils::append_items_after(construct, posterior_stmts);
+}
+
+void HLTPragmaPhase::do_loop_tile(TL::PragmaCustomStatement construct)
+{
+    TL::ObjectList<Nodecl::NodeclBase> expr_list;
+    if (!check_language(construct, "tile")
+            || !get_integer_parameters(construct, "tile", expr_list)
+            || !check_sizes(construct, "tile", expr_list))
+        return;
+
+    HLT::LoopTiling loop_tiling;
+    loop_tiling
+        .set_loop(get_statement_from_pragma(construct))
+        .set_tile_sizes(expr_list);
+
+    loop_tiling.tile();
+    info_printf_at(construct.get_locus(), "loop nest of %d loop(s) tiled\n",
+            (int)expr_list.size());
+
+    Nodecl::NodeclBase transformed_code = loop_tiling.get_whole_transformation();
+    construct.replace(transformed_code);
+
+    Nodecl::NodeclBase posterior_stmts = loop_tiling.get_post_transformation_stmts();
+    Nodecl::Utils::append_items_after(construct, posterior_stmts);
+}
+
+void HLTPragmaPhase::do_loop_interchange(TL::PragmaCustomStatement construct)
+{
+    TL::ObjectList<Nodecl::NodeclBase> expr_list;
+    if (!check_language(construct, "interchange")
+            || !get_integer_parameters(construct, "interchange", expr_list))
+        return;
+
+    // The permutation is written one-based
+    int depth = expr_list.size();
+    TL::ObjectList<int> permutation;
+    TL::ObjectList<bool> used(depth, false);
+    for (TL::ObjectList<Nodecl::NodeclBase>::iterator it = expr_list.begin();
+            it != expr_list.end();
+            it++)
+    {
+        int position = it->is_constant()
+            ? const_value_cast_to_signed_int(it->get_constant()) : 0;
+        if (position < 1
+                || position > depth
+                || used[position - 1])
+        {
+            error_printf_at(construct.get_locus(),
+                    "arguments of 'interchange' construct must be a permutation of 1..%d\n",
+                    depth);
+            return;
+        }
+        used[position - 1] = true;
+        permutation.append(position - 1);
+    }
+
+    HLT::LoopInterchange loop_interchange;
+    loop_interchange
+        .set_loop(get_statement_from_pragma(construct))
+        .set_permutation(permutation);
+
+    loop_interchange.interchange();
+    info_printf_at(construct.get_locus(), "loop nest of %d loop(s) interchanged\n",
+            depth);
+
+    Nodecl::NodeclBase transformed_code = loop_interchange.get_whole_transformation();
+    construct.replace(transformed_code);
+
+    Nodecl::NodeclBase posterior_stmts = loop_interchange.get_post_transformation_stmts();
+    Nodecl::Utils::append_items_after(construct, posterior_stmts);
+}
+
+void HLTPragmaPhase::do_loop_fuse(TL::PragmaCustomStatement construct)
+{
+    if (!check_language(construct, "fuse"))
+        return;
+
+    Nodecl::NodeclBase stmt = get_statement_from_pragma(construct);
+    TL::ObjectList<Nodecl::NodeclBase> stmts;
+    int num_loops = 0;
+    if (stmt.is<Nodecl::CompoundStatement>())
+    {
+        TL::ObjectList<Nodecl::NodeclBase> enclosed_stmts = HLT::Utils::get_enclosed_statements(
+                stmt.as<Nodecl::CompoundStatement>().get_statements());
+        for (TL::ObjectList<Nodecl::NodeclBase>::iterator it = enclosed_stmts.begin();
+                it != enclosed_stmts.end();
+                it++)
+        {
+            // Declarations would have to be moved out of the fused block
+            if (it->is<Nodecl::ObjectInit>()
+                    || it->is<Nodecl::CxxDecl>()
+                    || it->is<Nodecl::CxxDef>())
+            {
+                error_printf_at(it->get_locus(),
+                        "'fuse' construct cannot contain declarations\n");
+                return;
+            }
+
+            TL::ObjectList<Nodecl::NodeclBase> current = HLT::Utils::get_enclosed_statements(*it);
+            if (current.size() == 1
+                    && current[0].is<Nodecl::ForStatement>())
+            {
+                stmts.append(current[0]);
+                num_loops++;
+            }
+            else
+            {
+                stmts.append(*it);
+            }
+        }
+    }
+
+    if (num_loops < 2)
+    {
+        error_printf_at(construct.get_locus(),
+                "'fuse' construct requires a compound statement with two or more 'for' loops\n");
+        return;
+    }
+
+    HLT::LoopFusion loop_fusion;
+    loop_fusion
+        .set_statements(stmts)
+        .set_pragma_context(construct.retrieve_context());
+
+    loop_fusion.fuse();
+    info_printf_at(construct.get_locus(), "%d loops fused\n", num_loops);
+
+    Nodecl::NodeclBase transformed_code = loop_fusion.get_whole_transformation();
+    construct.replace(transformed_code);
+}
+
+void HLTPragmaPhase::do_loop_distribute(TL::PragmaCustomStatement construct)
+{
+    if (!check_language(construct, "distribute"))
+        return;
+
+    TL::ObjectList<TL::Symbol> expanded_symbols;
+    TL::PragmaCustomClause expand_clause = construct.get_pragma_line().get_clause("expand");
+    if (expand_clause.is_defined())
+    {
+        TL::ObjectList<Nodecl::NodeclBase> expr_list = expand_clause.get_arguments_as_expressions();
+        for (TL::ObjectList<Nodecl::NodeclBase>::iterator it = expr_list.begin();
+                it != expr_list.end();
+                it++)
+        {
+            Nodecl::NodeclBase expr = it->no_conv();
+            if (!expr.is<Nodecl::Symbol>())
+            {
+                error_printf_at(construct.get_locus(),
+                        "'expand' clause only accepts variable names\n");
+                return;
+            }
+            expanded_symbols.insert(expr.get_symbol());
+        }
+    }
+
+    HLT::LoopDistribution loop_distribution;
+    loop_distribution
+        .set_loop(get_statement_from_pragma(construct))
+        .set_expanded_symbols(expanded_symbols);
+
+    loop_distribution.distribute();
+    info_printf_at(construct.get_locus(), "loop distributed\n");
+
+    Nodecl::NodeclBase transformed_code = loop_distribution.get_whole_transformation();
+    construct.replace(transformed_code);
+}
+
 } }
 
 EXPORT_PHASE(TL::HLT::HLTPragmaPhase)
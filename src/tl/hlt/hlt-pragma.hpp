@@ -44,43 +44,43 @@ namespace TL
           This class implements several pragmas
 
           \code
-#pragma hlt unroll factor(N)
+#pragma hlt unroll(N)
   regular-for-loop
           \endcode
           \sa TL::HLT::LoopUnroll
 
           \code
-#pragma hlt block factors(expr-list)
+#pragma hlt tile(expr-list)
   perfect-loop-nest
           \endcode
-          \sa TL::HLT::LoopBlocking
+          \sa TL::HLT::LoopTiling
 
           \code
-#pragma hlt stripmine amount(expr)
+#pragma hlt stripmine(expr)
   regular-for-loop
           \endcode
-          \sa TL::HLT::StripMine
+          \sa TL::HLT::LoopStripmine
 
           \code
-#pragma hlt distribute expand(var-list)
+#pragma hlt distribute [expand(var-list)]
   regular-for-loop
           \endcode
           \sa TL::HLT::LoopDistribution
 
           \code
-#pragma hlt fusion
+#pragma hlt fuse
   compound-statement
           \endcode
           \sa TL::HLT::LoopFusion
 
           \code
-#pragma hlt interchange permutation(perm{1..N})
+#pragma hlt interchange(perm{1..N})
   perfect-loop-nest
           \endcode
           \sa TL::HLT::LoopInterchange
 
           \code
-#pragma hlt collapse
+#pragma hlt collapse(N)
   perfect-loop-nest
           \endcode
           \sa TL::HLT::LoopCollapse
@@ -113,6 +113,11 @@ namespace TL
                 void do_loop_unroll(TL::PragmaCustomStatement construct);
                 void do_loop_normalize(TL::PragmaCustomStatement construct);
                 void do_loop_collapse(TL::PragmaCustomStatement construct);
+                void do_loop_stripmine(TL::PragmaCustomStatement construct);
+                void do_loop_tile(TL::PragmaCustomStatement construct);
+                void do_loop_interchange(TL::PragmaCustomStatement construct);
+                void do_loop_fuse(TL::PragmaCustomStatement construct);
+                void do_loop_distribute(TL::PragmaCustomStatement construct);
         };
 
         //! @}
@@ -26,6 +26,9 @@
 
 #include "hlt-utils.hpp"
 
+#include "cxx-cexpr.h"
+#include "cxx-diagnostic.h"
+
 namespace TL {namespace HLT { namespace Utils {
 
 Nodecl::NodeclBase compute_induction_variable_final_expr(
@@ -82,4 +85,269 @@ Nodecl::NodeclBase compute_induction_variable_final_expr(
     return expr;
 }
 
+TL::ObjectList<Nodecl::NodeclBase> get_enclosed_statements(
+        const Nodecl::NodeclBase& n)
+{
+    Nodecl::NodeclBase current = n;
+    while (!current.is_null())
+    {
+        if (current.is<Nodecl::List>())
+        {
+            TL::ObjectList<Nodecl::NodeclBase> stmts;
+            Nodecl::List l = current.as<Nodecl::List>();
+            for (Nodecl::List::iterator it = l.begin(); it != l.end(); it++)
+            {
+                if (!it->is<Nodecl::EmptyStatement>())
+                    stmts.append(*it);
+            }
+
+            if (stmts.size() != 1)
+                return stmts;
+
+            current = stmts[0];
+        }
+        else if (current.is<Nodecl::Context>())
+        {
+            current = current.as<Nodecl::Context>().get_in_context();
+        }
+        else if (current.is<Nodecl::CompoundStatement>())
+        {
+            current = current.as<Nodecl::CompoundStatement>().get_statements();
+        }
+        else
+        {
+            return TL::ObjectList<Nodecl::NodeclBase>(1, current);
+        }
+    }
+    return TL::ObjectList<Nodecl::NodeclBase>();
+}
+
+TL::ObjectList<Nodecl::NodeclBase> get_perfect_loop_nest(
+        const Nodecl::NodeclBase& loop, int depth)
+{
+    TL::ObjectList<Nodecl::NodeclBase> nest;
+    Nodecl::NodeclBase current = loop;
+    while ((int)nest.size() < depth
+            && current.is<Nodecl::ForStatement>())
+    {
+        nest.append(current);
+
+        TL::ObjectList<Nodecl::NodeclBase> stmts = get_enclosed_statements(
+                current.as<Nodecl::ForStatement>().get_statement());
+        if (stmts.size() != 1)
+            break;
+
+        current = stmts[0];
+    }
+    return nest;
+}
+
+void check_canonical_loop(
+        const Nodecl::NodeclBase& loop,
+        const std::string& transformation)
+{
+    if (!loop.is<Nodecl::ForStatement>())
+        fatal_printf_at(loop.get_locus(),
+                "cannot %s a statement that is not a 'for' loop\n",
+                transformation.c_str());
+
+    TL::ForStatement for_stmt(loop.as<Nodecl::ForStatement>());
+    if (!for_stmt.is_omp_valid_loop())
+        fatal_printf_at(loop.get_locus(),
+                "cannot %s a non-canonical 'for' loop\n",
+                transformation.c_str());
+
+    Nodecl::NodeclBase step = for_stmt.get_step();
+    if (!step.is_constant()
+            || !const_value_is_integer(step.get_constant())
+            || const_value_is_zero(step.get_constant()))
+        fatal_printf_at(loop.get_locus(),
+                "cannot %s a loop whose step is not a nonzero integer constant, normalize it first\n",
+                transformation.c_str());
+}
+
+namespace {
+
+    bool uses_any_symbol(const Nodecl::NodeclBase& n,
+            const TL::ObjectList<TL::Symbol>& symbols)
+    {
+        if (n.is_null())
+            return false;
+
+        if (n.is<Nodecl::Symbol>()
+                && symbols.contains(n.get_symbol()))
+            return true;
+
+        Nodecl::NodeclBase::Children children = n.children();
+        for (Nodecl::NodeclBase::Children::iterator it = children.begin();
+                it != children.end();
+                it++)
+        {
+            if (uses_any_symbol(*it, symbols))
+                return true;
+        }
+        return false;
+    }
+
+}
+
+void check_rectangular_loop_nest(
+        const TL::ObjectList<Nodecl::NodeclBase>& nest,
+        const std::string& transformation)
+{
+    TL::ObjectList<TL::Symbol> induction_vars;
+    for (TL::ObjectList<Nodecl::NodeclBase>::const_iterator it = nest.begin();
+            it != nest.end();
+            it++)
+    {
+        TL::ForStatement for_stmt(it->as<Nodecl::ForStatement>());
+        if (uses_any_symbol(for_stmt.get_lower_bound(), induction_vars)
+                || uses_any_symbol(for_stmt.get_upper_bound(), induction_vars))
+            fatal_printf_at(it->get_locus(),
+                    "cannot %s a loop whose bounds depend on the induction variable of an enclosing loop\n",
+                    transformation.c_str());
+
+        induction_vars.append(for_stmt.get_induction_variable());
+    }
+}
+
+Nodecl::NodeclBase make_loop_body(
+        const Nodecl::NodeclBase& stmts,
+        TL::Scope scope)
+{
+    return Nodecl::List::make(
+            Nodecl::Context::make(
+                Nodecl::List::make(
+                    Nodecl::CompoundStatement::make(stmts, Nodecl::NodeclBase::null())),
+                scope));
+}
+
+Nodecl::NodeclBase make_loop_control(
+        TL::Symbol induction_var,
+        const Nodecl::NodeclBase& lower,
+        const Nodecl::NodeclBase& upper,
+        const Nodecl::NodeclBase& step,
+        bool is_increasing)
+{
+    TL::Type type = induction_var.get_type().no_ref();
+
+    // iv = lower
+    Nodecl::NodeclBase init =
+        Nodecl::Assignment::make(
+                induction_var.make_nodecl(/* set_ref_type */ true),
+                lower,
+                type.get_lvalue_reference_to());
+
+    // iv <= upper or iv >= upper
+    Nodecl::NodeclBase cond;
+    if (is_increasing)
+    {
+        cond = Nodecl::LowerOrEqualThan::make(
+                induction_var.make_nodecl(/* set_ref_type */ true),
+                upper,
+                ::get_bool_type());
+    }
+    else
+    {
+        cond = Nodecl::GreaterOrEqualThan::make(
+                induction_var.make_nodecl(/* set_ref_type */ true),
+                upper,
+                ::get_bool_type());
+    }
+
+    // iv = iv + step
+    Nodecl::NodeclBase next =
+        Nodecl::Assignment::make(
+                induction_var.make_nodecl(/* set_ref_type */ true),
+                Nodecl::Add::make(
+                    induction_var.make_nodecl(/* set_ref_type */ true),
+                    step,
+                    type),
+                type.get_lvalue_reference_to());
+
+    return Nodecl::LoopControl::make(
+            Nodecl::List::make(init),
+            cond,
+            next);
+}
+
+Nodecl::NodeclBase compute_strip_step(
+        const Nodecl::NodeclBase& size,
+        const Nodecl::NodeclBase& step,
+        TL::Type type)
+{
+    if (size.is_constant())
+    {
+        return const_value_to_nodecl(
+                const_value_mul(
+                    size.get_constant(),
+                    step.get_constant()));
+    }
+
+    return Nodecl::Mul::make(
+            size.shallow_copy(),
+            step.shallow_copy(),
+            type);
+}
+
+Nodecl::NodeclBase compute_strip_upper_bound(
+        TL::Symbol strip_var,
+        const Nodecl::NodeclBase& upper,
+        const Nodecl::NodeclBase& size,
+        const Nodecl::NodeclBase& step)
+{
+    TL::Type type = strip_var.get_type().no_ref();
+
+    Nodecl::NodeclBase offset;
+    if (size.is_constant())
+    {
+        offset = const_value_to_nodecl(
+                const_value_mul(
+                    const_value_sub(
+                        size.get_constant(),
+                        const_value_get_signed_int(1)),
+                    step.get_constant()));
+    }
+    else
+    {
+        offset = Nodecl::Mul::make(
+                Nodecl::ParenthesizedExpression::make(
+                    Nodecl::Minus::make(
+                        size.shallow_copy(),
+                        const_value_to_nodecl(const_value_get_signed_int(1)),
+                        type),
+                    type),
+                step.shallow_copy(),
+                type);
+    }
+
+    Nodecl::NodeclBase strip_last =
+        Nodecl::Add::make(
+                strip_var.make_nodecl(/* set_ref_type */ true),
+                offset,
+                type);
+
+    Nodecl::NodeclBase cond;
+    if (const_value_is_positive(step.get_constant()))
+    {
+        cond = Nodecl::LowerThan::make(
+                upper.shallow_copy(),
+                strip_last.shallow_copy(),
+                ::get_bool_type());
+    }
+    else
+    {
+        cond = Nodecl::GreaterThan::make(
+                upper.shallow_copy(),
+                strip_last.shallow_copy(),
+                ::get_bool_type());
+    }
+
+    return Nodecl::ConditionalExpression::make(
+            cond,
+            upper.shallow_copy(),
+            strip_last,
+            type);
+}
+
 } } }
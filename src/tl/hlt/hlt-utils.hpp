@@ -37,6 +37,57 @@ namespace TL {
             Nodecl::NodeclBase compute_induction_variable_final_expr(
                     const Nodecl::NodeclBase& loop);
 
+            //! Statements of 'n' skipping the contexts and compound
+            //! statements that only enclose one statement
+            TL::ObjectList<Nodecl::NodeclBase> get_enclosed_statements(
+                    const Nodecl::NodeclBase& n);
+
+            //! Loops of the perfect nest starting at 'loop', at most 'depth'
+            TL::ObjectList<Nodecl::NodeclBase> get_perfect_loop_nest(
+                    const Nodecl::NodeclBase& loop, int depth);
+
+            //! Emits an error if 'loop' is not a canonical loop with a
+            //! constant step, which is required to 'transformation' it
+            void check_canonical_loop(
+                    const Nodecl::NodeclBase& loop,
+                    const std::string& transformation);
+
+            //! Emits an error if the bounds of a loop of 'nest' depend on
+            //! the induction variable of an enclosing loop
+            void check_rectangular_loop_nest(
+                    const TL::ObjectList<Nodecl::NodeclBase>& nest,
+                    const std::string& transformation);
+
+            //! Wraps 'stmts' in a compound statement of 'scope', as
+            //! expected for the body of a loop
+            Nodecl::NodeclBase make_loop_body(
+                    const Nodecl::NodeclBase& stmts,
+                    TL::Scope scope);
+
+            //! for (iv = lower; iv <= upper; iv = iv + step), >= if the
+            //! loop is decreasing
+            Nodecl::NodeclBase make_loop_control(
+                    TL::Symbol induction_var,
+                    const Nodecl::NodeclBase& lower,
+                    const Nodecl::NodeclBase& upper,
+                    const Nodecl::NodeclBase& step,
+                    bool is_increasing);
+
+            //! Step of the loop that traverses the strips: size * step
+            Nodecl::NodeclBase compute_strip_step(
+                    const Nodecl::NodeclBase& size,
+                    const Nodecl::NodeclBase& step,
+                    TL::Type type);
+
+            //! Last iteration of the strip starting at 'strip_var':
+            //! min(upper, strip_var + (size - 1) * step), max if the loop
+            //! is decreasing
+            Nodecl::NodeclBase compute_strip_upper_bound(
+                    TL::Symbol strip_var,
+                    const Nodecl::NodeclBase& upper,
+                    const Nodecl::NodeclBase& size,
+                    const Nodecl::NodeclBase& step);
+
         }
     }
 }
@@ -84,6 +84,12 @@ namespace TL { namespace OpenMP {
                 _disable_task_expr_optim_str,
                 "0");
 
+        register_parameter("taskloop_runtime_based",
+                "If set to '1' the iterations of a taskloop are split into tasks by the runtime, "
+                "otherwise the compiler emits the loop that creates the tasks",
+                _taskloop_runtime_based_str,
+                "0");
+
 
         // TL::Core phase flags
         register_parameter("ompss_mode",
@@ -676,6 +682,108 @@ namespace TL { namespace OpenMP {
                 );
     }
 
+    void Base::ordered_depend_handler_pre(TL::PragmaCustomDirective) { }
+    void Base::ordered_depend_handler_post(TL::PragmaCustomDirective directive)
+    {
+        PragmaCustomLine pragma_line = directive.get_pragma_line();
+
+        if (emit_omp_report())
+        {
+            *_omp_report_file
+                << "\n"
+                << directive.get_locus_str() << ": " << "ORDERED DEPEND construct\n"
+                << directive.get_locus_str() << ": " << "------------------------\n"
+                ;
+        }
+
+        // The first dependence is lexed as the parameter of the directive and
+        // the following ones as 'depend' clauses
+        ObjectList<ObjectList<std::string> > dependences;
+        dependences.append(pragma_line.get_parameter().get_tokenized_arguments());
+
+        ObjectList<TL::PragmaCustomSingleClause> clauses = pragma_line.get_all_clauses();
+        for (ObjectList<TL::PragmaCustomSingleClause>::iterator it = clauses.begin();
+                it != clauses.end();
+                it++)
+        {
+            if (it->get_text() != "depend")
+                continue;
+
+            it->mark_as_used();
+            dependences.append(it->get_tokenized_arguments());
+        }
+
+        bool is_source = false;
+        Nodecl::List sinks;
+        for (ObjectList<ObjectList<std::string> >::iterator it = dependences.begin();
+                it != dependences.end();
+                it++)
+        {
+            ObjectList<std::string> &items = *it;
+            if (items.empty())
+                continue;
+
+            std::string first_item = items[0];
+            std::string::size_type colon = first_item.find(':');
+
+            std::string dependence_type = first_item.substr(0, colon);
+            dependence_type.erase(0, dependence_type.find_first_not_of(" \t"));
+            dependence_type.erase(dependence_type.find_last_not_of(" \t") + 1);
+
+            if (dependence_type == "source"
+                    && colon == std::string::npos
+                    && items.size() == 1)
+            {
+                is_source = true;
+            }
+            else if (dependence_type == "sink"
+                    && colon != std::string::npos)
+            {
+                items[0] = first_item.substr(colon + 1);
+
+                Nodecl::List iteration;
+                for (ObjectList<std::string>::iterator it_item = items.begin();
+                        it_item != items.end();
+                        it_item++)
+                {
+                    iteration.append(Source(*it_item).parse_expression(directive));
+                }
+
+                sinks.append(
+                        Nodecl::OpenMP::DoacrossSink::make(
+                            iteration,
+                            directive.get_locus()));
+            }
+            else
+            {
+                error_printf_at(directive.get_locus(),
+                        "invalid dependence '%s' in 'ordered' construct, expecting 'sink : vector' or 'source'\n",
+                        first_item.c_str());
+            }
+        }
+
+        pragma_line.diagnostic_unused_clauses();
+
+        if (is_source && !sinks.empty())
+        {
+            error_printf_at(directive.get_locus(),
+                    "'source' and 'sink' dependences cannot appear in the same 'ordered' construct\n");
+        }
+        else if (is_source)
+        {
+            directive.replace(
+                    Nodecl::OpenMP::DoacrossPost::make(
+                        directive.get_locus()));
+        }
+        else if (!sinks.empty())
+        {
+            directive.replace(
+                    Nodecl::OpenMP::DoacrossWait::make(
+                        sinks,
+                        directive.get_locus()));
+        }
+    }
+
     // Inline tasks
     void Base::task_handler_pre(TL::PragmaCustomStatement construct)
     {
@@ -1326,6 +1434,39 @@ namespace TL { namespace OpenMP {
             }
         }
 
+        PragmaCustomClause ordered_clause = pragma_line.get_clause("ordered");
+        if (ordered_clause.is_defined())
+        {
+            ObjectList<Nodecl::NodeclBase> args = ordered_clause.get_arguments_as_expressions();
+            if (args.empty())
+            {
+                // Only the ordered construct uses a plain 'ordered' clause
+                ordered_clause.mark_as_unused();
+            }
+            else if (args.size() != 1
+                    || !args[0].is_constant()
+                    || !const_value_is_positive(args[0].get_constant()))
+            {
+                error_printf_at(directive.get_locus(),
+                        "the argument of the 'ordered' clause must be a positive integer constant\n");
+            }
+            else
+            {
+                execution_environment.append(
+                        Nodecl::OpenMP::DoacrossLoops::make(
+                            args[0],
+                            directive.get_locus()));
+
+                if (emit_omp_report())
+                {
+                    *_omp_report_file
+                        << OpenMP::Report::indent
+                        << "Loop is a doacross nest of '" << args[0].prettyprint() << "' loops\n"
+                        ;
+                }
+            }
+        }
+
         if (barrier_at_end)
         {
             execution_environment.append(
@@ -1435,6 +1576,10 @@ namespace TL { namespace OpenMP {
         PragmaCustomClause num_tasks_clause = pragma_line.get_clause("num_tasks");
         PragmaCustomClause nogroup = pragma_line.get_clause("nogroup");
 
+        // When the runtime splits the loop it chooses the number of tasks if
+        // neither 'grainsize' nor 'num_tasks' are given
+        bool runtime_based = (_taskloop_runtime_based_str == "1");
+
         Nodecl::NodeclBase grainsize_expr, num_tasks_expr;
         if (grainsize_clause.is_defined() == num_tasks_clause.is_defined())
         {
@@ -1442,7 +1587,7 @@ namespace TL { namespace OpenMP {
             {
                 error_printf_at(pragma_line.get_locus(), "cannot define 'grainsize' and 'num_tasks' clauses at the same time\n");
             }
-            else
+            else if (!runtime_based)
             {
                 error_printf_at(pragma_line.get_locus(), "missing a 'grainsize' or a 'num_tasks' clauses\n");
             }
@@ -1486,8 +1631,9 @@ namespace TL { namespace OpenMP {
         }
 
         // grainsize_expr or num_tasks_expr has to be valid, otherwise we skip the taskloop
-        if ((grainsize_expr.is_null() || grainsize_expr.is<Nodecl::ErrExpr>()) &&
-            (num_tasks_expr.is_null() || num_tasks_expr.is<Nodecl::ErrExpr>()))
+        if (!runtime_based
+                && (grainsize_expr.is_null() || grainsize_expr.is<Nodecl::ErrExpr>())
+                && (num_tasks_expr.is_null() || num_tasks_expr.is<Nodecl::ErrExpr>()))
             return;
 
         bool taskwait_at_the_end = true;
@@ -1509,6 +1655,34 @@ namespace TL { namespace OpenMP {
 
         pragma_line.diagnostic_unused_clauses();
 
+        if (runtime_based)
+        {
+            if (!grainsize_expr.is_null())
+            {
+                execution_environment.append(
+                        Nodecl::OpenMP::Grainsize::make(grainsize_expr));
+            }
+            else if (!num_tasks_expr.is_null())
+            {
+                execution_environment.append(
+                        Nodecl::OpenMP::NumTasks::make(num_tasks_expr));
+            }
+
+            if (!taskwait_at_the_end)
+            {
+                execution_environment.append(
+                        Nodecl::OpenMP::Nogroup::make(directive.get_locus()));
+            }
+
+            directive.replace(
+                    Nodecl::List::make(
+                        Nodecl::OpenMP::TaskLoop::make(
+                            execution_environment,
+                            statement,
+                            directive.get_locus())));
+            return;
+        }
+
         taskloop_block_loop(directive, statement, execution_environment, grainsize_expr, num_tasks_expr);
 
         Nodecl::List list;
@@ -69,6 +69,8 @@ namespace TL
 
                 std::string _disable_task_expr_optim_str;
 
+                std::string _taskloop_runtime_based_str;
+
                 // Strings used to store the TL::Core phase flags
                 std::string _ompss_mode_str;
                 std::string _copy_deps_str;
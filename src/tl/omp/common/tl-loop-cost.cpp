@@ -0,0 +1,205 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2015 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+#include "tl-loop-cost.hpp"
+#include "tl-nodecl-utils.hpp"
+
+#include "cxx-cexpr.h"
+
+#include <algorithm>
+
+namespace TL {
+
+    LoopCostEstimator::LoopCostEstimator()
+        : _cost(0)
+    {
+    }
+
+    void LoopCostEstimator::add_cost(unsigned int cost)
+    {
+        if (_cost > MAX_COST - cost)
+            _cost = MAX_COST;
+        else
+            _cost += cost;
+    }
+
+    void LoopCostEstimator::add_loop_cost(unsigned int body_cost, unsigned int trip_count)
+    {
+        if (trip_count != 0
+                && body_cost > MAX_COST / trip_count)
+            add_cost(MAX_COST);
+        else
+            add_cost(body_cost * trip_count);
+    }
+
+    unsigned int LoopCostEstimator::estimate_nested(const Nodecl::NodeclBase& n)
+    {
+        if (n.is_null())
+            return 0;
+
+        LoopCostEstimator nested;
+        return nested.estimate(n);
+    }
+
+    unsigned int LoopCostEstimator::estimate(const Nodecl::NodeclBase& n)
+    {
+        _cost = 0;
+        walk(n);
+        return _cost;
+    }
+
+    unsigned int LoopCostEstimator::estimate_iteration(const Nodecl::ForStatement& loop)
+    {
+        _cost = 0;
+        walk(loop.get_statement());
+
+        // The evaluation of the condition and the increment of the loop
+        Nodecl::NodeclBase loop_control = loop.get_loop_header();
+        if (loop_control.is<Nodecl::LoopControl>())
+        {
+            walk(loop_control.as<Nodecl::LoopControl>().get_cond());
+            walk(loop_control.as<Nodecl::LoopControl>().get_next());
+        }
+
+        return _cost;
+    }
+
+    void LoopCostEstimator::visit(const Nodecl::ForStatement& n)
+    {
+        unsigned int iteration_cost;
+        {
+            LoopCostEstimator nested;
+            iteration_cost = nested.estimate_iteration(n);
+        }
+
+        unsigned int trip_count = UNKNOWN_TRIP_COUNT;
+
+        TL::ForStatement for_stmt(n);
+        if (for_stmt.is_omp_valid_loop())
+        {
+            Nodecl::NodeclBase lower = for_stmt.get_lower_bound();
+            Nodecl::NodeclBase upper = for_stmt.get_upper_bound();
+            Nodecl::NodeclBase step = for_stmt.get_step();
+
+            if (!lower.is_null() && lower.is_constant()
+                    && !upper.is_null() && upper.is_constant()
+                    && !step.is_null() && step.is_constant()
+                    && !const_value_is_zero(step.get_constant()))
+            {
+                // Both bounds are inclusive: (U - L + S) / S
+                const_value_t* num_iters = const_value_div(
+                        const_value_add(
+                            const_value_sub(upper.get_constant(), lower.get_constant()),
+                            step.get_constant()),
+                        step.get_constant());
+
+                if (const_value_is_positive(num_iters))
+                    trip_count = const_value_cast_to_unsigned_int(num_iters);
+                else
+                    trip_count = 0;
+            }
+        }
+
+        add_loop_cost(iteration_cost, trip_count);
+    }
+
+    void LoopCostEstimator::visit(const Nodecl::WhileStatement& n)
+    {
+        unsigned int iteration_cost =
+            estimate_nested(n.get_condition()) + estimate_nested(n.get_statement());
+        add_loop_cost(iteration_cost, UNKNOWN_TRIP_COUNT);
+    }
+
+    void LoopCostEstimator::visit(const Nodecl::DoStatement& n)
+    {
+        unsigned int iteration_cost =
+            estimate_nested(n.get_condition()) + estimate_nested(n.get_statement());
+        add_loop_cost(iteration_cost, UNKNOWN_TRIP_COUNT);
+    }
+
+    void LoopCostEstimator::visit(const Nodecl::IfElseStatement& n)
+    {
+        walk(n.get_condition());
+
+        unsigned int then_cost = estimate_nested(n.get_then());
+        unsigned int else_cost = estimate_nested(n.get_else());
+        add_cost(std::max(then_cost, else_cost));
+    }
+
+    void LoopCostEstimator::visit(const Nodecl::ConditionalExpression& n)
+    {
+        walk(n.get_condition());
+
+        unsigned int true_cost = estimate_nested(n.get_true());
+        unsigned int false_cost = estimate_nested(n.get_false());
+        add_cost(std::max(true_cost, false_cost));
+    }
+
+    void LoopCostEstimator::visit(const Nodecl::FunctionCall& n)
+    {
+        walk(n.get_arguments());
+        add_cost(FUNCTION_CALL_COST);
+    }
+
+#define MEMORY_ACCESS_COST(_kind) \
+    void LoopCostEstimator::visit_post(const Nodecl::_kind& n) \
+    { \
+        add_cost(2); \
+    }
+    MEMORY_ACCESS_COST(ArraySubscript)
+    MEMORY_ACCESS_COST(Dereference)
+    MEMORY_ACCESS_COST(ClassMemberAccess)
+#undef MEMORY_ACCESS_COST
+
+    // Constant expressions are folded at compile time so they do not have any cost
+#define OPERATION_COST(_kind, _cost) \
+    void LoopCostEstimator::visit_post(const Nodecl::_kind& n) \
+    { \
+        if (!n.is_constant()) \
+            add_cost(_cost); \
+    }
+    OPERATION_COST(Add, 1)
+    OPERATION_COST(Minus, 1)
+    OPERATION_COST(Mul, 1)
+    OPERATION_COST(Div, 8)
+    OPERATION_COST(Mod, 8)
+    OPERATION_COST(Assignment, 1)
+    OPERATION_COST(AddAssignment, 1)
+    OPERATION_COST(MinusAssignment, 1)
+    OPERATION_COST(MulAssignment, 1)
+    OPERATION_COST(DivAssignment, 8)
+    OPERATION_COST(Preincrement, 1)
+    OPERATION_COST(Postincrement, 1)
+    OPERATION_COST(Predecrement, 1)
+    OPERATION_COST(Postdecrement, 1)
+    OPERATION_COST(LowerThan, 1)
+    OPERATION_COST(LowerOrEqualThan, 1)
+    OPERATION_COST(GreaterThan, 1)
+    OPERATION_COST(GreaterOrEqualThan, 1)
+    OPERATION_COST(Equal, 1)
+    OPERATION_COST(Different, 1)
+#undef OPERATION_COST
+}
@@ -0,0 +1,104 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2015 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+#ifndef TL_LOOP_COST_HPP
+#define TL_LOOP_COST_HPP
+
+#include "tl-nodecl-visitor.hpp"
+
+namespace TL {
+
+    //! This visitor estimates the amount of work done by a piece of code
+    /*!
+     * The estimation is expressed in abstract cost units, where one unit is
+     * roughly the cost of a simple integer operation. Memory accesses,
+     * divisions and calls to unknown functions are weighted accordingly.
+     *
+     * Like the cyclomatic complexity, the cost of a conditional only takes
+     * into account one of its paths (the most expensive one). Inner loops
+     * multiply the cost of their body by their trip count when it is known
+     * at compile time, and by a default factor otherwise.
+     */
+    class LoopCostEstimator : public Nodecl::ExhaustiveVisitor<void>
+    {
+        private:
+            unsigned int _cost;
+
+            unsigned int estimate_nested(const Nodecl::NodeclBase& n);
+            void add_cost(unsigned int cost);
+            void add_loop_cost(unsigned int body_cost, unsigned int trip_count);
+
+        public:
+            // Cost of a call to a function whose body is unknown
+            static const unsigned int FUNCTION_CALL_COST = 20;
+            // Trip count assumed for loops whose bounds are not constant
+            static const unsigned int UNKNOWN_TRIP_COUNT = 8;
+            // Any estimation is saturated to this value
+            static const unsigned int MAX_COST = 1u << 30;
+
+            LoopCostEstimator();
+
+            //! Returns the estimated cost of one execution of 'n'
+            unsigned int estimate(const Nodecl::NodeclBase& n);
+
+            //! Returns the estimated cost of one iteration of 'loop'
+            unsigned int estimate_iteration(const Nodecl::ForStatement& loop);
+
+            virtual void visit(const Nodecl::ForStatement& n);
+            virtual void visit(const Nodecl::WhileStatement& n);
+            virtual void visit(const Nodecl::DoStatement& n);
+            virtual void visit(const Nodecl::IfElseStatement& n);
+            virtual void visit(const Nodecl::ConditionalExpression& n);
+            virtual void visit(const Nodecl::FunctionCall& n);
+
+            virtual void visit_post(const Nodecl::ArraySubscript& n);
+            virtual void visit_post(const Nodecl::Dereference& n);
+            virtual void visit_post(const Nodecl::ClassMemberAccess& n);
+
+            virtual void visit_post(const Nodecl::Add& n);
+            virtual void visit_post(const Nodecl::Minus& n);
+            virtual void visit_post(const Nodecl::Mul& n);
+            virtual void visit_post(const Nodecl::Div& n);
+            virtual void visit_post(const Nodecl::Mod& n);
+            virtual void visit_post(const Nodecl::Assignment& n);
+            virtual void visit_post(const Nodecl::AddAssignment& n);
+            virtual void visit_post(const Nodecl::MinusAssignment& n);
+            virtual void visit_post(const Nodecl::MulAssignment& n);
+            virtual void visit_post(const Nodecl::DivAssignment& n);
+            virtual void visit_post(const Nodecl::Preincrement& n);
+            virtual void visit_post(const Nodecl::Postincrement& n);
+            virtual void visit_post(const Nodecl::Predecrement& n);
+            virtual void visit_post(const Nodecl::Postdecrement& n);
+            virtual void visit_post(const Nodecl::LowerThan& n);
+            virtual void visit_post(const Nodecl::LowerOrEqualThan& n);
+            virtual void visit_post(const Nodecl::GreaterThan& n);
+            virtual void visit_post(const Nodecl::GreaterOrEqualThan& n);
+            virtual void visit_post(const Nodecl::Equal& n);
+            virtual void visit_post(const Nodecl::Different& n);
+    };
+}
+
+#endif // TL_LOOP_COST_HPP
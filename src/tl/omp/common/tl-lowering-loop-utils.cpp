@@ -0,0 +1,83 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2015 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+#include "tl-lowering-loop-utils.hpp"
+
+namespace TL { namespace Lowering { namespace Utils {
+
+    namespace
+    {
+        TL::Source long_distance(TL::Source lower, TL::Source upper)
+        {
+            TL::Source result;
+            result
+                << "((long)(" << upper << ")"
+                << " - (long)(" << lower << "))";
+            return result;
+        }
+    }
+
+    TL::Source loop_iteration_count(
+            TL::Source lower,
+            TL::Source upper,
+            TL::Source step)
+    {
+        TL::Source result;
+        result
+            << "((" << step << ") > 0"
+            << " ? (" << long_distance(lower, upper) << " >= 0"
+            <<      " ? " << long_distance(lower, upper) << " / (long)(" << step << ") + 1"
+            <<      " : 0L)"
+            << " : (" << long_distance(lower, upper) << " <= 0"
+            <<      " ? " << long_distance(lower, upper) << " / (long)(" << step << ") + 1"
+            <<      " : 0L))"
+            ;
+        return result;
+    }
+
+    TL::Source unsigned_loop_iteration_count(
+            TL::Source lower,
+            TL::Source upper,
+            TL::Source step)
+    {
+        TL::Source result;
+        result
+            << "((long long)(" << step << ") > 0"
+            << " ? ((" << upper << ") >= (" << lower << ")"
+            <<      " ? ((unsigned long long)(" << upper << ") - (unsigned long long)(" << lower << "))"
+            <<          " / (unsigned long long)(" << step << ") + 1"
+            <<      " : 0ULL)"
+            << " : ((" << upper << ") <= (" << lower << ")"
+            <<      " ? ((unsigned long long)(" << lower << ") - (unsigned long long)(" << upper << "))"
+            <<          " / (unsigned long long)(-(long long)(" << step << ")) + 1"
+            <<      " : 0ULL))"
+            ;
+        return result;
+    }
+
+} } }
@@ -0,0 +1,53 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2015 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+#ifndef TL_LOWERING_LOOP_UTILS_HPP
+#define TL_LOWERING_LOOP_UTILS_HPP
+
+#include "tl-source.hpp"
+
+namespace TL { namespace Lowering { namespace Utils {
+
+    // Number of iterations, as a long, of a loop running from 'lower' to
+    // 'upper' (both included) with a stride of 'step'. The arguments are
+    // evaluated more than once, so they should be names of variables
+    TL::Source loop_iteration_count(
+            TL::Source lower,
+            TL::Source upper,
+            TL::Source step);
+
+    // Like loop_iteration_count but as an unsigned long long, for loops whose
+    // bounds do not fit in a long. 'step' is interpreted as a long long
+    TL::Source unsigned_loop_iteration_count(
+            TL::Source lower,
+            TL::Source upper,
+            TL::Source step);
+
+} } }
+
+#endif // TL_LOWERING_LOOP_UTILS_HPP
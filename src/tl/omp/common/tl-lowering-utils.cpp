@@ -27,10 +27,327 @@
 
 #include "tl-lowering-utils.hpp"
 #include "tl-scope.hpp"
+#include "tl-nodecl-utils.hpp"
 #include "fortran03-typeutils.h"
 #include "cxx-cexpr.h"
 
-namespace TL { namespace Lowering { namespace Utils { namespace Fortran {
+namespace TL { namespace Lowering { namespace Utils {
+
+    namespace
+    {
+        // Removes the nodes that do not change which object is designated by
+        // an lvalue, so a write through 'x', '(x)', 'x[i]' or 'x.f' is seen
+        // as a write to 'x'. Accesses through pointers are not stripped since
+        // they do not modify the pointer itself
+        Nodecl::NodeclBase get_written_base(Nodecl::NodeclBase n)
+        {
+            for (;;)
+            {
+                if (n.is<Nodecl::Conversion>())
+                {
+                    n = n.as<Nodecl::Conversion>().get_nest();
+                }
+                else if (n.is<Nodecl::ParenthesizedExpression>())
+                {
+                    n = n.as<Nodecl::ParenthesizedExpression>().get_nest();
+                }
+                else if (n.is<Nodecl::ArraySubscript>()
+                        && n.as<Nodecl::ArraySubscript>().get_subscripted()
+                            .get_type().no_ref().is_array())
+                {
+                    n = n.as<Nodecl::ArraySubscript>().get_subscripted();
+                }
+                else if (n.is<Nodecl::ClassMemberAccess>())
+                {
+                    n = n.as<Nodecl::ClassMemberAccess>().get_lhs();
+                }
+                else
+                {
+                    return n;
+                }
+            }
+        }
+
+        // Returns true if 'n' is an OpenMP/OmpSs construct or a pragma that
+        // can appear among the statements or expressions of a task
+        bool is_directive(Nodecl::NodeclBase n)
+        {
+            switch (n.get_kind())
+            {
+                case NODECL_OPEN_M_P_ATOMIC:
+                case NODECL_OPEN_M_P_BARRIER_FULL:
+                case NODECL_OPEN_M_P_BARRIER_SIGNAL:
+                case NODECL_OPEN_M_P_BARRIER_WAIT:
+                case NODECL_OPEN_M_P_CRITICAL:
+                case NODECL_OPEN_M_P_DISTRIBUTE:
+                case NODECL_OPEN_M_P_DOACROSS_POST:
+                case NODECL_OPEN_M_P_DOACROSS_WAIT:
+                case NODECL_OPEN_M_P_FLUSH_MEMORY:
+                case NODECL_OPEN_M_P_FOR:
+                case NODECL_OPEN_M_P_FOR_APPENDIX:
+                case NODECL_OPEN_M_P_MASTER:
+                case NODECL_OPEN_M_P_PARALLEL:
+                case NODECL_OPEN_M_P_PARALLEL_SIMD_FOR:
+                case NODECL_OPEN_M_P_SECTION:
+                case NODECL_OPEN_M_P_SECTIONS:
+                case NODECL_OPEN_M_P_SIMD:
+                case NODECL_OPEN_M_P_SIMD_FOR:
+                case NODECL_OPEN_M_P_SIMD_FUNCTION:
+                case NODECL_OPEN_M_P_SINGLE:
+                case NODECL_OPEN_M_P_TARGET:
+                case NODECL_OPEN_M_P_TARGET_DATA:
+                case NODECL_OPEN_M_P_TARGET_UPDATE:
+                case NODECL_OPEN_M_P_TASK:
+                case NODECL_OPEN_M_P_TASK_LOOP:
+                case NODECL_OPEN_M_P_TASKWAIT:
+                case NODECL_OPEN_M_P_TASKYIELD:
+                case NODECL_OPEN_M_P_TEAMS:
+                case NODECL_OPEN_M_P_WORKSHARE:
+                case NODECL_OMP_SS_REGISTER:
+                case NODECL_OMP_SS_RELEASE:
+                case NODECL_OMP_SS_TASK_CALL:
+                case NODECL_OMP_SS_TASK_EXPRESSION:
+                case NODECL_OMP_SS_UNREGISTER:
+                case NODECL_PRAGMA_CUSTOM_DECLARATION:
+                case NODECL_PRAGMA_CUSTOM_DIRECTIVE:
+                case NODECL_PRAGMA_CUSTOM_STATEMENT:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        // Checks that some statements do not modify (or let escape) any of
+        // the private or firstprivate variables of a task. Optionally they
+        // must not contain other OpenMP/OmpSs constructs either
+        struct NonSharedWritesChecker
+        {
+            TL::ObjectList<TL::Symbol> _non_shared;
+            bool _reject_directives;
+            bool _valid;
+
+            NonSharedWritesChecker(const TL::ObjectList<TL::Symbol>& non_shared,
+                    bool reject_directives)
+                : _non_shared(non_shared), _reject_directives(reject_directives), _valid(true) { }
+
+            bool is_non_shared_write(Nodecl::NodeclBase n)
+            {
+                n = get_written_base(n);
+                return n.is<Nodecl::Symbol>()
+                    && _non_shared.contains(n.get_symbol());
+            }
+
+            void check_call_arguments(Nodecl::NodeclBase called, Nodecl::NodeclBase arguments)
+            {
+                if (arguments.is_null())
+                    return;
+
+                TL::Type function_type = called.get_type().no_ref();
+                if (function_type.is_pointer())
+                    function_type = function_type.points_to();
+
+                if (!function_type.is_function())
+                {
+                    _valid = false;
+                    return;
+                }
+
+                TL::ObjectList<TL::Type> parameters = function_type.parameters();
+                Nodecl::List args = arguments.as<Nodecl::List>();
+                int i = 0;
+                for (Nodecl::List::iterator it = args.begin(); it != args.end(); it++, i++)
+                {
+                    if (i >= (int)parameters.size())
+                        break;
+
+                    TL::Type param_type = parameters[i];
+                    if ((param_type.is_lvalue_reference()
+                                || param_type.is_rvalue_reference())
+                            && !param_type.no_ref().is_const()
+                            && is_non_shared_write(*it))
+                    {
+                        _valid = false;
+                        return;
+                    }
+                }
+            }
+
+            void walk(Nodecl::NodeclBase n)
+            {
+                if (n.is_null() || !_valid)
+                    return;
+
+                if (_reject_directives && is_directive(n))
+                {
+                    _valid = false;
+                    return;
+                }
+
+                if (Nodecl::Utils::nodecl_is_assignment_op(n))
+                {
+                    if (is_non_shared_write(n.children()[0]))
+                    {
+                        _valid = false;
+                        return;
+                    }
+                }
+                else if (n.is<Nodecl::Preincrement>()
+                        || n.is<Nodecl::Postincrement>()
+                        || n.is<Nodecl::Predecrement>()
+                        || n.is<Nodecl::Postdecrement>()
+                        || n.is<Nodecl::Reference>())
+                {
+                    if (is_non_shared_write(n.children()[0]))
+                    {
+                        _valid = false;
+                        return;
+                    }
+                }
+                else if (n.is<Nodecl::FunctionCall>())
+                {
+                    check_call_arguments(
+                            n.as<Nodecl::FunctionCall>().get_called(),
+                            n.as<Nodecl::FunctionCall>().get_arguments());
+                }
+                else if (n.is<Nodecl::VirtualFunctionCall>())
+                {
+                    check_call_arguments(
+                            n.as<Nodecl::VirtualFunctionCall>().get_called(),
+                            n.as<Nodecl::VirtualFunctionCall>().get_arguments());
+                }
+                else if (n.is<Nodecl::ObjectInit>())
+                {
+                    // A reference bound to a private variable may be used
+                    // later to modify it
+                    TL::Symbol sym = n.get_symbol();
+                    if (sym.get_type().is_any_reference()
+                            && !sym.get_type().no_ref().is_const()
+                            && is_non_shared_write(sym.get_value()))
+                    {
+                        _valid = false;
+                        return;
+                    }
+                    walk(sym.get_value());
+                }
+
+                Nodecl::NodeclBase::Children children = n.children();
+                for (Nodecl::NodeclBase::Children::iterator it = children.begin();
+                        it != children.end();
+                        it++)
+                {
+                    walk(*it);
+                }
+            }
+        };
+    }
+
+    bool expression_has_side_effects(Nodecl::NodeclBase n)
+    {
+        if (n.is_null())
+            return false;
+
+        if (n.is<Nodecl::FunctionCall>()
+                || n.is<Nodecl::VirtualFunctionCall>()
+                || Nodecl::Utils::nodecl_is_assignment_op(n)
+                || n.is<Nodecl::Preincrement>()
+                || n.is<Nodecl::Postincrement>()
+                || n.is<Nodecl::Predecrement>()
+                || n.is<Nodecl::Postdecrement>())
+            return true;
+
+        Nodecl::NodeclBase::Children children = n.children();
+        for (Nodecl::NodeclBase::Children::iterator it = children.begin();
+                it != children.end();
+                it++)
+        {
+            if (expression_has_side_effects(*it))
+                return true;
+        }
+        return false;
+    }
+
+    bool task_can_be_inlined_when_undeferred(
+            Nodecl::NodeclBase environment,
+            Nodecl::NodeclBase statements,
+            // Out
+            Nodecl::NodeclBase& if_condition)
+    {
+        if_condition = Nodecl::NodeclBase::null();
+
+        if (IS_FORTRAN_LANGUAGE)
+            return false;
+
+        TL::ObjectList<TL::Symbol> non_shared;
+        Nodecl::List env = environment.as<Nodecl::List>();
+        for (Nodecl::List::iterator it = env.begin(); it != env.end(); it++)
+        {
+            if (it->is<Nodecl::OpenMP::If>())
+            {
+                if_condition = it->as<Nodecl::OpenMP::If>().get_condition();
+            }
+            else if (it->is<Nodecl::OpenMP::Firstprivate>())
+            {
+                non_shared.append(
+                        it->as<Nodecl::OpenMP::Firstprivate>().get_symbols()
+                        .as<Nodecl::List>().to_object_list()
+                        .map<TL::Symbol>(&Nodecl::NodeclBase::get_symbol));
+            }
+            else if (it->is<Nodecl::OpenMP::Private>())
+            {
+                non_shared.append(
+                        it->as<Nodecl::OpenMP::Private>().get_symbols()
+                        .as<Nodecl::List>().to_object_list()
+                        .map<TL::Symbol>(&Nodecl::NodeclBase::get_symbol));
+            }
+            else if (!it->is<Nodecl::OpenMP::Shared>()
+                    && !it->is<Nodecl::OpenMP::Final>()
+                    && !it->is<Nodecl::OpenMP::Priority>()
+                    && !it->is<Nodecl::OpenMP::Untied>()
+                    && !it->is<Nodecl::OpenMP::FunctionTaskParsingContext>()
+                    && !it->is<Nodecl::OmpSs::TaskLabel>()
+                    && !it->is<Nodecl::OmpSs::Cost>())
+            {
+                // Dependences, reductions, copies, devices, etc. need
+                // the runtime even if the task is undeferred
+                return false;
+            }
+        }
+
+        if (if_condition.is_null()
+                || expression_has_side_effects(if_condition))
+            return false;
+
+        // The copy constructors and destructors of the privatized objects
+        // would be lost
+        for (TL::ObjectList<TL::Symbol>::iterator it = non_shared.begin();
+                it != non_shared.end();
+                it++)
+        {
+            TL::Type t = it->get_type().no_ref();
+            while (t.is_array())
+                t = t.array_element();
+
+            if (IS_CXX_LANGUAGE && t.is_class())
+                return false;
+        }
+
+        // The body is executed in the context of its creator without
+        // privatizing anything
+        NonSharedWritesChecker checker(non_shared, /* reject_directives */ true);
+        checker.walk(statements);
+        return checker._valid;
+    }
+
+    bool statements_may_modify_symbols(
+            Nodecl::NodeclBase statements,
+            const TL::ObjectList<TL::Symbol>& symbols)
+    {
+        NonSharedWritesChecker checker(symbols, /* reject_directives */ false);
+        checker.walk(statements);
+        return !checker._valid;
+    }
+
+namespace Fortran {
 
     Nodecl::NodeclBase get_lower_bound(Nodecl::NodeclBase expr, int dimension_num)
     {
@@ -129,5 +446,6 @@ namespace TL { namespace Lowering { namespace Utils { namespace Fortran {
 
         return n;
     }
-} } } }
+}
 
+} } }
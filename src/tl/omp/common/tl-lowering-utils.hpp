@@ -35,6 +35,25 @@
 
 namespace TL { namespace Lowering { namespace Utils {
 
+    // Returns true if evaluating 'n' may call a function or modify a variable
+    bool expression_has_side_effects(Nodecl::NodeclBase n);
+
+    // Returns true if the statements of a task with the given environment
+    // can be executed directly by its creator when the 'if' clause is
+    // false, skipping the runtime. 'if_condition' is set to the expression
+    // of that clause
+    bool task_can_be_inlined_when_undeferred(
+            Nodecl::NodeclBase environment,
+            Nodecl::NodeclBase statements,
+            // Out
+            Nodecl::NodeclBase& if_condition);
+
+    // Returns true if 'statements' may modify any of 'symbols', either
+    // directly or through a reference or a pointer to them
+    bool statements_may_modify_symbols(
+            Nodecl::NodeclBase statements,
+            const TL::ObjectList<TL::Symbol>& symbols);
+
     namespace Fortran
     {
         //FIXME: ADD DESCRIPTIONS!
@@ -2660,6 +2660,7 @@ namespace TL { namespace OpenMP {
         EMPTY_HANDLERS_DIRECTIVE(register)
         EMPTY_HANDLERS_DIRECTIVE(unregister)
         EMPTY_HANDLERS_DIRECTIVE(taskyield)
+        EMPTY_HANDLERS_DIRECTIVE(ordered_depend)
 
         UNIMPLEMENTED_HANDLER_STATEMENT(ordered)
 
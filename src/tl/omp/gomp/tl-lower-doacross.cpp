@@ -0,0 +1,162 @@
+
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2015 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+#include "tl-counters.hpp"
+#include "tl-lowering-visitor.hpp"
+#include "tl-lowering-utils.hpp"
+#include "cxx-diagnostic.h"
+
+
+namespace TL { namespace GOMP {
+
+TL::Source LoweringVisitor::doacross_iteration(const DoacrossLoop& loop,
+        Nodecl::NodeclBase value)
+{
+    Source result;
+    result
+        << "(((long)(" << as_expression(value.shallow_copy()) << ")"
+        << " - (long)(" << as_expression(loop.lower.shallow_copy()) << "))"
+        << " / (long)(" << as_expression(loop.step.shallow_copy()) << "))"
+        ;
+    return result;
+}
+
+void LoweringVisitor::visit(const Nodecl::OpenMP::DoacrossWait& construct)
+{
+    if (_doacross_nests.empty()
+            || _doacross_nests.back().empty())
+    {
+        error_printf_at(construct.get_locus(),
+                "'ordered depend' must be closely nested in a loop with an 'ordered(n)' clause\n");
+        return;
+    }
+
+    const TL::ObjectList<DoacrossLoop> &nest = _doacross_nests.back();
+
+    Source wait_code;
+    wait_code << "{";
+
+    Nodecl::List sinks = construct.get_sinks().as<Nodecl::List>();
+    for (Nodecl::List::iterator it = sinks.begin(); it != sinks.end(); it++)
+    {
+        Nodecl::List iteration =
+            it->as<Nodecl::OpenMP::DoacrossSink>().get_iteration().as<Nodecl::List>();
+        if (iteration.size() != nest.size())
+        {
+            error_printf_at(it->get_locus(),
+                    "the sink vector has %d elements but the doacross nest has %d loops\n",
+                    (int)iteration.size(), (int)nest.size());
+            continue;
+        }
+
+        // Sink iterations outside the iteration space, or not reached by the
+        // step of the loop, are not waited for
+        Source in_iteration_space, logical_iterations;
+        for (int i = 0; i < (int)nest.size(); i++)
+        {
+            const DoacrossLoop &loop = nest[i];
+            Nodecl::NodeclBase value = iteration[i];
+
+            if (i > 0)
+            {
+                in_iteration_space << " && ";
+                logical_iterations << ", ";
+            }
+
+            in_iteration_space
+                << "((" << as_expression(loop.step.shallow_copy()) << ") > 0"
+                << " ? ((" << as_expression(value.shallow_copy()) << ") >= (" << as_expression(loop.lower.shallow_copy()) << ")"
+                <<    " && (" << as_expression(value.shallow_copy()) << ") <= (" << as_expression(loop.upper.shallow_copy()) << "))"
+                << " : ((" << as_expression(value.shallow_copy()) << ") <= (" << as_expression(loop.lower.shallow_copy()) << ")"
+                <<    " && (" << as_expression(value.shallow_copy()) << ") >= (" << as_expression(loop.upper.shallow_copy()) << ")))"
+                << " && ((long)(" << as_expression(value.shallow_copy()) << ")"
+                <<    " - (long)(" << as_expression(loop.lower.shallow_copy()) << "))"
+                <<    " % (long)(" << as_expression(loop.step.shallow_copy()) << ") == 0"
+                ;
+
+            logical_iterations << doacross_iteration(loop, value);
+        }
+
+        wait_code
+            << "if (" << in_iteration_space << ")"
+            <<     "GOMP_doacross_wait(" << logical_iterations << ");"
+            ;
+    }
+
+    wait_code << "}";
+
+    construct.replace(wait_code.parse_statement(construct));
+}
+
+void LoweringVisitor::visit(const Nodecl::OpenMP::DoacrossPost& construct)
+{
+    if (_doacross_nests.empty()
+            || _doacross_nests.back().empty())
+    {
+        error_printf_at(construct.get_locus(),
+                "'ordered depend' must be closely nested in a loop with an 'ordered(n)' clause\n");
+        return;
+    }
+
+    const TL::ObjectList<DoacrossLoop> &nest = _doacross_nests.back();
+
+    std::string post_iteration_name;
+    {
+        TL::Counter &c = TL::CounterManager::get_counter("gomp-omp-doacross");
+
+        std::stringstream ss;
+        ss << "gomp_doacross_iter_" << (int)c;
+        post_iteration_name = ss.str();
+
+        c++;
+    }
+
+    Source post_code;
+    post_code
+        << "{"
+        << "long " << post_iteration_name << "[" << nest.size() << "];"
+        ;
+
+    for (int i = 0; i < (int)nest.size(); i++)
+    {
+        post_code
+            << post_iteration_name << "[" << i << "] = "
+            << doacross_iteration(nest[i], nest[i].induction_var.make_nodecl(/* set_ref_type */ true))
+            << ";"
+            ;
+    }
+
+    post_code
+        << "GOMP_doacross_post(" << post_iteration_name << ");"
+        << "}"
+        ;
+
+    construct.replace(post_code.parse_statement(construct));
+}
+
+} }
@@ -27,15 +27,47 @@
 
 #include "tl-lowering-visitor.hpp"
 #include "tl-lowering-utils.hpp"
+#include "tl-lowering-loop-utils.hpp"
 
 #include "tl-lower-reductions.hpp"
 
 #include "tl-counters.hpp"
 
 #include "cxx-diagnostic.h"
+#include "cxx-cexpr.h"
 
 namespace TL { namespace GOMP {
 
+namespace {
+    // Returns the loop that is the only statement of 'n', if any
+    Nodecl::NodeclBase get_single_nested_loop(Nodecl::NodeclBase n)
+    {
+        while (!n.is_null() && !n.is<Nodecl::ForStatement>())
+        {
+            if (n.is<Nodecl::List>())
+            {
+                Nodecl::List l = n.as<Nodecl::List>();
+                if (l.size() != 1)
+                    return Nodecl::NodeclBase::null();
+                n = l.front();
+            }
+            else if (n.is<Nodecl::Context>())
+            {
+                n = n.as<Nodecl::Context>().get_in_context();
+            }
+            else if (n.is<Nodecl::CompoundStatement>())
+            {
+                n = n.as<Nodecl::CompoundStatement>().get_statements();
+            }
+            else
+            {
+                return Nodecl::NodeclBase::null();
+            }
+        }
+        return n;
+    }
+}
+
 void LoweringVisitor::visit(const Nodecl::OpenMP::For& construct)
 {
     lower_for(construct, Nodecl::NodeclBase::null(),
@@ -62,8 +94,49 @@ void LoweringVisitor::lower_for(const Nodecl::OpenMP::For& construct,
     Nodecl::OpenMP::Schedule schedule = environment.find_first<Nodecl::OpenMP::Schedule>();
     ERROR_CONDITION(schedule.is_null(), "Schedule tree is missing", 0);
 
+    // The loops of a doacross nest are all associated to the construct but
+    // only the outermost one is distributed
+    TL::ObjectList<DoacrossLoop> doacross_nest;
+    TL::ObjectList<TL::Symbol> doacross_private_symbols;
+    Nodecl::OpenMP::DoacrossLoops doacross_loops =
+        environment.find_first<Nodecl::OpenMP::DoacrossLoops>();
+    if (!doacross_loops.is_null())
+    {
+        int num_loops = const_value_cast_to_signed_int(
+                doacross_loops.get_num_loops().get_constant());
+
+        Nodecl::NodeclBase current_loop = for_statement;
+        for (int i = 0; i < num_loops; i++)
+        {
+            if (current_loop.is_null()
+                    || !TL::ForStatement(current_loop.as<Nodecl::ForStatement>()).is_omp_valid_loop())
+            {
+                fatal_printf_at(construct.get_locus(),
+                        "'ordered(%d)' requires %d perfectly nested canonical loops\n",
+                        num_loops, num_loops);
+            }
+
+            TL::ForStatement current_for(current_loop.as<Nodecl::ForStatement>());
+
+            DoacrossLoop loop;
+            loop.induction_var = current_for.get_induction_variable();
+            loop.lower = current_for.get_lower_bound();
+            loop.upper = current_for.get_upper_bound();
+            loop.step = current_for.get_step();
+            doacross_nest.append(loop);
+
+            // The induction variables of the inner loops are private too
+            if (i > 0 && !current_for.induction_variable_in_separate_scope())
+                doacross_private_symbols.insert(loop.induction_var);
+
+            current_loop = get_single_nested_loop(current_for.get_statement());
+        }
+    }
+
     Nodecl::NodeclBase statements = for_statement.get_statement();
+    _doacross_nests.push_back(doacross_nest);
     walk(statements);
+    _doacross_nests.pop_back();
     statements = for_statement.get_statement(); // Should not be necessary
 
     TL::ObjectList<Nodecl::OpenMP::Shared> shared_list =
@@ -168,6 +241,7 @@ void LoweringVisitor::lower_for(const Nodecl::OpenMP::For& construct,
     TL::Type induction_var_type = induction_var.get_type().no_ref();
 
     private_symbols.insert(induction_var);
+    private_symbols.insert(doacross_private_symbols);
 
     TL::Scope block_scope = stmt_placeholder.retrieve_context();
     for (TL::ObjectList<TL::Symbol>::iterator it = private_symbols.begin();
@@ -212,56 +286,22 @@ void LoweringVisitor::lower_for(const Nodecl::OpenMP::For& construct,
         }
     }
 
-    // TL::Symbol reduction_pack_symbol;
+    TL::ObjectList<ReductionPrivate> reduction_privates;
     if (!reduction_items.empty())
     {
-        fatal_printf_at(construct.get_locus(),
-                        "reductions not yet implemented");
-#if 0
-        TL::ObjectList<Symbol> reduction_symbols
-            = reduction_items
-                  .map<Nodecl::NodeclBase>(
-                       &Nodecl::OpenMP::ReductionItem::get_reduced_symbol)
-                  .map<TL::Symbol>(&Nodecl::NodeclBase::get_symbol);
-
-        TL::Symbol reduction_pack_type = declare_reduction_pack(reduction_symbols, construct);
-        reduction_pack_symbol = GOMP::new_private_symbol(
-                "red",
-                reduction_pack_type.get_user_defined_type(),
-                SK_VARIABLE,
-                block_scope);
-
-        // Initialize every member with the neuter
-        TL::ObjectList<TL::Symbol> fields = reduction_pack_symbol.get_type().get_fields();
-        TL::ObjectList<TL::Symbol>::iterator it_fields = fields.begin();
-        for (TL::ObjectList<Nodecl::OpenMP::ReductionItem>::iterator it = reduction_items.begin();
-                it != reduction_items.end();
-                it++, it_fields++)
-        {
-            Nodecl::OpenMP::ReductionItem &current(*it);
-
-            TL::Symbol reductor = current.get_reductor().get_symbol();
-            OpenMP::Reduction* omp_reduction = OpenMP::Reduction::get_reduction_info_from_symbol(reductor);
-
-            Source init_field;
-            init_field << as_symbol(reduction_pack_symbol) << "." << it_fields->get_name()
-                << " = " << as_expression(omp_reduction->get_initializer().shallow_copy()) << ";"
-                ;
-            Nodecl::NodeclBase init_field_tree = init_field.parse_statement(stmt_placeholder);
-            stmt_placeholder.prepend_sibling(init_field_tree);
-        }
-
-        CXX_LANGUAGE()
-        {
-            stmt_placeholder.prepend_sibling(
-                    Nodecl::CxxDef::make(
-                        /* context */ Nodecl::NodeclBase::null(),
-                        reduction_pack_symbol));
-        }
-#endif
+        reduction_privates = GOMP::privatize_reductions(
+                reduction_items, symbol_map, stmt_placeholder);
     }
 
-    Source static_init, lower, upper, step, chunk_size, istart, iend, not_done;
+    // Without a chunk, a static schedule gives each thread one contiguous
+    // block of iterations that can be computed without the runtime
+    bool inline_static_schedule = doacross_nest.empty()
+        && schedule.get_text() == "static"
+        && schedule.get_chunk().is_constant()
+        && const_value_is_zero(schedule.get_chunk().get_constant());
+
+    Source static_init, lower, upper, step, chunk_size, istart, iend, not_done,
+           num_iterations;
     lower << "lower_" << (int)private_num;
     upper << "upper_" << (int)private_num;
     step << "step_" << (int)private_num;
@@ -269,6 +309,7 @@ void LoweringVisitor::lower_for(const Nodecl::OpenMP::For& construct,
     istart << "istart_" << (int)private_num;
     iend << "iend_" << (int)private_num;
     not_done << "not_done_" << (int)private_num;
+    num_iterations << "num_iterations_" << (int)private_num;
     private_num++;
 
     Source common_initialization;
@@ -294,8 +335,16 @@ void LoweringVisitor::lower_for(const Nodecl::OpenMP::For& construct,
 
     if (!lastprivate_symbols.empty())
     {
-        lastprivate_code << "if (" << as_symbol(private_induction_var)
-                         << " == " << upper << ") {";
+        if (inline_static_schedule)
+        {
+            lastprivate_code << "if (" << istart << " < " << iend
+                             << " && " << iend << " == " << num_iterations << ") {";
+        }
+        else
+        {
+            lastprivate_code << "if (" << as_symbol(private_induction_var)
+                             << " == " << upper << ") {";
+        }
     }
 
     for (TL::ObjectList<TL::Symbol>::iterator it = lastprivate_symbols.begin();
@@ -344,7 +393,7 @@ void LoweringVisitor::lower_for(const Nodecl::OpenMP::For& construct,
         "runtime",
         std::make_pair("GOMP_loop_runtime_start", "GOMP_loop_runtime_next")));
 
-    Source loop_start, loop_next;
+    Source loop_next;
     schedule_map_t::iterator schedule_info
         = valid_schedules.find(schedule.get_text());
     if (schedule_info == valid_schedules.end())
@@ -357,102 +406,161 @@ void LoweringVisitor::lower_for(const Nodecl::OpenMP::For& construct,
     ERROR_CONDITION(
         schedule_info == valid_schedules.end(), "Invalid schedule", 0);
 
-    loop_start << schedule_info->second.first;
     loop_next << schedule_info->second.second;
 
-    Source sched_loop;
-    sched_loop << common_initialization << not_done << " = " << loop_start
-               << " (" << lower << ", 1 + (" << upper << "), " << step << ", "
-               << chunk_size << ", &" << istart << ", &" << iend << ");"
-               << "while (" << not_done << ") {"
-               << "for (" << as_symbol(private_induction_var) << " = " << istart
-               << "; " << as_symbol(private_induction_var) << " < " << iend
-               << ";" << as_symbol(private_induction_var) << "+=" << step << ")"
-               << "{" << statement_placeholder(loop_body) << "}" << not_done
-               << " = " << loop_next << "(&" << istart << ", &" << iend << ");"
-               << "}" << lastprivate_code
-               << statement_placeholder(reduction_code)
-               << statement_placeholder(barrier_code);
-
-    Nodecl::NodeclBase sched_loop_tree
-        = sched_loop.parse_statement(stmt_placeholder);
-    stmt_placeholder.prepend_sibling(sched_loop_tree);
-
-    TL::Symbol enclosing_function = Nodecl::Utils::get_enclosing_function(construct);
-    if (!reduction_items.empty())
+    Source loop_start_call, loop_iteration, iteration_setup;
+    if (inline_static_schedule)
     {
-        fatal_printf_at(construct.get_locus(),
-                        "reductions not yet implemented");
-#if 0
-        Source nowait;
-        if (barrier_at_end.is_null())
-        {
-            nowait << "_nowait";
-        }
+        // Same partition as GOMP_loop_static_start: the first threads get
+        // one more iteration when the threads do not divide the iterations
+        Source logical_iter, num_threads, thread_num, block, extra;
+        logical_iter << "iter_" << (int)private_num;
+        num_threads << "num_threads_" << (int)private_num;
+        thread_num << "thread_num_" << (int)private_num;
+        block << "block_" << (int)private_num;
+        extra << "extra_" << (int)private_num;
+        private_num++;
 
-        TL::Symbol callback = emit_callback_for_reduction(
-                _lowering->simd_reductions_knc(),
-                reduction_items,
-                reduction_pack_symbol.get_type(),
-                construct, enclosing_function);
+        common_initialization
+            << "long " << num_iterations << " = "
+            << TL::Lowering::Utils::loop_iteration_count(lower, upper, step) << ";"
+            << "long " << logical_iter << ";"
+            << "long " << num_threads << " = omp_get_num_threads();"
+            << "long " << thread_num << " = omp_get_thread_num();"
+            << "long " << block << " = " << num_iterations << " / " << num_threads << ";"
+            << "long " << extra << " = " << num_iterations << " % " << num_threads << ";"
+            << "if (" << thread_num << " < " << extra << ") {"
+            <<    block << "++;"
+            <<    extra << " = 0;"
+            << "}"
+            << istart << " = " << thread_num << " * " << block << " + " << extra << ";"
+            << iend << " = " << istart << " + " << block << ";";
+
+        loop_iteration
+            << "for (" << logical_iter << " = " << istart
+            << "; " << logical_iter << " < " << iend
+            << "; " << logical_iter << "++)";
+
+        iteration_setup
+            << as_symbol(private_induction_var) << " = "
+            << lower << " + " << logical_iter << " * " << step << ";";
+    }
+    else if (doacross_nest.empty())
+    {
+        loop_start_call
+            << schedule_info->second.first
+            << " (" << lower << ", 1 + (" << upper << "), " << step << ", "
+            << chunk_size << ", &" << istart << ", &" << iend << ")";
+
+        loop_iteration
+            << "for (" << as_symbol(private_induction_var) << " = " << istart
+            << "; " << as_symbol(private_induction_var) << " < " << iend
+            << ";" << as_symbol(private_induction_var) << "+=" << step << ")";
+    }
+    else
+    {
+        // The runtime tracks the dependences of a doacross loop using the
+        // logical iteration numbers of each loop of the nest
+        Source counts, logical_iter;
+        counts << "doacross_counts_" << (int)private_num;
+        logical_iter << "doacross_iter_" << (int)private_num;
+        private_num++;
 
-        if (callback.is_valid())
+        common_initialization
+            << "long " << counts << "[" << doacross_nest.size() << "];"
+            << "long " << logical_iter << ";";
+        for (int i = 0; i < (int)doacross_nest.size(); i++)
         {
-            Source master_combiner;
-            TL::ObjectList<TL::Symbol> reduction_fields = reduction_pack_symbol.get_type().get_fields();
-            TL::ObjectList<TL::Symbol>::iterator it_fields = reduction_fields.begin();
-            for (TL::ObjectList<Nodecl::OpenMP::ReductionItem>::iterator it = reduction_items.begin();
-                    it != reduction_items.end();
-                    it++, it_fields++)
+            // The bounds of the outermost loop are already evaluated, the
+            // ones of the inner loops are evaluated once here
+            Source nest_lower, nest_upper, nest_step;
+            if (i == 0)
+            {
+                nest_lower << lower;
+                nest_upper << upper;
+                nest_step << step;
+            }
+            else
             {
-                Nodecl::OpenMP::ReductionItem &current(*it);
-                TL::Symbol reduced_symbol = current.get_reduced_symbol().get_symbol();
-                TL::Symbol reductor = current.get_reductor().get_symbol();
-                OpenMP::Reduction* reduction = OpenMP::Reduction::get_reduction_info_from_symbol(reductor);
+                nest_lower << counts << "_lower_" << i;
+                nest_upper << counts << "_upper_" << i;
+                nest_step << counts << "_step_" << i;
+
+                common_initialization
+                    << "long " << nest_lower << " = "
+                    << as_expression(doacross_nest[i].lower.shallow_copy()) << ";"
+                    << "long " << nest_upper << " = "
+                    << as_expression(doacross_nest[i].upper.shallow_copy()) << ";"
+                    << "long " << nest_step << " = "
+                    << as_expression(doacross_nest[i].step.shallow_copy()) << ";";
+            }
 
-                Nodecl::NodeclBase combiner_expr = reduction->get_combiner().shallow_copy();
+            common_initialization
+                << counts << "[" << i << "] = "
+                << TL::Lowering::Utils::loop_iteration_count(nest_lower, nest_upper, nest_step) << ";";
+        }
 
-                ReplaceInOutMaster replace_inout(
-                        *it_fields,
-                        reduction->get_omp_in(), reduction_pack_symbol,
-                        reduction->get_omp_out(), reduced_symbol);
-                replace_inout.walk(combiner_expr);
+        // GOMP maps auto to static
+        std::string doacross_schedule = schedule_info->first;
+        if (doacross_schedule == "auto")
+            doacross_schedule = "static";
+
+        loop_start_call
+            << "GOMP_loop_doacross_" << doacross_schedule << "_start"
+            << " (" << doacross_nest.size() << ", " << counts << ", ";
+        if (doacross_schedule != "runtime")
+            loop_start_call << chunk_size << ", ";
+        loop_start_call << "&" << istart << ", &" << iend << ")";
+
+        loop_iteration
+            << "for (" << logical_iter << " = " << istart
+            << "; " << logical_iter << " < " << iend
+            << "; " << logical_iter << "++)";
+
+        iteration_setup
+            << as_symbol(private_induction_var) << " = "
+            << lower << " + " << logical_iter << " * " << step << ";";
+    }
 
-                master_combiner << as_expression(combiner_expr) << ";"
-                    ;
-            }
+    Source sched_loop;
+    if (inline_static_schedule)
+    {
+        sched_loop << common_initialization
+                   << loop_iteration
+                   << "{" << iteration_setup << statement_placeholder(loop_body) << "}"
+                   << lastprivate_code
+                   << statement_placeholder(reduction_code)
+                   << statement_placeholder(barrier_code);
+    }
+    else
+    {
+        sched_loop << common_initialization << not_done << " = " << loop_start_call << ";"
+                   << "while (" << not_done << ") {"
+                   << loop_iteration
+                   << "{" << iteration_setup << statement_placeholder(loop_body) << "}" << not_done
+                   << " = " << loop_next << "(&" << istart << ", &" << iend << ");"
+                   << "}" << lastprivate_code
+                   << statement_placeholder(reduction_code)
+                   << statement_placeholder(barrier_code);
+    }
 
-            Source reduction_src;
-            reduction_src
-                << "switch (__kmpc_reduce" << nowait << "(&" << as_symbol(ident_symbol)
-                <<               ", __kmpc_global_thread_num(&" << as_symbol(ident_symbol) << ")"
-                <<               ", " << reduction_items.size()
-                <<               ", sizeof(" << as_type(reduction_pack_symbol.get_type()) << ")"
-                <<               ", &" << as_symbol(reduction_pack_symbol)
-                <<               ", (void(*)(void*,void*))" << as_symbol(callback)
-                <<               ", &" << as_symbol(GOMP::get_global_lock_symbol(construct)) << "))"
-                << "{"
-                <<    "case 1:"
-                <<    "{"
-                <<       master_combiner
-                <<       "__kmpc_end_reduce" << nowait << "(&" << as_symbol(ident_symbol)
-                <<               ", __kmpc_global_thread_num(&" << as_symbol(ident_symbol) << ")"
-                <<               ", &" << as_symbol(GOMP::get_global_lock_symbol(construct)) << ");"
-                <<       "break;"
-                <<    "}"
-                <<    "case 0: break;"
-                <<    "default: __builtin_abort();"
-                << "}"
-                ;
+    Nodecl::NodeclBase sched_loop_tree
+        = sched_loop.parse_statement(stmt_placeholder);
+    stmt_placeholder.prepend_sibling(sched_loop_tree);
 
-            Nodecl::NodeclBase reduction_tree = reduction_src.parse_statement(stmt_placeholder);
-            reduction_code.prepend_sibling(reduction_tree);
-        }
-#endif
+    if (!reduction_items.empty())
+    {
+        GOMP::emit_reduction_combine(reduction_privates, reduction_code);
     }
 
     Source barrier_src;
-    if (barrier_at_end.is_null())
+    if (inline_static_schedule)
+    {
+        // No work share was started so there is nothing to release
+        if (!barrier_at_end.is_null())
+            barrier_src << "GOMP_barrier();";
+    }
+    else if (barrier_at_end.is_null())
     {
         barrier_src << "GOMP_loop_end_nowait();";
     }
@@ -460,7 +568,8 @@ void LoweringVisitor::lower_for(const Nodecl::OpenMP::For& construct,
     {
         barrier_src << "GOMP_loop_end();";
     }
-    barrier_code.replace(barrier_src.parse_statement(barrier_code));
+    if (!barrier_src.empty())
+        barrier_code.replace(barrier_src.parse_statement(barrier_code));
 
     Nodecl::NodeclBase new_statements = Nodecl::Utils::deep_copy(statements,
             loop_body, symbol_map);
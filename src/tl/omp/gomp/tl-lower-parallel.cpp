@@ -189,7 +189,6 @@ void LoweringVisitor::visit(const Nodecl::OpenMP::Parallel& construct)
             parameter_types);
 
     Nodecl::NodeclBase outline_function_code, outline_function_stmt;
-    Nodecl::List reduction_code_list;
     SymbolUtils::build_empty_body_for_function(outline_function,
             outline_function_code,
             outline_function_stmt);
@@ -280,10 +279,16 @@ void LoweringVisitor::visit(const Nodecl::OpenMP::Parallel& construct)
         }
     }
 
+    // Will override the shared reduced symbols
+    TL::ObjectList<GOMP::ReductionPrivate> reduction_privates =
+        GOMP::privatize_reductions(reduction_items, symbol_map, outline_function_stmt);
+
     Nodecl::NodeclBase parallel_body = Nodecl::Utils::deep_copy(statements,
             outline_function_stmt,
             symbol_map);
     outline_function_stmt.prepend_sibling(parallel_body);
+
+    GOMP::emit_reduction_combine(reduction_privates, outline_function_stmt);
     Nodecl::Utils::prepend_to_enclosing_top_level_location(construct, outline_function_code);
 
     // Spawn threads
@@ -26,552 +26,575 @@
 
 
 #include "tl-lower-reductions.hpp"
-#include "tl-symbol-utils.hpp"
+#include "tl-lowering-utils.hpp"
 #include "tl-nodecl-utils.hpp"
 #include "tl-counters.hpp"
 #include "cxx-diagnostic.h"
 #include "cxx-cexpr.h"
 
+#include <vector>
+
 namespace TL
 {
-    GOMP::ReplaceInOutMaster::ReplaceInOutMaster(
-            TL::Symbol field,
-            TL::Symbol orig_omp_in,  TL::Symbol reduction_pack_symbol,
-            TL::Symbol orig_omp_out, TL::Symbol reduced_symbol)
-        : _field(field),
-        _orig_omp_in(orig_omp_in), _reduction_pack_symbol(reduction_pack_symbol),
-        _orig_omp_out(orig_omp_out), _reduced_symbol(reduced_symbol)
-    { }
-
-    void GOMP::ReplaceInOutMaster::visit(const Nodecl::Symbol& node)
-    {
-        TL::Symbol sym = node.get_symbol();
+    namespace {
 
-        if (sym == _orig_omp_in)
-        {
-            Nodecl::NodeclBase class_member = 
-                Nodecl::ClassMemberAccess::make(
-                        _reduction_pack_symbol.make_nodecl(/* set_ref_type */ true, node.get_locus()),
-                        Nodecl::Symbol::make(_field, node.get_locus()),
-                        Nodecl::NodeclBase::null(),
-                        node.get_type(),
-                        node.get_locus());
-            node.replace(class_member);
-        }
-        else if (sym == _orig_omp_out)
+        // Replaces two of the special symbols of a reduction (omp_out and
+        // omp_in, or omp_priv and omp_orig) by arbitrary expressions
+        struct ReplaceReductionSymbols : Nodecl::ExhaustiveVisitor<void>
         {
-            Nodecl::NodeclBase reduced_sym_tree =
-                _reduced_symbol.make_nodecl(/* set_ref_type */ true, node.get_locus());
-            node.replace(reduced_sym_tree);
-        }
-    }
-
-    struct ReplaceInOut : Nodecl::ExhaustiveVisitor<void>
-    {
-        TL::Symbol _field;
-        TL::Symbol _orig_omp_in, _new_omp_in;
-        TL::Symbol _orig_omp_out, _new_omp_out;
-
-        ReplaceInOut(
-                TL::Symbol field,
-                TL::Symbol orig_omp_in,  TL::Symbol new_omp_in,
-                TL::Symbol orig_omp_out, TL::Symbol new_omp_out)
-            : _field(field),
-            _orig_omp_in(orig_omp_in), _new_omp_in(new_omp_in),
-            _orig_omp_out(orig_omp_out), _new_omp_out(new_omp_out)
-        { }
-
-        virtual void visit(const Nodecl::Symbol& node)
-        {
-            TL::Symbol sym = node.get_symbol();
-
-            TL::Symbol *new_symbol = NULL;
-
-            if (sym == _orig_omp_in)
-                new_symbol = &_new_omp_in;
-            else if (sym == _orig_omp_out)
-                new_symbol = &_new_omp_out;
-            else
-                return;
-
-            Nodecl::NodeclBase class_member = 
-                Nodecl::ClassMemberAccess::make(
-                        new_symbol->make_nodecl(/* set_ref_type */ true, node.get_locus()),
-                        Nodecl::Symbol::make(_field, node.get_locus()),
-                        Nodecl::NodeclBase::null(),
-                        node.get_type(),
-                        node.get_locus());
-
-            node.replace(class_member);
-        }
-    };
+            TL::Symbol _first_sym, _second_sym;
+            Nodecl::NodeclBase _first_expr, _second_expr;
 
-    TL::Symbol GOMP::emit_callback_for_reduction_scalar(
-            TL::ObjectList<Nodecl::OpenMP::ReductionItem> &reduction_items,
-            TL::Type reduction_pack_type,
-            Nodecl::NodeclBase location,
-            TL::Symbol current_function)
-    {
-        TL::ObjectList<std::string> parameter_names;
-        TL::ObjectList<TL::Type> parameter_types;
-
-        parameter_names.append("red_omp_out");
-        parameter_types.append(reduction_pack_type.get_lvalue_reference_to());
-
-        parameter_names.append("red_omp_in");
-        parameter_types.append(reduction_pack_type.get_lvalue_reference_to());
-
-        TL::Counter &counters = TL::CounterManager::get_counter("gomp-omp-reduction");
-        std::stringstream ss;
-        ss << "_red_" << (int)counters;
-        counters++;
-
-        TL::Symbol new_callback = SymbolUtils::new_function_symbol(
-                current_function,
-                ss.str(),
-                get_void_type(),
-                parameter_names,
-                parameter_types);
+            ReplaceReductionSymbols(
+                    TL::Symbol first_sym, Nodecl::NodeclBase first_expr,
+                    TL::Symbol second_sym, Nodecl::NodeclBase second_expr)
+                : _first_sym(first_sym), _second_sym(second_sym),
+                _first_expr(first_expr), _second_expr(second_expr)
+            { }
 
-        Nodecl::NodeclBase function_code, empty_stmt;
-
-        SymbolUtils::build_empty_body_for_function(
-                new_callback,
-                function_code,
-                empty_stmt);
+            virtual void visit(const Nodecl::Symbol& node)
+            {
+                TL::Symbol sym = node.get_symbol();
 
-        TL::Symbol red_omp_out = empty_stmt.retrieve_context().get_symbol_from_name("red_omp_out");
-        TL::Symbol red_omp_in = empty_stmt.retrieve_context().get_symbol_from_name("red_omp_in");
+                if (sym == _first_sym)
+                    node.replace(_first_expr.shallow_copy());
+                else if (sym == _second_sym)
+                    node.replace(_second_expr.shallow_copy());
+            }
+        };
 
-        TL::Source combiner;
-        TL::ObjectList<TL::Symbol> reduction_fields = reduction_pack_type.get_fields();
-        TL::ObjectList<TL::Symbol>::iterator it_fields = reduction_fields.begin();
-        for (TL::ObjectList<Nodecl::OpenMP::ReductionItem>::iterator it = reduction_items.begin();
-                it != reduction_items.end();
-                it++, it_fields++)
+        // Combiner of 'reduction' where omp_out and omp_in are 'out' and 'in'
+        Nodecl::NodeclBase make_combiner(OpenMP::Reduction* reduction,
+                Source out, Source in,
+                Nodecl::NodeclBase location)
         {
-            Nodecl::OpenMP::ReductionItem &current(*it);
-            TL::Symbol reductor = current.get_reductor().get_symbol();
-            OpenMP::Reduction* reduction = OpenMP::Reduction::get_reduction_info_from_symbol(reductor);
+            Nodecl::NodeclBase out_expr = out.parse_expression(location);
+            Nodecl::NodeclBase in_expr = in.parse_expression(location);
 
             Nodecl::NodeclBase combiner_expr = reduction->get_combiner().shallow_copy();
 
-            ReplaceInOut replace_inout(
-                    *it_fields,
-                    reduction->get_omp_in(), red_omp_in,
-                    reduction->get_omp_out(), red_omp_out);
+            ReplaceReductionSymbols replace_inout(
+                    reduction->get_omp_out(), out_expr,
+                    reduction->get_omp_in(), in_expr);
             replace_inout.walk(combiner_expr);
 
-            combiner << as_expression(combiner_expr) << ";"
-                ;
+            return Nodecl::ExpressionStatement::make(combiner_expr, location.get_locus());
         }
 
-        Nodecl::NodeclBase new_body_tree = combiner.parse_statement(empty_stmt);
-        empty_stmt.replace(new_body_tree);
+        // Identity of 'reduction' where omp_priv and omp_orig are 'priv' and
+        // 'orig'. When 'as_value' is true only the value assigned to omp_priv
+        // is returned, this requires an initializer of the form 'omp_priv = expr'
+        Nodecl::NodeclBase make_initializer(OpenMP::Reduction* reduction,
+                Source priv, Source orig,
+                bool as_value,
+                Nodecl::NodeclBase location)
+        {
+            Nodecl::NodeclBase priv_expr = priv.parse_expression(location);
+            Nodecl::NodeclBase orig_expr = orig.parse_expression(location);
 
-        Nodecl::Utils::prepend_to_enclosing_top_level_location(location, function_code);
+            Nodecl::NodeclBase initializer = reduction->get_initializer().shallow_copy();
+            if (!as_value
+                    && initializer.is<Nodecl::StructuredValue>())
+            {
+                Nodecl::StructuredValue structured_value = initializer.as<Nodecl::StructuredValue>();
+                if (structured_value.get_form().is<Nodecl::StructuredValueBracedImplicit>())
+                {
+                    structured_value.set_form(Nodecl::StructuredValueCompoundLiteral::make());
+                }
+            }
 
-        return new_callback;
-    }
+            ReplaceReductionSymbols replace_privorig(
+                    reduction->get_omp_priv(), priv_expr,
+                    reduction->get_omp_orig(), orig_expr);
+            replace_privorig.walk(initializer);
 
-    TL::Symbol GOMP::emit_callback_for_reduction(
-            bool simd_knc,
-            TL::ObjectList<Nodecl::OpenMP::ReductionItem> &reduction_items,
-            TL::Type reduction_pack_type,
-            Nodecl::NodeclBase location,
-            TL::Symbol current_function)
-    {
-        if (simd_knc)
-        {
-            if (reduction_items.size() != 1)
+            if (as_value)
+                return initializer;
+
+            if (reduction->get_is_initialization())
             {
-                error_printf_at(location.get_locus(),
-                        "SIMD reductions are implemented only for one variable at a time\n");
-                return TL::Symbol();
+                initializer = Nodecl::Assignment::make(
+                        priv_expr.shallow_copy(),
+                        initializer,
+                        priv_expr.get_type().no_ref(),
+                        location.get_locus());
             }
 
-            return emit_callback_for_reduction_simd_knc(
-                    reduction_items,
-                    reduction_pack_type,
-                    location,
-                    current_function);
+            return Nodecl::ExpressionStatement::make(initializer, location.get_locus());
         }
-        else
+
+        TL::Type reduction_element_type(TL::Type t)
         {
-            return emit_callback_for_reduction_scalar(
-                    reduction_items,
-                    reduction_pack_type,
-                    location,
-                    current_function);
+            t = t.no_ref();
+            while (t.is_array())
+                t = t.array_element();
+            return t;
         }
-    }
-
-    struct UpdateReductionUses : Nodecl::ExhaustiveVisitor<void>
-    {
-        TL::Symbol &_reduction_pack_symbol;
-        TL::ObjectList<TL::Symbol> &_reduction_symbols;
 
-        UpdateReductionUses(TL::Symbol &reduction_pack_symbol,
-                TL::ObjectList<TL::Symbol>& reduction_symbols)
-            : _reduction_pack_symbol(reduction_pack_symbol),
-            _reduction_symbols(reduction_symbols)
+        // Arrays are reduced element-wise, the elements are accessed
+        // through a flattened view of the whole array
+        Source array_element(Source base_address, TL::Type element_type, Source index)
         {
+            Source result;
+            result << "((" << as_type(element_type.get_pointer_to()) << ")" << base_address << ")"
+                << "[" << index << "]";
+            return result;
         }
 
-        virtual void visit(const Nodecl::Symbol &n)
+        Source array_num_elements(TL::Symbol array, TL::Type element_type)
         {
-            TL::Symbol sym = n.get_symbol();
-            if (!_reduction_symbols.contains(sym))
-                return;
-
-            TL::ObjectList<TL::Symbol> fields = _reduction_pack_symbol
-                .get_type()
-                .get_fields()
-                .find(sym, std::function<std::string(const TL::Symbol&)>(&TL::Symbol::get_name));
-
-            ERROR_CONDITION(fields.empty(), "Field '%s' not found", sym.get_name().c_str());
-            ERROR_CONDITION(fields.size() > 1, "Too many fields", 0);
-
-            TL::Symbol member_in_class = fields[0];
-
-            Nodecl::NodeclBase class_member_access =
-                Nodecl::ClassMemberAccess::make(
-                        _reduction_pack_symbol.make_nodecl(/* set_ref_type */ true, n.get_locus()),
-                        Nodecl::Symbol::make(member_in_class, n.get_locus()),
-                        Nodecl::NodeclBase::null(),
-                        n.get_type(),
-                        n.get_locus());
-
-            n.replace(class_member_access);
+            Source result;
+            result << "(long)(sizeof(" << as_symbol(array) << ") / sizeof(" << as_type(element_type) << "))";
+            return result;
         }
-    };
-
-    void GOMP::update_reduction_uses(Nodecl::NodeclBase node,
-            const TL::ObjectList<Nodecl::OpenMP::ReductionItem>& reduction_items,
-            TL::Symbol reduction_pack_symbol)
-    {
-        TL::ObjectList<Symbol> reduction_symbols = reduction_items
-            .map<Nodecl::NodeclBase>(&Nodecl::OpenMP::ReductionItem::get_reduced_symbol) // TL::ObjectList<Nodecl::NodeclBase>
-            .map<TL::Symbol>(&Nodecl::NodeclBase::get_symbol); // TL::ObjectList<TL::Symbol>
 
-        UpdateReductionUses update(reduction_pack_symbol, reduction_symbols);
-        update.walk(node);
-    }
-
-    TL::Symbol GOMP::declare_reduction_pack(const TL::ObjectList<TL::Symbol> &reduction_symbols,
-            Nodecl::NodeclBase location)
-    {
-        TL::Counter &private_num = TL::CounterManager::get_counter("gomp-omp-privates");
-        std::stringstream struct_name;
-        struct_name << "reduction_pack_" << (int)private_num;
-        private_num++;
-
-        Source struct_decl;
-        struct_decl << "struct " << struct_name.str() << " {";
-        for (TL::ObjectList<TL::Symbol>::const_iterator it = reduction_symbols.begin();
-                it != reduction_symbols.end();
-                it++)
+        std::string get_reduction_name(const std::string& prefix)
         {
-            struct_decl << as_type(it->get_type()) << " " << it->get_name() << ";";
-        }
+            TL::Counter &counters = TL::CounterManager::get_counter("gomp-omp-reduction");
+            std::stringstream ss;
+            ss << prefix << (int)counters;
+            counters++;
 
-        struct_decl << "};";
-        TL::Scope global_scope = CURRENT_COMPILED_FILE->global_decl_context;
-        Nodecl::NodeclBase decl = struct_decl.parse_declaration(global_scope);
+            return ss.str();
+        }
 
-        TL::Symbol result;
-        if (IS_CXX_LANGUAGE)
+        // Types whose reduction can be combined with atomic builtins
+        bool reduction_can_use_atomics(TL::Type t)
         {
-            Nodecl::Utils::prepend_to_enclosing_top_level_location(location, decl);
-            result = global_scope.get_symbol_from_name(struct_name.str());
+            t = t.no_ref();
+
+            return (t.is_integral_type()
+                    || t.is_floating_type()
+                    || t.is_pointer())
+                && t.get_size() <= 8;
         }
-        else
+
+        // Builtin that applies the combiner of 'reduction' as a single atomic
+        // read-modify-write or an empty string if there is none
+        std::string get_atomic_fetch_builtin(OpenMP::Reduction* reduction, TL::Type t)
         {
-            result = global_scope.get_symbol_from_name("struct " + struct_name.str());
-        }
+            t = t.no_ref();
+            if (!t.is_integral_type()
+                    || t.is_bool())
+                return "";
 
-        ERROR_CONDITION(!result.is_valid(), "Invalid symbol", 0);
-        ERROR_CONDITION(!result.is_class(), "Should be a class-name", 0);
+            Nodecl::NodeclBase combiner = reduction->get_combiner();
 
-        return result;
-    }
+            std::string builtin;
+            switch (combiner.get_kind())
+            {
+                case NODECL_ADD_ASSIGNMENT:
+                    builtin = "__atomic_fetch_add";
+                    break;
+                case NODECL_BITWISE_AND_ASSIGNMENT:
+                    builtin = "__atomic_fetch_and";
+                    break;
+                case NODECL_BITWISE_OR_ASSIGNMENT:
+                    builtin = "__atomic_fetch_or";
+                    break;
+                case NODECL_BITWISE_XOR_ASSIGNMENT:
+                    builtin = "__atomic_fetch_xor";
+                    break;
+                default:
+                    return "";
+            }
 
-    namespace {
+            // The left and right hand sides of every compound assignment
+            Nodecl::NodeclBase lhs = Nodecl::Utils::advance_conversions(combiner.children()[0]);
+            Nodecl::NodeclBase rhs = Nodecl::Utils::advance_conversions(combiner.children()[1]);
 
-        struct SIMDizeCombiner : Nodecl::NodeclVisitor<void>
-        {
-            TL::Symbol _field;
-            TL::Symbol _orig_omp_in, _new_omp_in;
-            TL::Symbol _orig_omp_out, _new_omp_out;
-            TL::Symbol _new_omp_mask;
+            if (!lhs.is<Nodecl::Symbol>()
+                    || lhs.get_symbol() != reduction->get_omp_out()
+                    || !rhs.is<Nodecl::Symbol>()
+                    || rhs.get_symbol() != reduction->get_omp_in())
+                return "";
 
-            ReplaceInOut * _replace_inout;
+            return builtin;
+        }
 
-            SIMDizeCombiner() : _replace_inout(NULL) { }
+        // Every thread adds its partial value to the shared storage without
+        // taking any lock: using a fetch-and-op builtin when the combiner is a
+        // plain compound assignment or a compare-and-swap loop otherwise.
+        // The memory order is relaxed (0) because the construct ends with a
+        // barrier or the partial values are not required to be visible yet
+        void emit_atomic_combine(const GOMP::ReductionPrivate& current,
+                Nodecl::NodeclBase location)
+        {
+            TL::Type type = current.private_.get_type().no_ref().get_unqualified_type();
 
-            void init(
-                    TL::Symbol field,
-                    TL::Symbol orig_omp_in,  TL::Symbol new_omp_in,
-                    TL::Symbol orig_omp_out, TL::Symbol new_omp_out,
-                                             TL::Symbol new_omp_mask)
+            std::string fetch_builtin = get_atomic_fetch_builtin(current.reduction, type);
+            if (!fetch_builtin.empty())
             {
-                _field = field;
-                _orig_omp_in = orig_omp_in;
-                _new_omp_in = new_omp_in;
-                _orig_omp_out = orig_omp_out;
-                _new_omp_out = new_omp_out;
-                _new_omp_mask = new_omp_mask;
-
-                delete _replace_inout;
-                _replace_inout = new ReplaceInOut(field,
-                        orig_omp_in, new_omp_in,
-                        orig_omp_out, new_omp_out);
-            }
+                Source atomic_src;
+                atomic_src
+                    << fetch_builtin << "(&" << as_symbol(current.shared) << ", "
+                    <<                          as_symbol(current.private_) << ", 0);"
+                    ;
 
-            virtual ~SIMDizeCombiner()
-            {
-                delete _replace_inout;
+                location.prepend_sibling(atomic_src.parse_statement(location));
+                return;
             }
 
-            TL::Type vector_type_of_scalar(TL::Type t)
-            {
-                t = t.no_ref().get_unqualified_type();
-                return t.get_vector_of_bytes(64);
-            }
+            std::string old_value = get_reduction_name("red_old_");
+            std::string new_value = get_reduction_name("red_new_");
+
+            Nodecl::NodeclBase combiner_placeholder;
+            Source atomic_src;
+            atomic_src
+                << "{"
+                <<    as_type(type) << " " << old_value << ";"
+                <<    as_type(type) << " " << new_value << ";"
+                <<    "__atomic_load(&" << as_symbol(current.shared) << ", &" << old_value << ", 0);"
+                <<    "do {"
+                <<        new_value << " = " << old_value << ";"
+                <<        statement_placeholder(combiner_placeholder)
+                <<    "} while (!__atomic_compare_exchange(&" << as_symbol(current.shared)
+                <<                     ", &" << old_value << ", &" << new_value << ", 0, 0, 0));"
+                << "}"
+                ;
 
-            private:
-                // Do not copy
-                SIMDizeCombiner(const SIMDizeCombiner&);
-                // Do not assign
-                SIMDizeCombiner& operator=(const SIMDizeCombiner&);
-        };
+            Nodecl::NodeclBase atomic_tree = atomic_src.parse_statement(location);
 
-        struct SIMDizeVerticalCombiner : SIMDizeCombiner
+            Source out, in;
+            out << new_value;
+            in << as_symbol(current.private_);
+            combiner_placeholder.replace(
+                    make_combiner(current.reduction, out, in, combiner_placeholder));
+
+            location.prepend_sibling(atomic_tree);
+        }
+
+        // Reductions that cannot be combined atomically publish the address
+        // of their private copy in a table of per-thread slots. Each thread
+        // owns a run of slots padded to a cache line so storing them does not
+        // cause false sharing. The table is allocated by one thread of the
+        // team and broadcast through GOMP_single_copy_{start,end}.
+        //
+        // Scalars are combined pairwise in a tree of log(P) steps, the thread
+        // 0 ends up holding the partial value of the team. Arrays are split
+        // in as many chunks as threads and every thread combines its chunk of
+        // all the private copies into the shared storage.
+        void emit_team_combine(
+                const TL::ObjectList<GOMP::ReductionPrivate>& tree_reductions,
+                const TL::ObjectList<GOMP::ReductionPrivate>& array_reductions,
+                Nodecl::NodeclBase location)
         {
-            virtual void visit(const Nodecl::ExpressionStatement& node)
-            {
-                walk(node.get_nest());
-            }
+            const int cache_line_size = 64;
+            const int pointer_size = TL::Type::get_void_type().get_pointer_to().get_size();
+            const int slots_per_line = cache_line_size / pointer_size;
+
+            const int num_slots = tree_reductions.size() + array_reductions.size();
+            const int slot_stride =
+                ((num_slots + slots_per_line - 1) / slots_per_line) * slots_per_line;
+
+            std::string nth = get_reduction_name("red_nth_");
+            std::string tid = get_reduction_name("red_tid_");
+            std::string memory = get_reduction_name("red_memory_");
+            std::string owner = get_reduction_name("red_owner_");
+            std::string slots = get_reduction_name("red_slots_");
+
+            TL::Type size_t_type = TL::Type::get_size_t_type();
+
+            Source team_src, publish_slots, tree_combine, array_combine;
+            team_src
+                << "{"
+                <<    "int " << nth << " = omp_get_num_threads();"
+                <<    "int " << tid << " = omp_get_thread_num();"
+                <<    "void* " << memory << " = GOMP_single_copy_start();"
+                <<    "int " << owner << " = (" << memory << " == 0);"
+                <<    "void** " << slots << ";"
+                <<    "if (" << owner << ")"
+                <<    "{"
+                           // One extra cache line to align the table
+                <<         memory << " = __builtin_malloc(sizeof(void*) * ("
+                <<                        nth << " * " << slot_stride << " + " << slots_per_line << "));"
+                <<         "GOMP_single_copy_end(" << memory << ");"
+                <<    "}"
+                <<    slots << " = (void**)((("
+                <<             as_type(size_t_type) << ")" << memory << " + " << (cache_line_size - 1) << ")"
+                <<             " & ~(" << as_type(size_t_type) << ")" << (cache_line_size - 1) << ");"
+                <<    publish_slots
+                <<    "GOMP_barrier();"
+                <<    tree_combine
+                <<    array_combine
+                <<    "if (" << owner << ")"
+                <<         "__builtin_free(" << memory << ");"
+                << "}"
+                ;
 
-            virtual void visit(const Nodecl::AddAssignment& node)
+            int current_slot = 0;
+            std::vector<Nodecl::NodeclBase> tree_placeholders(tree_reductions.size());
+            std::vector<Nodecl::NodeclBase> final_placeholders(tree_reductions.size());
+            std::string stride;
+            if (!tree_reductions.empty())
             {
-                _replace_inout->walk(node.get_lhs());
-                _replace_inout->walk(node.get_rhs());
-
-                Nodecl::NodeclBase vector_add = Nodecl::VectorAdd::make(
-                        Nodecl::VectorLoad::make(
-                            Nodecl::Reference::make(
-                                node.get_lhs().shallow_copy(),
-                                node.get_lhs().get_type().no_ref().get_pointer_to()),
-                            _new_omp_mask.make_nodecl(),
-                            Nodecl::List::make(
-                                Nodecl::AlignedFlag::make()),
-                            vector_type_of_scalar(node.get_lhs().get_type()).get_lvalue_reference_to()),
-                        Nodecl::VectorLoad::make(
-                            Nodecl::Reference::make(
-                                node.get_rhs().shallow_copy(),
-                                node.get_rhs().get_type().no_ref().get_pointer_to()),
-                            _new_omp_mask.make_nodecl(),
-                            Nodecl::List::make(
-                                Nodecl::AlignedFlag::make()),
-                            vector_type_of_scalar(node.get_rhs().get_type()).get_lvalue_reference_to()),
-                        _new_omp_mask.make_nodecl(),
-                        vector_type_of_scalar(node.get_type()));
-
-                Nodecl::NodeclBase vector_store = Nodecl::VectorStore::make(
-                        Nodecl::Reference::make(
-                            node.get_lhs().shallow_copy(),
-                            vector_type_of_scalar(node.get_type()).get_pointer_to()),
-                        vector_add,
-                        _new_omp_mask.make_nodecl(),
-                        Nodecl::List::make(
-                            Nodecl::AlignedFlag::make()),
-                        vector_type_of_scalar(node.get_type()));
-
-                node.replace(vector_store);
-            }
+                stride = get_reduction_name("red_stride_");
+
+                Source tree_step, final_step;
+                tree_combine
+                    << "{"
+                    <<    "int " << stride << ";"
+                    <<    "for (" << stride << " = 1; " << stride << " < " << nth << "; " << stride << " *= 2)"
+                    <<    "{"
+                    <<        "if (" << tid << " % (2 * " << stride << ") == 0"
+                    <<                " && " << tid << " + " << stride << " < " << nth << ")"
+                    <<        "{"
+                    <<            tree_step
+                    <<        "}"
+                    <<        "GOMP_barrier();"
+                    <<    "}"
+                    <<    "if (" << tid << " == 0)"
+                    <<    "{"
+                    <<        final_step
+                    <<    "}"
+                    << "}"
+                    ;
 
-            virtual void unhandled_node(const Nodecl::NodeclBase& n)
-            {
-                internal_error("Unhandled node '%s'\n", ast_print_node_type(n.get_kind()));
+                for (unsigned int i = 0; i < tree_reductions.size(); i++, current_slot++)
+                {
+                    publish_slots
+                        << slots << "[" << tid << " * " << slot_stride << " + " << current_slot << "]"
+                        << " = (void*)&" << as_symbol(tree_reductions[i].private_) << ";"
+                        ;
+
+                    tree_step << statement_placeholder(tree_placeholders[i]);
+                    final_step << statement_placeholder(final_placeholders[i]);
+                }
             }
-        };
 
-        struct SIMDizeHorizontalCombiner : SIMDizeCombiner
-        {
-#if 0
-            virtual void visit(const Nodecl::ExpressionStatement& node)
+            std::vector<Nodecl::NodeclBase> array_placeholders(array_reductions.size());
+            std::string thread_index, element_index;
+            if (!array_reductions.empty())
             {
-                walk(node.get_nest());
+                thread_index = get_reduction_name("red_j_");
+                element_index = get_reduction_name("red_k_");
+                std::string lower = get_reduction_name("red_lower_");
+                std::string upper = get_reduction_name("red_upper_");
+
+                array_combine
+                    << "{"
+                    <<    "long " << thread_index << ", " << element_index << ", "
+                    <<            lower << ", " << upper << ";"
+                    ;
+
+                for (unsigned int i = 0; i < array_reductions.size(); i++, current_slot++)
+                {
+                    TL::Symbol private_array = array_reductions[i].private_;
+                    TL::Type element_type = reduction_element_type(private_array.get_type());
+                    Source num_elements = array_num_elements(private_array, element_type);
+
+                    publish_slots
+                        << slots << "[" << tid << " * " << slot_stride << " + " << current_slot << "]"
+                        << " = (void*)&" << as_symbol(private_array) << ";"
+                        ;
+
+                    array_combine
+                        << lower << " = " << num_elements << " * " << tid << " / " << nth << ";"
+                        << upper << " = " << num_elements << " * (" << tid << " + 1) / " << nth << ";"
+                        << "for (" << thread_index << " = 0; " << thread_index << " < " << nth << "; "
+                        <<                                     thread_index << "++)"
+                        << "for (" << element_index << " = " << lower << "; "
+                        <<            element_index << " < " << upper << "; " << element_index << "++)"
+                        << "{"
+                        <<     statement_placeholder(array_placeholders[i])
+                        << "}"
+                        ;
+                }
+
+                array_combine
+                    // The private copies must outlive the combination of every chunk
+                    <<    "GOMP_barrier();"
+                    << "}"
+                    ;
             }
 
-            virtual void visit(const Nodecl::AddAssignment& node)
+            Nodecl::NodeclBase team_tree = team_src.parse_statement(location);
+
+            current_slot = 0;
+            for (unsigned int i = 0; i < tree_reductions.size(); i++, current_slot++)
             {
-                _replace_inout->walk(node.get_lhs());
-                _replace_inout->walk(node.get_rhs());
-
-                Nodecl::NodeclBase vector_reduction_add =
-                    Nodecl::VectorReductionAdd::make(
-                            node.get_lhs().shallow_copy(),
-                            Nodecl::VectorLoad::make(
-                                Nodecl::Reference::make(
-                                    node.get_rhs().shallow_copy(),
-                                    node.get_rhs().get_type().no_ref().get_pointer_to()),
-                                _new_omp_mask.make_nodecl(),
-                                Nodecl::List::make(
-                                    Nodecl::AlignedFlag::make()),
-                                vector_type_of_scalar(node.get_rhs().get_type()).get_lvalue_reference_to()),
-                            _new_omp_mask.make_nodecl(),
-                            node.get_type());
-
-                node.replace(vector_reduction_add);
+                const GOMP::ReductionPrivate& current = tree_reductions[i];
+                TL::Type type = current.private_.get_type().no_ref();
+
+                // omp_out = own partial value, omp_in = partial value of the partner
+                Source private_value, partner_value;
+                private_value << as_symbol(current.private_);
+                partner_value
+                    << "(*(" << as_type(type.get_pointer_to()) << ")"
+                    << slots << "[(" << tid << " + " << stride << ") * " << slot_stride
+                    <<          " + " << current_slot << "])"
+                    ;
+                tree_placeholders[i].replace(
+                        make_combiner(current.reduction,
+                            private_value, partner_value,
+                            tree_placeholders[i]));
+
+                // omp_out = shared storage, omp_in = partial value of the team
+                Source shared_value, team_value;
+                shared_value << as_symbol(current.shared);
+                team_value << as_symbol(current.private_);
+                final_placeholders[i].replace(
+                        make_combiner(current.reduction,
+                            shared_value, team_value,
+                            final_placeholders[i]));
             }
-#endif
 
-            virtual void unhandled_node(const Nodecl::NodeclBase& n)
+            for (unsigned int i = 0; i < array_reductions.size(); i++, current_slot++)
             {
-                internal_error("Unhandled node '%s'\n", ast_print_node_type(n.get_kind()));
+                const GOMP::ReductionPrivate& current = array_reductions[i];
+                TL::Type element_type = reduction_element_type(current.private_.get_type());
+
+                // omp_out = element of the shared array,
+                // omp_in = element of the private copy of a thread
+                Source shared_address, private_address;
+                shared_address << "&" << as_symbol(current.shared);
+                private_address
+                    << slots << "[" << thread_index << " * " << slot_stride << " + " << current_slot << "]";
+
+                array_placeholders[i].replace(
+                        make_combiner(current.reduction,
+                            array_element(shared_address, element_type, element_index),
+                            array_element(private_address, element_type, element_index),
+                            array_placeholders[i]));
             }
-        };
-
-        TL::Symbol generate_simd_combiner_knc(SIMDizeCombiner &simdizer,
-                TL::ObjectList<Nodecl::OpenMP::ReductionItem> &reduction_items,
-                TL::Type reduction_pack_type,
-                Nodecl::NodeclBase location,
-                TL::Symbol current_function)
-        {
-            TL::ObjectList<std::string> parameter_names;
-            TL::ObjectList<TL::Type> parameter_types;
 
-            parameter_names.append("red_omp_out");
-            parameter_types.append(reduction_pack_type.get_lvalue_reference_to());
-
-            parameter_names.append("red_omp_in");
-            parameter_types.append(reduction_pack_type.get_lvalue_reference_to());
-
-            TL::Symbol mmask_16_typedef = current_function.get_scope().get_symbol_from_name("__mmask16");
-            ERROR_CONDITION(!mmask_16_typedef.is_valid(), "__mmask16 not found in the scope", 0);
+            location.prepend_sibling(team_tree);
+        }
+    }
 
-            parameter_names.append("red_omp_mask");
-            parameter_types.append(mmask_16_typedef.get_user_defined_type());
+    TL::ObjectList<GOMP::ReductionPrivate> GOMP::privatize_reductions(
+            const TL::ObjectList<Nodecl::OpenMP::ReductionItem> &reduction_items,
+            Nodecl::Utils::SimpleSymbolMap &symbol_map,
+            Nodecl::NodeclBase location)
+    {
+        TL::ObjectList<ReductionPrivate> result;
 
-            TL::Counter &counters = TL::CounterManager::get_counter("gomp-omp-reduction");
-            std::stringstream ss;
-            ss << "_red_" << (int)counters;
-            counters++;
+        TL::Scope private_scope = location.retrieve_context();
+        for (TL::ObjectList<Nodecl::OpenMP::ReductionItem>::const_iterator it = reduction_items.begin();
+                it != reduction_items.end();
+                it++)
+        {
+            Nodecl::OpenMP::ReductionItem current_item(*it);
+            TL::Symbol reduced_symbol = current_item.get_reduced_symbol().get_symbol();
+            TL::Symbol reductor = current_item.get_reductor().get_symbol();
+
+            ReductionPrivate current;
+            current.reduction = OpenMP::Reduction::get_reduction_info_from_symbol(reductor);
+            current.shared = symbol_map.map(reduced_symbol);
+            current.private_ = GOMP::new_private_symbol(
+                    reduced_symbol.get_name(),
+                    reduced_symbol.get_type().no_ref(),
+                    SK_VARIABLE,
+                    private_scope);
+
+            // VLA sizes may have been remapped
+            current.private_.get_internal_symbol()->type_information = ::type_deep_copy(
+                    current.private_.get_internal_symbol()->type_information,
+                    private_scope.get_decl_context(),
+                    symbol_map.get_symbol_map());
+
+            CXX_LANGUAGE()
+            {
+                location.prepend_sibling(
+                        Nodecl::CxxDef::make(
+                            /* context */ Nodecl::NodeclBase::null(),
+                            current.private_));
+            }
 
-            TL::Symbol new_callback = SymbolUtils::new_function_symbol(
-                    current_function,
-                    ss.str(),
-                    get_void_type(),
-                    parameter_names,
-                    parameter_types);
-
-            Nodecl::NodeclBase function_code, empty_stmt;
-
-            SymbolUtils::build_empty_body_for_function(
-                    new_callback,
-                    function_code,
-                    empty_stmt);
-
-            TL::Symbol red_omp_out = empty_stmt.retrieve_context().get_symbol_from_name("red_omp_out");
-            TL::Symbol red_omp_in = empty_stmt.retrieve_context().get_symbol_from_name("red_omp_in");
-            TL::Symbol red_omp_mask = empty_stmt.retrieve_context().get_symbol_from_name("red_omp_mask");
-
-            TL::Source combiner;
-            TL::ObjectList<TL::Symbol> reduction_fields = reduction_pack_type.get_fields();
-            TL::ObjectList<TL::Symbol>::iterator it_fields = reduction_fields.begin();
-            for (TL::ObjectList<Nodecl::OpenMP::ReductionItem>::iterator it = reduction_items.begin();
-                    it != reduction_items.end();
-                    it++, it_fields++)
+            TL::Type private_type = current.private_.get_type();
+            if (private_type.is_array())
             {
-                Nodecl::OpenMP::ReductionItem &current(*it);
-                TL::Symbol reductor = current.get_reductor().get_symbol();
-                OpenMP::Reduction* reduction = OpenMP::Reduction::get_reduction_info_from_symbol(reductor);
+                TL::Type element_type = reduction_element_type(private_type);
+                std::string element_index = get_reduction_name("red_k_");
+
+                Nodecl::NodeclBase init_placeholder;
+                Source init_array;
+                init_array
+                    << "{"
+                    <<    "long " << element_index << ";"
+                    <<    "for (" << element_index << " = 0; "
+                    <<               element_index << " < " << array_num_elements(current.private_, element_type) << "; "
+                    <<               element_index << "++)"
+                    <<    "{"
+                    <<        statement_placeholder(init_placeholder)
+                    <<    "}"
+                    << "}"
+                    ;
 
-                Nodecl::NodeclBase combiner_expr = reduction->get_combiner().shallow_copy();
+                Nodecl::NodeclBase init_array_tree = init_array.parse_statement(location);
 
-                simdizer.init(
-                        *it_fields,
-                        reduction->get_omp_in(), red_omp_in,
-                        reduction->get_omp_out(), red_omp_out,
-                        red_omp_mask);
-                simdizer.walk(combiner_expr);
+                Source private_address, shared_address;
+                private_address << "&" << as_symbol(current.private_);
+                shared_address << "&" << as_symbol(current.shared);
+                init_placeholder.replace(
+                        make_initializer(current.reduction,
+                            array_element(private_address, element_type, element_index),
+                            array_element(shared_address, element_type, element_index),
+                            /* as_value */ false,
+                            init_placeholder));
 
-                combiner << as_expression(combiner_expr) << ";"
-                    ;
+                location.prepend_sibling(init_array_tree);
+            }
+            else
+            {
+                Source private_value, shared_value;
+                private_value << as_symbol(current.private_);
+                shared_value << as_symbol(current.shared);
+
+                if (current.reduction->get_is_initialization())
+                {
+                    current.private_.set_value(
+                            make_initializer(current.reduction,
+                                private_value, shared_value,
+                                /* as_value */ true,
+                                location));
+                }
+                else
+                {
+                    location.prepend_sibling(
+                            make_initializer(current.reduction,
+                                private_value, shared_value,
+                                /* as_value */ false,
+                                location));
+                }
             }
 
-            Nodecl::NodeclBase new_body_tree = combiner.parse_statement(empty_stmt);
-            empty_stmt.replace(new_body_tree);
-
-            Nodecl::Utils::prepend_to_enclosing_top_level_location(location, function_code);
-
-            return new_callback;
+            symbol_map.add_map(reduced_symbol, current.private_);
+            result.append(current);
         }
+
+        return result;
     }
 
-    // SIMD - KNC
-    TL::Symbol GOMP::emit_callback_for_reduction_simd_knc(
-            TL::ObjectList<Nodecl::OpenMP::ReductionItem> &reduction_items,
-            TL::Type reduction_pack_type,
-            Nodecl::NodeclBase location,
-            TL::Symbol current_function)
+    void GOMP::emit_reduction_combine(
+            const TL::ObjectList<ReductionPrivate> &reductions,
+            Nodecl::NodeclBase location)
     {
-        SIMDizeVerticalCombiner vertical_simdizer;
-        TL::Symbol vertical_combiner = generate_simd_combiner_knc(
-                vertical_simdizer,
-                reduction_items, reduction_pack_type,
-                location, current_function);
-
-        SIMDizeHorizontalCombiner horizontal_simdizer;
-        TL::Symbol horizontal_combiner = generate_simd_combiner_knc(
-                horizontal_simdizer,
-                reduction_items, reduction_pack_type,
-                location, current_function);
-
-        TL::Counter &counters = TL::CounterManager::get_counter("gomp-omp-reduction");
-        std::stringstream ss;
-        ss << "_red_arr_" << (int)counters;
-        counters++;
-
-        TL::ObjectList<TL::Type> void_ptr_void_ptr;
-        void_ptr_void_ptr.append(TL::Type::get_void_type().get_pointer_to());
-        void_ptr_void_ptr.append(TL::Type::get_void_type().get_pointer_to());
-
-        TL::Type fun_type = TL::Type::get_void_type().
-            get_function_returning(void_ptr_void_ptr);
-
-        TL::Type ptr_fun_type = fun_type.get_pointer_to();
-        TL::Type array_2_ptr_fun_type = ptr_fun_type.get_array_to(
-                const_value_to_nodecl(const_value_get_signed_int(2)),
-                current_function.get_scope());
-
-        TL::Symbol array_of_pf = current_function.get_scope().new_symbol(ss.str());
-        array_of_pf.get_internal_symbol()->kind = SK_VARIABLE;
-        symbol_entity_specs_set_is_user_declared(array_of_pf.get_internal_symbol(), 1);
-        array_of_pf.set_type(array_2_ptr_fun_type);
-
-        Nodecl::NodeclBase cast1, cast2;
-        Nodecl::NodeclBase array_initializer =
-            Nodecl::StructuredValue::make(
-                    Nodecl::List::make(
-                        cast1 = Nodecl::Conversion::make(
-                            vertical_combiner.make_nodecl(),
-                            ptr_fun_type),
-                        cast2 = Nodecl::Conversion::make(
-                            horizontal_combiner.make_nodecl(),
-                            ptr_fun_type)),
-                    Nodecl::StructuredValueBracedImplicit::make(),
-                    array_of_pf.get_type());
-        cast1.set_text("C");
-        cast2.set_text("C");
-
-        array_of_pf.set_value(array_initializer);
-
-        Nodecl::NodeclBase object_init = Nodecl::ObjectInit::make(array_of_pf);
-        Nodecl::Utils::prepend_to_enclosing_top_level_location(location, object_init);
-
-        return array_of_pf;
+        TL::ObjectList<ReductionPrivate> tree_reductions;
+        TL::ObjectList<ReductionPrivate> array_reductions;
+        for (TL::ObjectList<ReductionPrivate>::const_iterator it = reductions.begin();
+                it != reductions.end();
+                it++)
+        {
+            TL::Type type = it->private_.get_type().no_ref();
+            if (type.is_array())
+            {
+                array_reductions.append(*it);
+            }
+            else if (reduction_can_use_atomics(type))
+            {
+                emit_atomic_combine(*it, location);
+            }
+            else
+            {
+                tree_reductions.append(*it);
+            }
+        }
+
+        if (!tree_reductions.empty()
+                || !array_reductions.empty())
+        {
+            emit_team_combine(tree_reductions, array_reductions, location);
+        }
     }
 }
@@ -32,46 +32,32 @@
 
 namespace TL { namespace GOMP {
 
-    TL::Symbol declare_reduction_pack(const TL::ObjectList<TL::Symbol> &sym,
-            Nodecl::NodeclBase location);
-
-    TL::Symbol emit_callback_for_reduction(
-            bool simd_reduction,
-            TL::ObjectList<Nodecl::OpenMP::ReductionItem> &reduction_items,
-            TL::Type reduction_pack_type,
-            Nodecl::NodeclBase location,
-            TL::Symbol current_function);
-
-    TL::Symbol emit_callback_for_reduction_scalar(
-            TL::ObjectList<Nodecl::OpenMP::ReductionItem> &reduction_items,
-            TL::Type reduction_pack_type,
-            Nodecl::NodeclBase location,
-            TL::Symbol current_function);
-
-    TL::Symbol emit_callback_for_reduction_simd_knc(
-            TL::ObjectList<Nodecl::OpenMP::ReductionItem> &reduction_items,
-            TL::Type reduction_pack_type,
-            Nodecl::NodeclBase location,
-            TL::Symbol current_function);
-
-    void update_reduction_uses(Nodecl::NodeclBase node,
-            const TL::ObjectList<Nodecl::OpenMP::ReductionItem>& reduction_items,
-            TL::Symbol reduction_pack_symbol);
-
-
-    struct ReplaceInOutMaster : Nodecl::ExhaustiveVisitor<void>
+    struct ReductionPrivate
     {
-        TL::Symbol _field;
-        TL::Symbol _orig_omp_in, _reduction_pack_symbol;
-        TL::Symbol _orig_omp_out, _reduced_symbol;
+        // Storage combined at the end of the construct
+        TL::Symbol shared;
+        // Partial value of the current thread
+        TL::Symbol private_;
+        OpenMP::Reduction* reduction;
+    };
 
-        ReplaceInOutMaster(
-                TL::Symbol field,
-                TL::Symbol orig_omp_in,  TL::Symbol reduction_pack_symbol,
-                TL::Symbol orig_omp_out, TL::Symbol reduced_symbol);
+    // Creates a private copy, initialized with the identity of the reduction,
+    // for every reduced symbol. 'symbol_map' must map the reduced symbols to
+    // the shared storage visible at 'location', after this call it maps them
+    // to the private copies
+    TL::ObjectList<ReductionPrivate> privatize_reductions(
+            const TL::ObjectList<Nodecl::OpenMP::ReductionItem> &reduction_items,
+            Nodecl::Utils::SimpleSymbolMap &symbol_map,
+            Nodecl::NodeclBase location);
 
-        virtual void visit(const Nodecl::Symbol& node);
-    };
+    // Emits before 'location' the code that combines the private copies of
+    // all the threads of the team into the shared storage. Scalars use atomic
+    // builtins when their type allows it and a log(P) tree otherwise, arrays
+    // are combined in chunks by all the threads. Every thread of the team must
+    // reach 'location'
+    void emit_reduction_combine(
+            const TL::ObjectList<ReductionPrivate> &reductions,
+            Nodecl::NodeclBase location);
 } }
 
 #endif // TL_LOWER_REDUCTIONS_HPP
@@ -0,0 +1,593 @@
+
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2015 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+#include "tl-counters.hpp"
+#include "tl-lowering-visitor.hpp"
+#include "tl-lowering-utils.hpp"
+#include "tl-lowering-loop-utils.hpp"
+#include "tl-symbol-utils.hpp"
+#include "cxx-diagnostic.h"
+
+
+namespace TL { namespace GOMP {
+
+void LoweringVisitor::visit(const Nodecl::OpenMP::TaskLoop& construct)
+{
+    TL::ForStatement for_statement(construct.get_loop().as<Nodecl::Context>().
+            get_in_context().as<Nodecl::List>().front().as<Nodecl::ForStatement>());
+
+    ERROR_CONDITION(!for_statement.is_omp_valid_loop(), "Invalid loop at this point", 0);
+
+    Nodecl::NodeclBase statements = for_statement.get_statement();
+    // A taskloop is not a doacross nest
+    _doacross_nests.push_back(TL::ObjectList<DoacrossLoop>());
+    walk(statements);
+    _doacross_nests.pop_back();
+    statements = for_statement.get_statement(); // Should not be necessary
+
+    Nodecl::List environment = construct.get_environment().as<Nodecl::List>();
+
+    TL::ObjectList<Nodecl::OpenMP::Shared> shared_list = environment.find_all<Nodecl::OpenMP::Shared>();
+    TL::ObjectList<Nodecl::OpenMP::Private> private_list = environment.find_all<Nodecl::OpenMP::Private>();
+    TL::ObjectList<Nodecl::OpenMP::Firstprivate> firstprivate_list = environment.find_all<Nodecl::OpenMP::Firstprivate>();
+    TL::ObjectList<Nodecl::OpenMP::Lastprivate> lastprivate_list = environment.find_all<Nodecl::OpenMP::Lastprivate>();
+    TL::ObjectList<Nodecl::OpenMP::FirstLastprivate> firstlastprivate_list = environment.find_all<Nodecl::OpenMP::FirstLastprivate>();
+
+    if (!environment.find_first<Nodecl::OpenMP::Reduction>().is_null()
+            || !environment.find_first<Nodecl::OpenMP::TaskReduction>().is_null())
+    {
+        error_printf_at(construct.get_locus(),
+                "reductions are not supported on the taskloop construct\n");
+    }
+    if (!environment.find_first<Nodecl::OpenMP::DepIn>().is_null()
+            || !environment.find_first<Nodecl::OpenMP::DepOut>().is_null()
+            || !environment.find_first<Nodecl::OpenMP::DepInout>().is_null())
+    {
+        error_printf_at(construct.get_locus(),
+                "dependences are not supported on the taskloop construct\n");
+    }
+
+    TL::ObjectList<TL::Symbol> all_symbols_passed; // Set of all symbols passed in the outline
+    TL::ObjectList<TL::Symbol> private_symbols;
+    TL::ObjectList<TL::Symbol> firstprivate_symbols;
+    TL::ObjectList<TL::Symbol> lastprivate_symbols;
+
+    if (!shared_list.empty())
+    {
+        TL::ObjectList<Symbol> tmp =
+            shared_list  // TL::ObjectList<OpenMP::Shared>
+            .map<Nodecl::NodeclBase>(&Nodecl::OpenMP::Shared::get_symbols) // TL::ObjectList<Nodecl::NodeclBase>
+            .map<Nodecl::List>(&Nodecl::NodeclBase::as<Nodecl::List>) // TL::ObjectList<Nodecl::List>
+            .map<TL::ObjectList<Nodecl::NodeclBase> >(&Nodecl::List::to_object_list) // TL::ObjectList<TL::ObjectList<Nodecl::NodeclBase> >
+            .reduction(TL::append_two_lists<Nodecl::NodeclBase>) // TL::ObjectList<Nodecl::NodeclBase>
+            .map<TL::Symbol>(&Nodecl::NodeclBase::get_symbol) // TL::ObjectList<TL::Symbol>
+            ;
+
+        all_symbols_passed.insert(tmp);
+    }
+    if (!private_list.empty())
+    {
+        TL::ObjectList<Symbol> tmp =
+            private_list  // TL::ObjectList<OpenMP::Private>
+            .map<Nodecl::NodeclBase>(&Nodecl::OpenMP::Private::get_symbols) // TL::ObjectList<Nodecl::NodeclBase>
+            .map<Nodecl::List>(&Nodecl::NodeclBase::as<Nodecl::List>) // TL::ObjectList<Nodecl::List>
+            .map<TL::ObjectList<Nodecl::NodeclBase> >(&Nodecl::List::to_object_list) // TL::ObjectList<TL::ObjectList<Nodecl::NodeclBase> >
+            .reduction(TL::append_two_lists<Nodecl::NodeclBase>) // TL::ObjectList<Nodecl::NodeclBase>
+            .map<TL::Symbol>(&Nodecl::NodeclBase::get_symbol) // TL::ObjectList<TL::Symbol>
+            ;
+
+        private_symbols.insert(tmp);
+    }
+    if (!firstprivate_list.empty())
+    {
+        TL::ObjectList<Symbol> tmp =
+            firstprivate_list  // TL::ObjectList<OpenMP::Firstprivate>
+            .map<Nodecl::NodeclBase>(&Nodecl::OpenMP::Firstprivate::get_symbols) // TL::ObjectList<Nodecl::NodeclBase>
+            .map<Nodecl::List>(&Nodecl::NodeclBase::as<Nodecl::List>) // TL::ObjectList<Nodecl::List>
+            .map<TL::ObjectList<Nodecl::NodeclBase> >(&Nodecl::List::to_object_list) // TL::ObjectList<TL::ObjectList<Nodecl::NodeclBase> >
+            .reduction(TL::append_two_lists<Nodecl::NodeclBase>) // TL::ObjectList<Nodecl::NodeclBase>
+            .map<TL::Symbol>(&Nodecl::NodeclBase::get_symbol) // TL::ObjectList<TL::Symbol>
+            ;
+
+        private_symbols.insert(tmp);
+        firstprivate_symbols.insert(tmp);
+        all_symbols_passed.insert(tmp);
+    }
+    if (!lastprivate_list.empty())
+    {
+        TL::ObjectList<Symbol> tmp =
+            lastprivate_list  // TL::ObjectList<OpenMP::Lastprivate>
+            .map<Nodecl::NodeclBase>(&Nodecl::OpenMP::Lastprivate::get_symbols) // TL::ObjectList<Nodecl::NodeclBase>
+            .map<Nodecl::List>(&Nodecl::NodeclBase::as<Nodecl::List>) // TL::ObjectList<Nodecl::List>
+            .map<TL::ObjectList<Nodecl::NodeclBase> >(&Nodecl::List::to_object_list) // TL::ObjectList<TL::ObjectList<Nodecl::NodeclBase> >
+            .reduction(TL::append_two_lists<Nodecl::NodeclBase>) // TL::ObjectList<Nodecl::NodeclBase>
+            .map<TL::Symbol>(&Nodecl::NodeclBase::get_symbol) // TL::ObjectList<TL::Symbol>
+            ;
+
+        private_symbols.insert(tmp);
+        lastprivate_symbols.insert(tmp);
+    }
+    if (!firstlastprivate_list.empty())
+    {
+        TL::ObjectList<Symbol> tmp =
+            firstlastprivate_list  // TL::ObjectList<OpenMP::FirstLastprivate>
+            .map<Nodecl::NodeclBase>(&Nodecl::OpenMP::FirstLastprivate::get_symbols) // TL::ObjectList<Nodecl::NodeclBase>
+            .map<Nodecl::List>(&Nodecl::NodeclBase::as<Nodecl::List>) // TL::ObjectList<Nodecl::List>
+            .map<TL::ObjectList<Nodecl::NodeclBase> >(&Nodecl::List::to_object_list) // TL::ObjectList<TL::ObjectList<Nodecl::NodeclBase> >
+            .reduction(TL::append_two_lists<Nodecl::NodeclBase>) // TL::ObjectList<Nodecl::NodeclBase>
+            .map<TL::Symbol>(&Nodecl::NodeclBase::get_symbol) // TL::ObjectList<TL::Symbol>
+            ;
+
+        private_symbols.insert(tmp);
+        firstprivate_symbols.insert(tmp);
+        lastprivate_symbols.insert(tmp);
+        all_symbols_passed.insert(tmp);
+    }
+
+    TL::Symbol induction_var = for_statement.get_induction_variable();
+    private_symbols.insert(induction_var);
+
+    // Add the VLA symbols
+    {
+        TL::ObjectList<TL::Symbol> vla_symbols;
+        for (TL::ObjectList<TL::Symbol>::iterator it = all_symbols_passed.begin();
+                it != all_symbols_passed.end();
+                it++)
+        {
+            GOMP::gather_vla_symbols(*it, vla_symbols);
+        }
+
+        // VLA symbols are always firstprivate
+        private_symbols.insert(vla_symbols);
+        firstprivate_symbols.insert(vla_symbols);
+
+        vla_symbols.insert(all_symbols_passed);
+        all_symbols_passed = vla_symbols;
+    }
+
+    TL::Scope current_scope = construct.retrieve_context();
+
+    // Unsigned bounds that may not fit in a long use GOMP_taskloop_ull. Its
+    // step is unsigned too, so its sign is checked as a long long
+    TL::Type induction_var_type = induction_var.get_type().no_ref();
+    TL::Type long_type = TL::Type::get_long_int_type();
+    bool use_ull = induction_var_type.is_unsigned_integral()
+        && induction_var_type.get_size() >= long_type.get_size();
+    TL::Type bounds_type = use_ull
+        ? TL::Type::get_unsigned_long_long_int_type()
+        : long_type;
+    std::string signed_step = use_ull ? "(long long)" : "";
+
+    // GOMP_taskloop stores the iterations [start, end) of each task in the
+    // first two fields of its data, so they must be the first ones
+    TL::Symbol task_start = GOMP::new_private_symbol("taskloop_start",
+            bounds_type, SK_VARIABLE, current_scope);
+    TL::Symbol task_end = GOMP::new_private_symbol("taskloop_end",
+            bounds_type, SK_VARIABLE, current_scope);
+    TL::Symbol task_step = GOMP::new_private_symbol("taskloop_step",
+            bounds_type, SK_VARIABLE, current_scope);
+
+    TL::ObjectList<TL::Symbol> taskloop_symbols;
+    taskloop_symbols.append(task_start);
+    taskloop_symbols.append(task_end);
+    taskloop_symbols.append(task_step);
+
+    // The task that runs the last iteration updates the lastprivate
+    // variables through a pointer to them
+    TL::Symbol loop_end;
+    TL::ObjectList<std::pair<TL::Symbol, TL::Symbol> > lastprivate_pointers;
+    if (!lastprivate_symbols.empty())
+    {
+        loop_end = GOMP::new_private_symbol("taskloop_loop_end",
+                bounds_type, SK_VARIABLE, current_scope);
+        taskloop_symbols.append(loop_end);
+
+        for (TL::ObjectList<TL::Symbol>::iterator it = lastprivate_symbols.begin();
+                it != lastprivate_symbols.end();
+                it++)
+        {
+            TL::Symbol pointer = GOMP::new_private_symbol("lastprivate_" + it->get_name(),
+                    it->get_type().no_ref().get_pointer_to(), SK_VARIABLE, current_scope);
+            taskloop_symbols.append(pointer);
+            lastprivate_pointers.append(std::make_pair(*it, pointer));
+        }
+    }
+
+    firstprivate_symbols.insert(taskloop_symbols);
+    {
+        TL::ObjectList<TL::Symbol> tmp = taskloop_symbols;
+        tmp.insert(all_symbols_passed);
+        all_symbols_passed = tmp;
+    }
+
+    TL::Symbol enclosing_function = Nodecl::Utils::get_enclosing_function(construct);
+    std::string outline_function_name;
+    {
+        TL::Counter &outline_num = TL::CounterManager::get_counter("gomp-omp-outline");
+        std::stringstream ss;
+        ss << "_ol_" << enclosing_function.get_name() << "_" << (int)outline_num;
+        outline_function_name = ss.str();
+        outline_num++;
+    }
+
+    TL::Type outline_struct = GOMP::create_outline_struct_task(
+            all_symbols_passed,
+            firstprivate_symbols,
+            enclosing_function,
+            construct.get_locus());
+
+    CXX_LANGUAGE()
+    {
+        Nodecl::Utils::prepend_to_enclosing_top_level_location(
+                construct,
+                Nodecl::CxxDef::make(
+                    /* context */ Nodecl::NodeclBase::null(),
+                    outline_struct.get_symbol()
+                    )
+                );
+    }
+
+    std::string ol_data_name;
+    {
+        TL::Counter &outline_num = TL::CounterManager::get_counter("gomp-omp-outline-data");
+
+        std::stringstream ss;
+        ss << "ol_data_" << (int)outline_num;
+        ol_data_name = ss.str();
+
+        outline_num++;
+    }
+
+    TL::Symbol outline_data = current_scope.new_symbol(ol_data_name);
+    outline_data.get_internal_symbol()->kind = SK_VARIABLE;
+    outline_data.get_internal_symbol()->type_information = outline_struct.get_internal_type();
+    symbol_entity_specs_set_is_user_declared(outline_data.get_internal_symbol(), 1);
+
+    TL::ObjectList<std::string> parameter_names;
+    TL::ObjectList<TL::Type> parameter_types;
+
+    parameter_names.append(ol_data_name);
+    parameter_types.append(outline_struct.get_pointer_to());
+
+    TL::Symbol outline_function = SymbolUtils::new_function_symbol(
+            enclosing_function,
+            outline_function_name,
+            TL::Type::get_void_type(),
+            parameter_names,
+            parameter_types);
+
+    Nodecl::NodeclBase outline_function_code, outline_function_stmt;
+    SymbolUtils::build_empty_body_for_function(outline_function,
+            outline_function_code,
+            outline_function_stmt);
+
+    Nodecl::Utils::SimpleSymbolMap symbol_map;
+
+    TL::Scope block_scope = outline_function_stmt.retrieve_context();
+
+    TL::Symbol ol_data_in_outline = block_scope.get_symbol_from_name(ol_data_name);
+    ERROR_CONDITION(!ol_data_in_outline.is_valid(), "Invalid symbol", 0);
+
+    for (TL::ObjectList<TL::Symbol>::iterator it = all_symbols_passed.begin();
+            it != all_symbols_passed.end();
+            it++)
+    {
+        TL::Symbol new_shared_sym = block_scope.new_symbol(it->get_name());
+        new_shared_sym.get_internal_symbol()->kind = SK_VARIABLE;
+        new_shared_sym.get_internal_symbol()->type_information = lvalue_ref(
+                it->get_internal_symbol()->type_information);
+        symbol_entity_specs_set_is_user_declared(
+                new_shared_sym.get_internal_symbol(),
+                1);
+
+        Source init_ref_src;
+        if (firstprivate_symbols.contains(*it))
+            init_ref_src << as_symbol(ol_data_in_outline) << "->" << it->get_name();
+        else
+            init_ref_src << "*(" << as_symbol(ol_data_in_outline) << "->" << it->get_name() << ")";
+        Nodecl::NodeclBase init_ref =
+            init_ref_src.parse_expression(block_scope);
+        new_shared_sym.set_value(init_ref);
+
+        symbol_map.add_map(*it, new_shared_sym);
+
+        CXX_LANGUAGE()
+        {
+            outline_function_stmt.prepend_sibling(
+                    Nodecl::CxxDef::make(
+                        /* context */ Nodecl::NodeclBase::null(),
+                        new_shared_sym));
+        }
+    }
+
+    for (TL::ObjectList<TL::Symbol>::iterator it = private_symbols.begin();
+            it != private_symbols.end();
+            it++)
+    {
+        // They are to be found in the struct
+        if (firstprivate_symbols.contains(*it))
+            continue;
+
+        TL::Symbol new_private_sym = GOMP::new_private_symbol(*it, block_scope);
+
+        new_private_sym.get_internal_symbol()->type_information = ::type_deep_copy(
+                new_private_sym.get_internal_symbol()->type_information,
+                outline_function_stmt.retrieve_context().get_decl_context(),
+                symbol_map.get_symbol_map());
+
+        symbol_map.add_map(*it, new_private_sym);
+
+        CXX_LANGUAGE()
+        {
+            outline_function_stmt.prepend_sibling(
+                    Nodecl::CxxDef::make(
+                        /* context */ Nodecl::NodeclBase::null(),
+                        new_private_sym));
+        }
+    }
+
+    TL::Symbol private_induction_var = symbol_map.map(induction_var);
+    ERROR_CONDITION(private_induction_var == induction_var, "Induction variable was not privatized", 0);
+
+    Source lastprivate_code;
+    if (!lastprivate_symbols.empty())
+    {
+        lastprivate_code
+            << "if (" << as_symbol(symbol_map.map(task_end)) << " == "
+            <<           as_symbol(symbol_map.map(loop_end)) << ") {"
+            ;
+
+        for (TL::ObjectList<std::pair<TL::Symbol, TL::Symbol> >::iterator it = lastprivate_pointers.begin();
+                it != lastprivate_pointers.end();
+                it++)
+        {
+            if (!it->first.get_type().no_ref().is_array())
+            {
+                lastprivate_code
+                    << "*" << as_symbol(symbol_map.map(it->second)) << " = "
+                    << as_symbol(symbol_map.map(it->first)) << ";"
+                    ;
+            }
+            else
+            {
+                lastprivate_code
+                    << "__builtin_memcpy(" << as_symbol(symbol_map.map(it->second)) << ","
+                    <<                        as_symbol(symbol_map.map(it->first))
+                    <<                        ", sizeof(" << as_type(it->first.get_type().no_ref()) << "));"
+                    ;
+            }
+        }
+
+        lastprivate_code << "}";
+    }
+
+    Nodecl::NodeclBase loop_body;
+    Source task_loop;
+    task_loop
+        << "for (" << as_symbol(private_induction_var) << " = " << as_symbol(symbol_map.map(task_start)) << ";"
+        <<      "(" << signed_step << as_symbol(symbol_map.map(task_step)) << " > 0)"
+        <<         " ? " << as_symbol(private_induction_var) << " < " << as_symbol(symbol_map.map(task_end))
+        <<         " : " << as_symbol(private_induction_var) << " > " << as_symbol(symbol_map.map(task_end)) << ";"
+        <<      as_symbol(private_induction_var) << " += " << as_symbol(symbol_map.map(task_step)) << ")"
+        << "{"
+        <<     statement_placeholder(loop_body)
+        << "}"
+        << lastprivate_code
+        ;
+
+    Nodecl::NodeclBase task_loop_tree = task_loop.parse_statement(outline_function_stmt);
+    outline_function_stmt.prepend_sibling(task_loop_tree);
+
+    Nodecl::NodeclBase new_statements = Nodecl::Utils::deep_copy(statements,
+            loop_body,
+            symbol_map);
+    loop_body.replace(new_statements);
+
+    Nodecl::Utils::prepend_to_enclosing_top_level_location(construct, outline_function_code);
+
+
+    Source setup_data;
+    CXX_LANGUAGE()
+    {
+        setup_data << as_statement(
+                Nodecl::CxxDef::make(
+                    /* context */ Nodecl::NodeclBase::null(),
+                    outline_data))
+            ;
+
+        for (TL::ObjectList<TL::Symbol>::iterator it = taskloop_symbols.begin();
+                it != taskloop_symbols.end();
+                it++)
+        {
+            setup_data << as_statement(
+                    Nodecl::CxxDef::make(
+                        /* context */ Nodecl::NodeclBase::null(),
+                        *it))
+                ;
+        }
+    }
+
+    // Each bound is evaluated once, 'task_end' holds the included upper
+    // bound until the iteration count is known
+    Source task_start_name, task_end_name, task_step_name;
+    task_start_name << as_symbol(task_start);
+    task_end_name << as_symbol(task_end);
+    task_step_name << as_symbol(task_step);
+
+    setup_data
+        << as_symbol(task_step) << " = " << as_expression(for_statement.get_step().shallow_copy()) << ";"
+        << as_symbol(task_start) << " = " << as_expression(for_statement.get_lower_bound().shallow_copy()) << ";"
+        << as_symbol(task_end) << " = " << as_expression(for_statement.get_upper_bound().shallow_copy()) << ";"
+        << as_symbol(task_end) << " = " << as_symbol(task_start) << " + "
+        <<      (use_ull
+                ? TL::Lowering::Utils::unsigned_loop_iteration_count(task_start_name, task_end_name, task_step_name)
+                : TL::Lowering::Utils::loop_iteration_count(task_start_name, task_end_name, task_step_name))
+        <<      " * " << as_symbol(task_step) << ";"
+        ;
+
+    if (!lastprivate_symbols.empty())
+    {
+        setup_data << as_symbol(loop_end) << " = " << as_symbol(task_end) << ";";
+
+        for (TL::ObjectList<std::pair<TL::Symbol, TL::Symbol> >::iterator it = lastprivate_pointers.begin();
+                it != lastprivate_pointers.end();
+                it++)
+        {
+            setup_data << as_symbol(it->second) << " = &" << as_symbol(it->first) << ";";
+        }
+    }
+
+    for (TL::ObjectList<TL::Symbol>::iterator it = all_symbols_passed.begin();
+            it != all_symbols_passed.end();
+            it++)
+    {
+        if (firstprivate_symbols.contains(*it))
+        {
+            setup_data
+                << as_symbol(outline_data) << "." << it->get_name() << " = " << as_symbol(*it) << ";"
+                ;
+        }
+        else
+        {
+            setup_data
+                << as_symbol(outline_data) << "." << it->get_name() << " = &" << as_symbol(*it) << ";"
+                ;
+        }
+    }
+
+    Source arg_size, arg_align, num_tasks, priority;
+
+    arg_size << outline_struct.get_size();
+    arg_align << outline_struct.get_alignment_of();
+
+    // Task flags
+    std::string task_flags_name;
+    {
+        TL::Counter &c = TL::CounterManager::get_counter("gomp-omp-task-flags");
+
+        std::stringstream ss;
+        ss << "gomp_task_flags_" << (int)c;
+        task_flags_name = ss.str();
+
+        c++;
+    }
+
+    Source set_task_flags;
+    set_task_flags
+        << "if (" << signed_step << as_symbol(task_step) << " > 0)"
+        <<    task_flags_name << " |= GOMP_TASK_UP;"
+        ;
+
+    Nodecl::OpenMP::If if_clause = environment.find_first<Nodecl::OpenMP::If>();
+    if (if_clause.is_null())
+    {
+        set_task_flags << task_flags_name << " |= GOMP_TASK_IF;"
+            ;
+    }
+    else
+    {
+        set_task_flags
+            << "if (" << as_expression(if_clause.get_condition().shallow_copy()) << ")"
+            <<    task_flags_name << " |= GOMP_TASK_IF;"
+            ;
+    }
+    if (!environment.find_first<Nodecl::OpenMP::Untied>().is_null())
+    {
+        set_task_flags << task_flags_name << " |= GOMP_TASK_UNTIED;"
+            ;
+    }
+    Nodecl::OpenMP::Final final_clause = environment.find_first<Nodecl::OpenMP::Final>();
+    if (!final_clause.is_null())
+    {
+        set_task_flags
+            << "if (" << as_expression(final_clause.get_condition().shallow_copy()) << ")"
+            <<    task_flags_name << " |= GOMP_TASK_FINAL;"
+            ;
+    }
+    if (!environment.find_first<Nodecl::OpenMP::Mergeable>().is_null())
+    {
+        set_task_flags << task_flags_name << " |= GOMP_TASK_MERGEABLE;"
+            ;
+    }
+    if (!environment.find_first<Nodecl::OpenMP::Nogroup>().is_null())
+    {
+        set_task_flags << task_flags_name << " |= GOMP_TASK_NOGROUP;"
+            ;
+    }
+
+    Nodecl::OpenMP::Priority priority_clause = environment.find_first<Nodecl::OpenMP::Priority>();
+    if (priority_clause.is_null())
+    {
+        priority << "0";
+    }
+    else
+    {
+        set_task_flags << task_flags_name << " |= GOMP_TASK_PRIORITY;"
+            ;
+        priority << as_expression(priority_clause.get_priority().shallow_copy());
+    }
+
+    // When neither grainsize nor num_tasks are given the runtime chooses the
+    // number of tasks
+    Nodecl::OpenMP::Grainsize grainsize_clause = environment.find_first<Nodecl::OpenMP::Grainsize>();
+    Nodecl::OpenMP::NumTasks num_tasks_clause = environment.find_first<Nodecl::OpenMP::NumTasks>();
+    if (!grainsize_clause.is_null())
+    {
+        set_task_flags << task_flags_name << " |= GOMP_TASK_GRAINSIZE;"
+            ;
+        num_tasks << as_expression(grainsize_clause.get_grainsize().shallow_copy());
+    }
+    else if (!num_tasks_clause.is_null())
+    {
+        num_tasks << as_expression(num_tasks_clause.get_num_tasks().shallow_copy());
+    }
+    else
+    {
+        num_tasks << "0";
+    }
+
+    Source taskloop_code;
+    taskloop_code
+        << setup_data
+        << "unsigned int " << task_flags_name << " = 0;"
+        << set_task_flags
+        << (use_ull ? "GOMP_taskloop_ull" : "GOMP_taskloop") << "((void(*)(void*))"
+        <<     as_symbol(outline_function) << ", &" << as_symbol(outline_data) << ", "
+        <<     "(void(*)(void*,void*))0,"
+        <<     arg_size << ", "  << arg_align << ", " << task_flags_name << ", "
+        <<     num_tasks << ", " << priority << ", "
+        <<     as_symbol(task_start) << ", " << as_symbol(task_end) << ", " << as_symbol(task_step)
+        << ");"
+        ;
+
+    Nodecl::NodeclBase taskloop_code_tree = taskloop_code.parse_statement(construct);
+
+    construct.replace(taskloop_code_tree);
+}
+
+} }
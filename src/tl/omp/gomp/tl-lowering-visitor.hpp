@@ -30,6 +30,7 @@
 #include "tl-omp-core.hpp"
 
 #include <set>
+#include <vector>
 #include <stdio.h>
 
 namespace TL { namespace GOMP {
@@ -55,8 +56,23 @@ class LoweringVisitor : public Nodecl::ExhaustiveVisitor<void>
         virtual void visit(const Nodecl::OmpSs::TaskCall& construct);
         virtual void visit(const Nodecl::OmpSs::TaskExpression& task_expr);
         virtual void visit(const Nodecl::OpenMP::Taskwait& construct);
+        virtual void visit(const Nodecl::OpenMP::TaskLoop& construct);
+        virtual void visit(const Nodecl::OpenMP::DoacrossWait& construct);
+        virtual void visit(const Nodecl::OpenMP::DoacrossPost& construct);
 
     private:
+        // Loops of the doacross nests being lowered, outermost first
+        struct DoacrossLoop
+        {
+            TL::Symbol induction_var;
+            Nodecl::NodeclBase lower;
+            Nodecl::NodeclBase upper;
+            Nodecl::NodeclBase step;
+        };
+        std::vector<TL::ObjectList<DoacrossLoop> > _doacross_nests;
+
+        TL::Source doacross_iteration(const DoacrossLoop& loop,
+                Nodecl::NodeclBase value);
 
         void lower_for(const Nodecl::OpenMP::For& construct, const Nodecl::NodeclBase& prependix,
                 const Nodecl::NodeclBase& appendix);
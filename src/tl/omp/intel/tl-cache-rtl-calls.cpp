@@ -32,33 +32,14 @@
 
 namespace TL { namespace Intel {
 
-    class FindRTLCacheableCalls : public Nodecl::ExhaustiveVisitor<void>
+    CacheRTLCalls::CacheRTLCalls()
     {
-        private:
-            TL::ObjectList<TL::Symbol> _cacheable_set;
-        public:
-            TL::ObjectList<TL::Symbol> functions_found;
-            std::map<TL::Symbol, TL::ObjectList<Nodecl::NodeclBase> > occurrences;
+        set_phase_name("Intel OpenMP RTL call caching");
+        set_phase_description("This phase caches the calls to the Intel OpenMP RTL "
+                "that always return the same value within a function");
 
-            FindRTLCacheableCalls(const TL::ObjectList<TL::Symbol> &cacheable_set)
-                : _cacheable_set(cacheable_set) { }
-
-            virtual void visit(const Nodecl::FunctionCall& n)
-            {
-                walk(n.get_arguments());
-
-                TL::Symbol called_sym = n.get_called().get_symbol();
-                if (called_sym.is_valid()
-                        && _cacheable_set.contains(n.get_called().get_symbol()))
-                {
-                    functions_found.insert(called_sym);
-                    occurrences[called_sym].append(n);
-                }
-            }
-    };
-
-    CacheRTLCalls::CacheRTLCalls(Lowering* lowering)
-        : _lowering(lowering) { }
+        handle_kind<Nodecl::TopLevel>();
+    }
 
     CacheRTLCalls::~CacheRTLCalls()
     {
@@ -124,7 +105,7 @@ namespace TL { namespace Intel {
         }
     }
 
-    void CacheRTLCalls::visit(const Nodecl::FunctionCode& function_code)
+    void CacheRTLCalls::handle_node(const Nodecl::NodeclBase& translation_unit)
     {
         TL::ObjectList<TL::Symbol> cacheable_set;
         std::map<TL::Symbol, CacheRTLCallsHandler> cacheable_handler_set;
@@ -134,20 +115,54 @@ namespace TL { namespace Intel {
                 cacheable_handler_set,
                 &CacheRTLCalls::cache_kmpc_global_thread);
 
-        FindRTLCacheableCalls find_rtl_cacheable_calls(cacheable_set);
-        find_rtl_cacheable_calls.walk(function_code);
+        if (cacheable_set.empty())
+            return;
+
+        // Calls are found in preorder so functions and the occurrences in
+        // each one keep the order of the tree
+        TL::ObjectList<Nodecl::NodeclBase> function_codes;
+        std::map<Nodecl::NodeclBase, TL::ObjectList<TL::Symbol> > functions_found;
+        std::map<Nodecl::NodeclBase, std::map<TL::Symbol, TL::ObjectList<Nodecl::NodeclBase> > > occurrences;
 
-        for (TL::ObjectList<TL::Symbol>::iterator
-                it = find_rtl_cacheable_calls.functions_found.begin();
-                it != find_rtl_cacheable_calls.functions_found.end();
+        TL::ObjectList<Nodecl::FunctionCall> calls =
+            Nodecl::Utils::find_all<Nodecl::FunctionCall>(translation_unit);
+        for (TL::ObjectList<Nodecl::FunctionCall>::iterator it = calls.begin();
+                it != calls.end();
                 it++)
         {
-            CacheRTLCallsHandler handler = cacheable_handler_set[*it];
+            TL::Symbol called_sym = it->get_called().get_symbol();
+            if (!called_sym.is_valid()
+                    || !cacheable_set.contains(called_sym))
+                continue;
+
+            Nodecl::NodeclBase function_code =
+                Nodecl::Utils::get_enclosing_nodecl_of_kind<Nodecl::FunctionCode>(*it);
+            if (function_code.is_null())
+                continue;
+
+            function_codes.insert(function_code);
+            functions_found[function_code].insert(called_sym);
+            occurrences[function_code][called_sym].append(*it);
+        }
+
+        for (TL::ObjectList<Nodecl::NodeclBase>::iterator it_function = function_codes.begin();
+                it_function != function_codes.end();
+                it_function++)
+        {
+            TL::ObjectList<TL::Symbol>& functions = functions_found[*it_function];
+            for (TL::ObjectList<TL::Symbol>::iterator it = functions.begin();
+                    it != functions.end();
+                    it++)
+            {
+                CacheRTLCallsHandler handler = cacheable_handler_set[*it];
 
-            (this->*handler)(*it,
-                    function_code,
-                    find_rtl_cacheable_calls.occurrences[*it]);
+                (this->*handler)(*it,
+                        *it_function,
+                        occurrences[*it_function][*it]);
+            }
         }
     }
 
 } }
+
+EXPORT_PHASE(TL::Intel::CacheRTLCalls);
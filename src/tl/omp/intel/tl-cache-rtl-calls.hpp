@@ -27,25 +27,25 @@
 #ifndef TL_CACHE_RTL_CALLS
 #define TL_CACHE_RTL_CALLS
 
-#include "tl-nodecl-visitor.hpp"
-#include "tl-omp-intel.hpp"
+#include "tl-compilerpipeline.hpp"
+#include "tl-nodecl.hpp"
 
 namespace TL { namespace Intel {
 
-class CacheRTLCalls : public Nodecl::ExhaustiveVisitor<void>
+// Only handles the top level node: the calls are queried at once so the
+// nodecl index, when enabled, avoids walking the tree again
+class CacheRTLCalls : public TL::FusablePhase
 {
     public:
-        CacheRTLCalls(Lowering*);
+        CacheRTLCalls();
         ~CacheRTLCalls();
 
-        virtual void visit(const Nodecl::FunctionCode& function_code);
+        virtual void handle_node(const Nodecl::NodeclBase& translation_unit);
 
         typedef void (CacheRTLCalls::* CacheRTLCallsHandler)(TL::Symbol sym,
                 Nodecl::NodeclBase function_code,
                 TL::ObjectList<Nodecl::NodeclBase>& ocurrences);
     private:
-        Lowering* _lowering;
-
         void add_cacheable_function(
                 TL::ObjectList<TL::Symbol>& cacheable_set,
                 const std::string& str,
@@ -27,6 +27,7 @@
 
 #include "tl-lowering-visitor.hpp"
 #include "tl-lowering-utils.hpp"
+#include "tl-lowering-loop-utils.hpp"
 
 #include "tl-lower-reductions.hpp"
 
@@ -90,6 +91,11 @@ void LoweringVisitor::lower_for(const Nodecl::OpenMP::For& construct,
     Nodecl::OpenMP::BarrierAtEnd barrier_at_end = environment.find_first<Nodecl::OpenMP::BarrierAtEnd>();
 
     bool is_static_schedule = (schedule.get_text() == "static");
+    // Without a chunk, a static schedule gives each thread one contiguous
+    // block of iterations that can be computed without the runtime
+    bool inline_static_schedule = is_static_schedule
+        && schedule.get_chunk().is_constant()
+        && const_value_is_zero(schedule.get_chunk().get_constant());
 
     TL::ObjectList<TL::Symbol> private_symbols;
     TL::ObjectList<TL::Symbol> firstprivate_symbols;
@@ -338,7 +344,58 @@ void LoweringVisitor::lower_for(const Nodecl::OpenMP::For& construct,
         lastprivate_code << "}";
     }
 
-    if (is_static_schedule)
+    if (inline_static_schedule)
+    {
+        // Same partition as kmp_sch_static: the first threads get one more
+        // iteration when the threads do not divide the iterations
+        Source num_iterations, logical_iter, num_threads, thread_num, block, extra, first;
+        num_iterations << "num_iterations_" << (int)private_num;
+        logical_iter << "iter_" << (int)private_num;
+        num_threads << "num_threads_" << (int)private_num;
+        thread_num << "thread_num_" << (int)private_num;
+        block << "block_" << (int)private_num;
+        extra << "extra_" << (int)private_num;
+        first << "first_" << (int)private_num;
+        private_num++;
+
+        Source static_loop;
+        static_loop
+            << common_initialization
+            << "long " << num_iterations << " = "
+            << TL::Lowering::Utils::loop_iteration_count(lower, upper, step) << ";"
+            << "long " << logical_iter << ";"
+            << "long " << num_threads << " = __kmpc_bound_num_threads(&" << as_symbol(ident_symbol) << ");"
+            << "long " << thread_num << " = __kmpc_bound_thread_num(&" << as_symbol(ident_symbol) << ");"
+            << "long " << block << " = " << num_iterations << " / " << num_threads << ";"
+            << "long " << extra << " = " << num_iterations << " % " << num_threads << ";"
+            << "if (" << thread_num << " < " << extra << ") {"
+            <<    block << "++;"
+            <<    extra << " = 0;"
+            << "}"
+            << "long " << first << " = " << thread_num << " * " << block << " + " << extra << ";"
+            << lower << " = " << lower << " + " << first << " * " << step << ";"
+            << lastiter << " = (" << block << " > 0 && "
+            <<                   first << " + " << block << " == " << num_iterations << ");"
+            << statement_placeholder(prependix_code)
+            << pragma_noprefetch
+            << "for (" << logical_iter << " = 0; "
+            <<            logical_iter << " < " << block << "; "
+            <<            logical_iter << "++)"
+            << "{"
+            <<     as_symbol(private_induction_var) << " = "
+            <<            lower << " + " << logical_iter << " * " << step << ";"
+            <<     statement_placeholder(loop_body)
+            << "}"
+            << lastprivate_code
+            << statement_placeholder(appendix_code)
+            << statement_placeholder(reduction_code)
+            << statement_placeholder(barrier_code)
+            ;
+
+        Nodecl::NodeclBase static_loop_tree = static_loop.parse_statement(stmt_placeholder);
+        stmt_placeholder.prepend_sibling(static_loop_tree);
+    }
+    else if (is_static_schedule)
     {
         Source static_loop;
         static_loop
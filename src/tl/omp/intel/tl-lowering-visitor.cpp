@@ -49,6 +49,16 @@ void LoweringVisitor::visit(const Nodecl::OpenMP::Critical& construct)
     error_printf_at(construct.get_locus(), "OpenMP Critical construct not yet implemented\n");
 }
 
+void LoweringVisitor::visit(const Nodecl::OpenMP::DoacrossPost& construct)
+{
+    error_printf_at(construct.get_locus(), "OpenMP DoacrossPost construct not yet implemented\n");
+}
+
+void LoweringVisitor::visit(const Nodecl::OpenMP::DoacrossWait& construct)
+{
+    error_printf_at(construct.get_locus(), "OpenMP DoacrossWait construct not yet implemented\n");
+}
+
 void LoweringVisitor::visit(const Nodecl::OpenMP::FlushMemory& construct)
 {
     error_printf_at(construct.get_locus(), "OpenMP FlushMemory construct not yet implemented\n");
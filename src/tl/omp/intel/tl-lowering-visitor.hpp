@@ -43,6 +43,8 @@ class LoweringVisitor : public Nodecl::ExhaustiveVisitor<void>
         virtual void visit(const Nodecl::OpenMP::Atomic& construct);
         virtual void visit(const Nodecl::OpenMP::BarrierFull& construct);
         virtual void visit(const Nodecl::OpenMP::Critical& construct);
+        virtual void visit(const Nodecl::OpenMP::DoacrossPost& construct);
+        virtual void visit(const Nodecl::OpenMP::DoacrossWait& construct);
         virtual void visit(const Nodecl::OpenMP::FlushMemory& construct);
         virtual void visit(const Nodecl::OpenMP::For& construct);
         virtual void visit(const Nodecl::OpenMP::Master& construct);
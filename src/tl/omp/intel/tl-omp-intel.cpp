@@ -25,7 +25,6 @@
 --------------------------------------------------------------------*/
 
 #include "tl-omp-intel.hpp"
-#include "tl-cache-rtl-calls.hpp"
 #include "tl-lowering-visitor.hpp"
 #include "tl-lowering-utils.hpp"
 
@@ -75,9 +74,6 @@ namespace TL { namespace Intel {
         Nodecl::NodeclBase n = *std::static_pointer_cast<Nodecl::NodeclBase>(dto["nodecl"]);
         LoweringVisitor lowering_visitor(this);
         lowering_visitor.walk(n);
-
-        CacheRTLCalls cache_calls_visitor(this);
-        cache_calls_visitor.walk(n);
     }
 
     void Lowering::set_simd_reductions(const std::string &str)
@@ -894,6 +894,19 @@ void LoweringVisitor::visit_task(
     Nodecl::NodeclBase environment = construct.get_environment();
     Nodecl::NodeclBase statements = construct.get_statements();
 
+    TL::CounterManager::get_counter("nanox-tasks")++;
+
+    // Tasks whose statements can be executed directly by the current thread
+    // when the 'if' clause evaluates to false. This must be checked before
+    // lowering the statements
+    Nodecl::NodeclBase if_condition;
+    Nodecl::NodeclBase undeferred_stmts;
+    bool undeferred_fast_path = !_lowering->undeferred_fast_path_disabled()
+        && !inside_task_expression
+        && TL::Lowering::Utils::task_can_be_inlined_when_undeferred(environment, statements, if_condition);
+    if (undeferred_fast_path)
+        undeferred_stmts = Nodecl::Utils::deep_copy(statements, statements.retrieve_context());
+
     walk(statements);
 
     TaskEnvironmentVisitor task_environment;
@@ -947,31 +960,66 @@ void LoweringVisitor::visit_task(
         argument_outline_data_item.set_base_address_expression(sym_ref);
     }
 
+    undeferred_fast_path = undeferred_fast_path
+        && outline_info.only_has_smp_or_mpi_implementations()
+        && !has_task_reduction;
+
     Nodecl::NodeclBase new_construct;
-    if (generate_final_stmts)
+    if (generate_final_stmts || undeferred_fast_path)
     {
         // We create a new Node OpenMP::Task with the same childs as the
         // original construct. Another solution is shallow copy all the
         // construct (less efficient)
         new_construct = Nodecl::OpenMP::Task::make(environment, statements);
-        TL::Source code;
 
+        TL::Source task_code;
+        Nodecl::NodeclBase undeferred_statements_placeholder;
+        if (undeferred_fast_path)
+        {
+            TL::CounterManager::get_counter("nanox-tasks-undeferred-fast-path")++;
+
+            task_code
+                << "if (" << as_expression(if_condition.shallow_copy()) << ")"
+                << "{"
+                <<      as_statement(new_construct)
+                << "}"
+                << "else"
+                << "{"
+                <<      statement_placeholder(undeferred_statements_placeholder)
+                << "}"
+                ;
+        }
+        else
+        {
+            task_code << as_statement(new_construct);
+        }
+
+        TL::Source code;
         Nodecl::NodeclBase copied_statements_placeholder;
-        code
-            << "{"
-            <<      as_type(TL::Type::get_bool_type()) << "mcc_is_in_final;"
-            <<      "nanos_err_t mcc_err_in_final = nanos_in_final(&mcc_is_in_final);"
-            <<      "if (mcc_err_in_final != NANOS_OK) nanos_handle_error(mcc_err_in_final);"
-            <<      "if (mcc_is_in_final)"
-            <<      "{"
-            <<          statement_placeholder(copied_statements_placeholder)
-            <<      "}"
-            <<      "else"
-            <<      "{"
-            <<          as_statement(new_construct)
-            <<      "}"
-            << "}"
-            ;
+        if (generate_final_stmts)
+        {
+            TL::CounterManager::get_counter("nanox-tasks-final-fast-path")++;
+
+            code
+                << "{"
+                <<      as_type(TL::Type::get_bool_type()) << "mcc_is_in_final;"
+                <<      "nanos_err_t mcc_err_in_final = nanos_in_final(&mcc_is_in_final);"
+                <<      "if (mcc_err_in_final != NANOS_OK) nanos_handle_error(mcc_err_in_final);"
+                <<      "if (mcc_is_in_final)"
+                <<      "{"
+                <<          statement_placeholder(copied_statements_placeholder)
+                <<      "}"
+                <<      "else"
+                <<      "{"
+                <<          task_code
+                <<      "}"
+                << "}"
+                ;
+        }
+        else
+        {
+            code << "{" << task_code << "}";
+        }
 
         if (IS_FORTRAN_LANGUAGE)
             Source::source_language = SourceLanguage::C;
@@ -983,26 +1031,34 @@ void LoweringVisitor::visit_task(
 
         construct.replace(if_else_tree);
 
-        // We obtain the list node which contains the placeholder used to store
-        // the final stmts. This must be done before the replace because at
-        // this point the parent of the copied_statements_placeholder is the
-        // first (and the unique) list node
-        Nodecl::NodeclBase final_stmt_list = copied_statements_placeholder.get_parent();
+        if (undeferred_fast_path)
+        {
+            undeferred_statements_placeholder.replace(undeferred_stmts);
+        }
 
-        std::map<Nodecl::NodeclBase, Nodecl::NodeclBase>::iterator it = _final_stmts_map.find(construct);
+        if (generate_final_stmts)
+        {
+            // We obtain the list node which contains the placeholder used to store
+            // the final stmts. This must be done before the replace because at
+            // this point the parent of the copied_statements_placeholder is the
+            // first (and the unique) list node
+            Nodecl::NodeclBase final_stmt_list = copied_statements_placeholder.get_parent();
 
-        ERROR_CONDITION(it == _final_stmts_map.end(), "Unreachable code", 0);
+            std::map<Nodecl::NodeclBase, Nodecl::NodeclBase>::iterator it = _final_stmts_map.find(construct);
 
-        // We need to replace the placeholder before transforming the OpenMP/OmpSs pragmas
-        if (!task_reduction_final_statements.is_null())
-            copied_statements_placeholder.replace(task_reduction_final_statements);
-        else
-            copied_statements_placeholder.replace(it->second);
+            ERROR_CONDITION(it == _final_stmts_map.end(), "Unreachable code", 0);
+
+            // We need to replace the placeholder before transforming the OpenMP/OmpSs pragmas
+            if (!task_reduction_final_statements.is_null())
+                copied_statements_placeholder.replace(task_reduction_final_statements);
+            else
+                copied_statements_placeholder.replace(it->second);
 
-        ERROR_CONDITION(!copied_statements_placeholder.is_in_list(), "Unreachable code\n", 0);
+            ERROR_CONDITION(!copied_statements_placeholder.is_in_list(), "Unreachable code\n", 0);
 
-        // Walk over the tree transforming OpenMP/OmpSs non-task pragmas
-        walk(final_stmt_list);
+            // Walk over the tree transforming OpenMP/OmpSs non-task pragmas
+            walk(final_stmt_list);
+        }
     }
     else
     {
@@ -30,6 +30,7 @@
 #include "tl-final-stmts-generator.hpp"
 #include "tl-lowering-visitor.hpp"
 #include "tl-compilerpipeline.hpp"
+#include "tl-counters.hpp"
 #include "codegen-phase.hpp"
 #include "cxx-profile.h"
 #include "cxx-driver-utils.h"
@@ -46,6 +47,7 @@ namespace TL { namespace Nanox {
         _instrumentation_enabled(false),
         _nanos_debug_enabled(false),
         _final_clause_transformation_disabled(false),
+        _undeferred_fast_path_disabled(false),
         _firstprivates_always_references(false)
     {
         set_phase_name("Nanos++ lowering");
@@ -81,6 +83,11 @@ namespace TL { namespace Nanox {
                 _final_clause_transformation_str,
                 "0").connect(std::bind(&Lowering::set_disable_final_clause_transformation, this, std::placeholders::_1));
 
+        register_parameter("disable_undeferred_fast_path",
+                "Disables the direct execution of tasks whose 'if' clause evaluates to false",
+                _undeferred_fast_path_str,
+                "0").connect(std::bind(&Lowering::set_disable_undeferred_fast_path, this, std::placeholders::_1));
+
         register_parameter("firstprivates_always_references",
                 "For C/C++, passes firstprivates always by reference",
                 _firstprivates_always_references_str,
@@ -106,12 +113,25 @@ namespace TL { namespace Nanox {
         if (!_final_clause_transformation_disabled)
             final_generator.walk(n);
 
+        TL::CounterManager::get_counter("nanox-tasks") = 0;
+        TL::CounterManager::get_counter("nanox-tasks-final-fast-path") = 0;
+        TL::CounterManager::get_counter("nanox-tasks-undeferred-fast-path") = 0;
+
         LoweringVisitor lowering_visitor(
                 this,
                 std::static_pointer_cast<TL::OmpSs::FunctionTaskSet>(dto["openmp_task_info"]),
                 final_generator.get_final_stmts());
         lowering_visitor.walk(n);
 
+        if (debug_options.lowering_stats)
+        {
+            std::cerr << "Nanos++ lowering: "
+                << (int)TL::CounterManager::get_counter("nanox-tasks") << " tasks, "
+                << (int)TL::CounterManager::get_counter("nanox-tasks-final-fast-path") << " with a final fast path, "
+                << (int)TL::CounterManager::get_counter("nanox-tasks-undeferred-fast-path") << " with an undeferred fast path"
+                << std::endl;
+        }
+
         finalize_phase(n);
     }
 
@@ -170,6 +190,16 @@ namespace TL { namespace Nanox {
         return _final_clause_transformation_disabled;
     }
 
+    void Lowering::set_disable_undeferred_fast_path(const std::string& str)
+    {
+        parse_boolean_option("disable_undeferred_fast_path", str, _undeferred_fast_path_disabled, "Assuming false.");
+    }
+
+    bool Lowering::undeferred_fast_path_disabled() const
+    {
+        return _undeferred_fast_path_disabled;
+    }
+
     bool Lowering::firstprivates_always_by_reference() const
     {
         return _firstprivates_always_references;
@@ -48,6 +48,7 @@ namespace TL { namespace Nanox {
             bool nanos_debug_enabled() const;
             bool instrumentation_enabled() const;
             bool final_clause_transformation_disabled() const;
+            bool undeferred_fast_path_disabled() const;
             bool firstprivates_always_by_reference() const;
 
             struct Flag
@@ -99,6 +100,10 @@ namespace TL { namespace Nanox {
             bool _final_clause_transformation_disabled;
             void set_disable_final_clause_transformation(const std::string& str);
 
+            std::string _undeferred_fast_path_str;
+            bool _undeferred_fast_path_disabled;
+            void set_disable_undeferred_fast_path(const std::string& str);
+
             std::string _firstprivates_always_references_str;
             bool _firstprivates_always_references;
             void set_firstprivates_always_references(const std::string& str);
@@ -0,0 +1,371 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+
+  This file is part of Mercurium C/C++ source-to-source compiler.
+
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+#include "tl-omp-simd-dispatch.hpp"
+
+#include "tl-vector-isa-descriptor.hpp"
+#include "tl-nodecl-utils.hpp"
+#include "tl-symbol-utils.hpp"
+#include "tl-source.hpp"
+#include "tl-counters.hpp"
+#include "cxx-cexpr.h"
+#include "cxx-diagnostic.h"
+
+#include <sstream>
+#include <string.h>
+
+using namespace TL::Vectorization;
+
+namespace TL
+{
+namespace OpenMP
+{
+namespace
+{
+    // Ordered from the best to the worst ISA, the baseline must be the last
+    // one since it is chosen when no check succeeds. KNL is not here: its
+    // backend emits KNC intrinsics that GCC rejects in avx512f functions
+    struct dispatch_isa_t
+    {
+        VectorInstructionSet isa;
+        const char* name;
+        const char* target;
+        const char* cpu_check;
+    } dispatch_isa[] =
+    {
+        { AVX2_ISA, "avx2", "avx2,fma",
+            "__builtin_cpu_supports(\"avx2\") && __builtin_cpu_supports(\"fma\")" },
+        { SSE4_2_ISA, "sse4.2", NULL, NULL },
+    };
+
+    const int num_dispatch_isas = sizeof(dispatch_isa) / sizeof(*dispatch_isa);
+}
+
+TL::ObjectList<VectorInstructionSet> parse_dispatch_isas(const std::string &str)
+{
+    TL::ObjectList<VectorInstructionSet> result;
+
+    std::stringstream ss(str);
+    std::string name;
+    while (std::getline(ss, name, ','))
+    {
+        if (name.empty())
+            continue;
+
+        int i;
+        for (i = 0; i < num_dispatch_isas - 1; i++)
+        {
+            if (name == dispatch_isa[i].name)
+                break;
+        }
+
+        if (i == num_dispatch_isas - 1)
+        {
+            fatal_error("SIMD: invalid instruction set '%s' in simd_dispatch_isas. "
+                    "The only valid one is 'avx2'\n",
+                    name.c_str());
+        }
+
+        result.insert(dispatch_isa[i].isa);
+    }
+
+    return result;
+}
+
+SimdDispatch::SimdDispatch(const TL::ObjectList<VectorInstructionSet> &isa_list)
+    : _isa_list(isa_list)
+{
+}
+
+const TL::ObjectList<TL::Symbol> &SimdDispatch::get_function_versions() const
+{
+    return _function_versions;
+}
+
+bool SimdDispatch::is_dispatchable(const Nodecl::FunctionCode &function_code)
+{
+    // Vector versions of 'declare simd' functions are only generated for
+    // the baseline ISA, so they cannot be cloned for the other ones
+    if (function_code.get_parent().is<Nodecl::OpenMP::SimdFunction>())
+    {
+        warn_printf_at(function_code.get_locus(),
+                "SIMD: 'declare simd' function '%s' will not be dispatched at runtime\n",
+                function_code.get_symbol().get_name().c_str());
+        return false;
+    }
+
+    if (!Nodecl::Utils::nodecl_contains_nodecl_of_kind<Nodecl::OpenMP::Simd>(
+                function_code)
+            && !Nodecl::Utils::nodecl_contains_nodecl_of_kind<
+                   Nodecl::OpenMP::SimdFor>(function_code))
+        return false;
+
+    TL::Symbol func_sym = function_code.get_symbol();
+    if (func_sym.is_member() || func_sym.is_nested_function())
+    {
+        warn_printf_at(function_code.get_locus(),
+                "SIMD: function '%s' will not be dispatched at runtime, "
+                "only non-member functions are supported\n",
+                func_sym.get_name().c_str());
+        return false;
+    }
+
+    bool has_ellipsis = false;
+    TL::ObjectList<TL::Type> parameters = func_sym.get_type().parameters(has_ellipsis);
+    if (has_ellipsis)
+    {
+        warn_printf_at(function_code.get_locus(),
+                "SIMD: variadic function '%s' will not be dispatched at runtime\n",
+                func_sym.get_name().c_str());
+        return false;
+    }
+    for (TL::ObjectList<TL::Type>::iterator it = parameters.begin();
+            it != parameters.end();
+            it++)
+    {
+        if (it->is_rvalue_reference())
+        {
+            warn_printf_at(function_code.get_locus(),
+                    "SIMD: function '%s' will not be dispatched at runtime, "
+                    "it has rvalue reference parameters\n",
+                    func_sym.get_name().c_str());
+            return false;
+        }
+    }
+
+    // Every clone would get its own copy of a static local
+    TL::ObjectList<Nodecl::NodeclBase> object_inits =
+        Nodecl::Utils::nodecl_get_all_nodecls_of_kind<Nodecl::ObjectInit>(
+                function_code.get_statements());
+    for (TL::ObjectList<Nodecl::NodeclBase>::iterator it = object_inits.begin();
+            it != object_inits.end();
+            it++)
+    {
+        if (it->get_symbol().is_static())
+        {
+            warn_printf_at(function_code.get_locus(),
+                    "SIMD: function '%s' will not be dispatched at runtime, "
+                    "it has static local variables\n",
+                    func_sym.get_name().c_str());
+            return false;
+        }
+    }
+
+    // Neither can the functions calling them
+    TL::ObjectList<Nodecl::NodeclBase> function_calls =
+        Nodecl::Utils::nodecl_get_all_nodecls_of_kind<Nodecl::FunctionCall>(
+                function_code.get_statements());
+    for (TL::ObjectList<Nodecl::NodeclBase>::iterator it = function_calls.begin();
+            it != function_calls.end();
+            it++)
+    {
+        Nodecl::NodeclBase called = it->as<Nodecl::FunctionCall>().get_called();
+        if (called.is<Nodecl::Symbol>()
+                && _simd_functions.contains(called.get_symbol()))
+        {
+            warn_printf_at(function_code.get_locus(),
+                    "SIMD: function '%s' will not be dispatched at runtime, "
+                    "it calls the 'declare simd' function '%s'\n",
+                    func_sym.get_name().c_str(),
+                    called.get_symbol().get_name().c_str());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+TL::Symbol SimdDispatch::new_function_version(
+        const Nodecl::FunctionCode &function_code,
+        VectorInstructionSet isa,
+        int dispatch_id)
+{
+    TL::Symbol func_sym = function_code.get_symbol();
+
+    std::stringstream version_name;
+    version_name << "__" << func_sym.get_name() << "_" << dispatch_id << "_"
+                 << get_vector_isa_description(isa).get_id();
+
+    TL::Symbol version_sym = SymbolUtils::new_function_symbol_for_deep_copy(
+            func_sym, version_name.str());
+
+    Nodecl::Utils::SimpleSymbolMap symbol_map;
+    symbol_map.add_map(func_sym, version_sym);
+
+    Nodecl::NodeclBase version_code = Nodecl::Utils::deep_copy(
+            function_code, func_sym.get_scope(), symbol_map);
+
+    // Versions are only reachable through the dispatcher
+    symbol_entity_specs_set_is_static(version_sym.get_internal_symbol(), 1);
+    symbol_entity_specs_set_is_extern(version_sym.get_internal_symbol(), 0);
+
+    for (int i = 0; i < num_dispatch_isas; i++)
+    {
+        if (dispatch_isa[i].isa == isa
+                && dispatch_isa[i].target != NULL)
+        {
+            const char* target = dispatch_isa[i].target;
+            gcc_attribute_t target_attr = { "target",
+                Nodecl::List::make(const_value_to_nodecl(
+                            const_value_make_string_null_ended(
+                                target, strlen(target)))).get_internal_nodecl() };
+            symbol_entity_specs_add_gcc_attributes(
+                    version_sym.get_internal_symbol(), target_attr);
+        }
+    }
+
+    Nodecl::Utils::prepend_items_before(function_code, version_code);
+
+    set_function_version_isa(version_sym, isa);
+    _function_versions.append(version_sym);
+
+    return version_sym;
+}
+
+void SimdDispatch::build_dispatcher(const Nodecl::FunctionCode &function_code,
+        const TL::ObjectList<TL::Symbol> &versions,
+        int dispatch_id)
+{
+    TL::Symbol func_sym = function_code.get_symbol();
+    const locus_t* locus = function_code.get_locus();
+
+    std::stringstream pointer_name;
+    pointer_name << "__" << func_sym.get_name() << "_" << dispatch_id << "_dispatch";
+
+    TL::Source dispatch_src, selection_src, arguments_src;
+
+    TL::ObjectList<TL::Symbol> parameters = func_sym.get_related_symbols();
+    for (TL::ObjectList<TL::Symbol>::iterator it = parameters.begin();
+            it != parameters.end();
+            it++)
+    {
+        if (it != parameters.begin())
+            arguments_src << ", ";
+        arguments_src << as_symbol(*it);
+    }
+
+    // versions follows the order of dispatch_isa
+    ERROR_CONDITION(versions.size() < 2, "At least two versions are required", 0);
+    for (unsigned int i = 0; i < versions.size(); i++)
+    {
+        VectorInstructionSet isa = SSE4_2_ISA;
+        get_function_version_isa(versions[i], isa);
+
+        const char* cpu_check = NULL;
+        for (int j = 0; j < num_dispatch_isas; j++)
+        {
+            if (dispatch_isa[j].isa == isa)
+                cpu_check = dispatch_isa[j].cpu_check;
+        }
+
+        if (cpu_check != NULL)
+        {
+            selection_src << "if (" << cpu_check << ") ";
+        }
+        selection_src << pointer_name.str() << " = " << as_symbol(versions[i]) << ";";
+        if (cpu_check != NULL)
+        {
+            selection_src << "else ";
+        }
+    }
+
+    // Concurrent first calls store the same value so no synchronization
+    // is needed
+    dispatch_src
+        << "static " << as_type(func_sym.get_type().get_pointer_to())
+        <<     " " << pointer_name.str() << " = 0;"
+        << "if (" << pointer_name.str() << " == 0)"
+        << "{"
+        <<     "__builtin_cpu_init();"
+        <<     selection_src
+        << "}"
+        ;
+
+    if (func_sym.get_type().returns().is_void())
+    {
+        dispatch_src << pointer_name.str() << "(" << arguments_src << ");";
+    }
+    else
+    {
+        dispatch_src << "return " << pointer_name.str() << "(" << arguments_src << ");";
+    }
+
+    Nodecl::NodeclBase empty_stmt = Nodecl::EmptyStatement::make(locus);
+    Nodecl::NodeclBase new_body = Nodecl::CompoundStatement::make(
+            Nodecl::List::make(empty_stmt),
+            /* destructors */ Nodecl::NodeclBase::null(),
+            locus);
+
+    Nodecl::Context context = function_code.get_statements().as<Nodecl::Context>();
+    context.get_in_context().replace(Nodecl::List::make(new_body));
+
+    empty_stmt.replace(dispatch_src.parse_statement(empty_stmt));
+}
+
+void SimdDispatch::dispatch(Nodecl::NodeclBase translation_unit)
+{
+    TL::ObjectList<Nodecl::NodeclBase> simd_function_list =
+        Nodecl::Utils::nodecl_get_all_nodecls_of_kind<Nodecl::OpenMP::SimdFunction>(
+                translation_unit);
+    for (TL::ObjectList<Nodecl::NodeclBase>::iterator it = simd_function_list.begin();
+            it != simd_function_list.end();
+            it++)
+    {
+        _simd_functions.insert(
+                it->as<Nodecl::OpenMP::SimdFunction>().get_statement().get_symbol());
+    }
+
+    TL::ObjectList<Nodecl::NodeclBase> function_code_list =
+        Nodecl::Utils::nodecl_get_all_nodecls_of_kind<Nodecl::FunctionCode>(
+                translation_unit);
+    for (TL::ObjectList<Nodecl::NodeclBase>::iterator it = function_code_list.begin();
+            it != function_code_list.end();
+            it++)
+    {
+        Nodecl::FunctionCode function_code = it->as<Nodecl::FunctionCode>();
+        if (!is_dispatchable(function_code))
+            continue;
+
+        TL::Counter &counter = TL::CounterManager::get_counter("simd-dispatch");
+        int dispatch_id = (int)counter;
+        counter++;
+
+        TL::ObjectList<TL::Symbol> versions;
+        for (int i = 0; i < num_dispatch_isas; i++)
+        {
+            if (dispatch_isa[i].isa == SSE4_2_ISA
+                    || _isa_list.contains(dispatch_isa[i].isa))
+            {
+                versions.append(new_function_version(function_code,
+                            dispatch_isa[i].isa, dispatch_id));
+            }
+        }
+
+        build_dispatcher(function_code, versions, dispatch_id);
+    }
+}
+}
+}
@@ -0,0 +1,74 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+
+  This file is part of Mercurium C/C++ source-to-source compiler.
+
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+#ifndef TL_OMP_SIMD_DISPATCH_HPP
+#define TL_OMP_SIMD_DISPATCH_HPP
+
+#include "tl-vectorization-common.hpp"
+#include "tl-nodecl.hpp"
+#include "tl-objectlist.hpp"
+
+namespace TL
+{
+namespace OpenMP
+{
+// Clones every function with simd loops once per instruction set and turns
+// the original function into a dispatcher that picks the best clone for the
+// running CPU the first time it is called
+class SimdDispatch
+{
+  private:
+    TL::ObjectList<Vectorization::VectorInstructionSet> _isa_list;
+
+    TL::ObjectList<TL::Symbol> _simd_functions;
+    TL::ObjectList<TL::Symbol> _function_versions;
+
+    bool is_dispatchable(const Nodecl::FunctionCode &function_code);
+
+    TL::Symbol new_function_version(const Nodecl::FunctionCode &function_code,
+                                    Vectorization::VectorInstructionSet isa,
+                                    int dispatch_id);
+
+    void build_dispatcher(const Nodecl::FunctionCode &function_code,
+                          const TL::ObjectList<TL::Symbol> &versions,
+                          int dispatch_id);
+
+  public:
+    SimdDispatch(
+        const TL::ObjectList<Vectorization::VectorInstructionSet> &isa_list);
+
+    void dispatch(Nodecl::NodeclBase translation_unit);
+
+    const TL::ObjectList<TL::Symbol> &get_function_versions() const;
+};
+
+// Parses the comma-separated value of simd_dispatch_isas
+TL::ObjectList<Vectorization::VectorInstructionSet> parse_dispatch_isas(
+    const std::string &str);
+}
+}
+
+#endif // TL_OMP_SIMD_DISPATCH_HPP
@@ -48,11 +48,15 @@ SimdProcessingBase::SimdProcessingBase(
     bool svml_enabled,
     bool only_adjacent_accesses,
     bool only_aligned_accesses,
-    bool overlap_in_place)
+    bool overlap_in_place,
+    bool cost_model_enabled,
+    bool alignment_versioning_enabled)
     : _vectorizer(TL::Vectorization::Vectorizer::get_vectorizer()),
       _vector_isa_desc(TL::Vectorization::get_vector_isa_description(vector_isa)),
       _fast_math_enabled(fast_math_enabled),
-      _overlap_in_place(overlap_in_place)
+      _overlap_in_place(overlap_in_place),
+      _cost_model_enabled(cost_model_enabled),
+      _alignment_versioning_enabled(alignment_versioning_enabled)
 {
     if (fast_math_enabled)
     {
@@ -97,6 +101,9 @@ SimdProcessingBase::SimdProcessingBase(
         case ROMOL_ISA:
             break;
 
+        case GENERIC_ISA:
+            break;
+
         default:
             fatal_error("SIMD: Unsupported vector ISA: %d", vector_isa);
     }
@@ -127,13 +134,17 @@ SimdPreregisterVisitor::SimdPreregisterVisitor(
     bool svml_enabled,
     bool only_adjacent_accesses,
     bool only_aligned_accesses,
-    bool overlap_in_place)
+    bool overlap_in_place,
+    bool cost_model_enabled,
+    bool alignment_versioning_enabled)
     : SimdProcessingBase(simd_isa,
                          fast_math_enabled,
                          svml_enabled,
                          only_adjacent_accesses,
                          only_aligned_accesses,
-                         overlap_in_place)
+                         overlap_in_place,
+                         cost_model_enabled,
+                         alignment_versioning_enabled)
 {
 }
 
@@ -147,13 +158,17 @@ SimdVisitor::SimdVisitor(Vectorization::VectorInstructionSet simd_isa,
                          bool svml_enabled,
                          bool only_adjacent_accesses,
                          bool only_aligned_accesses,
-                         bool overlap_in_place)
+                         bool overlap_in_place,
+                         bool cost_model_enabled,
+                         bool alignment_versioning_enabled)
     : SimdProcessingBase(simd_isa,
                          fast_math_enabled,
                          svml_enabled,
                          only_adjacent_accesses,
                          only_aligned_accesses,
-                         overlap_in_place)
+                         overlap_in_place,
+                         cost_model_enabled,
+                         alignment_versioning_enabled)
 {
 }
 
@@ -184,6 +199,17 @@ void SimdVisitor::visit(const Nodecl::FunctionCode &n)
     for (const auto &node : omp_simd_for_list)
         _vectorizer.preprocess_code(node);
 
+    // Versioning replaces the simd nodes so they are gathered again
+    if (_alignment_versioning_enabled && !omp_simd_list.empty())
+    {
+        for (const auto &node : omp_simd_list)
+            _vectorizer.version_loop_for_alignment(
+                node.as<Nodecl::OpenMP::Simd>(), _vector_isa_desc);
+
+        omp_simd_list = Nodecl::Utils::nodecl_get_all_nodecls_of_kind<
+            Nodecl::OpenMP::Simd>(n);
+    }
+
     if (!omp_simd_list.empty() || !omp_simd_for_list.empty())
     {
         _vectorizer.initialize_analysis(n);
@@ -320,6 +346,28 @@ void SimdVisitor::visit(const Nodecl::OpenMP::Simd &simd_input_node)
                                                  vectorlengthfor_type,
                                                  _vector_isa_desc);
 
+    // The cost model only refines the vec factor when the user did not
+    // choose it explicitly
+    if (_cost_model_enabled
+            && vectorlength_in_elements == 0
+            && !vectorlengthfor_type.is_valid())
+    {
+        CostModelDecision decision = _vectorizer.evaluate_cost_model(
+            loop_statement, simd_environment, _vector_isa_desc, vec_factor);
+
+        if (!decision.vectorize)
+        {
+            // Keep the scalar loop
+            simd_input_node.replace(simd_input_node.get_statement());
+            return;
+        }
+
+        vec_factor = decision.vec_factor;
+
+        if (unroll_factor == 0 && decision.interleave_factor > 1)
+            unroll_factor = decision.interleave_factor;
+    }
+
     // External symbols (loop)
     std::map<TL::Symbol, TL::Symbol> new_external_vector_symbol_map;
     // Reduction and simd_reduction clauses
@@ -666,6 +714,26 @@ void SimdVisitor::visit(const Nodecl::OpenMP::SimdFor &simd_input_node)
                                                  vectorlengthfor_type,
                                                  _vector_isa_desc);
 
+    if (_cost_model_enabled
+            && vectorlength_in_elements == 0
+            && !vectorlengthfor_type.is_valid())
+    {
+        CostModelDecision decision = _vectorizer.evaluate_cost_model(
+            for_statement, omp_for_environment, _vector_isa_desc, vec_factor);
+
+        if (!decision.vectorize)
+        {
+            // Keep the worksharing loop scalar
+            simd_input_node.replace(omp_for);
+            return;
+        }
+
+        vec_factor = decision.vec_factor;
+
+        if (unroll_factor == 0 && decision.interleave_factor > 1)
+            unroll_factor = decision.interleave_factor;
+    }
+
     // External symbols (loop)
     std::map<TL::Symbol, TL::Symbol> new_external_vector_symbol_map;
     // Reduction clause
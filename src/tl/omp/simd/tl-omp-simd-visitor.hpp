@@ -43,13 +43,17 @@ class SimdProcessingBase
     const TL::Vectorization::VectorIsaDescriptor& _vector_isa_desc;
     bool _fast_math_enabled;
     bool _overlap_in_place;
+    bool _cost_model_enabled;
+    bool _alignment_versioning_enabled;
 
     SimdProcessingBase(Vectorization::VectorInstructionSet simd_isa,
                        bool fast_math_enabled,
                        bool svml_enabled,
                        bool only_adjacent_accesses,
                        bool only_aligned_accesses,
-                       bool overlap_in_place);
+                       bool overlap_in_place,
+                       bool cost_model_enabled,
+                       bool alignment_versioning_enabled);
 };
 
 class SimdVisitor : public Nodecl::ExhaustiveVisitor<void>,
@@ -65,7 +69,9 @@ class SimdVisitor : public Nodecl::ExhaustiveVisitor<void>,
                 bool svml_enabled,
                 bool only_adjacent_accesses,
                 bool only_aligned_accesses,
-                bool overlap_in_place);
+                bool overlap_in_place,
+                bool cost_model_enabled,
+                bool alignment_versioning_enabled);
     ~SimdVisitor();
 
     virtual void visit(const Nodecl::FunctionCode &func_code);
@@ -90,7 +96,9 @@ class SimdPreregisterVisitor : public Nodecl::ExhaustiveVisitor<void>,
                            bool svml_enabled,
                            bool only_adjacent_accesses,
                            bool only_aligned_accesses,
-                           bool overlap_in_place);
+                           bool overlap_in_place,
+                           bool cost_model_enabled,
+                           bool alignment_versioning_enabled);
     ~SimdPreregisterVisitor();
 
     virtual void visit(const Nodecl::OpenMP::SimdFunction &simd_node);
@@ -26,8 +26,10 @@
 
 #include "tl-omp-simd.hpp"
 #include "tl-omp-simd-visitor.hpp"
+#include "tl-omp-simd-dispatch.hpp"
 
 #include "tl-vectorization-common.hpp"
+#include "tl-vector-isa-descriptor.hpp"
 
 using namespace TL::Vectorization;
 
@@ -42,11 +44,14 @@ namespace TL {
             _avx2_enabled(false),
             _neon_enabled(false),
             _romol_enabled(false),
+            _generic_enabled(false),
             _knc_enabled(false),
             _knl_enabled(false),
             _only_adjacent_accesses_enabled(false),
             _only_aligned_accesses_enabled(false),
-            _overlap_in_place(false)
+            _overlap_in_place(false),
+            _cost_model_enabled(false),
+            _alignment_versioning_enabled(false)
         {
             set_phase_name("Vectorize OpenMP SIMD parallel IR");
             set_phase_description("This phase vectorize the OpenMP SIMD parallel IR");
@@ -90,6 +95,16 @@ namespace TL {
                     _romol_enabled_str,
                     "0").connect(std::bind(&Simd::set_romol, this, std::placeholders::_1));
 
+            register_parameter("generic_enabled",
+                    "If set to '1' enables compilation for generic GCC vectors, otherwise it is disabled",
+                    _generic_enabled_str,
+                    "0").connect(std::bind(&Simd::set_generic, this, std::placeholders::_1));
+
+            register_parameter("generic_vector_length",
+                    "Vector length in bytes used when compiling for generic GCC vectors",
+                    _generic_vector_length_str,
+                    "16").connect(std::bind(&Simd::set_generic_vector_length, this, std::placeholders::_1));
+
             register_parameter("only_adjacent_accesses",
                     "If set to '1' disables emission of gather/scatter vector instructions",
                     _only_adjacent_accesses_str,
@@ -105,6 +120,22 @@ namespace TL {
                     _overlap_in_place_str,
                     "0").connect(std::bind(&Simd::set_overlap_in_place, this, std::placeholders::_1));
 
+            register_parameter("simd_cost_model",
+                    "If set to '1' a cost model chooses the vectorization and interleave factors and may keep loops scalar",
+                    _cost_model_enabled_str,
+                    "0").connect(std::bind(&Simd::set_cost_model, this, std::placeholders::_1));
+
+            register_parameter("simd_alignment_versioning",
+                    "If set to '1' simd loops are versioned on the runtime alignment of their pointers and peeled to reach it",
+                    _alignment_versioning_enabled_str,
+                    "0").connect(std::bind(&Simd::set_alignment_versioning, this, std::placeholders::_1));
+
+            register_parameter("simd_dispatch_isas",
+                    "Comma-separated list of extra instruction sets (only 'avx2') for which functions with simd loops are "
+                    "also vectorized. The best version is chosen at runtime",
+                    _dispatch_isas_str,
+                    "");
+
         }
 
         void Simd::set_simd(const std::string simd_enabled_str)
@@ -147,6 +178,17 @@ namespace TL {
             parse_boolean_option("romol_enabled", romol_enabled_str, _romol_enabled, "Invalid romol_enabled value");
         }
 
+        void Simd::set_generic(const std::string generic_enabled_str)
+        {
+            parse_boolean_option("generic_enabled", generic_enabled_str, _generic_enabled, "Invalid generic_enabled value");
+        }
+
+        void Simd::set_generic_vector_length(const std::string generic_vector_length_str)
+        {
+            TL::Vectorization::set_generic_vector_length(
+                    TL::Vectorization::parse_generic_vector_length(generic_vector_length_str));
+        }
+
         void Simd::set_only_adjcent_accesses(
                 const std::string only_adjacent_accesses_str)
         {
@@ -173,6 +215,22 @@ namespace TL {
             }
         }
 
+        void Simd::set_cost_model(const std::string cost_model_enabled_str)
+        {
+            parse_boolean_option("simd_cost_model",
+                    cost_model_enabled_str,
+                    _cost_model_enabled,
+                    "Invalid simd_cost_model value");
+        }
+
+        void Simd::set_alignment_versioning(const std::string alignment_versioning_enabled_str)
+        {
+            parse_boolean_option("simd_alignment_versioning",
+                    alignment_versioning_enabled_str,
+                    _alignment_versioning_enabled,
+                    "Invalid simd_alignment_versioning value");
+        }
+
         void Simd::pre_run(TL::DTO& dto)
         {
             this->PragmaCustomCompilerPhase::pre_run(dto);
@@ -200,6 +258,7 @@ namespace TL {
                     { _knl_enabled,  "KNL",  KNL_ISA, },
                     { _neon_enabled, "NEON", NEON_ISA },
                     { _romol_enabled, "RoMoL", ROMOL_ISA },
+                    { _generic_enabled, "generic", GENERIC_ISA },
                 };
 
                 simd_isa = SSE4_2_ISA; // Default ISA is SSE 4.2
@@ -233,21 +292,79 @@ namespace TL {
                     fatal_error("SVML cannot be used with RoMoL\n");
                 }
 
+                if (_svml_enabled && _generic_enabled)
+                {
+                    fatal_error("SVML cannot be used with generic vectors\n");
+                }
+
+                TL::ObjectList<VectorInstructionSet> dispatch_isas =
+                    parse_dispatch_isas(_dispatch_isas_str);
+
+                if (!dispatch_isas.empty())
+                {
+                    if (simd_isa != SSE4_2_ISA)
+                    {
+                        fatal_error("SIMD: simd_dispatch_isas requires SSE 4.2 as the baseline instruction set\n");
+                    }
+                    if (_svml_enabled)
+                    {
+                        fatal_error("SVML cannot be used with simd_dispatch_isas\n");
+                    }
+                    if (IS_FORTRAN_LANGUAGE)
+                    {
+                        fatal_error("SIMD: simd_dispatch_isas is not supported in Fortran\n");
+                    }
+                }
+
                 SimdPreregisterVisitor simd_preregister_visitor(
                     simd_isa,
                     _fast_math_enabled,
                     _svml_enabled,
                     _only_adjacent_accesses_enabled,
                     _only_aligned_accesses_enabled,
-                    _overlap_in_place);
+                    _overlap_in_place,
+                    _cost_model_enabled,
+                    _alignment_versioning_enabled);
                 simd_preregister_visitor.walk(translation_unit);
 
+                if (!dispatch_isas.empty())
+                {
+                    SimdDispatch simd_dispatch(dispatch_isas);
+                    simd_dispatch.dispatch(translation_unit);
+
+                    // Versions for the baseline ISA are vectorized below
+                    // along with the rest of the translation unit
+                    TL::ObjectList<TL::Symbol> versions =
+                        simd_dispatch.get_function_versions();
+                    for (TL::ObjectList<TL::Symbol>::iterator it = versions.begin();
+                            it != versions.end();
+                            it++)
+                    {
+                        VectorInstructionSet version_isa;
+                        if (!get_function_version_isa(*it, version_isa)
+                                || version_isa == simd_isa)
+                            continue;
+
+                        SimdVisitor version_simd_visitor(version_isa,
+                                _fast_math_enabled,
+                                _svml_enabled,
+                                _only_adjacent_accesses_enabled,
+                                _only_aligned_accesses_enabled,
+                                _overlap_in_place,
+                                _cost_model_enabled,
+                                _alignment_versioning_enabled);
+                        version_simd_visitor.walk(it->get_function_code());
+                    }
+                }
+
                 SimdVisitor simd_visitor(simd_isa,
                                          _fast_math_enabled,
                                          _svml_enabled,
                                          _only_adjacent_accesses_enabled,
                                          _only_aligned_accesses_enabled,
-                                         _overlap_in_place);
+                                         _overlap_in_place,
+                                         _cost_model_enabled,
+                                         _alignment_versioning_enabled);
                 simd_visitor.walk(translation_unit);
             }
         }
@@ -52,11 +52,16 @@ namespace TL
                 std::string _avx2_enabled_str;
                 std::string _neon_enabled_str;
                 std::string _romol_enabled_str;
+                std::string _generic_enabled_str;
+                std::string _generic_vector_length_str;
                 std::string _knc_enabled_str;
                 std::string _knl_enabled_str;
                 std::string _only_adjacent_accesses_str;
                 std::string _only_aligned_accesses_str;
                 std::string _overlap_in_place_str;
+                std::string _cost_model_enabled_str;
+                std::string _alignment_versioning_enabled_str;
+                std::string _dispatch_isas_str;
 
                 bool _simd_enabled;
                 bool _svml_enabled;
@@ -64,11 +69,14 @@ namespace TL
                 bool _avx2_enabled;
                 bool _neon_enabled;
                 bool _romol_enabled;
+                bool _generic_enabled;
                 bool _knc_enabled;
                 bool _knl_enabled;
                 bool _only_adjacent_accesses_enabled;
                 bool _only_aligned_accesses_enabled;
                 bool _overlap_in_place;
+                bool _cost_model_enabled;
+                bool _alignment_versioning_enabled;
 
                 void set_simd(const std::string simd_enabled_str);
                 void set_svml(const std::string svml_enabled_str);
@@ -76,11 +84,15 @@ namespace TL
                 void set_avx2(const std::string avx2_enabled_str);
                 void set_neon(const std::string neon_enabled_str);
                 void set_romol(const std::string romol_enabled_str);
+                void set_generic(const std::string generic_enabled_str);
+                void set_generic_vector_length(const std::string generic_vector_length_str);
                 void set_knc(const std::string knc_enabled_str);
                 void set_knl(const std::string knl_enabled_str);
                 void set_only_adjcent_accesses(const std::string only_adjacent_accesses_str);
                 void set_only_aligned_accesses(const std::string only_aligned_accesses_str);
                 void set_overlap_in_place(const std::string overlap_in_place_str);
+                void set_cost_model(const std::string cost_model_enabled_str);
+                void set_alignment_versioning(const std::string alignment_versioning_enabled_str);
         };
     }
 }
@@ -62,6 +62,8 @@ namespace TL { namespace Nanos6 {
             void visit(const Nodecl::OpenMP::FlushMemory &n);
             void visit(const Nodecl::OmpSs::Register &n);
             void visit(const Nodecl::OmpSs::Unregister &n);
+            void visit(const Nodecl::OpenMP::DoacrossWait &n);
+            void visit(const Nodecl::OpenMP::DoacrossPost &n);
 
         private:
             void lower_taskwait(const Nodecl::OpenMP::Taskwait& n);
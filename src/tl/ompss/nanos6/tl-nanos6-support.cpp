@@ -116,3 +116,50 @@ void TL::Nanos6::add_extra_mappings_for_vla_types(
             t.points_to(), sc, symbol_map, new_vlas);
     }
 }
+
+bool TL::Nanos6::subscript_is_iterator_plus_offset(
+    Nodecl::NodeclBase subscript,
+    TL::Symbol iterator,
+    /* out */
+    Nodecl::NodeclBase &offset)
+{
+    subscript = subscript.no_conv();
+
+    if (subscript.is<Nodecl::Symbol>())
+    {
+        offset = Nodecl::NodeclBase::null();
+        return subscript.get_symbol() == iterator;
+    }
+    else if (subscript.is<Nodecl::Add>() || subscript.is<Nodecl::Minus>())
+    {
+        Nodecl::NodeclBase lhs, rhs;
+        if (subscript.is<Nodecl::Add>())
+        {
+            lhs = subscript.as<Nodecl::Add>().get_lhs().no_conv();
+            rhs = subscript.as<Nodecl::Add>().get_rhs().no_conv();
+        }
+        else
+        {
+            lhs = subscript.as<Nodecl::Minus>().get_lhs().no_conv();
+            rhs = subscript.as<Nodecl::Minus>().get_rhs().no_conv();
+        }
+
+        if (subscript.is<Nodecl::Add>() && rhs.is<Nodecl::Symbol>()
+            && rhs.get_symbol() == iterator)
+            std::swap(lhs, rhs);
+
+        if (!lhs.is<Nodecl::Symbol>() || lhs.get_symbol() != iterator
+            || Nodecl::Utils::get_all_symbols(rhs).contains(iterator))
+            return false;
+
+        if (subscript.is<Nodecl::Add>())
+            offset = rhs.shallow_copy();
+        else
+            offset = Nodecl::Neg::make(rhs.shallow_copy(),
+                                       rhs.get_type().no_ref());
+
+        return true;
+    }
+
+    return false;
+}
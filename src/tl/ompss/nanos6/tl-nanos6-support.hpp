@@ -44,6 +44,15 @@ void add_extra_mappings_for_vla_types(
     /* out */
     Nodecl::Utils::SimpleSymbolMap &symbol_map,
     TL::ObjectList<TL::Symbol> &vla_vars);
+
+// States whether 'subscript' has the form 'it', 'it + e', 'e + it' or 'it - e',
+// where 'e' does not depend on the iterator 'it'. The offset 'e' (negated
+// for the 'it - e' case) is returned in 'offset', and it is null if there
+// is no offset
+bool subscript_is_iterator_plus_offset(Nodecl::NodeclBase subscript,
+                                       TL::Symbol iterator,
+                                       /* out */
+                                       Nodecl::NodeclBase &offset);
 }
 }
 
@@ -0,0 +1,704 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2015-2015 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+#include "tl-nanos6-task-aggregation.hpp"
+#include "tl-nanos6-support.hpp"
+
+#include "tl-lowering-utils.hpp"
+#include "tl-loop-cost.hpp"
+#include "tl-nodecl-utils.hpp"
+#include "tl-counters.hpp"
+
+#include "cxx-cexpr.h"
+
+#include <algorithm>
+
+namespace TL { namespace Nanos6 {
+
+    namespace {
+
+    // Returns the only statement of 'n' looking through compound statements,
+    // or null if there is more than one
+    Nodecl::NodeclBase get_single_statement(Nodecl::NodeclBase n)
+    {
+        while (!n.is_null())
+        {
+            if (n.is<Nodecl::List>())
+            {
+                Nodecl::List l = n.as<Nodecl::List>();
+                if (l.size() != 1)
+                    return Nodecl::NodeclBase::null();
+                n = *l.begin();
+            }
+            else if (n.is<Nodecl::Context>())
+            {
+                n = n.as<Nodecl::Context>().get_in_context();
+            }
+            else if (n.is<Nodecl::CompoundStatement>())
+            {
+                n = n.as<Nodecl::CompoundStatement>().get_statements();
+            }
+            else
+            {
+                return n;
+            }
+        }
+        return n;
+    }
+
+    bool uses_symbol(Nodecl::NodeclBase n, TL::Symbol sym)
+    {
+        return Nodecl::Utils::get_all_symbols(n).contains(sym);
+    }
+
+    TL::ObjectList<TL::Symbol> get_data_sharing_symbols(Nodecl::NodeclBase symbols)
+    {
+        return symbols.as<Nodecl::List>()
+            .to_object_list()
+            .map<TL::Symbol>(&Nodecl::NodeclBase::get_symbol);
+    }
+
+    // Replaces every occurrence of 'sym' in 'n' by a copy of 'replacement'
+    void replace_symbol(Nodecl::NodeclBase n, TL::Symbol sym, Nodecl::NodeclBase replacement)
+    {
+        if (n.is_null())
+            return;
+
+        if (n.is<Nodecl::Symbol>()
+                && n.get_symbol() == sym)
+        {
+            n.replace(replacement.shallow_copy());
+            return;
+        }
+
+        Nodecl::NodeclBase::Children children = n.children();
+        for (Nodecl::NodeclBase::Children::iterator it = children.begin();
+                it != children.end();
+                it++)
+        {
+            replace_symbol(*it, sym, replacement);
+        }
+    }
+
+    Nodecl::NodeclBase add_offset(Nodecl::NodeclBase n, Nodecl::NodeclBase offset)
+    {
+        if (offset.is_null())
+            return n.shallow_copy();
+
+        return Nodecl::Add::make(
+                Nodecl::ParenthesizedExpression::make(
+                    n.shallow_copy(), n.get_type().no_ref()),
+                offset.shallow_copy(),
+                n.get_type().no_ref());
+    }
+
+    // Values taken by the induction variable in the iterations of one bundle
+    struct Bundle
+    {
+        TL::Symbol induction_variable;
+        // Lowest and highest values, both inclusive
+        Nodecl::NodeclBase lower;
+        Nodecl::NodeclBase upper;
+        // Absolute value of the step of the loop
+        Nodecl::NodeclBase stride;
+        TL::Scope scope;
+    };
+
+    // Returns a dependence that covers 'dep' in all the iterations of
+    // 'bundle', or null if there is not any
+    Nodecl::NodeclBase aggregate_dependence(Nodecl::NodeclBase dep, const Bundle& bundle)
+    {
+        TL::Symbol iv = bundle.induction_variable;
+        if (!uses_symbol(dep, iv))
+            return dep.shallow_copy();
+
+        // The induction variable itself is firstprivate, a dependence on it
+        // is meaningless once it is bundled
+        if (dep.no_conv().is<Nodecl::Symbol>())
+            return Nodecl::NodeclBase::null();
+
+        Nodecl::NodeclBase base = dep.no_conv();
+        if (base.is<Nodecl::ArraySubscript>()
+                && !uses_symbol(base.as<Nodecl::ArraySubscript>().get_subscripted(), iv))
+        {
+            Nodecl::ArraySubscript array = base.as<Nodecl::ArraySubscript>();
+            Nodecl::List original_subscripts = array.get_subscripts().as<Nodecl::List>();
+
+            TL::ObjectList<Nodecl::NodeclBase> subscripts;
+            int position = -1;
+            bool valid = true;
+            for (Nodecl::List::iterator it = original_subscripts.begin();
+                    it != original_subscripts.end();
+                    it++)
+            {
+                if (uses_symbol(*it, iv))
+                {
+                    valid = valid && (position == -1);
+                    position = subscripts.size();
+                }
+                subscripts.append(it->shallow_copy());
+            }
+
+            Nodecl::NodeclBase lower, upper;
+            if (valid && position != -1)
+            {
+                Nodecl::NodeclBase subscript = subscripts[position].no_conv();
+                if (subscript.is<Nodecl::Range>())
+                {
+                    // a[i + e1 : i + e2] becomes a[first + e1 : last + e2]. If
+                    // the step is larger than the section this also covers
+                    // elements that are not accessed, which is conservative
+                    Nodecl::Range range = subscript.as<Nodecl::Range>();
+                    Nodecl::NodeclBase stride = range.get_stride();
+                    Nodecl::NodeclBase lower_offset, upper_offset;
+                    if ((stride.is_null()
+                                || (stride.is_constant() && const_value_is_one(stride.get_constant())))
+                            && subscript_is_iterator_plus_offset(range.get_lower(), iv, lower_offset)
+                            && subscript_is_iterator_plus_offset(range.get_upper(), iv, upper_offset))
+                    {
+                        lower = add_offset(bundle.lower, lower_offset);
+                        upper = add_offset(bundle.upper, upper_offset);
+                    }
+                }
+                else
+                {
+                    // a[i + e] becomes a[first + e : last + e] only if every
+                    // element in between is accessed
+                    Nodecl::NodeclBase offset;
+                    if (bundle.stride.is_constant()
+                            && const_value_is_one(bundle.stride.get_constant())
+                            && subscript_is_iterator_plus_offset(subscript, iv, offset))
+                    {
+                        lower = add_offset(bundle.lower, offset);
+                        upper = add_offset(bundle.upper, offset);
+                    }
+                }
+            }
+
+            if (!lower.is_null())
+            {
+                subscripts[position] = Nodecl::Range::make(
+                        lower,
+                        upper,
+                        const_value_to_nodecl_with_basic_type(
+                            const_value_get_one(type_get_size(get_ptrdiff_t_type()), /* signed */ 1),
+                            get_ptrdiff_t_type()),
+                        TL::Type::get_ptrdiff_t_type(),
+                        subscripts[position].get_locus());
+
+                return Nodecl::ArraySubscript::make(
+                        array.get_subscripted().shallow_copy(),
+                        Nodecl::List::make(subscripts),
+                        array.get_type(),
+                        array.get_locus());
+            }
+        }
+
+        // Otherwise use the multidependence {dep[i := it], it = first:last:step}
+        TL::Scope iterator_scope = new_block_context(bundle.scope.get_decl_context());
+        TL::Symbol iterator = iterator_scope.new_symbol(iv.get_name() + "_bundle_dep");
+        iterator.get_internal_symbol()->kind = SK_VARIABLE;
+        iterator.set_type(iv.get_type().no_ref());
+        symbol_entity_specs_set_is_user_declared(iterator.get_internal_symbol(), 1);
+
+        Nodecl::NodeclBase multi_base = dep.shallow_copy();
+        replace_symbol(multi_base, iv, iterator.make_nodecl(/* set_ref_type */ true));
+
+        return Nodecl::MultiExpression::make(
+                Nodecl::Range::make(
+                    bundle.lower.shallow_copy(),
+                    bundle.upper.shallow_copy(),
+                    bundle.stride.shallow_copy(),
+                    iv.get_type().no_ref(),
+                    dep.get_locus()),
+                multi_base,
+                iterator,
+                multi_base.get_type(),
+                dep.get_locus());
+    }
+
+    template <typename T>
+    bool aggregate_dependences(const T& n, const Bundle& bundle, Nodecl::List& new_environment)
+    {
+        TL::ObjectList<Nodecl::NodeclBase> new_exprs;
+
+        Nodecl::List exprs = n.get_exprs().template as<Nodecl::List>();
+        for (Nodecl::List::iterator it = exprs.begin();
+                it != exprs.end();
+                it++)
+        {
+            Nodecl::NodeclBase new_dep = aggregate_dependence(*it, bundle);
+            if (new_dep.is_null())
+                return false;
+
+            new_exprs.append(new_dep);
+        }
+
+        new_environment.append(T::make(Nodecl::List::make(new_exprs), n.get_locus()));
+        return true;
+    }
+
+    }
+
+    void TaskAggregation::visit(const Nodecl::ForStatement& n)
+    {
+        // Innermost loops first
+        walk(n.get_statement());
+
+        Nodecl::NodeclBase stmt = get_single_statement(n.get_statement());
+        if (stmt.is_null()
+                || !stmt.is<Nodecl::OpenMP::Task>()
+                || !n.get_loop_header().is<Nodecl::LoopControl>())
+            return;
+
+        Nodecl::OpenMP::Task task = stmt.as<Nodecl::OpenMP::Task>();
+
+        TL::ForStatement for_stmt(n);
+        if (!for_stmt.is_omp_valid_loop())
+            return;
+
+        TL::Symbol induction_var = for_stmt.get_induction_variable();
+        Nodecl::NodeclBase lower_bound = for_stmt.get_lower_bound();
+        Nodecl::NodeclBase upper_bound = for_stmt.get_upper_bound();
+        Nodecl::NodeclBase step = for_stmt.get_step();
+
+        // The bounds are evaluated again by the bundles and after the loop
+        if (!induction_var.get_type().no_ref().is_integral_type()
+                || !step.is_constant()
+                || const_value_is_zero(step.get_constant())
+                || uses_symbol(lower_bound, induction_var)
+                || uses_symbol(upper_bound, induction_var)
+                || TL::Lowering::Utils::expression_has_side_effects(lower_bound)
+                || TL::Lowering::Utils::expression_has_side_effects(upper_bound))
+            return;
+
+        // A bundle runs several iterations so the task cannot leave its body
+        Nodecl::NodeclBase task_stmts = task.get_statements();
+        if (Nodecl::Utils::nodecl_contains_nodecl_of_kind<Nodecl::ReturnStatement>(task_stmts)
+                || Nodecl::Utils::nodecl_contains_nodecl_of_kind<Nodecl::GotoStatement>(task_stmts))
+            return;
+
+        unsigned int factor = compute_aggregation_factor(n, task);
+        if (factor <= 1)
+            return;
+
+        if (aggregate(n, task, factor))
+            TL::CounterManager::get_counter("nanos6-aggregated-task-loops")++;
+    }
+
+    unsigned int TaskAggregation::compute_aggregation_factor(
+            const Nodecl::ForStatement& loop,
+            const Nodecl::OpenMP::Task& task) const
+    {
+        unsigned int factor = _phase->task_aggregation_factor();
+        if (factor == 0)
+        {
+            unsigned int cost;
+            Nodecl::OmpSs::Cost cost_clause =
+                task.get_environment().as<Nodecl::List>().find_first<Nodecl::OmpSs::Cost>();
+            if (!cost_clause.is_null()
+                    && cost_clause.get_cost().is_constant()
+                    && const_value_is_positive(cost_clause.get_cost().get_constant()))
+            {
+                cost = const_value_cast_to_unsigned_int(cost_clause.get_cost().get_constant());
+            }
+            else
+            {
+                LoopCostEstimator cost_estimator;
+                cost = cost_estimator.estimate(task.get_statements());
+            }
+            cost = std::max(cost, 1u);
+
+            // Bundles should not be cheaper than the minimum task cost
+            factor = (_phase->task_aggregation_min_cost() + cost - 1) / cost;
+        }
+
+        // Do not make bundles larger than the whole loop
+        TL::ForStatement for_stmt(loop);
+        Nodecl::NodeclBase lower_bound = for_stmt.get_lower_bound();
+        Nodecl::NodeclBase upper_bound = for_stmt.get_upper_bound();
+        if (lower_bound.is_constant()
+                && upper_bound.is_constant())
+        {
+            const_value_t* num_iterations =
+                const_value_add(
+                        const_value_div(
+                            const_value_sub(upper_bound.get_constant(), lower_bound.get_constant()),
+                            for_stmt.get_step().get_constant()),
+                        const_value_get_signed_int(1));
+
+            if (!const_value_is_positive(num_iterations))
+                return 1;
+
+            factor = std::min(factor, const_value_cast_to_unsigned_int(num_iterations));
+        }
+
+        return factor;
+    }
+
+    bool TaskAggregation::aggregate(
+            const Nodecl::ForStatement& loop,
+            const Nodecl::OpenMP::Task& task,
+            unsigned int factor)
+    {
+        TL::ForStatement for_stmt(loop);
+        TL::Symbol induction_var = for_stmt.get_induction_variable();
+        TL::Type induction_var_type = induction_var.get_type().no_ref();
+        Nodecl::NodeclBase lower_bound = for_stmt.get_lower_bound();
+        Nodecl::NodeclBase upper_bound = for_stmt.get_upper_bound();
+        const_value_t* step = for_stmt.get_step().get_constant();
+        bool is_increasing = const_value_is_positive(step);
+
+        // Last iteration of the bundle that starts at 'i'
+        //
+        //     (U - i < (K-1)*S) ? U : i + (K-1)*S      (>  if S is negative)
+        Nodecl::NodeclBase offset = const_value_to_nodecl(
+                const_value_mul(const_value_get_signed_int(factor - 1), step));
+
+        Nodecl::NodeclBase distance =
+            Nodecl::Minus::make(
+                    Nodecl::ParenthesizedExpression::make(
+                        upper_bound.shallow_copy(), induction_var_type),
+                    induction_var.make_nodecl(/* set_ref_type */ true),
+                    induction_var_type);
+
+        Nodecl::NodeclBase last_is_upper_bound;
+        if (is_increasing)
+            last_is_upper_bound = Nodecl::LowerThan::make(distance, offset, TL::Type::get_bool_type());
+        else
+            last_is_upper_bound = Nodecl::GreaterThan::make(distance, offset, TL::Type::get_bool_type());
+
+        Nodecl::NodeclBase last =
+            Nodecl::ParenthesizedExpression::make(
+                    Nodecl::ConditionalExpression::make(
+                        last_is_upper_bound,
+                        Nodecl::ParenthesizedExpression::make(
+                            upper_bound.shallow_copy(), induction_var_type),
+                        Nodecl::Add::make(
+                            induction_var.make_nodecl(/* set_ref_type */ true),
+                            offset.shallow_copy(),
+                            induction_var_type),
+                        induction_var_type),
+                    induction_var_type);
+
+        Bundle bundle;
+        bundle.induction_variable = induction_var;
+        bundle.lower = is_increasing ? induction_var.make_nodecl(/* set_ref_type */ true) : last;
+        bundle.upper = is_increasing ? last : induction_var.make_nodecl(/* set_ref_type */ true);
+        bundle.stride = const_value_to_nodecl(is_increasing ? step : const_value_neg(step));
+        bundle.scope = task.retrieve_context();
+
+        // Environment of the bundle
+        Nodecl::List new_environment;
+        TL::ObjectList<TL::Symbol> data_sharings;
+        TL::ObjectList<TL::Symbol> firstprivates;
+
+        Nodecl::List environment = task.get_environment().as<Nodecl::List>();
+        for (Nodecl::List::iterator it = environment.begin();
+                it != environment.end();
+                it++)
+        {
+            if (it->is<Nodecl::OpenMP::Firstprivate>())
+            {
+                TL::ObjectList<TL::Symbol> symbols =
+                    get_data_sharing_symbols(it->as<Nodecl::OpenMP::Firstprivate>().get_symbols());
+                firstprivates.append(symbols);
+                data_sharings.append(symbols);
+                new_environment.append(it->shallow_copy());
+            }
+            else if (it->is<Nodecl::OpenMP::Shared>()
+                    || it->is<Nodecl::OpenMP::Private>())
+            {
+                TL::ObjectList<TL::Symbol> symbols = get_data_sharing_symbols(
+                        it->is<Nodecl::OpenMP::Shared>()
+                        ? it->as<Nodecl::OpenMP::Shared>().get_symbols()
+                        : it->as<Nodecl::OpenMP::Private>().get_symbols());
+                if (symbols.contains(induction_var))
+                    return false;
+                data_sharings.append(symbols);
+                new_environment.append(it->shallow_copy());
+            }
+            else if (it->is<Nodecl::OmpSs::Cost>())
+            {
+                // A bundle runs 'factor' iterations
+                Nodecl::NodeclBase cost = it->as<Nodecl::OmpSs::Cost>().get_cost();
+                new_environment.append(
+                        Nodecl::OmpSs::Cost::make(
+                            Nodecl::Mul::make(
+                                Nodecl::ParenthesizedExpression::make(
+                                    cost.shallow_copy(), cost.get_type().no_ref()),
+                                const_value_to_nodecl(const_value_get_signed_int(factor)),
+                                cost.get_type().no_ref()),
+                            it->get_locus()));
+            }
+            else if (it->is<Nodecl::OpenMP::DepIn>())
+            {
+                if (!aggregate_dependences(it->as<Nodecl::OpenMP::DepIn>(), bundle, new_environment))
+                    return false;
+            }
+            else if (it->is<Nodecl::OpenMP::DepOut>())
+            {
+                if (!aggregate_dependences(it->as<Nodecl::OpenMP::DepOut>(), bundle, new_environment))
+                    return false;
+            }
+            else if (it->is<Nodecl::OpenMP::DepInout>())
+            {
+                if (!aggregate_dependences(it->as<Nodecl::OpenMP::DepInout>(), bundle, new_environment))
+                    return false;
+            }
+            else if (it->is<Nodecl::OmpSs::DepWeakIn>())
+            {
+                if (!aggregate_dependences(it->as<Nodecl::OmpSs::DepWeakIn>(), bundle, new_environment))
+                    return false;
+            }
+            else if (it->is<Nodecl::OmpSs::DepWeakOut>())
+            {
+                if (!aggregate_dependences(it->as<Nodecl::OmpSs::DepWeakOut>(), bundle, new_environment))
+                    return false;
+            }
+            else if (it->is<Nodecl::OmpSs::DepWeakInout>())
+            {
+                if (!aggregate_dependences(it->as<Nodecl::OmpSs::DepWeakInout>(), bundle, new_environment))
+                    return false;
+            }
+            else if (it->is<Nodecl::OmpSs::DepCommutative>()
+                    || it->is<Nodecl::OmpSs::DepConcurrent>()
+                    || it->is<Nodecl::OmpSs::DepReduction>()
+                    || it->is<Nodecl::OmpSs::DepInPrivate>()
+                    || it->is<Nodecl::OpenMP::TaskReduction>()
+                    || it->is<Nodecl::OpenMP::TaskIsTaskwait>()
+                    || it->is<Nodecl::OpenMP::TaskIsTaskloop>()
+                    // Clauses like 'if' or 'priority' cannot be merged
+                    || uses_symbol(*it, induction_var))
+            {
+                return false;
+            }
+            else
+            {
+                new_environment.append(it->shallow_copy());
+            }
+        }
+
+        if (!firstprivates.contains(induction_var))
+            return false;
+
+        // Every task had its own copy of the firstprivates but the iterations
+        // of a bundle share one, so a write would be seen by the next
+        // iteration. This includes the induction variable, which drives the
+        // loop of the bundle
+        if (TL::Lowering::Utils::statements_may_modify_symbols(
+                    task.get_statements(), firstprivates))
+            return false;
+
+        // The bundles read the upper bound of the loop
+        TL::ObjectList<Nodecl::NodeclBase> captured_symbols;
+        TL::ObjectList<TL::Symbol> upper_bound_symbols = Nodecl::Utils::get_nonlocal_symbols(upper_bound);
+        for (TL::ObjectList<TL::Symbol>::iterator it = upper_bound_symbols.begin();
+                it != upper_bound_symbols.end();
+                it++)
+        {
+            if (it->is_variable()
+                    && !it->is_member()
+                    && !data_sharings.contains(*it))
+                captured_symbols.append(it->make_nodecl(/* set_ref_type */ true));
+        }
+        if (!captured_symbols.empty())
+        {
+            new_environment.append(
+                    Nodecl::OpenMP::Firstprivate::make(
+                        Nodecl::List::make(captured_symbols),
+                        task.get_locus()));
+        }
+
+        // Statements of the bundle
+        //
+        //     {
+        //         int i_bundle;
+        //         for (i_bundle = i; i_bundle <= last; i_bundle = i_bundle + S)
+        //             task-statements[i := i_bundle]
+        //     }
+        TL::Scope bundle_scope = new_block_context(bundle.scope.get_decl_context());
+        TL::Scope bundle_loop_scope = new_block_context(bundle_scope.get_decl_context());
+
+        TL::Symbol bundle_var = bundle_scope.new_symbol(induction_var.get_name() + "_bundle");
+        bundle_var.get_internal_symbol()->kind = SK_VARIABLE;
+        bundle_var.set_type(induction_var_type);
+        symbol_entity_specs_set_is_user_declared(bundle_var.get_internal_symbol(), 1);
+
+        Nodecl::Utils::SimpleSymbolMap symbol_map;
+        symbol_map.add_map(induction_var, bundle_var);
+
+        Nodecl::NodeclBase bundle_body =
+            Nodecl::Utils::deep_copy(task.get_statements(), bundle_loop_scope, symbol_map);
+
+        Nodecl::NodeclBase bundle_cond;
+        if (is_increasing)
+            bundle_cond = Nodecl::LowerOrEqualThan::make(
+                    bundle_var.make_nodecl(/* set_ref_type */ true),
+                    last.shallow_copy(),
+                    TL::Type::get_bool_type());
+        else
+            bundle_cond = Nodecl::GreaterOrEqualThan::make(
+                    bundle_var.make_nodecl(/* set_ref_type */ true),
+                    last.shallow_copy(),
+                    TL::Type::get_bool_type());
+
+        Nodecl::NodeclBase bundle_loop =
+            Nodecl::ForStatement::make(
+                    Nodecl::LoopControl::make(
+                        Nodecl::List::make(
+                            Nodecl::Assignment::make(
+                                bundle_var.make_nodecl(/* set_ref_type */ true),
+                                induction_var.make_nodecl(/* set_ref_type */ true),
+                                induction_var_type.get_lvalue_reference_to())),
+                        bundle_cond,
+                        Nodecl::Assignment::make(
+                            bundle_var.make_nodecl(/* set_ref_type */ true),
+                            Nodecl::Add::make(
+                                bundle_var.make_nodecl(/* set_ref_type */ true),
+                                const_value_to_nodecl(step),
+                                induction_var_type),
+                            induction_var_type.get_lvalue_reference_to())),
+                    Nodecl::List::make(
+                        Nodecl::Context::make(
+                            Nodecl::List::make(
+                                Nodecl::CompoundStatement::make(
+                                    bundle_body,
+                                    /* finally */ Nodecl::NodeclBase::null())),
+                            bundle_loop_scope)),
+                    /* loop-name */ Nodecl::NodeclBase::null(),
+                    task.get_locus());
+
+        Nodecl::NodeclBase bundle_stmts =
+            Nodecl::List::make(
+                    Nodecl::Context::make(
+                        Nodecl::List::make(
+                            Nodecl::CompoundStatement::make(
+                                Nodecl::List::make(
+                                    Nodecl::ObjectInit::make(bundle_var),
+                                    bundle_loop),
+                                /* finally */ Nodecl::NodeclBase::null())),
+                        bundle_scope));
+
+        task.replace(
+                Nodecl::OpenMP::Task::make(
+                    new_environment,
+                    bundle_stmts,
+                    task.get_locus()));
+
+        // The loop now creates one task per bundle
+        //
+        //     for (i = L; i <= U; i = i + K*S)
+        Nodecl::LoopControl loop_control = loop.get_loop_header().as<Nodecl::LoopControl>();
+        if (is_increasing)
+            loop_control.get_cond().replace(
+                    Nodecl::LowerOrEqualThan::make(
+                        induction_var.make_nodecl(/* set_ref_type */ true),
+                        upper_bound.shallow_copy(),
+                        TL::Type::get_bool_type()));
+        else
+            loop_control.get_cond().replace(
+                    Nodecl::GreaterOrEqualThan::make(
+                        induction_var.make_nodecl(/* set_ref_type */ true),
+                        upper_bound.shallow_copy(),
+                        TL::Type::get_bool_type()));
+
+        loop_control.get_next().replace(
+                Nodecl::Assignment::make(
+                    induction_var.make_nodecl(/* set_ref_type */ true),
+                    Nodecl::Add::make(
+                        induction_var.make_nodecl(/* set_ref_type */ true),
+                        const_value_to_nodecl(
+                            const_value_mul(const_value_get_signed_int(factor), step)),
+                        induction_var_type),
+                    induction_var_type.get_lvalue_reference_to()));
+
+        if (!for_stmt.induction_variable_in_separate_scope())
+        {
+            // The last bundle leaves the induction variable past the value it
+            // would have after the original loop
+            //
+            //     if (L <= U) i = L + ((U - L) / S + 1) * S;      (>= if S is negative)
+            Nodecl::NodeclBase num_iterations =
+                Nodecl::Add::make(
+                        Nodecl::Div::make(
+                            Nodecl::ParenthesizedExpression::make(
+                                Nodecl::Minus::make(
+                                    Nodecl::ParenthesizedExpression::make(
+                                        upper_bound.shallow_copy(), induction_var_type),
+                                    Nodecl::ParenthesizedExpression::make(
+                                        lower_bound.shallow_copy(), induction_var_type),
+                                    induction_var_type),
+                                induction_var_type),
+                            const_value_to_nodecl(step),
+                            induction_var_type),
+                        const_value_to_nodecl(const_value_get_signed_int(1)),
+                        induction_var_type);
+
+            Nodecl::NodeclBase final_value =
+                Nodecl::Add::make(
+                        Nodecl::ParenthesizedExpression::make(
+                            lower_bound.shallow_copy(), induction_var_type),
+                        Nodecl::Mul::make(
+                            Nodecl::ParenthesizedExpression::make(num_iterations, induction_var_type),
+                            const_value_to_nodecl(step),
+                            induction_var_type),
+                        induction_var_type);
+
+            Nodecl::NodeclBase loop_runs;
+            if (is_increasing)
+                loop_runs = Nodecl::LowerOrEqualThan::make(
+                        lower_bound.shallow_copy(), upper_bound.shallow_copy(), TL::Type::get_bool_type());
+            else
+                loop_runs = Nodecl::GreaterOrEqualThan::make(
+                        lower_bound.shallow_copy(), upper_bound.shallow_copy(), TL::Type::get_bool_type());
+
+            Nodecl::NodeclBase fix_induction_var =
+                Nodecl::IfElseStatement::make(
+                        loop_runs,
+                        Nodecl::List::make(
+                            Nodecl::ExpressionStatement::make(
+                                Nodecl::Assignment::make(
+                                    induction_var.make_nodecl(/* set_ref_type */ true),
+                                    final_value,
+                                    induction_var_type.get_lvalue_reference_to()))),
+                        /* else */ Nodecl::NodeclBase::null());
+
+            Nodecl::NodeclBase new_loop = loop.shallow_copy();
+            loop.replace(
+                    Nodecl::Context::make(
+                        Nodecl::List::make(
+                            Nodecl::CompoundStatement::make(
+                                Nodecl::List::make(new_loop, fix_induction_var),
+                                /* finally */ Nodecl::NodeclBase::null())),
+                        new_block_context(loop.retrieve_context().get_decl_context())));
+        }
+
+        return true;
+    }
+
+} }
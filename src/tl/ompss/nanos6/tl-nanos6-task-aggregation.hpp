@@ -0,0 +1,82 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2015-2015 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+#ifndef TL_NANOS6_TASK_AGGREGATION_HPP
+#define TL_NANOS6_TASK_AGGREGATION_HPP
+
+#include "tl-nanos6.hpp"
+#include "tl-nodecl.hpp"
+#include "tl-nodecl-visitor.hpp"
+
+namespace TL { namespace Nanos6 {
+
+    //! This visitor bundles several iterations of a loop that creates a task
+    /*!
+     * A loop whose body is just a cheap task
+     *
+     *     for (i = L; i <= U; i += S)
+     *         #pragma oss task in(a[i]) out(b[i])
+     *         body(i);
+     *
+     * is rewritten so every task runs K consecutive iterations
+     *
+     *     for (i = L; i <= U; i += K*S)
+     *         #pragma oss task in(a[i:last]) out(b[i:last])
+     *         for (i_bundle = i; i_bundle <= last; i_bundle += S)
+     *             body(i_bundle);
+     *
+     * where 'last' is min(i + (K-1)*S, U). The dependences of the new task are
+     * the union of the dependences of the bundled iterations: 'it + e'
+     * subscripts become array sections and anything else becomes a
+     * multidependence over the iterations of the bundle.
+     *
+     * K comes from the 'cost' clause of the task or from an estimation of
+     * the cost of its body, so that each new task costs at least
+     * task_aggregation_min_cost.
+     */
+    struct TaskAggregation : public Nodecl::ExhaustiveVisitor<void>
+    {
+        private:
+            LoweringPhase* _phase;
+
+            unsigned int compute_aggregation_factor(
+                    const Nodecl::ForStatement& loop,
+                    const Nodecl::OpenMP::Task& task) const;
+
+            bool aggregate(const Nodecl::ForStatement& loop,
+                    const Nodecl::OpenMP::Task& task,
+                    unsigned int factor);
+
+        public:
+            TaskAggregation(LoweringPhase* phase) : _phase(phase) { }
+
+            void visit(const Nodecl::ForStatement& n);
+    };
+
+} }
+
+#endif // TL_NANOS6_TASK_AGGREGATION_HPP
@@ -41,6 +41,7 @@
 
 #include "tl-lowering-utils.hpp"
 #include "tl-atomics.hpp"
+#include "tl-loop-cost.hpp"
 
 #include "cxx-typeutils.h"
 #include "cxx-cexpr.h"
@@ -86,6 +87,9 @@ namespace TL { namespace Nanos6 {
                     for_stmt.get_upper_bound().get_type());
             taskloop_info.step = for_stmt.get_step();
             taskloop_info.chunksize = _env.chunksize;
+
+            LoopCostEstimator cost_estimator;
+            taskloop_info.iteration_cost = cost_estimator.estimate_iteration(for_stmt);
         }
     }
 
@@ -2858,6 +2862,218 @@ namespace TL { namespace Nanos6 {
         register_statements.append(body);
     }
 
+    namespace {
+
+    // Tries to coalesce a multidependence like '{a[i][j], i = L:U}' into the
+    // single array section 'a[L:U][j]'. This way the whole set of regions is
+    // registered with one multidimensional call instead of one call per
+    // element. Only iterators with unit stride are coalesced, the others are
+    // kept in the returned expression, which is a multidependence only if
+    // some of them remain.
+    //
+    // The ranges of the coalesced iterators are returned in 'coalesced_ranges'
+    // because the caller must guard the registration against empty ranges
+    Nodecl::NodeclBase coalesce_multidependence(
+            const TL::DataReference& data_ref,
+            // Out
+            TL::ObjectList<Nodecl::Range>& coalesced_ranges)
+    {
+        TL::ObjectList<TL::DataReference::MultiRefIterator> multireferences =
+            data_ref.multireferences();
+
+        Nodecl::NodeclBase base_exp = data_ref;
+        while (base_exp.is<Nodecl::MultiExpression>())
+            base_exp = base_exp.as<Nodecl::MultiExpression>().get_base();
+
+        if (!base_exp.no_conv().is<Nodecl::ArraySubscript>())
+            return data_ref;
+
+        Nodecl::ArraySubscript array = base_exp.no_conv().as<Nodecl::ArraySubscript>();
+        Nodecl::NodeclBase subscripted = array.get_subscripted();
+        // Note that we work on copies of the subscripts since some of them
+        // will be replaced and all of them will be part of a new tree
+        TL::ObjectList<Nodecl::NodeclBase> subscripts;
+        Nodecl::List original_subscripts = array.get_subscripts().as<Nodecl::List>();
+        for (Nodecl::List::iterator it = original_subscripts.begin();
+                it != original_subscripts.end();
+                it++)
+        {
+            subscripts.append(it->shallow_copy());
+        }
+
+        TL::ObjectList<TL::DataReference::MultiRefIterator> remaining_iterators;
+        for (TL::ObjectList<TL::DataReference::MultiRefIterator>::iterator it = multireferences.begin();
+                it != multireferences.end();
+                it++)
+        {
+            TL::Symbol iterator = it->first;
+
+            bool can_be_coalesced = it->second.is<Nodecl::Range>();
+            if (can_be_coalesced)
+            {
+                Nodecl::NodeclBase stride = it->second.as<Nodecl::Range>().get_stride();
+                can_be_coalesced = stride.is_null()
+                    || (stride.is_constant() && const_value_is_one(stride.get_constant()));
+            }
+
+            // The iterator must not be used by the subscripted expression nor
+            // by the range of any other iterator, and its range must not
+            // depend on other iterators either
+            can_be_coalesced = can_be_coalesced
+                && !Nodecl::Utils::get_all_symbols(subscripted).contains(iterator);
+
+            TL::ObjectList<TL::Symbol> range_symbols = Nodecl::Utils::get_all_symbols(it->second);
+            for (TL::ObjectList<TL::DataReference::MultiRefIterator>::iterator it2 = multireferences.begin();
+                    it2 != multireferences.end() && can_be_coalesced;
+                    it2++)
+            {
+                if (it2 != it)
+                    can_be_coalesced = !Nodecl::Utils::get_all_symbols(it2->second).contains(iterator)
+                        && !range_symbols.contains(it2->first);
+            }
+
+            // The iterator must appear in exactly one subscript, as 'it + offset'
+            int position = -1;
+            Nodecl::NodeclBase offset;
+            for (int i = 0; i < (int)subscripts.size() && can_be_coalesced; i++)
+            {
+                if (!Nodecl::Utils::get_all_symbols(subscripts[i]).contains(iterator))
+                    continue;
+
+                if (position != -1
+                        || subscripts[i].is<Nodecl::Range>()
+                        || !subscript_is_iterator_plus_offset(subscripts[i], iterator, offset))
+                    can_be_coalesced = false;
+                else
+                    position = i;
+            }
+
+            if (!can_be_coalesced
+                    || position == -1)
+            {
+                remaining_iterators.append(*it);
+                continue;
+            }
+
+            Nodecl::Range range = it->second.as<Nodecl::Range>();
+            Nodecl::NodeclBase lower = range.get_lower().shallow_copy();
+            Nodecl::NodeclBase upper = range.get_upper().shallow_copy();
+            if (!offset.is_null())
+            {
+                lower = Nodecl::Add::make(
+                        Nodecl::ParenthesizedExpression::make(lower, lower.get_type().no_ref()),
+                        offset.shallow_copy(),
+                        lower.get_type().no_ref());
+                upper = Nodecl::Add::make(
+                        Nodecl::ParenthesizedExpression::make(upper, upper.get_type().no_ref()),
+                        offset.shallow_copy(),
+                        upper.get_type().no_ref());
+            }
+
+            subscripts[position] = Nodecl::Range::make(
+                    lower,
+                    upper,
+                    const_value_to_nodecl_with_basic_type(
+                        const_value_get_one(type_get_size(get_ptrdiff_t_type()), /* signed */ 1),
+                        get_ptrdiff_t_type()),
+                    TL::Type::get_ptrdiff_t_type(),
+                    subscripts[position].get_locus());
+
+            coalesced_ranges.append(range);
+        }
+
+        if (coalesced_ranges.empty())
+            return data_ref;
+
+        Nodecl::NodeclBase result = Nodecl::ArraySubscript::make(
+                subscripted.shallow_copy(),
+                Nodecl::List::make(subscripts),
+                array.get_type(),
+                array.get_locus());
+
+        for (TL::ObjectList<TL::DataReference::MultiRefIterator>::reverse_iterator it = remaining_iterators.rbegin();
+                it != remaining_iterators.rend();
+                it++)
+        {
+            result = Nodecl::MultiExpression::make(
+                    it->second.shallow_copy(),
+                    result,
+                    it->first,
+                    result.get_type(),
+                    result.get_locus());
+        }
+
+        return result;
+    }
+
+    // Replaces 'data_ref' and 'data_type' by the coalesced multidependence
+    // when it can be registered with one call. Returns the ranges of the
+    // coalesced iterators, empty if 'data_ref' has been kept
+    TL::ObjectList<Nodecl::Range> coalesce_multidependence_if_registrable(
+            TL::DataReference& data_ref,
+            TL::Type& data_type,
+            int max_dimensions)
+    {
+        TL::ObjectList<Nodecl::Range> coalesced_ranges;
+        TL::DataReference coalesced_data_ref =
+            coalesce_multidependence(data_ref, coalesced_ranges);
+        TL::Type coalesced_data_type = coalesced_data_ref.get_data_type();
+
+        if (coalesced_ranges.empty()
+                || !coalesced_data_ref.is_valid()
+                || (coalesced_data_type.is_array()
+                    && coalesced_data_type.get_num_dimensions() > max_dimensions))
+        {
+            // Fallback to one registration per element
+            coalesced_ranges.clear();
+        }
+        else
+        {
+            data_ref = coalesced_data_ref;
+            data_type = coalesced_data_type;
+        }
+
+        return coalesced_ranges;
+    }
+
+    // A coalesced multidependence must not register anything if any of its
+    // original iteration spaces was empty. Returns the condition, in terms of
+    // the symbols of the task, or null if no range can be empty
+    Nodecl::NodeclBase coalesced_ranges_non_empty_condition(
+            const TL::ObjectList<Nodecl::Range>& coalesced_ranges)
+    {
+        Nodecl::NodeclBase non_empty_cond;
+        for (TL::ObjectList<Nodecl::Range>::const_iterator it = coalesced_ranges.begin();
+                it != coalesced_ranges.end();
+                it++)
+        {
+            Nodecl::NodeclBase lower = it->get_lower();
+            Nodecl::NodeclBase upper = it->get_upper();
+            if (lower.is_constant()
+                    && upper.is_constant()
+                    && const_value_is_nonzero(
+                        const_value_lte(lower.get_constant(), upper.get_constant())))
+                continue;
+
+            Nodecl::NodeclBase current_cond = Nodecl::LowerOrEqualThan::make(
+                    lower.shallow_copy(),
+                    upper.shallow_copy(),
+                    TL::Type::get_bool_type());
+
+            if (non_empty_cond.is_null())
+                non_empty_cond = current_cond;
+            else
+                non_empty_cond = Nodecl::LogicalAnd::make(
+                        non_empty_cond,
+                        current_cond,
+                        TL::Type::get_bool_type());
+        }
+
+        return non_empty_cond;
+    }
+
+    }
+
     void TaskProperties::create_dependences_function_c()
     {
         TL::ObjectList<std::string> dep_parameter_names(2);
@@ -2936,9 +3152,20 @@ namespace TL { namespace Nanos6 {
                 TL::DataReference data_ref = *it;
                 TL::Type data_type = data_ref.get_data_type();
 
+                int max_dimensions = phase->nanos6_api_max_dimensions();
+
+                TL::ObjectList<Nodecl::Range> coalesced_ranges;
+                // Reductions over arrays are not supported, so do not create them
+                if (data_ref.is_multireference()
+                        && &dep_list != &_env.dep_reduction
+                        && phase->multidependences_coalescing_enabled())
+                {
+                    coalesced_ranges = coalesce_multidependence_if_registrable(
+                            data_ref, data_type, max_dimensions);
+                }
+
                 TL::Symbol register_fun;
                 {
-                    int max_dimensions = phase->nanos6_api_max_dimensions();
                     ERROR_CONDITION(data_type.is_array() &&
                             (data_type.get_num_dimensions() > max_dimensions),
                             "Maximum number of data dimensions allowed is %d",
@@ -2982,6 +3209,18 @@ namespace TL { namespace Nanos6 {
                             local_symbols,
                             register_statements);
                 }
+
+                Nodecl::NodeclBase non_empty_cond =
+                    coalesced_ranges_non_empty_condition(coalesced_ranges);
+                if (!non_empty_cond.is_null())
+                {
+                    register_statements = Nodecl::List::make(
+                            Nodecl::IfElseStatement::make(
+                                rewrite_expression_using_args(arg, non_empty_cond, local_symbols),
+                                register_statements,
+                                /* else */ Nodecl::NodeclBase::null()));
+                }
+
                 dependences_empty_stmt.prepend_sibling(register_statements);
             }
         }
@@ -3226,9 +3465,20 @@ namespace TL { namespace Nanos6 {
                 TL::DataReference data_ref = *it;
                 TL::Type data_type = data_ref.get_data_type();
 
+                int max_dimensions = phase->nanos6_api_max_dimensions();
+
+                TL::ObjectList<Nodecl::Range> coalesced_ranges;
+                // Reductions over arrays are not supported, so do not create them
+                if (data_ref.is_multireference()
+                        && &dep_list != &_env.dep_reduction
+                        && phase->multidependences_coalescing_enabled())
+                {
+                    coalesced_ranges = coalesce_multidependence_if_registrable(
+                            data_ref, data_type, max_dimensions);
+                }
+
                 TL::Symbol register_fun;
                 {
-                    int max_dimensions = phase->nanos6_api_max_dimensions();
                     ERROR_CONDITION(data_type.is_array() &&
                             (data_type.get_num_dimensions() > max_dimensions),
                             "Maximum number of data dimensions allowed is %d",
@@ -3270,6 +3520,18 @@ namespace TL { namespace Nanos6 {
                             register_statements);
                 }
 
+                Nodecl::NodeclBase non_empty_cond =
+                    coalesced_ranges_non_empty_condition(coalesced_ranges);
+                if (!non_empty_cond.is_null())
+                {
+                    register_statements = Nodecl::List::make(
+                            Nodecl::IfElseStatement::make(
+                                Nodecl::Utils::deep_copy(non_empty_cond,
+                                    TL::Scope::get_global_scope(), symbol_map),
+                                register_statements,
+                                /* else */ Nodecl::NodeclBase::null()));
+                }
+
                 dep_fun_empty_stmt.prepend_sibling(register_statements);
             }
         }
@@ -4309,6 +4571,217 @@ namespace TL { namespace Nanos6 {
                         value,
                         value.get_type()));
         }
+
+        Nodecl::NodeclBase taskloop_information_field_access(
+                const TL::Symbol& taskloop_bounds_ptr,
+                const GetField& get_field,
+                const std::string& field_name)
+        {
+            Nodecl::NodeclBase field = get_field(field_name);
+            return Nodecl::ClassMemberAccess::make(
+                    Nodecl::Dereference::make(
+                        taskloop_bounds_ptr.make_nodecl(/*set_ref_type*/ true),
+                        taskloop_bounds_ptr.get_type().points_to().get_lvalue_reference_to()),
+                    field,
+                    /*member literal*/ Nodecl::NodeclBase::null(),
+                    field.get_type());
+        }
+
+        // The fields of the taskloop bounds may be unsigned, a negative step
+        // only keeps its sign if they are read as signed values
+        Nodecl::NodeclBase taskloop_information_signed_field(
+                const TL::Symbol& taskloop_bounds_ptr,
+                const GetField& get_field,
+                const std::string& field_name,
+                TL::Type signed_type)
+        {
+            Nodecl::NodeclBase cast = Nodecl::Conversion::make(
+                    taskloop_information_field_access(taskloop_bounds_ptr, get_field, field_name),
+                    signed_type);
+            cast.set_text("C");
+            return cast;
+        }
+
+        // step > 0 ? step : -step
+        Nodecl::NodeclBase taskloop_absolute_step(
+                const TL::Symbol& taskloop_bounds_ptr,
+                const GetField& get_field,
+                TL::Type signed_type)
+        {
+            return Nodecl::ParenthesizedExpression::make(
+                    Nodecl::ConditionalExpression::make(
+                        Nodecl::GreaterThan::make(
+                            taskloop_information_signed_field(taskloop_bounds_ptr, get_field, "step", signed_type),
+                            const_value_to_nodecl(const_value_get_signed_int(0)),
+                            TL::Type::get_bool_type()),
+                        taskloop_information_signed_field(taskloop_bounds_ptr, get_field, "step", signed_type),
+                        Nodecl::Neg::make(
+                            taskloop_information_signed_field(taskloop_bounds_ptr, get_field, "step", signed_type),
+                            signed_type),
+                        signed_type),
+                    signed_type);
+        }
+
+        // Distance covered by the iterations with the upper bound made
+        // exclusive in the direction of the step. The upper bound field is the
+        // last iteration plus one, so a decreasing loop ends at upper_bound - 2
+        //
+        //     step > 0 ? upper_bound - lower_bound : lower_bound - upper_bound + 2
+        Nodecl::NodeclBase taskloop_distance(
+                const TL::Symbol& taskloop_bounds_ptr,
+                const GetField& get_field,
+                TL::Type signed_type)
+        {
+            return Nodecl::ParenthesizedExpression::make(
+                    Nodecl::ConditionalExpression::make(
+                        Nodecl::GreaterThan::make(
+                            taskloop_information_signed_field(taskloop_bounds_ptr, get_field, "step", signed_type),
+                            const_value_to_nodecl(const_value_get_signed_int(0)),
+                            TL::Type::get_bool_type()),
+                        Nodecl::Minus::make(
+                            taskloop_information_signed_field(taskloop_bounds_ptr, get_field, "upper_bound", signed_type),
+                            taskloop_information_signed_field(taskloop_bounds_ptr, get_field, "lower_bound", signed_type),
+                            signed_type),
+                        Nodecl::Add::make(
+                            Nodecl::Minus::make(
+                                taskloop_information_signed_field(taskloop_bounds_ptr, get_field, "lower_bound", signed_type),
+                                taskloop_information_signed_field(taskloop_bounds_ptr, get_field, "upper_bound", signed_type),
+                                signed_type),
+                            const_value_to_nodecl(const_value_get_signed_int(2)),
+                            signed_type),
+                        signed_type),
+                    signed_type);
+        }
+    }
+
+    void TaskProperties::compute_adaptive_taskloop_chunksize(
+            TL::Symbol taskloop_bounds_ptr,
+            /* out */
+            Nodecl::List& stmts) const
+    {
+        TL::Type class_type = taskloop_bounds_ptr.get_type().points_to();
+        TL::ObjectList<TL::Symbol> nonstatic_data_members = class_type.get_nonstatic_data_members();
+        GetField get_field(nonstatic_data_members);
+
+        // Tasks should not be cheaper than the minimum task cost
+        unsigned int iteration_cost = std::max(taskloop_info.iteration_cost, 1u);
+        unsigned int min_chunksize =
+            (phase->taskloop_min_task_cost() + iteration_cost - 1) / iteration_cost;
+        min_chunksize = std::max(min_chunksize, 1u);
+
+        TL::Type chunksize_type = get_field("chunksize").get_type().no_ref();
+
+        Nodecl::NodeclBase min_chunksize_value =
+            const_value_to_nodecl_with_basic_type(
+                    const_value_get_integer(
+                        min_chunksize,
+                        chunksize_type.get_size(),
+                        /* sign */ chunksize_type.is_signed_integral()),
+                    chunksize_type.get_internal_type());
+
+        TL::Symbol nanos6_get_num_cpus_sym =
+            TL::Scope::get_global_scope().get_symbol_from_name("nanos6_get_num_cpus");
+        if (!nanos6_get_num_cpus_sym.is_valid()
+                || !nanos6_get_num_cpus_sym.is_function())
+        {
+            // Without the number of CPUs we can only honour the cost threshold
+            stmts.append(
+                    Nodecl::ExpressionStatement::make(
+                        Nodecl::Assignment::make(
+                            taskloop_information_field_access(taskloop_bounds_ptr, get_field, "chunksize"),
+                            min_chunksize_value,
+                            chunksize_type.get_lvalue_reference_to())));
+            return;
+        }
+
+        // The bounds have already been captured, note that the upper bound is
+        // not inclusive. Decreasing loops are counted with the absolute value
+        // of the step, empty loops and a zero step give no iterations
+        //
+        //     chunksize = ((step != 0 && distance > 0)
+        //             ? (distance + |step| - 1) / |step|
+        //             : 0) / (K * nanos6_get_num_cpus());
+        //     if (chunksize < min_chunksize)
+        //         chunksize = min_chunksize;
+        TL::Type bounds_type =
+            taskloop_information_field_access(taskloop_bounds_ptr, get_field, "lower_bound")
+            .get_type().no_ref();
+        TL::Type signed_type = bounds_type.is_signed_integral()
+            ? bounds_type
+            : TL::Type::get_ptrdiff_t_type();
+
+        Nodecl::NodeclBase has_iterations =
+            Nodecl::LogicalAnd::make(
+                    Nodecl::Different::make(
+                        taskloop_information_signed_field(taskloop_bounds_ptr, get_field, "step", signed_type),
+                        const_value_to_nodecl(const_value_get_signed_int(0)),
+                        TL::Type::get_bool_type()),
+                    Nodecl::GreaterThan::make(
+                        taskloop_distance(taskloop_bounds_ptr, get_field, signed_type),
+                        const_value_to_nodecl(const_value_get_signed_int(0)),
+                        TL::Type::get_bool_type()),
+                    TL::Type::get_bool_type());
+
+        Nodecl::NodeclBase num_iterations =
+            Nodecl::ConditionalExpression::make(
+                    has_iterations,
+                    Nodecl::Div::make(
+                        Nodecl::ParenthesizedExpression::make(
+                            Nodecl::Minus::make(
+                                Nodecl::Add::make(
+                                    taskloop_distance(taskloop_bounds_ptr, get_field, signed_type),
+                                    taskloop_absolute_step(taskloop_bounds_ptr, get_field, signed_type),
+                                    signed_type),
+                                const_value_to_nodecl(const_value_get_signed_int(1)),
+                                signed_type),
+                            signed_type),
+                        taskloop_absolute_step(taskloop_bounds_ptr, get_field, signed_type),
+                        signed_type),
+                    const_value_to_nodecl_with_basic_type(
+                        const_value_get_integer(0, signed_type.get_size(), /* sign */ 1),
+                        signed_type.get_internal_type()),
+                    signed_type);
+
+        Nodecl::NodeclBase num_cpus_call =
+            Nodecl::FunctionCall::make(
+                    nanos6_get_num_cpus_sym.make_nodecl(/* set_ref_type */ true),
+                    /* arguments */ Nodecl::NodeclBase::null(),
+                    /* alternate_name */ Nodecl::NodeclBase::null(),
+                    /* function_form */ Nodecl::NodeclBase::null(),
+                    nanos6_get_num_cpus_sym.get_type().returns());
+
+        Nodecl::NodeclBase num_tasks =
+            Nodecl::ParenthesizedExpression::make(
+                    Nodecl::Mul::make(
+                        const_value_to_nodecl(
+                            const_value_get_unsigned_int(phase->taskloop_tasks_per_cpu())),
+                        num_cpus_call,
+                        num_cpus_call.get_type()),
+                    num_cpus_call.get_type());
+
+        stmts.append(
+                Nodecl::ExpressionStatement::make(
+                    Nodecl::Assignment::make(
+                        taskloop_information_field_access(taskloop_bounds_ptr, get_field, "chunksize"),
+                        Nodecl::Div::make(
+                            Nodecl::ParenthesizedExpression::make(num_iterations, signed_type),
+                            num_tasks,
+                            signed_type),
+                        chunksize_type.get_lvalue_reference_to())));
+
+        stmts.append(
+                Nodecl::IfElseStatement::make(
+                    Nodecl::LowerThan::make(
+                        taskloop_information_field_access(taskloop_bounds_ptr, get_field, "chunksize"),
+                        min_chunksize_value.shallow_copy(),
+                        TL::Type::get_bool_type()),
+                    Nodecl::List::make(
+                        Nodecl::ExpressionStatement::make(
+                            Nodecl::Assignment::make(
+                                taskloop_information_field_access(taskloop_bounds_ptr, get_field, "chunksize"),
+                                min_chunksize_value.shallow_copy(),
+                                chunksize_type.get_lvalue_reference_to()))),
+                    /* else */ Nodecl::NodeclBase::null()));
     }
 
     void TaskProperties::capture_taskloop_information(
@@ -4344,10 +4817,20 @@ namespace TL { namespace Nanos6 {
                 capture_taskloop_information_field(
                     taskloop_bounds_ptr, get_field, "step", original_step));
 
-        new_stmts.append(
-                capture_taskloop_information_field(
-                    taskloop_bounds_ptr, get_field, "chunksize", chunksize));
-
+        // A zero chunksize means that the user did not specify it
+        if ((IS_C_LANGUAGE || IS_CXX_LANGUAGE)
+                && phase->taskloop_adaptive_chunksize_enabled()
+                && chunksize.is_constant()
+                && const_value_is_zero(chunksize.get_constant()))
+        {
+            compute_adaptive_taskloop_chunksize(taskloop_bounds_ptr, new_stmts);
+        }
+        else
+        {
+            new_stmts.append(
+                    capture_taskloop_information_field(
+                        taskloop_bounds_ptr, get_field, "chunksize", chunksize));
+        }
 
         stmts = new_stmts;
     }
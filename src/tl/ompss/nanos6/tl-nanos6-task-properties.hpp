@@ -210,6 +210,10 @@ namespace TL { namespace Nanos6 {
                 Nodecl::NodeclBase upper_bound;
                 Nodecl::NodeclBase step;
                 Nodecl::NodeclBase chunksize;
+
+                // Estimated cost of one iteration of the loop, used to
+                // compute a chunksize when the user did not specify it
+                unsigned int iteration_cost;
             };
 
             TaskloopInfo taskloop_info;
@@ -264,6 +268,18 @@ namespace TL { namespace Nanos6 {
                     /* out */
                     Nodecl::NodeclBase& stmts) const;
 
+            //! This function computes a chunksize for a taskloop construct without one
+            /*!
+             * The chunksize is computed at runtime from the number of
+             * iterations and the number of CPUs, and it is bounded by the
+             * estimated cost of the loop body. It must be called once the
+             * bounds have already been captured
+             */
+            void compute_adaptive_taskloop_chunksize(
+                    TL::Symbol taskloop_bounds_ptr,
+                    /* out */
+                    Nodecl::List& stmts) const;
+
             void compute_task_flags(
                     TL::Symbol task_flags,
                     /* out */
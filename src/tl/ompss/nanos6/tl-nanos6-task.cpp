@@ -30,6 +30,8 @@
 #include "tl-nanos6-fortran-support.hpp"
 #include "tl-nanos6-interface.hpp"
 
+#include "tl-lowering-utils.hpp"
+
 #include "tl-counters.hpp"
 #include "tl-source.hpp"
 
@@ -53,79 +55,138 @@ namespace TL { namespace Nanos6 {
         lower_task(node, serial_stmts);
     }
 
-    // Substitute the task node for an ifelse for when using final
+    // Substitute the task node for an ifelse for when using final and, if
+    // possible, for another ifelse that skips the runtime when the task is
+    // undeferred
     void Lower::lower_task(const Nodecl::OpenMP::Task& node, Nodecl::NodeclBase& serial_stmts)
     {
         ERROR_CONDITION(serial_stmts.is_null()
                 && !_phase->_final_clause_transformation_disabled,
                 "Invalid serial statement for a task", 0);
 
+        TL::CounterManager::get_counter("nanos6-tasks")++;
+
+        Nodecl::NodeclBase if_condition;
+        bool undeferred_fast_path = !_phase->_undeferred_fast_path_disabled
+            && TL::Lowering::Utils::task_can_be_inlined_when_undeferred(
+                    node.get_environment(), node.get_statements(), if_condition);
+
         Nodecl::OpenMP::Task new_task = node;
-        if (!_phase->_final_clause_transformation_disabled)
+        if (!_phase->_final_clause_transformation_disabled
+                || undeferred_fast_path)
         {
-            // Traverse the serial statements since they may contain additional pragmas
-            walk(serial_stmts);
-
             Nodecl::NodeclBase stmts = node.get_statements();
+            Scope sc = node.retrieve_context();
 
-            // Wrap the function call into if (nanos_in_final())
-            TL::Symbol nanos_in_final_sym =
-                TL::Scope::get_global_scope().get_symbol_from_name("nanos_in_final");
-            ERROR_CONDITION(!nanos_in_final_sym .is_valid()
-                    || !nanos_in_final_sym.is_function(),
-                    "Invalid symbol", 0);
-
-            Nodecl::NodeclBase call_to_nanos_in_final = Nodecl::FunctionCall::make(
-                nanos_in_final_sym.make_nodecl(/* set_ref_type */ true,
-                    node.get_locus()), /* called */
-                Nodecl::NodeclBase::null(), /* Argument list */
-                Nodecl::NodeclBase::null(), /* Alternate name */
-                Nodecl::NodeclBase::null(), /* Function Form */
-                TL::Type::get_int_type()
-            );
+            // The statements must be copied before they are moved to the new task
+            Nodecl::NodeclBase undeferred_stmts;
+            if (undeferred_fast_path)
+                undeferred_stmts = Nodecl::Utils::deep_copy(stmts, sc);
 
             new_task = Nodecl::OpenMP::Task::make(node.get_environment(), stmts, node.get_locus());
+            Nodecl::NodeclBase new_stmt = new_task;
 
-            Scope sc = node.retrieve_context();
-            Scope not_final_context = new_block_context(sc.get_decl_context());
-
-            Nodecl::NodeclBase not_final_compound_stmt = Nodecl::Context::make(
-                Nodecl::List::make(
-                    Nodecl::CompoundStatement::make(
-                        Nodecl::List::make(new_task),
-                        /* finally */ Nodecl::NodeclBase::null(),
-                        node.get_locus()
-                        )
-                    ),
-                not_final_context,
-                node.get_locus()
-            );
-
-            Scope in_final_context = new_block_context(sc.get_decl_context());
-            Nodecl::NodeclBase in_final_compound_stmts = Nodecl::Context::make(
-                Nodecl::List::make(
-                    Nodecl::CompoundStatement::make(
-                        serial_stmts,
-                        /* finally */ Nodecl::NodeclBase::null(),
-                        node.get_locus()
-                        )
-                    ),
-                in_final_context,
-                node.get_locus()
-            );
-
-            Nodecl::NodeclBase if_in_final = Nodecl::IfElseStatement::make(
-                    Nodecl::Different::make(
-                        call_to_nanos_in_final,
-                        const_value_to_nodecl_with_basic_type(
-                            const_value_get_signed_int(0),
-                            get_size_t_type()),
-                        get_bool_type()),
-                    Nodecl::List::make(in_final_compound_stmts),
-                    Nodecl::List::make(not_final_compound_stmt)
+            if (undeferred_fast_path)
+            {
+                TL::CounterManager::get_counter("nanos6-tasks-undeferred-fast-path")++;
+
+                // When the 'if' clause evaluates to false the task would be
+                // executed immediately by the current thread, so we skip the
+                // runtime and execute its statements directly
+                Nodecl::NodeclBase deferred_compound_stmt = Nodecl::Context::make(
+                    Nodecl::List::make(
+                        Nodecl::CompoundStatement::make(
+                            Nodecl::List::make(new_stmt),
+                            /* finally */ Nodecl::NodeclBase::null(),
+                            node.get_locus()
+                            )
+                        ),
+                    new_block_context(sc.get_decl_context()),
+                    node.get_locus()
+                );
+
+                Nodecl::NodeclBase undeferred_compound_stmt = Nodecl::Context::make(
+                    Nodecl::List::make(
+                        Nodecl::CompoundStatement::make(
+                            undeferred_stmts,
+                            /* finally */ Nodecl::NodeclBase::null(),
+                            node.get_locus()
+                            )
+                        ),
+                    new_block_context(sc.get_decl_context()),
+                    node.get_locus()
                 );
 
-            node.replace(if_in_final);
+                new_stmt = Nodecl::IfElseStatement::make(
+                        if_condition.shallow_copy(),
+                        Nodecl::List::make(deferred_compound_stmt),
+                        Nodecl::List::make(undeferred_compound_stmt),
+                        node.get_locus());
+            }
+
+            if (!_phase->_final_clause_transformation_disabled)
+            {
+                TL::CounterManager::get_counter("nanos6-tasks-final-fast-path")++;
+
+                // Traverse the serial statements since they may contain additional pragmas
+                walk(serial_stmts);
+
+                // Wrap the function call into if (nanos_in_final())
+                TL::Symbol nanos_in_final_sym =
+                    TL::Scope::get_global_scope().get_symbol_from_name("nanos_in_final");
+                ERROR_CONDITION(!nanos_in_final_sym .is_valid()
+                        || !nanos_in_final_sym.is_function(),
+                        "Invalid symbol", 0);
+
+                Nodecl::NodeclBase call_to_nanos_in_final = Nodecl::FunctionCall::make(
+                    nanos_in_final_sym.make_nodecl(/* set_ref_type */ true,
+                        node.get_locus()), /* called */
+                    Nodecl::NodeclBase::null(), /* Argument list */
+                    Nodecl::NodeclBase::null(), /* Alternate name */
+                    Nodecl::NodeclBase::null(), /* Function Form */
+                    TL::Type::get_int_type()
+                );
+
+                Scope not_final_context = new_block_context(sc.get_decl_context());
+
+                Nodecl::NodeclBase not_final_compound_stmt = Nodecl::Context::make(
+                    Nodecl::List::make(
+                        Nodecl::CompoundStatement::make(
+                            Nodecl::List::make(new_stmt),
+                            /* finally */ Nodecl::NodeclBase::null(),
+                            node.get_locus()
+                            )
+                        ),
+                    not_final_context,
+                    node.get_locus()
+                );
+
+                Scope in_final_context = new_block_context(sc.get_decl_context());
+                Nodecl::NodeclBase in_final_compound_stmts = Nodecl::Context::make(
+                    Nodecl::List::make(
+                        Nodecl::CompoundStatement::make(
+                            serial_stmts,
+                            /* finally */ Nodecl::NodeclBase::null(),
+                            node.get_locus()
+                            )
+                        ),
+                    in_final_context,
+                    node.get_locus()
+                );
+
+                new_stmt = Nodecl::IfElseStatement::make(
+                        Nodecl::Different::make(
+                            call_to_nanos_in_final,
+                            const_value_to_nodecl_with_basic_type(
+                                const_value_get_signed_int(0),
+                                get_size_t_type()),
+                            get_bool_type()),
+                        Nodecl::List::make(in_final_compound_stmts),
+                        Nodecl::List::make(not_final_compound_stmt)
+                    );
+            }
+
+            node.replace(new_stmt);
         }
 
         lower_task(new_task);
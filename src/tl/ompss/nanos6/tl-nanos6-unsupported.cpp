@@ -72,5 +72,15 @@ void Lower::visit(const Nodecl::OmpSs::Unregister &n)
     unsupported(n);
 }
 
+void Lower::visit(const Nodecl::OpenMP::DoacrossWait &n)
+{
+    unsupported(n);
+}
+
+void Lower::visit(const Nodecl::OpenMP::DoacrossPost &n)
+{
+    unsupported(n);
+}
+
 }
 }
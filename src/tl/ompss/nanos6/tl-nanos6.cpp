@@ -28,8 +28,10 @@
 #include "tl-nanos6.hpp"
 #include "tl-nanos6-interface.hpp"
 #include "tl-nanos6-lower.hpp"
+#include "tl-nanos6-task-aggregation.hpp"
 
 #include "tl-compilerpipeline.hpp"
+#include "tl-counters.hpp"
 #include "tl-final-stmts-generator.hpp"
 
 #include "codegen-phase.hpp"
@@ -39,11 +41,20 @@
 #include "cxx-cexpr.h"
 
 #include <errno.h>
+#include <sstream>
 
 namespace TL { namespace Nanos6 {
 
     LoweringPhase::LoweringPhase()
-        : _final_clause_transformation_disabled(false)
+        : _final_clause_transformation_disabled(false),
+        _undeferred_fast_path_disabled(false),
+        _coalesce_multidependences_enabled(false),
+        _taskloop_adaptive_chunksize_disabled(false),
+        _taskloop_tasks_per_cpu(4),
+        _taskloop_min_task_cost(5000),
+        _task_aggregation_enabled(false),
+        _task_aggregation_factor(0),
+        _task_aggregation_min_cost(5000)
     {
         set_phase_name("Nanos 6 lowering");
         set_phase_description("This phase lowers from Mercurium parallel IR "
@@ -54,6 +65,49 @@ namespace TL { namespace Nanos6 {
                 _final_clause_transformation_str,
                 "0").connect(std::bind(&LoweringPhase::set_disable_final_clause_transformation, this, std::placeholders::_1));
 
+        register_parameter("disable_undeferred_fast_path",
+                "Disables the direct execution of tasks whose 'if' clause evaluates to false",
+                _undeferred_fast_path_str,
+                "0").connect(std::bind(&LoweringPhase::set_disable_undeferred_fast_path, this, std::placeholders::_1));
+
+        register_parameter("coalesce_multidependences",
+                "Registers multidependences whose iterators have unit stride using a single "
+                "multidimensional region instead of one region per element. "
+                "This is only equivalent when the runtime uses region-based dependences",
+                _coalesce_multidependences_str,
+                "0").connect(std::bind(&LoweringPhase::set_coalesce_multidependences, this, std::placeholders::_1));
+
+        register_parameter("disable_taskloop_adaptive_chunksize",
+                "Disables the computation of a chunksize for taskloops that do not specify it",
+                _taskloop_adaptive_chunksize_str,
+                "0").connect(std::bind(&LoweringPhase::set_disable_taskloop_adaptive_chunksize, this, std::placeholders::_1));
+
+        register_parameter("taskloop_tasks_per_cpu",
+                "Number of tasks per CPU that a taskloop without chunksize tries to create",
+                _taskloop_tasks_per_cpu_str,
+                "4").connect(std::bind(&LoweringPhase::set_taskloop_tasks_per_cpu, this, std::placeholders::_1));
+
+        register_parameter("taskloop_min_task_cost",
+                "Minimum estimated cost of the iterations of a task created by a taskloop without chunksize",
+                _taskloop_min_task_cost_str,
+                "5000").connect(std::bind(&LoweringPhase::set_taskloop_min_task_cost, this, std::placeholders::_1));
+
+        register_parameter("task_aggregation",
+                "Bundles several iterations of a loop whose body is a cheap task into a single task",
+                _task_aggregation_str,
+                "0").connect(std::bind(&LoweringPhase::set_task_aggregation, this, std::placeholders::_1));
+
+        register_parameter("task_aggregation_factor",
+                "Number of iterations bundled in every task by the task aggregation. "
+                "When it is 0 it is computed from the cost of the task",
+                _task_aggregation_factor_str,
+                "0").connect(std::bind(&LoweringPhase::set_task_aggregation_factor, this, std::placeholders::_1));
+
+        register_parameter("task_aggregation_min_cost",
+                "Minimum estimated cost of the tasks created by the task aggregation",
+                _task_aggregation_min_cost_str,
+                "5000").connect(std::bind(&LoweringPhase::set_task_aggregation_min_cost, this, std::placeholders::_1));
+
         // std::cerr << "Initializing Nanos 6 lowering phase" << std::endl;
     }
 
@@ -84,13 +138,36 @@ namespace TL { namespace Nanos6 {
             *std::static_pointer_cast<Nodecl::NodeclBase>(dto["nodecl"]);
 
 
+        TL::CounterManager::get_counter("nanos6-aggregated-task-loops") = 0;
+        if (_task_aggregation_enabled
+                && (IS_C_LANGUAGE || IS_CXX_LANGUAGE))
+        {
+            // This must be done before computing the serial statements of the tasks
+            TaskAggregation task_aggregation(this);
+            task_aggregation.walk(translation_unit);
+        }
+
         FinalStmtsGenerator final_generator(/* ompss_mode */ true);
         // If the final clause transformation is disabled we shouldn't generate the final stmts
         if (!_final_clause_transformation_disabled)
             final_generator.walk(translation_unit);
 
+        TL::CounterManager::get_counter("nanos6-tasks") = 0;
+        TL::CounterManager::get_counter("nanos6-tasks-final-fast-path") = 0;
+        TL::CounterManager::get_counter("nanos6-tasks-undeferred-fast-path") = 0;
+
         Lower lower(this, final_generator.get_final_stmts());
         lower.walk(translation_unit);
+
+        if (debug_options.lowering_stats)
+        {
+            std::cerr << "Nanos 6 lowering: "
+                << (int)TL::CounterManager::get_counter("nanos6-tasks") << " tasks, "
+                << (int)TL::CounterManager::get_counter("nanos6-tasks-final-fast-path") << " with a final fast path, "
+                << (int)TL::CounterManager::get_counter("nanos6-tasks-undeferred-fast-path") << " with an undeferred fast path, "
+                << (int)TL::CounterManager::get_counter("nanos6-aggregated-task-loops") << " aggregated task loops"
+                << std::endl;
+        }
     }
 
     void LoweringPhase::pre_run(DTO& dto)
@@ -147,6 +224,108 @@ namespace TL { namespace Nanos6 {
         parse_boolean_option("disable_final_clause_transformation", str, _final_clause_transformation_disabled, "Assuming false.");
     }
 
+    void LoweringPhase::set_disable_undeferred_fast_path(const std::string& str)
+    {
+        parse_boolean_option("disable_undeferred_fast_path", str, _undeferred_fast_path_disabled, "Assuming false.");
+    }
+
+    void LoweringPhase::set_coalesce_multidependences(const std::string& str)
+    {
+        parse_boolean_option("coalesce_multidependences", str, _coalesce_multidependences_enabled, "Assuming false.");
+    }
+
+    bool LoweringPhase::multidependences_coalescing_enabled() const
+    {
+        return _coalesce_multidependences_enabled;
+    }
+
+    void LoweringPhase::set_disable_taskloop_adaptive_chunksize(const std::string& str)
+    {
+        parse_boolean_option("disable_taskloop_adaptive_chunksize", str, _taskloop_adaptive_chunksize_disabled, "Assuming false.");
+    }
+
+    bool LoweringPhase::taskloop_adaptive_chunksize_enabled() const
+    {
+        return !_taskloop_adaptive_chunksize_disabled;
+    }
+
+    void LoweringPhase::set_taskloop_tasks_per_cpu(const std::string& str)
+    {
+        std::stringstream ss;
+        ss << str;
+        ss >> _taskloop_tasks_per_cpu;
+
+        if (ss.fail() || _taskloop_tasks_per_cpu == 0)
+        {
+            _taskloop_tasks_per_cpu = 4;
+            std::cerr << "Invalid specification for parameter 'taskloop_tasks_per_cpu'. Assuming 4" << std::endl;
+        }
+    }
+
+    unsigned int LoweringPhase::taskloop_tasks_per_cpu() const
+    {
+        return _taskloop_tasks_per_cpu;
+    }
+
+    void LoweringPhase::set_taskloop_min_task_cost(const std::string& str)
+    {
+        std::stringstream ss;
+        ss << str;
+        ss >> _taskloop_min_task_cost;
+
+        if (ss.fail())
+        {
+            _taskloop_min_task_cost = 5000;
+            std::cerr << "Invalid specification for parameter 'taskloop_min_task_cost'. Assuming 5000" << std::endl;
+        }
+    }
+
+    unsigned int LoweringPhase::taskloop_min_task_cost() const
+    {
+        return _taskloop_min_task_cost;
+    }
+
+    void LoweringPhase::set_task_aggregation(const std::string& str)
+    {
+        parse_boolean_option("task_aggregation", str, _task_aggregation_enabled, "Assuming false.");
+    }
+
+    void LoweringPhase::set_task_aggregation_factor(const std::string& str)
+    {
+        std::stringstream ss;
+        ss << str;
+        ss >> _task_aggregation_factor;
+
+        if (ss.fail())
+        {
+            _task_aggregation_factor = 0;
+            std::cerr << "Invalid specification for parameter 'task_aggregation_factor'. Assuming 0" << std::endl;
+        }
+    }
+
+    unsigned int LoweringPhase::task_aggregation_factor() const
+    {
+        return _task_aggregation_factor;
+    }
+
+    void LoweringPhase::set_task_aggregation_min_cost(const std::string& str)
+    {
+        std::stringstream ss;
+        ss << str;
+        ss >> _task_aggregation_min_cost;
+
+        if (ss.fail())
+        {
+            _task_aggregation_min_cost = 5000;
+            std::cerr << "Invalid specification for parameter 'task_aggregation_min_cost'. Assuming 5000" << std::endl;
+        }
+    }
+
+    unsigned int LoweringPhase::task_aggregation_min_cost() const
+    {
+        return _task_aggregation_min_cost;
+    }
+
     unsigned int LoweringPhase::nanos6_api_max_dimensions() const
     {
         return _constants.api_max_dimensions;
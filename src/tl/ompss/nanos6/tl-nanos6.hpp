@@ -58,6 +58,15 @@ namespace TL { namespace Nanos6 {
 
             unsigned int nanos6_api_max_dimensions() const;
 
+            bool multidependences_coalescing_enabled() const;
+
+            bool taskloop_adaptive_chunksize_enabled() const;
+            unsigned int taskloop_tasks_per_cpu() const;
+            unsigned int taskloop_min_task_cost() const;
+
+            unsigned int task_aggregation_factor() const;
+            unsigned int task_aggregation_min_cost() const;
+
         private:
             void fortran_preprocess_api(DTO& dto);
             void fortran_fixup_api();
@@ -68,6 +77,38 @@ namespace TL { namespace Nanos6 {
             bool _final_clause_transformation_disabled;
             void set_disable_final_clause_transformation(const std::string& str);
 
+            std::string _undeferred_fast_path_str;
+            bool _undeferred_fast_path_disabled;
+            void set_disable_undeferred_fast_path(const std::string& str);
+
+            std::string _coalesce_multidependences_str;
+            bool _coalesce_multidependences_enabled;
+            void set_coalesce_multidependences(const std::string& str);
+
+            std::string _taskloop_adaptive_chunksize_str;
+            bool _taskloop_adaptive_chunksize_disabled;
+            void set_disable_taskloop_adaptive_chunksize(const std::string& str);
+
+            std::string _taskloop_tasks_per_cpu_str;
+            unsigned int _taskloop_tasks_per_cpu;
+            void set_taskloop_tasks_per_cpu(const std::string& str);
+
+            std::string _taskloop_min_task_cost_str;
+            unsigned int _taskloop_min_task_cost;
+            void set_taskloop_min_task_cost(const std::string& str);
+
+            std::string _task_aggregation_str;
+            bool _task_aggregation_enabled;
+            void set_task_aggregation(const std::string& str);
+
+            std::string _task_aggregation_factor_str;
+            unsigned int _task_aggregation_factor;
+            void set_task_aggregation_factor(const std::string& str);
+
+            std::string _task_aggregation_min_cost_str;
+            unsigned int _task_aggregation_min_cost;
+            void set_task_aggregation_min_cost(const std::string& str);
+
 
             Nodecl::List _extra_c_code;
             
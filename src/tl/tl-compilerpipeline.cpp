@@ -30,6 +30,8 @@
 #include "tl-compilerpipeline.hpp"
 #include "cxx-driver.h"
 #include "cxx-utils.h"
+#include "cxx-driver-utils.h"
+#include "cxx-compile-stats.h"
 #include "filename.h"
 
 namespace TL
@@ -150,4 +152,130 @@ namespace TL
         : _filename(str)
     {
     }
+
+    FusablePhase::FusablePhase()
+        : _handled_kinds(AST_LAST_NODE, false),
+        _handles_all_kinds(true)
+    {
+    }
+
+    void FusablePhase::add_dependence(const std::string& phase_name)
+    {
+        _dependences.insert(phase_name);
+    }
+
+    void FusablePhase::run(DTO& data_flow)
+    {
+        PassManager pass_manager;
+        pass_manager.add_phase(this);
+        pass_manager.run(data_flow);
+    }
+
+    PassManager::PassManager()
+        : _phases()
+    {
+    }
+
+    bool PassManager::can_fuse(FusablePhase* phase) const
+    {
+        const ObjectList<std::string>& dependences = phase->get_dependences();
+        for (std::vector<PhaseInfo>::const_iterator it = _phases.begin();
+                it != _phases.end();
+                it++)
+        {
+            if (dependences.contains(it->phase->get_phase_name()))
+                return false;
+        }
+        return true;
+    }
+
+    void PassManager::add_phase(FusablePhase* phase)
+    {
+        ERROR_CONDITION(!can_fuse(phase), "Phase '%s' cannot be fused with the previous ones",
+                phase->get_phase_name().c_str());
+
+        PhaseInfo info;
+        info.phase = phase;
+        info.nodes_handled = 0;
+        _phases.push_back(info);
+    }
+
+    std::string PassManager::get_name() const
+    {
+        if (_phases.size() == 1)
+            return _phases[0].phase->get_phase_name();
+
+        std::string result;
+        for (std::vector<PhaseInfo>::const_iterator it = _phases.begin();
+                it != _phases.end();
+                it++)
+        {
+            if (it != _phases.begin())
+                result += " + ";
+            result += it->phase->get_phase_name();
+        }
+        return result + " (fused)";
+    }
+
+    void PassManager::handle(nodecl_t n)
+    {
+        for (std::vector<PhaseInfo>::iterator it = _phases.begin();
+                it != _phases.end();
+                it++)
+        {
+            // A previous handler may have changed the kind of the node
+            if (!it->phase->handles_kind(nodecl_get_kind(n)))
+                continue;
+
+            it->phase->handle_node(Nodecl::NodeclBase(n));
+            it->nodes_handled++;
+        }
+    }
+
+    void PassManager::walk(nodecl_t n)
+    {
+        if (nodecl_is_null(n))
+            return;
+
+        compile_stats_nodes_visited++;
+
+        if (nodecl_is_list(n))
+        {
+            // Lists are not handled, only their elements, like the visitors do
+            AST it;
+            for_each_element(nodecl_get_ast(n), it)
+            {
+                walk(_nodecl_wrap(ASTSon1(it)));
+            }
+            return;
+        }
+
+        for (int i = 0; i < MCXX_MAX_AST_CHILDREN; i++)
+        {
+            walk(nodecl_get_child(n, i));
+        }
+
+        handle(n);
+    }
+
+    void PassManager::run(DTO& data_flow)
+    {
+        Nodecl::NodeclBase top_level = *std::static_pointer_cast<Nodecl::NodeclBase>(data_flow["nodecl"]);
+
+        for (std::vector<PhaseInfo>::iterator it = _phases.begin();
+                it != _phases.end();
+                it++)
+        {
+            it->phase->begin_tree(data_flow);
+        }
+
+        walk(top_level.get_internal_nodecl());
+
+        for (std::vector<PhaseInfo>::iterator it = _phases.begin();
+                it != _phases.end();
+                it++)
+        {
+            it->phase->end_tree(data_flow);
+        }
+    }
 }
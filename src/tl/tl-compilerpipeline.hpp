@@ -33,8 +33,11 @@
 #include "tl-common.hpp"
 #include "tl-object.hpp"
 #include "tl-objectlist.hpp"
+#include "tl-compilerphase.hpp"
+#include "tl-nodecl-base.hpp"
 
 #include <map>
+#include <vector>
 
 namespace TL
 {
@@ -169,6 +172,108 @@ namespace TL
             static CompiledFile get_current_file();
     };
 
+
+    //! Base class for phases that can share a traversal of the tree
+    /*!
+     * A fusable phase does not walk the tree itself. Instead it handles
+     * nodes one at a time, in postorder, so several consecutive fusable
+     * phases can be run by a PassManager in a single traversal when the
+     * driver is invoked with --fuse-phases.
+     *
+     * handle_node may modify or replace the handled node and its subtree
+     * but nothing else of the tree, since the remaining phases of the
+     * traversal have not seen it yet.
+     */
+    class LIBTL_CLASS FusablePhase : public CompilerPhase
+    {
+        private:
+            std::vector<bool> _handled_kinds;
+            bool _handles_all_kinds;
+            ObjectList<std::string> _dependences;
+
+        protected:
+            //! States that this phase handles nodes of kind Kind
+            /*!
+             * If no kind is stated, every node of the tree is handled
+             */
+            template <typename Kind>
+            void handle_kind()
+            {
+                _handled_kinds[Nodecl::NodeclBase::kind_of<Kind>()] = true;
+                _handles_all_kinds = false;
+            }
+
+            //! States that phase_name must have handled the whole tree
+            //! before this phase handles any node
+            void add_dependence(const std::string& phase_name);
+
+        public:
+            FusablePhase();
+
+            //! Called before the traversal
+            virtual void begin_tree(DTO& data_flow) { }
+
+            //! Called for every handled node after its children
+            virtual void handle_node(const Nodecl::NodeclBase& node) = 0;
+
+            //! Called after the traversal
+            virtual void end_tree(DTO& data_flow) { }
+
+            bool handles_kind(node_t kind) const
+            {
+                return _handles_all_kinds || _handled_kinds[kind];
+            }
+
+            const ObjectList<std::string>& get_dependences() const
+            {
+                return _dependences;
+            }
+
+            //! Runs this phase alone
+            virtual void run(DTO& data_flow);
+    };
+
+    //! Runs several fusable phases in a single traversal of the tree
+    /*!
+     * Every node is handled by the phases in the order they were added.
+     * The traversal is timed as a whole by whoever runs it, timing every
+     * handler would cost more than what most of them do
+     */
+    class LIBTL_CLASS PassManager
+    {
+        private:
+            struct PhaseInfo
+            {
+                FusablePhase* phase;
+                unsigned long long nodes_handled;
+            };
+            std::vector<PhaseInfo> _phases;
+
+            void walk(nodecl_t n);
+            void handle(nodecl_t n);
+        public:
+            PassManager();
+
+            //! States whether phase can join the phases already added
+            /*!
+             * It cannot when it depends on any of them
+             */
+            bool can_fuse(FusablePhase* phase) const;
+
+            void add_phase(FusablePhase* phase);
+
+            //! Name used in the compile statistics and in messages
+            std::string get_name() const;
+
+            //! Traverses the tree in the "nodecl" entry of data_flow
+            void run(DTO& data_flow);
+
+            //! Number of nodes passed to the handler of the i-th phase
+            unsigned long long get_nodes_handled(int i) const
+            {
+                return _phases[i].nodes_handled;
+            }
+    };
 }
 
 #endif // TL_COMPILERPIPELINE_HPP
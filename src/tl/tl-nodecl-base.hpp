@@ -126,6 +126,7 @@ namespace Nodecl {
             // Simple RTTI
             template <typename T> bool is() const { return !this->is_null() && (T::_kind == this->get_kind()); }
             template <typename T> T as() const { return T(this->_n); }
+            template <typename T> static node_t kind_of() { return (node_t)T::_kind; }
             template <typename Ret> friend class BaseNodeclVisitor;
 
             // Sorting of trees by pointer
@@ -218,14 +219,7 @@ namespace Nodecl {
 
                     void rewind()
                     {
-                        _current = _top;
-                        if (nodecl_is_null(_current))
-                            return;
-
-                        while (!nodecl_is_null(nodecl_get_child(_current, 0)))
-                        {
-                            _current = nodecl_get_child(_current, 0);
-                        }
+                        _current = nodecl_list_nth_node(_top, 0);
                     }
                 public:
                     bool operator==(const iterator& it) const
@@ -406,14 +400,7 @@ namespace Nodecl {
 
                     void rewind()
                     {
-                        _current = _top;
-                        if (nodecl_is_null(_current))
-                            return;
-
-                        while (!nodecl_is_null(nodecl_get_child(_current, 0)))
-                        {
-                            _current = nodecl_get_child(_current, 0);
-                        }
+                        _current = nodecl_list_nth_node(_top, 0);
                     }
                 public:
                     bool operator==(const reverse_iterator& it) const
@@ -646,10 +633,7 @@ namespace Nodecl {
 
             Nodecl::NodeclBase at(int n) const
             {
-                const_iterator it = this->begin();
-                it = it + n;
-
-                return *it;
+                return nodecl_list_nth(this->get_internal_nodecl(), n);
             }
 
             Nodecl::NodeclBase front() const
@@ -686,15 +670,8 @@ namespace Nodecl {
                 }
                 else // If we are the end we have to modify "this"
                 {
-                    nodecl_t old_previous = nodecl_get_child(this->get_internal_nodecl(), 0);
-                    nodecl_t old_last = nodecl_get_child(this->get_internal_nodecl(), 1);
-
-                    nodecl_set_child(this->get_internal_nodecl(), 1, new_node.get_internal_nodecl());
-
-                    nodecl_t singleton = nodecl_make_list_1(old_last);
-                    nodecl_set_child(singleton, 0, old_previous);
-
-                    nodecl_set_child(this->get_internal_nodecl(), 0, singleton);
+                    nodecl_list_append_in_place(this->get_internal_nodecl(),
+                            new_node.get_internal_nodecl());
                 }
             }
 
@@ -32,6 +32,7 @@
 #include "tl-source.hpp"
 
 #include "cxx-nodecl-deep-copy.h"
+#include "cxx-nodecl-index.h"
 
 #include <tr1/unordered_map>
 #include <functional>
@@ -438,6 +439,34 @@ namespace Utils {
         return finder.found_nodes;
     }
 
+    // Returns the nodes of kind Kind in n in preorder. Unlike
+    // nodecl_get_all_nodecls_of_kind this does not look into the
+    // initializers of ObjectInit. With --nodecl-index the nodes of the whole
+    // translation unit are taken from the index instead of walking it
+    template <typename Kind>
+    TL::ObjectList<Kind> find_all(const Nodecl::NodeclBase& n)
+    {
+        int num_nodes = 0;
+        nodecl_t* nodes = ::nodecl_index_find_all(n.get_internal_nodecl(),
+                Nodecl::NodeclBase::kind_of<Kind>(), &num_nodes);
+
+        TL::ObjectList<Kind> result;
+        for (int i = 0; i < num_nodes; i++)
+        {
+            result.append(Kind(nodes[i]));
+        }
+        DELETE(nodes);
+
+        return result;
+    }
+
+    // Like above for the whole translation unit being compiled
+    template <typename Kind>
+    TL::ObjectList<Kind> find_all()
+    {
+        return find_all<Kind>(Nodecl::NodeclBase::null());
+    }
+
     void nodecl_replace_nodecl_by_structure(
             const Nodecl::NodeclBase& haystack,
             const Nodecl::NodeclBase& needle,
@@ -26,6 +26,9 @@
 
 #include "tl-vector-isa-descriptor.hpp"
 
+#include <sstream>
+#include <map>
+
 namespace TL
 {
 namespace Vectorization
@@ -134,8 +137,60 @@ namespace {
     SimdIsa knl("knl", 64, 16, SUPPORT_MASKING);
     SimdIsa neon("neon", 16, 0, DONT_SUPPORT_MASKING);
     VectorIsa romol("romol", 64, 64, SUPPORT_MASKING); // vector length in elements
+
+    // Created on demand, see set_generic_vector_length
+    unsigned int generic_vector_length = 16;
+    SimdIsa* generic = NULL;
+
+    typedef std::map<TL::Symbol, VectorInstructionSet> function_version_isa_t;
+    function_version_isa_t function_version_isa;
+}
+
+unsigned int parse_generic_vector_length(const std::string& str)
+{
+    std::stringstream ss(str);
+    unsigned int vector_length = 0;
+    ss >> vector_length;
+
+    // GCC only accepts powers of two in vector_size and one vector must
+    // hold at least one double
+    if (ss.fail()
+            || !ss.eof()
+            || vector_length < 8
+            || (vector_length & (vector_length - 1)) != 0)
+    {
+        fatal_error("SIMD: invalid generic vector length '%s'. "
+                "It must be a power of two greater or equal than 8\n",
+                str.c_str());
+    }
+
+    return vector_length;
+}
+
+void set_generic_vector_length(unsigned int vector_length)
+{
+    if (generic != NULL
+            && generic_vector_length != vector_length)
+    {
+        internal_error("Generic vector length changed after being used", 0);
+    }
+    generic_vector_length = vector_length;
+}
+
+void set_function_version_isa(TL::Symbol function, const VectorInstructionSet isa)
+{
+    function_version_isa[function] = isa;
 }
 
+bool get_function_version_isa(TL::Symbol function, VectorInstructionSet &isa)
+{
+    function_version_isa_t::iterator it = function_version_isa.find(function);
+    if (it == function_version_isa.end())
+        return false;
+
+    isa = it->second;
+    return true;
+}
 
 VectorIsaDescriptor &get_vector_isa_description(const VectorInstructionSet isa)
 {
@@ -153,6 +208,11 @@ VectorIsaDescriptor &get_vector_isa_description(const VectorInstructionSet isa)
             return neon;
         case ROMOL_ISA:
             return romol;
+        case GENERIC_ISA:
+            if (generic == NULL)
+                generic = new SimdIsa("generic",
+                        generic_vector_length, 0, DONT_SUPPORT_MASKING);
+            return *generic;
         default:
             fatal_error("SIMD: Unsupported SIMD ISA: %d", isa);
     }
@@ -29,6 +29,7 @@
 
 #include "tl-vectorization-common.hpp"
 #include "tl-type.hpp"
+#include "tl-symbol.hpp"
 
 namespace TL
 {
@@ -102,6 +103,15 @@ class VectorIsa : public VectorIsaDescriptor
 
 VectorIsaDescriptor &get_vector_isa_description(const VectorInstructionSet isa);
 
+// The vector length (in bytes) of the generic ISA is chosen by the user
+unsigned int parse_generic_vector_length(const std::string& str);
+void set_generic_vector_length(unsigned int vector_length);
+
+// Function versions that have to be vectorized and lowered for an ISA other
+// than the one of the translation unit (see simd_dispatch_isas)
+void set_function_version_isa(TL::Symbol function, const VectorInstructionSet isa);
+bool get_function_version_isa(TL::Symbol function, VectorInstructionSet &isa);
+
 }
 }
 
@@ -59,6 +59,7 @@ namespace TL
             KNL_ISA,
             NEON_ISA,
             ROMOL_ISA,
+            GENERIC_ISA,
         };
     }
 }
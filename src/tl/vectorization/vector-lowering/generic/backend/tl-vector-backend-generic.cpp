@@ -0,0 +1,860 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+
+  This file is part of Mercurium C/C++ source-to-source compiler.
+
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+#include "tl-vector-backend-generic.hpp"
+#include "tl-vector-legalization-generic.hpp"
+#include "tl-vectorization-utils.hpp"
+#include "tl-nodecl-utils.hpp"
+
+#include "cxx-cexpr.h"
+#include "cxx-typeutils.h"
+#include "cxx-diagnostic.h"
+
+namespace TL
+{
+    namespace Vectorization
+    {
+        namespace {
+            std::string type_str(const TL::Type& t, const Nodecl::NodeclBase& n)
+            {
+                return print_type_str(t.get_internal_type(),
+                        n.retrieve_context().get_decl_context());
+            }
+
+            bool is_trivial(const Nodecl::NodeclBase& n)
+            {
+                return n.is<Nodecl::Symbol>() || n.is_constant();
+            }
+
+            void replace_with_expression(const Nodecl::NodeclBase& n,
+                    TL::Source& src)
+            {
+                Nodecl::NodeclBase expression =
+                    src.parse_expression(n.retrieve_context());
+
+                n.replace(expression);
+            }
+        }
+
+        GenericVectorBackend::GenericVectorBackend()
+        {
+            std::cerr << "--- Generic vector backend phase ---" << std::endl;
+        }
+
+        void GenericVectorBackend::check_mask(const Nodecl::NodeclBase& n,
+                const Nodecl::NodeclBase& mask)
+        {
+            if (!mask.is_null()
+                    && !TL::Vectorization::Utils::is_all_one_mask(mask))
+            {
+                fatal_printf_at(n.get_locus(),
+                        "Generic Vector Backend: Node %s has an unsupported mask\n",
+                        ast_print_node_type(n.get_kind()));
+            }
+        }
+
+        // Element-wise conversion between vectors with the same number of
+        // elements. GCC folds it into the proper conversion instructions
+        TL::Source GenericVectorBackend::convert_vector(TL::Source expr,
+                const TL::Type& type_from,
+                const TL::Type& type_to,
+                const Nodecl::NodeclBase& n)
+        {
+            TL::Type from = type_from.no_ref().get_unqualified_type();
+            TL::Type to = type_to.no_ref().get_unqualified_type();
+
+            ERROR_CONDITION(from.vector_num_elements() != to.vector_num_elements(),
+                    "Invalid vector conversion", 0);
+
+            TL::Source result;
+            if (from.is_same_type(to))
+            {
+                result << "(" << expr << ")";
+                return result;
+            }
+
+            TL::Type element_from = from.vector_element();
+            TL::Type element_to = to.vector_element();
+
+            // Integers of the same size only need a bitwise cast
+            if (element_from.is_integral_type()
+                    && element_to.is_integral_type()
+                    && element_from.get_size() == element_to.get_size())
+            {
+                result << "((" << type_str(to, n) << ")(" << expr << "))";
+                return result;
+            }
+
+            std::string element_to_str = type_str(element_to, n);
+
+            result << "({ " << type_str(from, n) << " __c = " << expr << "; "
+                << "(" << type_str(to, n) << "){";
+            for (int i = 0; i < to.vector_num_elements(); i++)
+            {
+                if (i > 0)
+                    result << ", ";
+                result << "(" << element_to_str << ")__c[" << i << "]";
+            }
+            result << "}; })";
+
+            return result;
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::ObjectInit& node)
+        {
+            if (node.has_symbol())
+            {
+                TL::Symbol sym = node.get_symbol();
+
+                Nodecl::NodeclBase init = sym.get_value();
+                if (!init.is_null())
+                {
+                    walk(init);
+                }
+            }
+        }
+
+        // GCC vectors have these operators, codegen cannot print the vector
+        // nodes so they are rebuilt as plain expressions
+#define GENERIC_OPERATOR(Node, Op) \
+        void GenericVectorBackend::visit(const Nodecl::Node& node) \
+        { \
+            check_mask(node, node.get_mask()); \
+            walk(node.get_lhs()); \
+            walk(node.get_rhs()); \
+            \
+            TL::Source src; \
+            src << "(" << as_expression(node.get_lhs()) << Op \
+                << as_expression(node.get_rhs()) << ")"; \
+            \
+            replace_with_expression(node, src); \
+        }
+
+        GENERIC_OPERATOR(VectorAdd, " + ")
+        GENERIC_OPERATOR(VectorMinus, " - ")
+        GENERIC_OPERATOR(VectorMul, " * ")
+        GENERIC_OPERATOR(VectorDiv, " / ")
+        GENERIC_OPERATOR(VectorMod, " % ")
+        GENERIC_OPERATOR(VectorBitwiseAnd, " & ")
+        GENERIC_OPERATOR(VectorBitwiseOr, " | ")
+        GENERIC_OPERATOR(VectorBitwiseXor, " ^ ")
+        GENERIC_OPERATOR(VectorBitwiseShl, " << ")
+        GENERIC_OPERATOR(VectorAssignment, " = ")
+
+        // GCC shifts right according to the signedness of the elements
+        void GenericVectorBackend::visit_shift_right(const Nodecl::NodeclBase& n,
+                const Nodecl::NodeclBase& lhs,
+                const Nodecl::NodeclBase& rhs,
+                const Nodecl::NodeclBase& mask,
+                bool arithmetic)
+        {
+            check_mask(n, mask);
+            walk(lhs);
+            walk(rhs);
+
+            TL::Type type = n.get_type().no_ref().get_unqualified_type();
+            bool is_signed = type.vector_element().is_signed_integral();
+
+            TL::Source src;
+            if (arithmetic == is_signed)
+            {
+                src << "(" << as_expression(lhs) << " >> " << as_expression(rhs) << ")";
+            }
+            else
+            {
+                TL::Type shift_type = arithmetic
+                    ? generic_integer_vector_type(type)
+                    : generic_unsigned_vector_type(type);
+
+                src << "((" << type_str(type, n) << ")(("
+                    << type_str(shift_type, n) << ")(" << as_expression(lhs) << ") >> "
+                    << as_expression(rhs) << "))";
+            }
+
+            replace_with_expression(n, src);
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::VectorBitwiseShr& node)
+        {
+            visit_shift_right(node, node.get_lhs(), node.get_rhs(), node.get_mask(),
+                    /* arithmetic */ false);
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::VectorArithmeticShr& node)
+        {
+            visit_shift_right(node, node.get_lhs(), node.get_rhs(), node.get_mask(),
+                    /* arithmetic */ true);
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::VectorNeg& node)
+        {
+            check_mask(node, node.get_mask());
+            walk(node.get_rhs());
+
+            TL::Source src;
+            src << "(-" << as_expression(node.get_rhs()) << ")";
+
+            replace_with_expression(node, src);
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::VectorBitwiseNot& node)
+        {
+            check_mask(node, node.get_mask());
+            walk(node.get_rhs());
+
+            TL::Source src;
+            src << "(~" << as_expression(node.get_rhs()) << ")";
+
+            replace_with_expression(node, src);
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::VectorFmadd& node)
+        {
+            check_mask(node, node.get_mask());
+            walk(node.get_first_op());
+            walk(node.get_second_op());
+            walk(node.get_third_op());
+
+            // GCC contracts this when the target has FMA
+            TL::Source src;
+            src << "(" << as_expression(node.get_first_op())
+                << " * " << as_expression(node.get_second_op())
+                << " + " << as_expression(node.get_third_op()) << ")";
+
+            replace_with_expression(node, src);
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::VectorFmminus& node)
+        {
+            check_mask(node, node.get_mask());
+            walk(node.get_first_mul_op());
+            walk(node.get_second_mul_op());
+            walk(node.get_minus_op());
+
+            TL::Source src;
+            src << "(" << as_expression(node.get_first_mul_op())
+                << " * " << as_expression(node.get_second_mul_op());
+            if (!node.get_minus_op().is_null())
+                src << " - " << as_expression(node.get_minus_op());
+            src << ")";
+
+            replace_with_expression(node, src);
+        }
+
+        void GenericVectorBackend::visit_comparison(const Nodecl::NodeclBase& n,
+                const Nodecl::NodeclBase& lhs,
+                const Nodecl::NodeclBase& rhs,
+                const Nodecl::NodeclBase& mask,
+                const std::string& op)
+        {
+            check_mask(n, mask);
+            walk(lhs);
+            walk(rhs);
+
+            // A comparison yields integers of the size of the compared
+            // elements but legalization may have chosen another size for
+            // the mask
+            TL::Type cmp_type = generic_integer_vector_type(lhs.get_type());
+            TL::Type mask_type = n.get_type().no_ref();
+
+            TL::Source cmp_src;
+            cmp_src << as_expression(lhs) << op << as_expression(rhs);
+
+            TL::Source src = convert_vector(cmp_src, cmp_type, mask_type, n);
+
+            replace_with_expression(n, src);
+        }
+
+#define GENERIC_COMPARISON(Node, Op) \
+        void GenericVectorBackend::visit(const Nodecl::Node& node) \
+        { \
+            visit_comparison(node, node.get_lhs(), node.get_rhs(), \
+                    node.get_mask(), Op); \
+        }
+
+        GENERIC_COMPARISON(VectorLowerThan, " < ")
+        GENERIC_COMPARISON(VectorLowerOrEqualThan, " <= ")
+        GENERIC_COMPARISON(VectorGreaterThan, " > ")
+        GENERIC_COMPARISON(VectorGreaterOrEqualThan, " >= ")
+        GENERIC_COMPARISON(VectorEqual, " == ")
+        GENERIC_COMPARISON(VectorDifferent, " != ")
+
+        void GenericVectorBackend::visit(const Nodecl::VectorAlignRight& node)
+        {
+            const Nodecl::NodeclBase left_vector = node.get_left_vector();
+            const Nodecl::NodeclBase right_vector = node.get_right_vector();
+            const Nodecl::NodeclBase num_elements = node.get_num_elements();
+
+            check_mask(node, node.get_mask());
+
+            walk(left_vector);
+            walk(right_vector);
+            walk(num_elements);
+
+            TL::Type type = node.get_type().no_ref().get_unqualified_type();
+            TL::Type index_type = generic_integer_vector_type(type);
+
+            // Elements [num_elements, num_elements + N) of the
+            // concatenation of right_vector and left_vector
+            TL::Source src, indexes;
+            src << "({ int __n = " << as_expression(num_elements) << "; "
+                << "__builtin_shuffle("
+                << as_expression(right_vector) << ", "
+                << as_expression(left_vector) << ", "
+                << "(" << type_str(index_type, node) << "){" << indexes << "}); })";
+
+            for (int i = 0; i < type.vector_num_elements(); i++)
+            {
+                if (i > 0)
+                    indexes << ", ";
+                indexes << "__n + " << i;
+            }
+
+            replace_with_expression(node, src);
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::VectorLogicalAnd& node)
+        {
+            fatal_printf_at(node.get_locus(),
+                    "Generic Vector Backend: 'logical and' operation (i.e., operator '&&') is not supported. "
+                    "Try using 'bitwise and' operations (i.e., operator '&') instead if possible.");
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::VectorLogicalOr& node)
+        {
+            fatal_printf_at(node.get_locus(),
+                    "Generic Vector Backend: 'logical or' operation (i.e., operator '||') is not supported. "
+                    "Try using 'bitwise or' operations (i.e., operator '|') instead if possible.");
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::VectorConversion& node)
+        {
+            check_mask(node, node.get_mask());
+
+            const TL::Type src_type = node.get_nest().get_type().no_ref().get_unqualified_type();
+            const TL::Type dst_type = node.get_type().no_ref().get_unqualified_type();
+
+            walk(node.get_nest());
+
+            if (src_type.is_same_type(dst_type))
+            {
+                node.replace(node.get_nest());
+                return;
+            }
+
+            TL::Source nest_src;
+            nest_src << as_expression(node.get_nest());
+
+            TL::Source src = convert_vector(nest_src, src_type, dst_type, node);
+
+            replace_with_expression(node, src);
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::VectorConditionalExpression& node)
+        {
+            Nodecl::NodeclBase true_node = node.get_true();
+            Nodecl::NodeclBase false_node = node.get_false();
+            Nodecl::NodeclBase condition_node = node.get_condition();
+
+            walk(false_node);
+            walk(true_node);
+            walk(condition_node);
+
+            TL::Type type = node.get_type().no_ref().get_unqualified_type();
+            TL::Type select_type = generic_integer_vector_type(type);
+
+            std::string type_s = type_str(type, node);
+            std::string select_type_s = type_str(select_type, node);
+
+            TL::Source condition_src;
+            condition_src << as_expression(condition_node);
+
+            // Bitwise select since C does not allow '?:' on vectors
+            TL::Source src;
+            src << "({ " << select_type_s << " __m = "
+                << convert_vector(condition_src,
+                        condition_node.get_type(), select_type, node) << "; "
+                << "(" << type_s << ")"
+                << "(((" << select_type_s << ")(" << as_expression(true_node) << ") & __m)"
+                << " | ((" << select_type_s << ")(" << as_expression(false_node) << ") & ~__m)); })"
+                ;
+
+            replace_with_expression(node, src);
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::VectorPromotion& node)
+        {
+            check_mask(node, node.get_mask());
+            walk(node.get_rhs());
+
+            TL::Type type = node.get_type().no_ref().get_unqualified_type();
+            std::string type_s = type_str(type, node);
+
+            TL::Source src, scalar, values;
+            if (is_trivial(node.get_rhs()))
+            {
+                scalar << as_expression(node.get_rhs());
+                src << "(" << type_s << "){" << values << "}";
+            }
+            else
+            {
+                // Evaluate the scalar only once
+                scalar << "__s";
+                src << "({ " << type_str(type.vector_element(), node) << " __s = "
+                    << as_expression(node.get_rhs()) << "; "
+                    << "(" << type_s << "){" << values << "}; })";
+            }
+
+            for (int i = 0; i < type.vector_num_elements(); i++)
+            {
+                if (i > 0)
+                    values << ", ";
+                values << scalar;
+            }
+
+            replace_with_expression(node, src);
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::VectorLiteral& node)
+        {
+            check_mask(node, node.get_mask());
+
+            TL::Type type = node.get_type().no_ref().get_unqualified_type();
+
+            TL::Source src;
+            src << "(" << type_str(type, node) << "){";
+
+            Nodecl::List scalar_values =
+                node.get_scalar_values().as<Nodecl::List>();
+
+            for (Nodecl::List::const_iterator it = scalar_values.begin();
+                    it != scalar_values.end();
+                    it++)
+            {
+                if (it != scalar_values.begin())
+                    src << ", ";
+
+                walk(*it);
+                src << as_expression(*it);
+            }
+
+            src << "}";
+
+            replace_with_expression(node, src);
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::VectorLoad& node)
+        {
+            check_mask(node, node.get_mask());
+            walk(node.get_rhs());
+
+            Nodecl::List flags = node.get_flags().as<Nodecl::List>();
+            bool aligned = !flags.find_first<Nodecl::AlignedFlag>().is_null();
+
+            TL::Type type = node.get_type().no_ref().get_unqualified_type();
+            std::string type_s = type_str(type, node);
+
+            TL::Source src;
+            if (aligned)
+            {
+                src << "(*(" << type_s << "*)(" << as_expression(node.get_rhs()) << "))";
+            }
+            else
+            {
+                // GCC emits an unaligned load for this
+                src << "({ " << type_s << " __v; "
+                    << "__builtin_memcpy(&__v, " << as_expression(node.get_rhs())
+                    << ", sizeof(__v)); __v; })";
+            }
+
+            replace_with_expression(node, src);
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::VectorStore& node)
+        {
+            check_mask(node, node.get_mask());
+            walk(node.get_lhs());
+            walk(node.get_rhs());
+
+            Nodecl::List flags = node.get_flags().as<Nodecl::List>();
+            bool aligned = !flags.find_first<Nodecl::AlignedFlag>().is_null();
+
+            TL::Type type = node.get_rhs().get_type().no_ref().get_unqualified_type();
+            std::string type_s = type_str(type, node);
+
+            TL::Source src;
+            if (aligned)
+            {
+                src << "(*(" << type_s << "*)(" << as_expression(node.get_lhs()) << ") = "
+                    << as_expression(node.get_rhs()) << ")";
+            }
+            else
+            {
+                src << "({ " << type_s << " __v = " << as_expression(node.get_rhs()) << "; "
+                    << "__builtin_memcpy(" << as_expression(node.get_lhs())
+                    << ", &__v, sizeof(__v)); })";
+            }
+
+            replace_with_expression(node, src);
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::VectorGather& node)
+        {
+            check_mask(node, node.get_mask());
+            walk(node.get_base());
+            walk(node.get_strides());
+
+            TL::Type type = node.get_type().no_ref().get_unqualified_type();
+            TL::Type index_type = node.get_strides().get_type().no_ref().get_unqualified_type();
+
+            TL::Source src;
+            src << "({ " << type_str(index_type, node) << " __i = "
+                << as_expression(node.get_strides()) << "; "
+                << "(" << type_str(type, node) << "){";
+
+            for (int i = 0; i < type.vector_num_elements(); i++)
+            {
+                if (i > 0)
+                    src << ", ";
+                src << "(" << as_expression(node.get_base()) << ")[__i[" << i << "]]";
+            }
+
+            src << "}; })";
+
+            replace_with_expression(node, src);
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::VectorScatter& node)
+        {
+            check_mask(node, node.get_mask());
+            walk(node.get_base());
+            walk(node.get_strides());
+            walk(node.get_source());
+
+            TL::Type type = node.get_source().get_type().no_ref().get_unqualified_type();
+            TL::Type index_type = node.get_strides().get_type().no_ref().get_unqualified_type();
+
+            TL::Source src;
+            src << "({ " << type_str(index_type, node) << " __i = "
+                << as_expression(node.get_strides()) << "; "
+                << type_str(type, node) << " __s = "
+                << as_expression(node.get_source()) << "; ";
+
+            for (int i = 0; i < type.vector_num_elements(); i++)
+            {
+                src << "(" << as_expression(node.get_base()) << ")[__i[" << i << "]]"
+                    << " = __s[" << i << "]; ";
+            }
+
+            src << "})";
+
+            replace_with_expression(node, src);
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::VectorFunctionCall& node)
+        {
+            Nodecl::FunctionCall function_call =
+                node.get_function_call().as<Nodecl::FunctionCall>();
+
+            walk(function_call.get_arguments());
+
+            node.replace(function_call);
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::VectorFabs& node)
+        {
+            check_mask(node, node.get_mask());
+            walk(node.get_argument());
+
+            TL::Type type = node.get_type().no_ref().get_unqualified_type();
+            TL::Type element = type.vector_element();
+            std::string type_s = type_str(type, node);
+
+            TL::Source src;
+            if (element.is_float() || element.is_double())
+            {
+                // Clear the sign bit
+                TL::Type int_type = generic_integer_vector_type(type);
+                std::string int_type_s = type_str(int_type, node);
+
+                src << "((" << type_s << ")((" << int_type_s << ")("
+                    << as_expression(node.get_argument()) << ") & "
+                    << "(" << int_type_s << "){";
+                for (int i = 0; i < type.vector_num_elements(); i++)
+                {
+                    if (i > 0)
+                        src << ", ";
+                    src << (element.is_float() ? "0x7FFFFFFF" : "0x7FFFFFFFFFFFFFFFLL");
+                }
+                src << "}))";
+            }
+            else if (element.is_signed_integral())
+            {
+                src << "({ " << type_s << " __a = " << as_expression(node.get_argument()) << "; "
+                    << type_s << " __m = __a >> " << (int)(element.get_size() * 8 - 1) << "; "
+                    << "(__a ^ __m) - __m; })";
+            }
+            else if (element.is_integral_type())
+            {
+                node.replace(node.get_argument());
+                return;
+            }
+            else
+            {
+                fatal_printf_at(node.get_locus(),
+                        "Generic Vector Backend: Node %s has an unsupported type.",
+                        ast_print_node_type(node.get_kind()));
+            }
+
+            replace_with_expression(node, src);
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::ParenthesizedExpression& node)
+        {
+            walk(node.get_nest());
+            Nodecl::NodeclBase n(node);
+
+            n.set_type(node.get_nest().get_type());
+        }
+
+        void GenericVectorBackend::visit_reduction(const Nodecl::NodeclBase& n,
+                const Nodecl::NodeclBase& vector_src,
+                const Nodecl::NodeclBase& mask,
+                const std::string& op)
+        {
+            check_mask(n, mask);
+            walk(vector_src);
+
+            TL::Type vtype = vector_src.get_type().no_ref().get_unqualified_type();
+
+            TL::Source src;
+            src << "({ " << type_str(vtype, n) << " __r = "
+                << as_expression(vector_src) << "; ";
+
+            for (int i = 0; i < vtype.vector_num_elements(); i++)
+            {
+                if (i > 0)
+                    src << op;
+                src << "__r[" << i << "]";
+            }
+
+            src << "; })";
+
+            replace_with_expression(n, src);
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::VectorReductionAdd& node)
+        {
+            visit_reduction(node, node.get_vector_src(), node.get_mask(), " + ");
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::VectorReductionMinus& node)
+        {
+            // Partial results of a '-' reduction are added
+            visit_reduction(node, node.get_vector_src(), node.get_mask(), " + ");
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::VectorReductionMul& node)
+        {
+            visit_reduction(node, node.get_vector_src(), node.get_mask(), " * ");
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::VectorMaskAssignment& node)
+        {
+            walk(node.get_lhs());
+            walk(node.get_rhs());
+
+            TL::Source src;
+            src << "(" << as_expression(node.get_lhs()) << " = "
+                << as_expression(node.get_rhs()) << ")";
+
+            replace_with_expression(node, src);
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::VectorMaskNot& node)
+        {
+            walk(node.get_rhs());
+
+            TL::Source src;
+            src << "(~" << as_expression(node.get_rhs()) << ")";
+
+            replace_with_expression(node, src);
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::VectorMaskConversion& node)
+        {
+            internal_error("Generic Vector Backend: Node %s at %s should have been legalized",
+                    ast_print_node_type(node.get_kind()),
+                    locus_to_str(node.get_locus()));
+        }
+
+        void GenericVectorBackend::visit_mask_binary(const Nodecl::NodeclBase& n,
+                const Nodecl::NodeclBase& lhs,
+                const Nodecl::NodeclBase& rhs,
+                const std::string& lhs_prefix,
+                const std::string& op,
+                const std::string& rhs_prefix)
+        {
+            walk(lhs);
+            walk(rhs);
+
+            TL::Source src;
+            src << "(" << lhs_prefix << as_expression(lhs)
+                << op << rhs_prefix << as_expression(rhs) << ")";
+
+            replace_with_expression(n, src);
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::VectorMaskAnd& node)
+        {
+            visit_mask_binary(node, node.get_lhs(), node.get_rhs(), "", " & ", "");
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::VectorMaskOr& node)
+        {
+            visit_mask_binary(node, node.get_lhs(), node.get_rhs(), "", " | ", "");
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::VectorMaskAnd1Not& node)
+        {
+            visit_mask_binary(node, node.get_lhs(), node.get_rhs(), "~", " & ", "");
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::VectorMaskAnd2Not& node)
+        {
+            visit_mask_binary(node, node.get_lhs(), node.get_rhs(), "", " & ", "~");
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::VectorMaskXor& node)
+        {
+            visit_mask_binary(node, node.get_lhs(), node.get_rhs(), "", " ^ ", "");
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::MaskLiteral& node)
+        {
+            TL::Type type = node.get_type().no_ref();
+            ERROR_CONDITION(!type.is_vector(), "Mask literal has not been legalized", 0);
+
+            const_value_t* value = node.get_constant();
+            bool all_ones = const_value_is_minus_one(value);
+            int num_elements = type.vector_num_elements();
+
+            if (!all_ones && num_elements > 64)
+            {
+                fatal_printf_at(node.get_locus(),
+                        "Generic Vector Backend: mask literal of %d elements is not supported\n",
+                        num_elements);
+            }
+
+            uint64_t bits = all_ones ? ~(uint64_t)0 : const_value_cast_to_8(value);
+
+            // Each bit of the mask becomes a whole lane
+            TL::Source src;
+            src << "(" << type_str(type, node) << "){";
+            for (int i = 0; i < num_elements; i++)
+            {
+                if (i > 0)
+                    src << ", ";
+                src << ((all_ones || ((bits >> i) & 1)) ? "-1" : "0");
+            }
+            src << "}";
+
+            replace_with_expression(node, src);
+        }
+
+        void GenericVectorBackend::visit_elementwise_sqrt(const Nodecl::NodeclBase& n,
+                const Nodecl::NodeclBase& rhs,
+                const std::string& prefix)
+        {
+            walk(rhs);
+
+            TL::Type type = n.get_type().no_ref().get_unqualified_type();
+            TL::Type element = type.vector_element();
+
+            std::string function;
+            if (element.is_float())
+            {
+                function = "__builtin_sqrtf";
+            }
+            else if (element.is_double())
+            {
+                function = "__builtin_sqrt";
+            }
+            else
+            {
+                fatal_printf_at(n.get_locus(),
+                        "Generic Vector Backend: Node %s has an unsupported type.",
+                        ast_print_node_type(n.get_kind()));
+            }
+
+            // GCC vectorizes this back with -fno-math-errno
+            TL::Source src;
+            src << "({ " << type_str(type, n) << " __a = " << as_expression(rhs) << "; "
+                << "(" << type_str(type, n) << "){";
+            for (int i = 0; i < type.vector_num_elements(); i++)
+            {
+                if (i > 0)
+                    src << ", ";
+                src << prefix << function << "(__a[" << i << "])";
+            }
+            src << "}; })";
+
+            replace_with_expression(n, src);
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::VectorSqrt& node)
+        {
+            check_mask(node, node.get_mask());
+            visit_elementwise_sqrt(node, node.get_rhs(), "");
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::VectorRsqrt& node)
+        {
+            check_mask(node, node.get_mask());
+            visit_elementwise_sqrt(node, node.get_rhs(), "1 / ");
+        }
+
+        void GenericVectorBackend::visit(const Nodecl::VectorRcp& node)
+        {
+            check_mask(node, node.get_mask());
+            walk(node.get_rhs());
+
+            TL::Type type = node.get_type().no_ref().get_unqualified_type();
+
+            TL::Source src;
+            src << "((" << type_str(type, node) << "){";
+            for (int i = 0; i < type.vector_num_elements(); i++)
+            {
+                if (i > 0)
+                    src << ", ";
+                src << "1";
+            }
+            src << "} / " << as_expression(node.get_rhs()) << ")";
+
+            replace_with_expression(node, src);
+        }
+    }
+}
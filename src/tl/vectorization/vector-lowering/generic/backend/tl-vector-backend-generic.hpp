@@ -0,0 +1,147 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information 
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+#ifndef GENERIC_VECTOR_BACKEND_HPP
+#define GENERIC_VECTOR_BACKEND_HPP
+
+#include "tl-nodecl-base.hpp"
+#include "tl-nodecl-visitor.hpp"
+#include "tl-source.hpp"
+
+namespace TL
+{
+    namespace Vectorization
+    {
+        // Lowers Vector IR to GCC generic vectors (vector_size attribute).
+        // Every vector node is replaced: operations that have an operator in
+        // GNU C become that operator, the rest are lowered to vector
+        // initializers, __builtin_shuffle and element-wise accesses. The
+        // native compiler is in charge of the instruction selection
+        class GenericVectorBackend : public Nodecl::ExhaustiveVisitor<void>
+        {
+            private:
+                void check_mask(const Nodecl::NodeclBase& n,
+                        const Nodecl::NodeclBase& mask);
+
+                TL::Source convert_vector(TL::Source expr,
+                        const TL::Type& type_from,
+                        const TL::Type& type_to,
+                        const Nodecl::NodeclBase& n);
+
+                void visit_comparison(const Nodecl::NodeclBase& n,
+                        const Nodecl::NodeclBase& lhs,
+                        const Nodecl::NodeclBase& rhs,
+                        const Nodecl::NodeclBase& mask,
+                        const std::string& op);
+                void visit_shift_right(const Nodecl::NodeclBase& n,
+                        const Nodecl::NodeclBase& lhs,
+                        const Nodecl::NodeclBase& rhs,
+                        const Nodecl::NodeclBase& mask,
+                        bool arithmetic);
+                void visit_mask_binary(const Nodecl::NodeclBase& n,
+                        const Nodecl::NodeclBase& lhs,
+                        const Nodecl::NodeclBase& rhs,
+                        const std::string& lhs_prefix,
+                        const std::string& op,
+                        const std::string& rhs_prefix);
+                void visit_elementwise_sqrt(const Nodecl::NodeclBase& n,
+                        const Nodecl::NodeclBase& rhs,
+                        const std::string& prefix);
+                void visit_reduction(const Nodecl::NodeclBase& n,
+                        const Nodecl::NodeclBase& vector_src,
+                        const Nodecl::NodeclBase& mask,
+                        const std::string& op);
+
+            public:
+
+                GenericVectorBackend();
+
+                virtual void visit(const Nodecl::ObjectInit& node);
+
+                virtual void visit(const Nodecl::VectorAdd& node);
+                virtual void visit(const Nodecl::VectorMinus& node);
+                virtual void visit(const Nodecl::VectorMul& node);
+                virtual void visit(const Nodecl::VectorDiv& node);
+                virtual void visit(const Nodecl::VectorMod& node);
+                virtual void visit(const Nodecl::VectorNeg& node);
+                virtual void visit(const Nodecl::VectorFmadd& node);
+                virtual void visit(const Nodecl::VectorFmminus& node);
+
+                virtual void visit(const Nodecl::VectorLowerThan& node);
+                virtual void visit(const Nodecl::VectorLowerOrEqualThan& node);
+                virtual void visit(const Nodecl::VectorGreaterThan& node);
+                virtual void visit(const Nodecl::VectorGreaterOrEqualThan& node);
+                virtual void visit(const Nodecl::VectorEqual& node);
+                virtual void visit(const Nodecl::VectorDifferent& node);
+
+                virtual void visit(const Nodecl::VectorBitwiseAnd& node);
+                virtual void visit(const Nodecl::VectorBitwiseOr& node);
+                virtual void visit(const Nodecl::VectorBitwiseXor& node);
+                virtual void visit(const Nodecl::VectorBitwiseNot& node);
+                virtual void visit(const Nodecl::VectorBitwiseShl& node);
+                virtual void visit(const Nodecl::VectorBitwiseShr& node);
+                virtual void visit(const Nodecl::VectorArithmeticShr& node);
+                virtual void visit(const Nodecl::VectorAlignRight& node);
+                virtual void visit(const Nodecl::VectorLogicalAnd& node);
+                virtual void visit(const Nodecl::VectorLogicalOr& node);
+
+                virtual void visit(const Nodecl::VectorConversion& node);
+                virtual void visit(const Nodecl::VectorConditionalExpression& node);
+                virtual void visit(const Nodecl::VectorPromotion& node);
+                virtual void visit(const Nodecl::VectorLiteral& node);
+                virtual void visit(const Nodecl::VectorAssignment& node);
+                virtual void visit(const Nodecl::VectorLoad& node);
+                virtual void visit(const Nodecl::VectorStore& node);
+                virtual void visit(const Nodecl::VectorGather& node);
+                virtual void visit(const Nodecl::VectorScatter& node);
+
+                virtual void visit(const Nodecl::VectorFunctionCall& node);
+                virtual void visit(const Nodecl::VectorFabs& node);
+
+                virtual void visit(const Nodecl::ParenthesizedExpression& node);
+
+                virtual void visit(const Nodecl::VectorReductionAdd& node);
+                virtual void visit(const Nodecl::VectorReductionMinus& node);
+                virtual void visit(const Nodecl::VectorReductionMul& node);
+
+                virtual void visit(const Nodecl::VectorMaskAssignment& node);
+                virtual void visit(const Nodecl::VectorMaskNot& node);
+                virtual void visit(const Nodecl::VectorMaskConversion& node);
+                virtual void visit(const Nodecl::VectorMaskAnd& node);
+                virtual void visit(const Nodecl::VectorMaskOr& node);
+                virtual void visit(const Nodecl::VectorMaskAnd1Not& node);
+                virtual void visit(const Nodecl::VectorMaskAnd2Not& node);
+                virtual void visit(const Nodecl::VectorMaskXor& node);
+                virtual void visit(const Nodecl::MaskLiteral& node);
+
+                virtual void visit(const Nodecl::VectorSqrt& node);
+
+                virtual void visit(const Nodecl::VectorRcp& node);
+                virtual void visit(const Nodecl::VectorRsqrt& node);
+        };
+    }
+}
+#endif // GENERIC_VECTOR_BACKEND_HPP
@@ -0,0 +1,199 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information 
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+#include "tl-vector-legalization-generic.hpp"
+
+#include "cxx-typeutils.h"
+#include "cxx-diagnostic.h"
+
+namespace TL
+{
+    namespace Vectorization
+    {
+        namespace {
+            TL::Type integer_type_of_size(unsigned int size)
+            {
+                if (size == 1)
+                    return TL::Type(get_signed_char_type());
+                else if (size == 2)
+                    return TL::Type::get_short_int_type();
+                else if (size == 4)
+                    return TL::Type::get_int_type();
+                else if (size == 8)
+                    return TL::Type::get_long_long_int_type();
+
+                internal_error("Generic Vector: no integer type of size %d", size);
+            }
+
+            TL::Type unsigned_type_of_size(unsigned int size)
+            {
+                if (size == 1)
+                    return TL::Type::get_unsigned_char_type();
+                else if (size == 2)
+                    return TL::Type::get_unsigned_short_int_type();
+                else if (size == 4)
+                    return TL::Type::get_unsigned_int_type();
+                else if (size == 8)
+                    return TL::Type::get_unsigned_long_long_int_type();
+
+                internal_error("Generic Vector: no unsigned type of size %d", size);
+            }
+        }
+
+        TL::Type generic_integer_vector_type(const TL::Type& vector_type)
+        {
+            TL::Type t = vector_type.no_ref();
+            ERROR_CONDITION(!t.is_vector(), "Invalid type", 0);
+
+            return integer_type_of_size(t.vector_element().get_size())
+                .get_vector_of_elements(t.vector_num_elements());
+        }
+
+        TL::Type generic_unsigned_vector_type(const TL::Type& vector_type)
+        {
+            TL::Type t = vector_type.no_ref();
+            ERROR_CONDITION(!t.is_vector(), "Invalid type", 0);
+
+            return unsigned_type_of_size(t.vector_element().get_size())
+                .get_vector_of_elements(t.vector_num_elements());
+        }
+
+        GenericVectorLegalization::GenericVectorLegalization(
+                unsigned int vector_length)
+            : _vector_length(vector_length)
+        {
+            std::cerr << "--- Generic vector legalization phase ---" << std::endl;
+        }
+
+        TL::Type GenericVectorLegalization::get_mask_vector_type(
+                const TL::Type& mask_type)
+        {
+            // There are no mask types in GCC vectors, a mask is a vector of
+            // integers that spans the whole vector length
+            unsigned int num_elements = mask_type.get_mask_num_elements();
+            unsigned int element_size = _vector_length / num_elements;
+
+            if (element_size == 0)
+            {
+                fatal_error("Generic Vector: a mask of %d elements does not fit in "
+                        "a vector of %d bytes\n",
+                        num_elements, _vector_length);
+            }
+            else if (element_size > 8)
+            {
+                element_size = 8;
+            }
+
+            return integer_type_of_size(element_size)
+                .get_vector_of_elements(num_elements);
+        }
+
+        void GenericVectorLegalization::fix_mask_symbol(TL::Symbol sym)
+        {
+            if (sym.get_type().is_mask())
+            {
+                sym.set_type(get_mask_vector_type(sym.get_type()));
+            }
+        }
+
+        void GenericVectorLegalization::fix_mask_type(Nodecl::NodeclBase node)
+        {
+            if (node.get_type().is_mask())
+                node.set_type(get_mask_vector_type(node.get_type()));
+            else if (node.get_type().is_lvalue_reference()
+                    && node.get_type().no_ref().is_mask())
+                node.set_type(get_mask_vector_type(node.get_type().no_ref())
+                        .get_lvalue_reference_to());
+        }
+
+        void GenericVectorLegalization::visit(const Nodecl::Symbol &node)
+        {
+            fix_mask_symbol(node.get_symbol());
+            fix_mask_type(node);
+        }
+
+        void GenericVectorLegalization::visit(const Nodecl::ObjectInit& node)
+        {
+            TL::Symbol sym = node.get_symbol();
+            fix_mask_symbol(sym);
+
+            Nodecl::NodeclBase init = sym.get_value();
+            if (!init.is_null())
+            {
+                walk(init);
+            }
+        }
+
+#define BINARY_MASK_OPS(Node) \
+        void GenericVectorLegalization::visit(const Nodecl::Node& n) \
+        { \
+            walk(n.get_lhs()); \
+            walk(n.get_rhs()); \
+            fix_mask_type(n); \
+        }
+
+        BINARY_MASK_OPS(VectorMaskAssignment)
+        BINARY_MASK_OPS(VectorLowerThan)
+        BINARY_MASK_OPS(VectorLowerOrEqualThan)
+        BINARY_MASK_OPS(VectorGreaterThan)
+        BINARY_MASK_OPS(VectorGreaterOrEqualThan)
+        BINARY_MASK_OPS(VectorEqual)
+        BINARY_MASK_OPS(VectorDifferent)
+        BINARY_MASK_OPS(VectorMaskOr)
+        BINARY_MASK_OPS(VectorMaskAnd)
+        BINARY_MASK_OPS(VectorMaskAnd1Not)
+        BINARY_MASK_OPS(VectorMaskAnd2Not)
+        BINARY_MASK_OPS(VectorMaskXor)
+
+        void GenericVectorLegalization::visit(const Nodecl::VectorMaskNot& n)
+        {
+            walk(n.get_rhs());
+            fix_mask_type(n);
+        }
+
+        void GenericVectorLegalization::visit(const Nodecl::MaskLiteral& n)
+        {
+            // The backend expands the bits of the constant into the lanes
+            fix_mask_type(n);
+        }
+
+        void GenericVectorLegalization::visit(
+            const Nodecl::VectorMaskConversion &node)
+        {
+            walk(node.get_nest());
+
+            Nodecl::VectorConversion vec_conv = Nodecl::VectorConversion::make(
+                    node.get_nest().shallow_copy(),
+                    Nodecl::NodeclBase::null() /* mask */,
+                    node.get_type(),
+                    node.get_locus());
+
+            fix_mask_type(vec_conv);
+
+            node.replace(vec_conv);
+        }
+    }
+}
@@ -38,6 +38,9 @@
 #include "tl-vector-legalization-romol.hpp"
 #include "tl-vector-backend-romol.hpp"
 #include "tl-vector-romol-regalloc.hpp"
+#include "tl-vector-legalization-generic.hpp"
+#include "tl-vector-backend-generic.hpp"
+#include "tl-vector-isa-descriptor.hpp"
 #include "tl-vectorization-three-addresses.hpp"
 
 
@@ -51,13 +54,15 @@ namespace TL
             _avx2_enabled(false),
             _neon_enabled(false),
             _romol_enabled(false),
+            _generic_enabled(false),
+            _generic_vector_length(16),
             _prefer_gather_scatter(false),
             _prefer_mask_gather_scatter(false),
             _valib_sim_header(false)
         {
             set_phase_name("Vector Lowering Phase");
             set_phase_description("This phase lowers Vector IR to builtin calls. "
-                    "By default targets SSE but AVX, AVX2, KNC, KNL, NEON and RoMoL are implemented as well");
+                    "By default targets SSE but AVX, AVX2, KNC, KNL, NEON, RoMoL and generic GCC vectors are implemented as well");
 
             register_parameter("knl_enabled",
                     "If set to '1' enables compilation for KNC architecture, otherwise it is disabled",
@@ -84,6 +89,16 @@ namespace TL
                     _romol_enabled_str,
                     "0").connect(std::bind(&VectorLoweringPhase::set_romol, this, std::placeholders::_1));
 
+            register_parameter("generic_enabled",
+                    "If set to '1' enables compilation for generic GCC vectors, otherwise it is disabled",
+                    _generic_enabled_str,
+                    "0").connect(std::bind(&VectorLoweringPhase::set_generic, this, std::placeholders::_1));
+
+            register_parameter("generic_vector_length",
+                    "Vector length in bytes used when compiling for generic GCC vectors",
+                    _generic_vector_length_str,
+                    "16").connect(std::bind(&VectorLoweringPhase::set_generic_vector_length, this, std::placeholders::_1));
+
             register_parameter("prefer_mask_gather_scatter",
                     "If set to '1' enables gather/scatter generation for unaligned load/stores with masks",
                     _prefer_mask_gather_scatter_str,
@@ -125,6 +140,16 @@ namespace TL
             parse_boolean_option("romol_enabled", romol_enabled_str, _romol_enabled, "Invalid value for romol_enabled");
         }
 
+        void VectorLoweringPhase::set_generic(const std::string& generic_enabled_str)
+        {
+            parse_boolean_option("generic_enabled", generic_enabled_str, _generic_enabled, "Invalid value for generic_enabled");
+        }
+
+        void VectorLoweringPhase::set_generic_vector_length(const std::string& generic_vector_length_str)
+        {
+            _generic_vector_length = parse_generic_vector_length(generic_vector_length_str);
+        }
+
         void VectorLoweringPhase::set_prefer_gather_scatter(
                 const std::string& prefer_gather_scatter_str)
         {
@@ -165,6 +190,7 @@ namespace TL
                 { _knl_enabled, "KNL" },
                 { _neon_enabled, "NEON" },
                 { _romol_enabled, "RoMoL" },
+                { _generic_enabled, "generic" },
             };
 
             const int N = sizeof(backend_flag) / sizeof(*backend_flag);
@@ -183,92 +209,154 @@ namespace TL
                 }
             }
 
-            if(_avx2_enabled)
-            {
-                // AVX2 Legalization phase
-                AVX2VectorLegalization avx2_vector_legalization;
-                avx2_vector_legalization.walk(translation_unit);
-
-                VectorizationThreeAddresses three_addresses_visitor;
-                three_addresses_visitor.walk(translation_unit);
-
-                // AVX2 Lowering to intrinsics
-                AVX2VectorLowering avx2_vector_lowering;
-                avx2_vector_lowering.walk(translation_unit);
-            }
+            VectorInstructionSet isa = SSE4_2_ISA;
+            if (_avx2_enabled)
+                isa = AVX2_ISA;
             else if (_knc_enabled)
+                isa = KNC_ISA;
+            else if (_knl_enabled)
+                isa = KNL_ISA;
+            else if (_neon_enabled)
+                isa = NEON_ISA;
+            else if (_romol_enabled)
+                isa = ROMOL_ISA;
+            else if (_generic_enabled)
+                isa = GENERIC_ISA;
+
+            // Function versions vectorized for another ISA are lowered first
+            // with their own backend
+            TL::ObjectList<Nodecl::NodeclBase> function_codes =
+                Nodecl::Utils::nodecl_get_all_nodecls_of_kind<Nodecl::FunctionCode>(
+                        translation_unit);
+            for (TL::ObjectList<Nodecl::NodeclBase>::iterator it = function_codes.begin();
+                    it != function_codes.end();
+                    it++)
             {
-                // KNC Legalization phase
-                KNCVectorLegalization knc_vector_legalization(
-                        _prefer_gather_scatter, _prefer_mask_gather_scatter);
-                knc_vector_legalization.walk(translation_unit);
+                VectorInstructionSet function_isa;
+                if (get_function_version_isa(it->get_symbol(), function_isa)
+                        && function_isa != isa)
+                {
+                    lower_vector_ir(*it, function_isa);
+                }
+            }
 
-                VectorizationThreeAddresses three_addresses_visitor;
-                three_addresses_visitor.walk(translation_unit);
+            lower_vector_ir(translation_unit, isa);
 
-                // Lowering to intrinsics
-                KNCVectorBackend knc_vector_backend;
-                knc_vector_backend.walk(translation_unit);
+            if (_romol_enabled && _valib_sim_header)
+            {
+                Nodecl::Utils::prepend_to_top_level_nodecl(
+                        Nodecl::PreprocessorLine::make(
+                            "#include <valib-sim.h>",
+                            /* locus */ 0));
             }
-            else if (_knl_enabled)
+        }
+
+        void VectorLoweringPhase::lower_vector_ir(Nodecl::NodeclBase n,
+                VectorInstructionSet isa)
+        {
+            switch (isa)
             {
-                // KNL Legalization phase
-                KNLVectorLegalization knl_vector_legalization(
-                        _prefer_gather_scatter, _prefer_mask_gather_scatter);
-                knl_vector_legalization.walk(translation_unit);
+                case AVX2_ISA:
+                    {
+                        // AVX2 Legalization phase
+                        AVX2VectorLegalization avx2_vector_legalization;
+                        avx2_vector_legalization.walk(n);
 
-                VectorizationThreeAddresses three_addresses_visitor;
-                three_addresses_visitor.walk(translation_unit);
+                        VectorizationThreeAddresses three_addresses_visitor;
+                        three_addresses_visitor.walk(n);
 
-                // Lowering to intrinsics
-                KNLVectorBackend knl_vector_backend;
-                knl_vector_backend.walk(translation_unit);
-            }
-            else if (_neon_enabled)
-            {
-                // NEON legalization
-                NeonVectorLegalization neon_vector_legalization;
-                neon_vector_legalization.walk(translation_unit);
+                        // AVX2 Lowering to intrinsics
+                        AVX2VectorLowering avx2_vector_lowering;
+                        avx2_vector_lowering.walk(n);
+                        break;
+                    }
+                case KNC_ISA:
+                    {
+                        // KNC Legalization phase
+                        KNCVectorLegalization knc_vector_legalization(
+                                _prefer_gather_scatter, _prefer_mask_gather_scatter);
+                        knc_vector_legalization.walk(n);
+
+                        VectorizationThreeAddresses three_addresses_visitor;
+                        three_addresses_visitor.walk(n);
+
+                        // Lowering to intrinsics
+                        KNCVectorBackend knc_vector_backend;
+                        knc_vector_backend.walk(n);
+                        break;
+                    }
+                case KNL_ISA:
+                    {
+                        // KNL Legalization phase
+                        KNLVectorLegalization knl_vector_legalization(
+                                _prefer_gather_scatter, _prefer_mask_gather_scatter);
+                        knl_vector_legalization.walk(n);
+
+                        VectorizationThreeAddresses three_addresses_visitor;
+                        three_addresses_visitor.walk(n);
+
+                        // Lowering to intrinsics
+                        KNLVectorBackend knl_vector_backend;
+                        knl_vector_backend.walk(n);
+                        break;
+                    }
+                case NEON_ISA:
+                    {
+                        // NEON legalization
+                        NeonVectorLegalization neon_vector_legalization;
+                        neon_vector_legalization.walk(n);
 
-                VectorizationThreeAddresses three_addresses_visitor;
-                three_addresses_visitor.walk(translation_unit);
+                        VectorizationThreeAddresses three_addresses_visitor;
+                        three_addresses_visitor.walk(n);
 
-                // Lower to NEON intrinsics
-                NeonVectorBackend neon_vector_backend;
-                neon_vector_backend.walk(translation_unit);
-            }
-            else if (_romol_enabled)
-            {
-                RomolVectorLegalization romol_vector_legalization;
-                romol_vector_legalization.walk(translation_unit);
+                        // Lower to NEON intrinsics
+                        NeonVectorBackend neon_vector_backend;
+                        neon_vector_backend.walk(n);
+                        break;
+                    }
+                case ROMOL_ISA:
+                    {
+                        RomolVectorLegalization romol_vector_legalization;
+                        romol_vector_legalization.walk(n);
 
-                VectorizationThreeAddresses three_addresses_visitor;
-                three_addresses_visitor.walk(translation_unit);
+                        VectorizationThreeAddresses three_addresses_visitor;
+                        three_addresses_visitor.walk(n);
 
-                RomolVectorRegAlloc romol_vector_ra;
-                romol_vector_ra.walk(translation_unit);
+                        RomolVectorRegAlloc romol_vector_ra;
+                        romol_vector_ra.walk(n);
 
-                RomolVectorBackend romol_vector_backend;
-                romol_vector_backend.walk(translation_unit);
+                        RomolVectorBackend romol_vector_backend;
+                        romol_vector_backend.walk(n);
+                        break;
+                    }
+                case GENERIC_ISA:
+                    {
+                        GenericVectorLegalization generic_vector_legalization(
+                                _generic_vector_length);
+                        generic_vector_legalization.walk(n);
 
-                if (_valib_sim_header)
-                {
-                    Nodecl::Utils::prepend_to_top_level_nodecl(
-                            Nodecl::PreprocessorLine::make(
-                                "#include <valib-sim.h>",
-                                /* locus */ 0));
-                }
-            }
-            else
-            {
-                SSEVectorLegalization sse_vector_legalization;
-                sse_vector_legalization.walk(translation_unit);
+                        VectorizationThreeAddresses three_addresses_visitor;
+                        three_addresses_visitor.walk(n);
+
+                        // Lower to GCC vector extensions
+                        GenericVectorBackend generic_vector_backend;
+                        generic_vector_backend.walk(n);
+                        break;
+                    }
+                case SSE4_2_ISA:
+                    {
+                        SSEVectorLegalization sse_vector_legalization;
+                        sse_vector_legalization.walk(n);
 
-                VectorizationThreeAddresses three_addresses_visitor;
-                three_addresses_visitor.walk(translation_unit);
+                        VectorizationThreeAddresses three_addresses_visitor;
+                        three_addresses_visitor.walk(n);
 
-                SSEVectorBackend sse_vector_backend;
-                sse_vector_backend.walk(translation_unit);
+                        SSEVectorBackend sse_vector_backend;
+                        sse_vector_backend.walk(n);
+                        break;
+                    }
+                default:
+                    fatal_error("SIMD: Unsupported vector ISA: %d", isa);
             }
         }
 
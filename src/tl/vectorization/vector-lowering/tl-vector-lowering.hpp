@@ -28,6 +28,7 @@
 #define VECTOR_LOWERING_PHASE_HPP
 
 #include "tl-compilerphase.hpp"
+#include "tl-vectorization-common.hpp"
 
 namespace TL
 {
@@ -41,6 +42,8 @@ namespace TL
                 bool _avx2_enabled;
                 bool _neon_enabled;
                 bool _romol_enabled;
+                bool _generic_enabled;
+                unsigned int _generic_vector_length;
                 bool _prefer_gather_scatter;
                 bool _prefer_mask_gather_scatter;
                 bool _valib_sim_header;
@@ -50,6 +53,8 @@ namespace TL
                 std::string _avx2_enabled_str;
                 std::string _neon_enabled_str;
                 std::string _romol_enabled_str;
+                std::string _generic_enabled_str;
+                std::string _generic_vector_length_str;
                 std::string _intel_compiler_profile_str;
                 std::string _prefer_gather_scatter_str;
                 std::string _prefer_mask_gather_scatter_str;
@@ -60,6 +65,8 @@ namespace TL
                 void set_avx2(const std::string& avx2_enabled_str);
                 void set_neon(const std::string& neon_enabled_str);
                 void set_romol(const std::string& romol_enabled_str);
+                void set_generic(const std::string& generic_enabled_str);
+                void set_generic_vector_length(const std::string& generic_vector_length_str);
                 void set_intel_compiler_profile(
                         const std::string& intel_compiler_profile_str);
                 void set_prefer_gather_scatter(
@@ -68,6 +75,9 @@ namespace TL
                         const std::string& prefer_mask_gather_scatter_str);
                 void set_valib_sim_header(const std::string& str);
 
+                void lower_vector_ir(Nodecl::NodeclBase n,
+                        VectorInstructionSet isa);
+
             public:
                 VectorLoweringPhase();
                 virtual void run(TL::DTO& dto);
@@ -0,0 +1,567 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+
+  This file is part of Mercurium C/C++ source-to-source compiler.
+
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+#include "tl-vectorizer-cost-model.hpp"
+
+#include "tl-nodecl-utils.hpp"
+#include "cxx-cexpr.h"
+
+#include <sstream>
+
+namespace TL
+{
+namespace Vectorization
+{
+    namespace
+    {
+        // Relative costs, roughly in number of instructions
+        const unsigned int arithmetic_cost = 1;
+        const unsigned int expensive_cost = 8;      // Div, Mod
+        const unsigned int memory_cost = 1;
+        const unsigned int insert_extract_cost = 1;
+        const unsigned int branch_cost = 2;         // Including some mispredictions
+        const unsigned int blend_cost = 1;
+        const unsigned int call_cost = 10;
+
+        // Assumed when the trip count is not known at compile time
+        const long long int default_trip_count = 256;
+
+        // Vector bodies cheaper than this are interleaved
+        const unsigned int small_body_cost = 8;
+        const unsigned int max_interleave_factor = 4;
+
+        unsigned int log2(unsigned int n)
+        {
+            unsigned int result = 0;
+            while (n > 1)
+            {
+                n >>= 1;
+                result++;
+            }
+            return result;
+        }
+    }
+
+    VectorizerCostModel::VectorizerCostModel(
+            const VectorIsaDescriptor& vec_isa_desc)
+        : _vec_isa_desc(vec_isa_desc)
+    {
+        reset();
+    }
+
+    void VectorizerCostModel::reset()
+    {
+        _iv = TL::Symbol();
+        _variant_symbols.clear();
+        _widest_type = TL::Type();
+        _trip_count = -1;
+        _mask_depth = 0;
+
+        _arithmetic_ops = 0;
+        _expensive_ops = 0;
+        _contiguous_accesses = 0;
+        _uniform_accesses = 0;
+        _gather_scatter_accesses = 0;
+        _masked_branches = 0;
+        _masked_statements = 0;
+        _function_calls = 0;
+        _reductions = 0;
+    }
+
+    CostModelDecision VectorizerCostModel::evaluate(
+            const Nodecl::NodeclBase& loop_statement,
+            const Nodecl::List& simd_environment,
+            unsigned int max_vec_factor)
+    {
+        reset();
+
+        CostModelDecision decision;
+        decision.vectorize = true;
+        decision.vec_factor = max_vec_factor;
+        decision.interleave_factor = 1;
+
+        if (!loop_statement.is<Nodecl::ForStatement>())
+        {
+            decision.reasoning.append("not a for statement, keeping the default vectorization factor");
+            return decision;
+        }
+
+        TL::ForStatementHelper<TL::NoNewNodePolicy> tl_for(
+                loop_statement.as<Nodecl::ForStatement>());
+
+        if (!tl_for.is_omp_valid_loop())
+        {
+            decision.reasoning.append("loop is not in canonical form, keeping the default vectorization factor");
+            return decision;
+        }
+
+        _iv = tl_for.get_induction_variable();
+        compute_trip_count(loop_statement);
+
+        for (Nodecl::List::const_iterator it = simd_environment.begin();
+                it != simd_environment.end();
+                it++)
+        {
+            if (it->is<Nodecl::OpenMP::Reduction>())
+            {
+                _reductions += it->as<Nodecl::OpenMP::Reduction>()
+                    .get_reductions().as<Nodecl::List>().size();
+            }
+            else if (it->is<Nodecl::OpenMP::SimdReduction>())
+            {
+                _reductions += it->as<Nodecl::OpenMP::SimdReduction>()
+                    .get_reductions().as<Nodecl::List>().size();
+            }
+        }
+
+        Nodecl::NodeclBase body = tl_for.get_statement();
+        collect_variant_symbols(body);
+        walk(body);
+
+        std::stringstream ss;
+        ss << "loop body: "
+            << _arithmetic_ops << " arithmetic ("
+            << _expensive_ops << " expensive), "
+            << _contiguous_accesses << " contiguous, "
+            << _uniform_accesses << " uniform and "
+            << _gather_scatter_accesses << " gather/scatter accesses, "
+            << _masked_statements << " masked statements, "
+            << _function_calls << " calls, "
+            << _reductions << " reductions";
+        decision.reasoning.append(ss.str());
+
+        ss.str("");
+        if (_trip_count >= 0)
+            ss << "trip count: " << _trip_count;
+        else
+            ss << "trip count unknown, assuming " << default_trip_count;
+        decision.reasoning.append(ss.str());
+
+        unsigned long long int scalar_cost = get_scalar_loop_cost();
+        ss.str("");
+        ss << "scalar cost: " << scalar_cost
+            << " (" << get_scalar_iteration_cost() << " per iteration)";
+        decision.reasoning.append(ss.str());
+
+        // The default vectorization factor fills the registers with the
+        // widest type so only smaller factors are considered. Ties are
+        // solved in favour of the largest one
+        unsigned int best_vec_factor = 0;
+        unsigned long long int best_cost = 0;
+        for (unsigned int vec_factor = max_vec_factor;
+                vec_factor >= 2;
+                vec_factor /= 2)
+        {
+            unsigned long long int vector_cost = get_vector_loop_cost(vec_factor);
+
+            ss.str("");
+            ss << "VF=" << vec_factor << ": vector cost " << vector_cost
+                << " (" << get_vector_iteration_cost(vec_factor)
+                << " per vector iteration, "
+                << get_registers(vec_factor) << " registers per vector, "
+                << (_vec_isa_desc.support_masking() ? "masked vector" : "scalar")
+                << " epilog)";
+            decision.reasoning.append(ss.str());
+
+            if (best_vec_factor == 0 || vector_cost < best_cost)
+            {
+                best_vec_factor = vec_factor;
+                best_cost = vector_cost;
+            }
+        }
+
+        if (best_vec_factor == 0)
+        {
+            decision.reasoning.append("vectorization factor is too small to evaluate");
+            return decision;
+        }
+
+        if (best_cost >= scalar_cost)
+        {
+            decision.vectorize = false;
+            decision.reasoning.append("not vectorizing: vector code is not cheaper than scalar code");
+            return decision;
+        }
+
+        decision.vec_factor = best_vec_factor;
+        decision.interleave_factor = get_interleave_factor(best_vec_factor);
+
+        ss.str("");
+        ss << "vectorizing with VF=" << decision.vec_factor
+            << " and interleave factor " << decision.interleave_factor;
+        decision.reasoning.append(ss.str());
+
+        return decision;
+    }
+
+    void VectorizerCostModel::compute_trip_count(
+            const Nodecl::NodeclBase& loop_statement)
+    {
+        TL::ForStatementHelper<TL::NoNewNodePolicy> tl_for(
+                loop_statement.as<Nodecl::ForStatement>());
+
+        Nodecl::NodeclBase lb = tl_for.get_lower_bound();
+        Nodecl::NodeclBase ub = tl_for.get_upper_bound();
+        Nodecl::NodeclBase step = tl_for.get_step();
+
+        if (lb.is_null() || ub.is_null() || step.is_null()
+                || !lb.is_constant() || !ub.is_constant() || !step.is_constant())
+            return;
+
+        long long int const_lb = const_value_cast_to_8(lb.get_constant());
+        long long int const_ub = const_value_cast_to_8(ub.get_constant());
+        long long int const_step = const_value_cast_to_8(step.get_constant());
+
+        // Upper bound is closed
+        if (const_step > 0)
+            _trip_count = (const_ub - const_lb) / const_step + 1;
+        else if (const_step < 0)
+            _trip_count = (const_lb - const_ub) / (-const_step) + 1;
+        else
+            return;
+
+        if (_trip_count < 0)
+            _trip_count = 0;
+    }
+
+    void VectorizerCostModel::collect_variant_symbols(
+            const Nodecl::NodeclBase& n)
+    {
+        _variant_symbols.insert(_iv);
+
+        TL::ObjectList<Nodecl::NodeclBase> object_inits =
+            Nodecl::Utils::nodecl_get_all_nodecls_of_kind<Nodecl::ObjectInit>(n);
+        for (TL::ObjectList<Nodecl::NodeclBase>::iterator it = object_inits.begin();
+                it != object_inits.end();
+                it++)
+        {
+            _variant_symbols.insert(it->get_symbol());
+        }
+
+        TL::ObjectList<Nodecl::NodeclBase> assignments =
+            Nodecl::Utils::nodecl_get_all_nodecls_of_kind<Nodecl::Assignment>(n);
+        for (TL::ObjectList<Nodecl::NodeclBase>::iterator it = assignments.begin();
+                it != assignments.end();
+                it++)
+        {
+            Nodecl::NodeclBase lhs = it->as<Nodecl::Assignment>().get_lhs().no_conv();
+            if (lhs.is<Nodecl::Symbol>())
+                _variant_symbols.insert(lhs.get_symbol());
+        }
+    }
+
+    void VectorizerCostModel::count_type(const TL::Type& type)
+    {
+        if (!type.is_integral_type() && !type.is_floating_type())
+            return;
+
+        if (!_widest_type.is_valid()
+                || type.get_size() > _widest_type.get_size())
+            _widest_type = type;
+    }
+
+    bool VectorizerCostModel::is_variant(const Nodecl::NodeclBase& n) const
+    {
+        TL::ObjectList<Nodecl::NodeclBase> symbols =
+            Nodecl::Utils::nodecl_get_all_nodecls_of_kind<Nodecl::Symbol>(n);
+        for (TL::ObjectList<Nodecl::NodeclBase>::iterator it = symbols.begin();
+                it != symbols.end();
+                it++)
+        {
+            if (_variant_symbols.contains(it->get_symbol()))
+                return true;
+        }
+
+        return false;
+    }
+
+    // a[i], a[i + c] and a[i - c] where only 'i' changes across iterations
+    bool VectorizerCostModel::is_adjacent_subscript(
+            const Nodecl::NodeclBase& n) const
+    {
+        Nodecl::ArraySubscript array_subscript = n.as<Nodecl::ArraySubscript>();
+
+        if (is_variant(array_subscript.get_subscripted()))
+            return false;
+
+        Nodecl::List subscripts = array_subscript.get_subscripts().as<Nodecl::List>();
+        if (subscripts.empty())
+            return false;
+
+        // Row-major: only the last subscript may move with the loop
+        for (Nodecl::List::iterator it = subscripts.begin();
+                it != subscripts.end();
+                it++)
+        {
+            if (*it != subscripts.back() && is_variant(*it))
+                return false;
+        }
+
+        Nodecl::NodeclBase index = subscripts.back().no_conv();
+
+        if (index.is<Nodecl::Symbol>())
+            return index.get_symbol() == _iv;
+
+        if (index.is<Nodecl::Add>())
+        {
+            Nodecl::NodeclBase lhs = index.as<Nodecl::Add>().get_lhs().no_conv();
+            Nodecl::NodeclBase rhs = index.as<Nodecl::Add>().get_rhs().no_conv();
+
+            if (lhs.is<Nodecl::Symbol>() && lhs.get_symbol() == _iv)
+                return !is_variant(rhs);
+            if (rhs.is<Nodecl::Symbol>() && rhs.get_symbol() == _iv)
+                return !is_variant(lhs);
+        }
+        else if (index.is<Nodecl::Minus>())
+        {
+            Nodecl::NodeclBase lhs = index.as<Nodecl::Minus>().get_lhs().no_conv();
+            Nodecl::NodeclBase rhs = index.as<Nodecl::Minus>().get_rhs().no_conv();
+
+            if (lhs.is<Nodecl::Symbol>() && lhs.get_symbol() == _iv)
+                return !is_variant(rhs);
+        }
+
+        return false;
+    }
+
+    unsigned int VectorizerCostModel::get_registers(
+            unsigned int vec_factor) const
+    {
+        TL::Type type = _widest_type.is_valid() ?
+            _widest_type : TL::Type::get_float_type();
+
+        unsigned int native_vec_factor = _vec_isa_desc.get_vec_factor_from_type(type);
+        if (native_vec_factor == 0)
+            return 1;
+
+        return (vec_factor + native_vec_factor - 1) / native_vec_factor;
+    }
+
+    unsigned int VectorizerCostModel::get_scalar_iteration_cost() const
+    {
+        return _arithmetic_ops * arithmetic_cost
+            + _expensive_ops * expensive_cost
+            + (_contiguous_accesses + _uniform_accesses
+                    + _gather_scatter_accesses) * memory_cost
+            + _masked_branches * branch_cost
+            + _function_calls * call_cost;
+    }
+
+    unsigned int VectorizerCostModel::get_vector_iteration_cost(
+            unsigned int vec_factor) const
+    {
+        unsigned int registers = get_registers(vec_factor);
+
+        unsigned int cost = registers * (_arithmetic_ops * arithmetic_cost
+                + _expensive_ops * expensive_cost
+                + _contiguous_accesses * memory_cost
+                + _function_calls * call_cost);
+
+        // Loop invariant values are broadcast
+        cost += _uniform_accesses * (memory_cost + insert_extract_cost);
+
+        // ISAs with masking support also have gather/scatter instructions.
+        // Otherwise every element is loaded and inserted separately
+        if (_vec_isa_desc.support_masking())
+            cost += _gather_scatter_accesses * registers
+                * (vec_factor / 2 + memory_cost);
+        else
+            cost += _gather_scatter_accesses * vec_factor
+                * (memory_cost + insert_extract_cost);
+
+        // Without masking support masked statements need a blend
+        if (!_vec_isa_desc.support_masking())
+            cost += _masked_statements * registers * blend_cost;
+
+        return cost;
+    }
+
+    unsigned long long int VectorizerCostModel::get_scalar_loop_cost() const
+    {
+        long long int trip_count = _trip_count >= 0 ?
+            _trip_count : default_trip_count;
+
+        return trip_count * get_scalar_iteration_cost();
+    }
+
+    unsigned long long int VectorizerCostModel::get_vector_loop_cost(
+            unsigned int vec_factor) const
+    {
+        long long int trip_count = _trip_count >= 0 ?
+            _trip_count : default_trip_count;
+
+        unsigned int vector_iteration_cost = get_vector_iteration_cost(vec_factor);
+        unsigned long long int cost =
+            (trip_count / vec_factor) * vector_iteration_cost;
+
+        // Epilog. On average half a vector is left when the trip count
+        // is unknown
+        long long int remaining = _trip_count >= 0 ?
+            trip_count % vec_factor : vec_factor / 2;
+        if (remaining > 0)
+        {
+            if (_vec_isa_desc.support_masking())
+                cost += vector_iteration_cost;
+            else
+                cost += remaining * get_scalar_iteration_cost();
+        }
+
+        // Horizontal reductions after the loop
+        cost += _reductions * log2(vec_factor)
+            * (arithmetic_cost + insert_extract_cost);
+
+        return cost;
+    }
+
+    unsigned int VectorizerCostModel::get_interleave_factor(
+            unsigned int vec_factor) const
+    {
+        // Gathers, scatters and calls already keep the core busy
+        if (_gather_scatter_accesses > 0 || _function_calls > 0)
+            return 1;
+
+        // Interleaving splits the dependence chain of reductions and
+        // amortizes the loop overhead of small bodies
+        if (_reductions == 0
+                && get_vector_iteration_cost(vec_factor) > small_body_cost)
+            return 1;
+
+        if (_trip_count < 0)
+            return 2;
+
+        unsigned int interleave_factor = max_interleave_factor;
+        while (interleave_factor > 1
+                && _trip_count / (vec_factor * interleave_factor) < 2)
+            interleave_factor /= 2;
+
+        return interleave_factor;
+    }
+
+    void VectorizerCostModel::visit(const Nodecl::ObjectInit& n)
+    {
+        TL::Symbol sym = n.get_symbol();
+        count_type(sym.get_type().no_ref());
+
+        Nodecl::NodeclBase init = sym.get_value();
+        if (!init.is_null())
+        {
+            if (_mask_depth > 0)
+                _masked_statements++;
+
+            walk(init);
+        }
+    }
+
+    void VectorizerCostModel::visit(const Nodecl::ArraySubscript& n)
+    {
+        count_type(n.get_type().no_ref());
+
+        if (!is_variant(n))
+        {
+            _uniform_accesses++;
+        }
+        else if (is_adjacent_subscript(n))
+        {
+            _contiguous_accesses++;
+        }
+        else
+        {
+            _gather_scatter_accesses++;
+
+            // Indices are computed in vector registers
+            walk(n.get_subscripts());
+        }
+    }
+
+    void VectorizerCostModel::visit(const Nodecl::IfElseStatement& n)
+    {
+        _masked_branches++;
+        walk(n.get_condition());
+
+        _mask_depth++;
+        walk(n.get_then());
+        walk(n.get_else());
+        _mask_depth--;
+    }
+
+    void VectorizerCostModel::visit(const Nodecl::ExpressionStatement& n)
+    {
+        if (_mask_depth > 0)
+            _masked_statements++;
+
+        walk(n.get_nest());
+    }
+
+    void VectorizerCostModel::visit(const Nodecl::FunctionCall& n)
+    {
+        _function_calls++;
+
+        walk(n.get_arguments());
+    }
+
+    // Vector select
+    void VectorizerCostModel::visit(const Nodecl::ConditionalExpression& n)
+    {
+        _arithmetic_ops++;
+
+        walk(n.get_condition());
+        walk(n.get_true());
+        walk(n.get_false());
+    }
+
+#define COST_MODEL_OPERATION(_node_kind, _counter) \
+    void VectorizerCostModel::visit(const Nodecl::_node_kind& n) \
+    { \
+        _counter++; \
+        Nodecl::ExhaustiveVisitor<void>::visit(n); \
+    }
+
+    COST_MODEL_OPERATION(Add, _arithmetic_ops)
+    COST_MODEL_OPERATION(Minus, _arithmetic_ops)
+    COST_MODEL_OPERATION(Mul, _arithmetic_ops)
+    COST_MODEL_OPERATION(Div, _expensive_ops)
+    COST_MODEL_OPERATION(Mod, _expensive_ops)
+    COST_MODEL_OPERATION(Neg, _arithmetic_ops)
+    COST_MODEL_OPERATION(BitwiseAnd, _arithmetic_ops)
+    COST_MODEL_OPERATION(BitwiseOr, _arithmetic_ops)
+    COST_MODEL_OPERATION(BitwiseXor, _arithmetic_ops)
+    COST_MODEL_OPERATION(BitwiseNot, _arithmetic_ops)
+    COST_MODEL_OPERATION(BitwiseShl, _arithmetic_ops)
+    COST_MODEL_OPERATION(BitwiseShr, _arithmetic_ops)
+    COST_MODEL_OPERATION(ArithmeticShr, _arithmetic_ops)
+    COST_MODEL_OPERATION(LowerThan, _arithmetic_ops)
+    COST_MODEL_OPERATION(LowerOrEqualThan, _arithmetic_ops)
+    COST_MODEL_OPERATION(GreaterThan, _arithmetic_ops)
+    COST_MODEL_OPERATION(GreaterOrEqualThan, _arithmetic_ops)
+    COST_MODEL_OPERATION(Equal, _arithmetic_ops)
+    COST_MODEL_OPERATION(Different, _arithmetic_ops)
+    COST_MODEL_OPERATION(LogicalAnd, _arithmetic_ops)
+    COST_MODEL_OPERATION(LogicalOr, _arithmetic_ops)
+    COST_MODEL_OPERATION(LogicalNot, _arithmetic_ops)
+
+#undef COST_MODEL_OPERATION
+}
+}
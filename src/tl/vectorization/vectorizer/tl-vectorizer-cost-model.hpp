@@ -0,0 +1,131 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+
+  This file is part of Mercurium C/C++ source-to-source compiler.
+
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+#ifndef TL_VECTORIZER_COST_MODEL_HPP
+#define TL_VECTORIZER_COST_MODEL_HPP
+
+#include "tl-nodecl-visitor.hpp"
+#include "tl-nodecl-base.hpp"
+#include "tl-vector-isa-descriptor.hpp"
+
+#include <string>
+
+
+namespace TL
+{
+namespace Vectorization
+{
+    struct CostModelDecision
+    {
+        bool vectorize;
+        unsigned int vec_factor;
+        unsigned int interleave_factor;
+
+        // Human readable reasoning, printed by VectorizerReport with
+        // --debug-flags=vectorization_verbose
+        TL::ObjectList<std::string> reasoning;
+    };
+
+    // Estimates the cost of one scalar iteration against the cost of the
+    // vector code (including gathers/scatters, masking, reductions and the
+    // epilog) and chooses the vectorization and interleave factors
+    class VectorizerCostModel : public Nodecl::ExhaustiveVisitor<void>
+    {
+        private:
+            const VectorIsaDescriptor& _vec_isa_desc;
+
+            TL::Symbol _iv;
+            TL::ObjectList<TL::Symbol> _variant_symbols;
+            TL::Type _widest_type;
+            long long int _trip_count;
+            unsigned int _mask_depth;
+
+            unsigned int _arithmetic_ops;
+            unsigned int _expensive_ops;
+            unsigned int _contiguous_accesses;
+            unsigned int _uniform_accesses;
+            unsigned int _gather_scatter_accesses;
+            unsigned int _masked_branches;
+            unsigned int _masked_statements;
+            unsigned int _function_calls;
+            unsigned int _reductions;
+
+            void reset();
+            void compute_trip_count(const Nodecl::NodeclBase& loop_statement);
+            void collect_variant_symbols(const Nodecl::NodeclBase& n);
+            void count_type(const TL::Type& type);
+
+            bool is_variant(const Nodecl::NodeclBase& n) const;
+            bool is_adjacent_subscript(const Nodecl::NodeclBase& n) const;
+
+            unsigned int get_registers(unsigned int vec_factor) const;
+            unsigned int get_scalar_iteration_cost() const;
+            unsigned int get_vector_iteration_cost(unsigned int vec_factor) const;
+            unsigned long long int get_scalar_loop_cost() const;
+            unsigned long long int get_vector_loop_cost(unsigned int vec_factor) const;
+            unsigned int get_interleave_factor(unsigned int vec_factor) const;
+
+        public:
+            VectorizerCostModel(const VectorIsaDescriptor& vec_isa_desc);
+
+            CostModelDecision evaluate(const Nodecl::NodeclBase& loop_statement,
+                    const Nodecl::List& simd_environment,
+                    unsigned int max_vec_factor);
+
+            void visit(const Nodecl::ObjectInit& n);
+            void visit(const Nodecl::ArraySubscript& n);
+            void visit(const Nodecl::IfElseStatement& n);
+            void visit(const Nodecl::ExpressionStatement& n);
+            void visit(const Nodecl::FunctionCall& n);
+            void visit(const Nodecl::ConditionalExpression& n);
+
+            void visit(const Nodecl::Add& n);
+            void visit(const Nodecl::Minus& n);
+            void visit(const Nodecl::Mul& n);
+            void visit(const Nodecl::Div& n);
+            void visit(const Nodecl::Mod& n);
+            void visit(const Nodecl::Neg& n);
+            void visit(const Nodecl::BitwiseAnd& n);
+            void visit(const Nodecl::BitwiseOr& n);
+            void visit(const Nodecl::BitwiseXor& n);
+            void visit(const Nodecl::BitwiseNot& n);
+            void visit(const Nodecl::BitwiseShl& n);
+            void visit(const Nodecl::BitwiseShr& n);
+            void visit(const Nodecl::ArithmeticShr& n);
+            void visit(const Nodecl::LowerThan& n);
+            void visit(const Nodecl::LowerOrEqualThan& n);
+            void visit(const Nodecl::GreaterThan& n);
+            void visit(const Nodecl::GreaterOrEqualThan& n);
+            void visit(const Nodecl::Equal& n);
+            void visit(const Nodecl::Different& n);
+            void visit(const Nodecl::LogicalAnd& n);
+            void visit(const Nodecl::LogicalOr& n);
+            void visit(const Nodecl::LogicalNot& n);
+    };
+}
+}
+
+#endif //TL_VECTORIZER_COST_MODEL_HPP
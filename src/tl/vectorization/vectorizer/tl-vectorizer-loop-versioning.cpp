@@ -0,0 +1,443 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+
+  This file is part of Mercurium C/C++ source-to-source compiler.
+
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+#include "tl-vectorizer-loop-versioning.hpp"
+
+#include "tl-nodecl-utils.hpp"
+#include "tl-source.hpp"
+#include "tl-counters.hpp"
+#include "cxx-cexpr.h"
+
+#include <sstream>
+
+namespace TL
+{
+namespace Vectorization
+{
+    VectorizerLoopVersioning::VectorizerLoopVersioning(
+            const VectorIsaDescriptor& vec_isa_desc)
+        : _vec_isa_desc(vec_isa_desc)
+    {
+        reset();
+    }
+
+    void VectorizerLoopVersioning::reset()
+    {
+        _iv = TL::Symbol();
+        _base_pointers.clear();
+        _modified_symbols.clear();
+        _min_element_size = 0;
+    }
+
+    bool VectorizerLoopVersioning::is_supported_loop(
+            const Nodecl::OpenMP::Simd& simd_node)
+    {
+        // The guard is built from C source
+        if (IS_FORTRAN_LANGUAGE)
+            return false;
+
+        // The ISA does not require aligned accesses
+        if (_vec_isa_desc.get_memory_alignment_in_bytes() == 0)
+            return false;
+
+        // The user already stated the alignment
+        Nodecl::List simd_environment = simd_node.get_environment().as<Nodecl::List>();
+        if (!simd_environment.find_first<Nodecl::OpenMP::Aligned>().is_null()
+                || !simd_environment.find_first<Nodecl::OpenMP::Suitable>().is_null())
+            return false;
+
+        Nodecl::NodeclBase loop_statement = simd_node.get_statement();
+        if (!loop_statement.is<Nodecl::ForStatement>())
+            return false;
+
+        Nodecl::NodeclBase loop_header =
+            loop_statement.as<Nodecl::ForStatement>().get_loop_header();
+        if (!loop_header.is<Nodecl::LoopControl>())
+            return false;
+
+        TL::ForStatementHelper<TL::NoNewNodePolicy> tl_for(
+                loop_statement.as<Nodecl::ForStatement>());
+
+        if (!tl_for.is_omp_valid_loop())
+            return false;
+
+        Nodecl::NodeclBase step = tl_for.get_step();
+        if (!step.is_constant()
+                || const_value_cast_to_signed_int(step.get_constant()) != 1)
+            return false;
+
+        _iv = tl_for.get_induction_variable();
+        if (!_iv.get_type().no_ref().is_integral_type())
+            return false;
+
+        // The lower bound of the fast version is set through the
+        // initialization of the induction variable
+        Nodecl::List init = loop_header.as<Nodecl::LoopControl>().get_init().as<Nodecl::List>();
+        if (init.size() != 1)
+            return false;
+
+        if (init.front().is<Nodecl::ObjectInit>())
+        {
+            if (init.front().get_symbol() != _iv)
+                return false;
+        }
+        else if (init.front().is<Nodecl::Assignment>())
+        {
+            Nodecl::NodeclBase lhs = Nodecl::Utils::advance_conversions(
+                    init.front().as<Nodecl::Assignment>().get_lhs());
+
+            if (!lhs.is<Nodecl::Symbol>() || lhs.get_symbol() != _iv)
+                return false;
+        }
+        else
+        {
+            return false;
+        }
+
+        walk(loop_statement.as<Nodecl::ForStatement>().get_statement());
+
+        // Pointers modified or declared in the loop cannot be checked before it
+        TL::ObjectList<TL::Symbol> checkable_pointers;
+        _min_element_size = 0;
+        for (TL::ObjectList<TL::Symbol>::iterator it = _base_pointers.begin();
+                it != _base_pointers.end();
+                it++)
+        {
+            if (_modified_symbols.contains(*it))
+                continue;
+
+            checkable_pointers.append(*it);
+
+            unsigned int element_size = it->get_type().no_ref().points_to().get_size();
+            if (_min_element_size == 0 || element_size < _min_element_size)
+                _min_element_size = element_size;
+        }
+        _base_pointers = checkable_pointers;
+
+        return !_base_pointers.empty();
+    }
+
+    bool VectorizerLoopVersioning::version_loop(
+            const Nodecl::OpenMP::Simd& simd_node)
+    {
+        reset();
+
+        if (!is_supported_loop(simd_node))
+            return false;
+
+        Nodecl::ForStatement loop = simd_node.get_statement().as<Nodecl::ForStatement>();
+        TL::ForStatementHelper<TL::NoNewNodePolicy> tl_for(loop);
+
+        TL::Type iv_type = _iv.get_type().no_ref();
+        Nodecl::NodeclBase lower_bound = tl_for.get_lower_bound();
+        Nodecl::NodeclBase upper_bound = tl_for.get_upper_bound();
+
+        // Iterations are peeled until the pointer with the smallest element
+        // size is aligned. The other pointers must be aligned at that same
+        // iteration, otherwise the fallback version is used
+        int alignment = _vec_isa_desc.get_memory_alignment_in_bytes();
+
+        TL::Symbol peel_pointer;
+        for (TL::ObjectList<TL::Symbol>::iterator it = _base_pointers.begin();
+                it != _base_pointers.end() && !peel_pointer.is_valid();
+                it++)
+        {
+            if (it->get_type().no_ref().points_to().get_size() == _min_element_size)
+                peel_pointer = *it;
+        }
+        ERROR_CONDITION(!peel_pointer.is_valid(), "No base pointer with the smallest element size", 0);
+
+        TL::Counter &counter = TL::CounterManager::get_counter("simd-alignment-versioning");
+        std::stringstream misalign_name, start_name;
+        misalign_name << "__vec_misalign_" << (int)counter;
+        start_name << "__vec_start_" << (int)counter;
+        counter++;
+
+        Source size_t_type;
+        size_t_type << as_type(TL::Type::get_size_t_type());
+
+        Source pointers_src;
+        for (TL::ObjectList<TL::Symbol>::iterator it = _base_pointers.begin();
+                it != _base_pointers.end();
+                it++)
+        {
+            if (*it == peel_pointer)
+                continue;
+
+            if (!pointers_src.empty())
+                pointers_src << " | ";
+
+            pointers_src << "((" << size_t_type << ")" << as_symbol(*it)
+                << " + (" << size_t_type << ")" << start_name.str()
+                << " * " << it->get_type().no_ref().points_to().get_size() << ")";
+        }
+
+        Source versioned_src, guard_src;
+        Nodecl::NodeclBase peel_placeholder, fast_placeholder, fallback_placeholder;
+
+        // A misalignment that is not a multiple of the element size is never
+        // fixed by peeling. Too short loops go to the fallback version too
+        guard_src << misalign_name.str() << " % " << _min_element_size << " == 0"
+            << " && " << start_name.str() << " <= "
+            << as_expression(upper_bound.shallow_copy()) << " + 1";
+
+        if (!pointers_src.empty())
+            guard_src << " && ((" << pointers_src << ") & " << (alignment - 1) << ") == 0";
+
+        versioned_src
+            << "{"
+            << size_t_type << " " << misalign_name.str() << " = ("
+            <<     "(" << size_t_type << ")" << as_symbol(peel_pointer)
+            <<     " + (" << size_t_type << ")(" << as_expression(lower_bound.shallow_copy()) << ")"
+            <<     " * " << _min_element_size << ") & " << (alignment - 1) << ";"
+            << as_type(iv_type) << " " << start_name.str() << " = "
+            <<     "(" << as_expression(lower_bound.shallow_copy()) << ") + "
+            <<     "(" << as_type(iv_type) << ")(((" << alignment << " - " << misalign_name.str()
+            <<     ") & " << (alignment - 1) << ") / " << _min_element_size << ");"
+            << "if (" << guard_src << ")"
+            << "{"
+            <<     statement_placeholder(peel_placeholder)
+            <<     statement_placeholder(fast_placeholder)
+            << "}"
+            << "else"
+            << "{"
+            <<     statement_placeholder(fallback_placeholder)
+            << "}"
+            << "}"
+            ;
+
+        Nodecl::NodeclBase versioned_code = versioned_src.parse_statement(simd_node);
+
+        // Fast version
+        Nodecl::OpenMP::Simd fast_simd =
+            Nodecl::Utils::deep_copy(simd_node, fast_placeholder).as<Nodecl::OpenMP::Simd>();
+        Nodecl::List fast_environment = fast_simd.get_environment().as<Nodecl::List>();
+
+        Nodecl::List aligned_pointers;
+        for (TL::ObjectList<TL::Symbol>::iterator it = _base_pointers.begin();
+                it != _base_pointers.end();
+                it++)
+        {
+            aligned_pointers.append(it->make_nodecl(/* set_ref_type */ true));
+        }
+
+        fast_environment.append(Nodecl::OpenMP::Aligned::make(
+                    aligned_pointers,
+                    const_value_to_nodecl(const_value_get_signed_int(alignment))));
+
+        TL::Symbol start_sym =
+            fast_placeholder.retrieve_context().get_symbol_from_name(start_name.str());
+        ERROR_CONDITION(!start_sym.is_valid(), "Symbol '%s' not found",
+                start_name.str().c_str());
+
+        Nodecl::NodeclBase start_value = Nodecl::Conversion::make(
+                start_sym.make_nodecl(/* set_ref_type */ true),
+                iv_type);
+
+        // The fast version starts where the peeled loop finishes
+        Nodecl::NodeclBase fast_init = fast_simd.get_statement()
+            .as<Nodecl::ForStatement>().get_loop_header()
+            .as<Nodecl::LoopControl>().get_init().as<Nodecl::List>().front();
+
+        if (fast_init.is<Nodecl::ObjectInit>())
+            fast_init.get_symbol().set_value(start_value);
+        else
+            fast_init.as<Nodecl::Assignment>().get_rhs().replace(start_value);
+
+        // Scalar peeled loop
+        Nodecl::ForStatement peel_loop =
+            Nodecl::Utils::deep_copy(loop, peel_placeholder).as<Nodecl::ForStatement>();
+        TL::ForStatementHelper<TL::NoNewNodePolicy> tl_peel_for(peel_loop);
+
+        Nodecl::NodeclBase peel_cond = peel_loop.get_loop_header()
+            .as<Nodecl::LoopControl>().get_cond();
+
+        Source peel_cond_src;
+        peel_cond_src << as_symbol(tl_peel_for.get_induction_variable())
+            << " < " << as_symbol(start_sym);
+
+        peel_cond.replace(peel_cond_src.parse_expression(peel_cond.retrieve_context()));
+        peel_placeholder.replace(peel_loop);
+
+        fast_placeholder.replace(fast_simd);
+
+        // Fallback version is the original loop
+        fallback_placeholder.replace(
+                Nodecl::Utils::deep_copy(simd_node, fallback_placeholder));
+
+        simd_node.replace(versioned_code);
+
+        return true;
+    }
+
+    void VectorizerLoopVersioning::visit(const Nodecl::ObjectInit& n)
+    {
+        _modified_symbols.insert(n.get_symbol());
+
+        Nodecl::NodeclBase value = n.get_symbol().get_value();
+        if (!value.is_null())
+            walk(value);
+    }
+
+    // Base pointers written or whose address is taken in the loop are not
+    // loop invariant
+    void VectorizerLoopVersioning::visit_assignment(
+            const Nodecl::NodeclBase& lhs,
+            const Nodecl::NodeclBase& rhs)
+    {
+        Nodecl::NodeclBase modified = Nodecl::Utils::advance_conversions(lhs);
+        if (modified.is<Nodecl::Symbol>())
+            _modified_symbols.insert(modified.get_symbol());
+
+        walk(lhs);
+        walk(rhs);
+    }
+
+    void VectorizerLoopVersioning::visit_xx_crement(const Nodecl::NodeclBase& rhs)
+    {
+        Nodecl::NodeclBase modified = Nodecl::Utils::advance_conversions(rhs);
+        if (modified.is<Nodecl::Symbol>())
+            _modified_symbols.insert(modified.get_symbol());
+
+        walk(rhs);
+    }
+
+    void VectorizerLoopVersioning::visit(const Nodecl::Assignment& n)
+    {
+        visit_assignment(n.get_lhs(), n.get_rhs());
+    }
+
+    void VectorizerLoopVersioning::visit(const Nodecl::AddAssignment& n)
+    {
+        visit_assignment(n.get_lhs(), n.get_rhs());
+    }
+
+    void VectorizerLoopVersioning::visit(const Nodecl::MinusAssignment& n)
+    {
+        visit_assignment(n.get_lhs(), n.get_rhs());
+    }
+
+    void VectorizerLoopVersioning::visit(const Nodecl::MulAssignment& n)
+    {
+        visit_assignment(n.get_lhs(), n.get_rhs());
+    }
+
+    void VectorizerLoopVersioning::visit(const Nodecl::DivAssignment& n)
+    {
+        visit_assignment(n.get_lhs(), n.get_rhs());
+    }
+
+    void VectorizerLoopVersioning::visit(const Nodecl::ModAssignment& n)
+    {
+        visit_assignment(n.get_lhs(), n.get_rhs());
+    }
+
+    void VectorizerLoopVersioning::visit(const Nodecl::BitwiseAndAssignment& n)
+    {
+        visit_assignment(n.get_lhs(), n.get_rhs());
+    }
+
+    void VectorizerLoopVersioning::visit(const Nodecl::BitwiseOrAssignment& n)
+    {
+        visit_assignment(n.get_lhs(), n.get_rhs());
+    }
+
+    void VectorizerLoopVersioning::visit(const Nodecl::BitwiseXorAssignment& n)
+    {
+        visit_assignment(n.get_lhs(), n.get_rhs());
+    }
+
+    void VectorizerLoopVersioning::visit(const Nodecl::BitwiseShlAssignment& n)
+    {
+        visit_assignment(n.get_lhs(), n.get_rhs());
+    }
+
+    void VectorizerLoopVersioning::visit(const Nodecl::BitwiseShrAssignment& n)
+    {
+        visit_assignment(n.get_lhs(), n.get_rhs());
+    }
+
+    void VectorizerLoopVersioning::visit(const Nodecl::ArithmeticShrAssignment& n)
+    {
+        visit_assignment(n.get_lhs(), n.get_rhs());
+    }
+
+    void VectorizerLoopVersioning::visit(const Nodecl::Preincrement& n)
+    {
+        visit_xx_crement(n.get_rhs());
+    }
+
+    void VectorizerLoopVersioning::visit(const Nodecl::Postincrement& n)
+    {
+        visit_xx_crement(n.get_rhs());
+    }
+
+    void VectorizerLoopVersioning::visit(const Nodecl::Predecrement& n)
+    {
+        visit_xx_crement(n.get_rhs());
+    }
+
+    void VectorizerLoopVersioning::visit(const Nodecl::Postdecrement& n)
+    {
+        visit_xx_crement(n.get_rhs());
+    }
+
+    // &p allows p to be modified through another name
+    void VectorizerLoopVersioning::visit(const Nodecl::Reference& n)
+    {
+        visit_xx_crement(n.get_rhs());
+    }
+
+    void VectorizerLoopVersioning::visit(const Nodecl::ArraySubscript& n)
+    {
+        Nodecl::NodeclBase subscripted =
+            Nodecl::Utils::advance_conversions(n.get_subscripted());
+        Nodecl::List subscripts = n.get_subscripts().as<Nodecl::List>();
+
+        // Only p[iv] is aligned by peeling
+        if (subscripted.is<Nodecl::Symbol>()
+                && subscripted.get_symbol().get_type().no_ref().is_pointer()
+                && subscripts.size() == 1)
+        {
+            Nodecl::NodeclBase subscript =
+                Nodecl::Utils::advance_conversions(subscripts.front());
+            unsigned int element_size = n.get_type().no_ref().get_size();
+
+            if (subscript.is<Nodecl::Symbol>()
+                    && subscript.get_symbol() == _iv
+                    && element_size > 0
+                    && (_vec_isa_desc.get_memory_alignment_in_bytes() % element_size) == 0)
+            {
+                _base_pointers.insert(subscripted.get_symbol());
+                return;
+            }
+        }
+
+        walk(n.get_subscripted());
+        walk(n.get_subscripts());
+    }
+}
+}
@@ -0,0 +1,89 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+
+  This file is part of Mercurium C/C++ source-to-source compiler.
+
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+#ifndef TL_VECTORIZER_LOOP_VERSIONING_HPP
+#define TL_VECTORIZER_LOOP_VERSIONING_HPP
+
+#include "tl-nodecl-visitor.hpp"
+#include "tl-nodecl-base.hpp"
+#include "tl-vector-isa-descriptor.hpp"
+
+
+namespace TL
+{
+namespace Vectorization
+{
+    // Versions a simd loop on the alignment of the pointers it accesses
+    // contiguously. Scalar iterations are peeled until the pointer with the
+    // smallest element size is aligned and the fast version is vectorized
+    // with an 'aligned' clause. The original loop is kept as fallback when
+    // the pointers cannot be aligned at the same iteration
+    class VectorizerLoopVersioning : public Nodecl::ExhaustiveVisitor<void>
+    {
+        private:
+            const VectorIsaDescriptor& _vec_isa_desc;
+
+            TL::Symbol _iv;
+            TL::ObjectList<TL::Symbol> _base_pointers;
+            TL::ObjectList<TL::Symbol> _modified_symbols;
+            unsigned int _min_element_size;
+
+            void reset();
+            bool is_supported_loop(const Nodecl::OpenMP::Simd& simd_node);
+
+            void visit_assignment(const Nodecl::NodeclBase& lhs,
+                    const Nodecl::NodeclBase& rhs);
+            void visit_xx_crement(const Nodecl::NodeclBase& rhs);
+
+        public:
+            VectorizerLoopVersioning(const VectorIsaDescriptor& vec_isa_desc);
+
+            bool version_loop(const Nodecl::OpenMP::Simd& simd_node);
+
+            void visit(const Nodecl::ObjectInit& n);
+            void visit(const Nodecl::Assignment& n);
+            void visit(const Nodecl::AddAssignment& n);
+            void visit(const Nodecl::MinusAssignment& n);
+            void visit(const Nodecl::MulAssignment& n);
+            void visit(const Nodecl::DivAssignment& n);
+            void visit(const Nodecl::ModAssignment& n);
+            void visit(const Nodecl::BitwiseAndAssignment& n);
+            void visit(const Nodecl::BitwiseOrAssignment& n);
+            void visit(const Nodecl::BitwiseXorAssignment& n);
+            void visit(const Nodecl::BitwiseShlAssignment& n);
+            void visit(const Nodecl::BitwiseShrAssignment& n);
+            void visit(const Nodecl::ArithmeticShrAssignment& n);
+            void visit(const Nodecl::Preincrement& n);
+            void visit(const Nodecl::Postincrement& n);
+            void visit(const Nodecl::Predecrement& n);
+            void visit(const Nodecl::Postdecrement& n);
+            void visit(const Nodecl::Reference& n);
+            void visit(const Nodecl::ArraySubscript& n);
+    };
+}
+}
+
+#endif //TL_VECTORIZER_LOOP_VERSIONING_HPP
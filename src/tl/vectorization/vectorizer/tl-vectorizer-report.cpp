@@ -89,6 +89,19 @@ void VectorizerReport::print_report(const Nodecl::NodeclBase& n)
             _vpromotions);
 }
 
+void VectorizerReport::print_cost_model_report(const Nodecl::NodeclBase& n,
+        const CostModelDecision& decision)
+{
+    for (TL::ObjectList<std::string>::const_iterator it = decision.reasoning.begin();
+            it != decision.reasoning.end();
+            it++)
+    {
+        info_printf_at(n.get_locus(),
+                "Cost model: %s\n",
+                it->c_str());
+    }
+}
+
 void VectorizerReport::visit(const Nodecl::ObjectInit& n)
 {
     TL::Symbol sym = n.get_symbol();
@@ -29,6 +29,7 @@
 
 #include "tl-nodecl-visitor.hpp"
 #include "tl-nodecl-base.hpp"
+#include "tl-vectorizer-cost-model.hpp"
 
 
 namespace TL
@@ -56,6 +57,8 @@ namespace Vectorization
 
             void reset_report();
             void print_report(const Nodecl::NodeclBase& n);
+            void print_cost_model_report(const Nodecl::NodeclBase& n,
+                    const CostModelDecision& decision);
             void visit(const Nodecl::ObjectInit& n);
 
             void visit(const Nodecl::VectorLoad& n);
@@ -126,8 +126,10 @@ namespace TL
                         }
                     }
                 }
-                else if (_environment._vec_isa_desc.get_id().compare("romol")
-                         == 0)
+                else if ((_environment._vec_isa_desc.get_id().compare("romol")
+                            == 0)
+                        || (_environment._vec_isa_desc.get_id().compare("generic")
+                            == 0))
                 {
                     if((red_name.compare("+") == 0) ||
                             (red_name.compare("-") == 0))
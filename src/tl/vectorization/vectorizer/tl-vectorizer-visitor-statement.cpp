@@ -112,8 +112,16 @@ namespace Vectorization
                     _environment._vec_factor,
                     true /*ref_type*/);
 
+        // Lanes disabled in the enclosing code must not run the loop
+        Nodecl::NodeclBase prev_mask = _environment._mask_list.back();
+
         if (init_next_need_vectorization || condition_needs_vectorization)
         {
+            Nodecl::NodeclBase lane_condition_symbol =
+                Utils::get_new_mask_symbol(_environment._analysis_simd_scope,
+                        _environment._vec_factor,
+                        true /*ref_type*/);
+
             Nodecl::ForStatement epilog = 
                 Vectorizer::_vectorizer_analysis->
                 deep_copy(n, n).as<Nodecl::ForStatement>();
@@ -208,8 +216,26 @@ namespace Vectorization
                             Nodecl::NodeclBase::null(),
                             mask_condition_symbol.get_symbol(),
                             mask_condition_symbol.get_locus()));
+                n.prepend_sibling(
+                        Nodecl::CxxDef::make(
+                            Nodecl::NodeclBase::null(),
+                            lane_condition_symbol.get_symbol(),
+                            lane_condition_symbol.get_locus()));
             }
             n.prepend_sibling(main_loop_precond_stmt);
+
+            // Loop precondition: mask = prev_mask & mask
+            if (!Utils::is_all_one_mask(prev_mask))
+            {
+                n.prepend_sibling(Nodecl::ExpressionStatement::make(
+                            Nodecl::VectorMaskAssignment::make(
+                                mask_condition_symbol.shallow_copy(),
+                                Nodecl::VectorMaskAnd::make(
+                                    prev_mask.shallow_copy(),
+                                    mask_condition_symbol.shallow_copy(),
+                                    mask_condition_symbol.get_type().no_ref()),
+                                mask_condition_symbol.get_type())));
+            }
            
             _environment._analysis_scopes.pop_back();
 
@@ -238,11 +264,22 @@ namespace Vectorization
             visitor_expression.walk(epilog_loop_postcondition);
 
 
-            // Loop postcondition statement
+            // Loop postcondition: lanes that finished their iterations stay
+            // disabled even if the condition becomes true again for them
+            //   lane_mask = cond, mask = mask & lane_mask
             Nodecl::VectorMaskAssignment epilog_loop_postcond_assig =
                 Nodecl::VectorMaskAssignment::make(
-                        mask_condition_symbol.shallow_copy(),
+                        lane_condition_symbol.shallow_copy(),
                         epilog_loop_postcondition,
+                        lane_condition_symbol.get_type());
+
+            Nodecl::VectorMaskAssignment epilog_loop_mask_assig =
+                Nodecl::VectorMaskAssignment::make(
+                        mask_condition_symbol.shallow_copy(),
+                        Nodecl::VectorMaskAnd::make(
+                            mask_condition_symbol.shallow_copy(),
+                            lane_condition_symbol.shallow_copy(),
+                            mask_condition_symbol.get_type().no_ref()),
                         mask_condition_symbol.get_type());
 
             Nodecl::NodeclBase epilog_old_next_copy =
@@ -250,9 +287,12 @@ namespace Vectorization
             
             epilog_loop_control.set_next(
                     Nodecl::Comma::make(
-                        epilog_old_next_copy,
-                        epilog_loop_postcond_assig,
-                        epilog_loop_postcond_assig.get_type()));
+                        Nodecl::Comma::make(
+                            epilog_old_next_copy,
+                            epilog_loop_postcond_assig,
+                            epilog_loop_postcond_assig.get_type()),
+                        epilog_loop_mask_assig,
+                        epilog_loop_mask_assig.get_type()));
 
             // If jump statements, a extra mask will have been added
             if (jump_stmts_inside_loop)
@@ -331,6 +371,129 @@ namespace Vectorization
 
 
 #define MASK_CHECK_THRESHOLD 9
+    // Nested WhileStatement
+    void VectorizerVisitorStatement::visit(const Nodecl::WhileStatement& n)
+    {
+        VECTORIZATION_DEBUG()
+        {
+            fprintf(stderr, "VECTORIZER: --- Vectorizing nested while loop ---\n");
+        }
+
+        _environment._analysis_scopes.push_back(n);
+
+        VectorizerLoopInfo loop_info(n, _environment);
+
+        if (loop_info.condition_is_uniform_in_simd_scope())
+        {
+            // All the lanes run the same iterations
+            walk(n.get_statement());
+
+            _environment._analysis_scopes.pop_back();
+            return;
+        }
+
+        if (Nodecl::Utils::nodecl_contains_nodecl_of_kind
+                <Nodecl::BreakStatement>(n) ||
+                Nodecl::Utils::nodecl_contains_nodecl_of_kind
+                <Nodecl::ContinueStatement>(n) ||
+                Nodecl::Utils::nodecl_contains_nodecl_of_kind
+                <Nodecl::ReturnStatement>(n))
+        {
+            fatal_error("Vectorizer: jump statements inside a while loop with "\
+                    "a varying condition are not supported.");
+        }
+
+        VECTORIZATION_DEBUG()
+        {
+            fprintf(stderr, "VECTORIZER: While condition '%s' needs vectorization\n",
+                    n.get_condition().prettyprint().c_str());
+        }
+
+        // Each lane runs until its own condition is false:
+        //
+        //   mask = prev_mask;
+        //   while ((lane_mask = cond (under mask), mask = mask & lane_mask), mask != 0)
+        //     body (under mask)
+        Nodecl::NodeclBase prev_mask = _environment._mask_list.back();
+
+        Nodecl::NodeclBase mask_condition_symbol =
+            Utils::get_new_mask_symbol(_environment._analysis_simd_scope,
+                    _environment._vec_factor,
+                    true /*ref_type*/);
+        Nodecl::NodeclBase lane_condition_symbol =
+            Utils::get_new_mask_symbol(_environment._analysis_simd_scope,
+                    _environment._vec_factor,
+                    true /*ref_type*/);
+
+        CXX_LANGUAGE()
+        {
+            n.prepend_sibling(
+                    Nodecl::CxxDef::make(
+                        Nodecl::NodeclBase::null(),
+                        mask_condition_symbol.get_symbol(),
+                        mask_condition_symbol.get_locus()));
+            n.prepend_sibling(
+                    Nodecl::CxxDef::make(
+                        Nodecl::NodeclBase::null(),
+                        lane_condition_symbol.get_symbol(),
+                        lane_condition_symbol.get_locus()));
+        }
+
+        n.prepend_sibling(Nodecl::ExpressionStatement::make(
+                    Nodecl::VectorMaskAssignment::make(
+                        mask_condition_symbol.shallow_copy(),
+                        prev_mask.shallow_copy(),
+                        mask_condition_symbol.get_type(),
+                        n.get_locus())));
+
+        // The condition is evaluated only for the lanes still running. The
+        // lanes that already exited must not evaluate it again
+        _environment._mask_list.push_back(mask_condition_symbol);
+
+        Nodecl::NodeclBase condition = n.get_condition();
+        VectorizerVisitorExpression visitor_expression(_environment);
+        visitor_expression.walk(condition);
+
+        Nodecl::VectorMaskAssignment lane_condition_assig =
+            Nodecl::VectorMaskAssignment::make(
+                    lane_condition_symbol.shallow_copy(),
+                    condition.shallow_copy(),
+                    lane_condition_symbol.get_type(),
+                    n.get_locus());
+
+        Nodecl::VectorMaskAssignment mask_assig =
+            Nodecl::VectorMaskAssignment::make(
+                    mask_condition_symbol.shallow_copy(),
+                    Nodecl::VectorMaskAnd::make(
+                        mask_condition_symbol.shallow_copy(),
+                        lane_condition_symbol.shallow_copy(),
+                        mask_condition_symbol.get_type().no_ref()),
+                    mask_condition_symbol.get_type(),
+                    n.get_locus());
+
+        Nodecl::Different active_lanes =
+            Nodecl::Different::make(
+                    mask_condition_symbol.shallow_copy(),
+                    const_value_to_nodecl(const_value_get_zero(4, 1)),
+                    Type::get_bool_type());
+
+        condition.replace(
+                Nodecl::Comma::make(
+                    Nodecl::Comma::make(
+                        lane_condition_assig,
+                        mask_assig,
+                        mask_assig.get_type()),
+                    active_lanes,
+                    active_lanes.get_type(),
+                    n.get_locus()));
+
+        // LOOP BODY
+        walk(n.get_statement());
+        _environment._mask_list.pop_back();
+
+        _environment._analysis_scopes.pop_back();
+    }
+
     void VectorizerVisitorStatement::visit(const Nodecl::IfElseStatement& n)
     {
         Nodecl::NodeclBase condition = n.get_condition();
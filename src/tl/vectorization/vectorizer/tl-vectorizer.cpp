@@ -325,6 +325,33 @@ namespace Vectorization
         }
     }
 
+    CostModelDecision Vectorizer::evaluate_cost_model(
+            const Nodecl::NodeclBase& loop_statement,
+            const Nodecl::List& simd_environment,
+            const VectorIsaDescriptor& vec_isa_desc,
+            unsigned int max_vec_factor)
+    {
+        VectorizerCostModel cost_model(vec_isa_desc);
+        CostModelDecision decision = cost_model.evaluate(loop_statement,
+                simd_environment, max_vec_factor);
+
+        VECTORIZATION_DEBUG()
+        {
+            VectorizerReport report;
+            report.print_cost_model_report(loop_statement, decision);
+        }
+
+        return decision;
+    }
+
+    bool Vectorizer::version_loop_for_alignment(
+            const Nodecl::OpenMP::Simd& simd_node,
+            const VectorIsaDescriptor& vec_isa_desc)
+    {
+        VectorizerLoopVersioning loop_versioning(vec_isa_desc);
+        return loop_versioning.version_loop(simd_node);
+    }
+
     bool Vectorizer::is_supported_reduction(bool is_builtin,
             const std::string& reduction_name,
             const TL::Type& reduction_type,
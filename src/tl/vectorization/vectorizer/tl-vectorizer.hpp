@@ -37,6 +37,8 @@
 #include "tl-vectorization-common.hpp"
 
 #include "tl-function-versioning.hpp"
+#include "tl-vectorizer-cost-model.hpp"
+#include "tl-vectorizer-loop-versioning.hpp"
 
 
 namespace TL
@@ -119,6 +121,15 @@ namespace TL
                         VectorizerEnvironment& environment,
                         bool& only_epilog);
 
+                CostModelDecision evaluate_cost_model(
+                        const Nodecl::NodeclBase& loop_statement,
+                        const Nodecl::List& simd_environment,
+                        const VectorIsaDescriptor& vec_isa_desc,
+                        unsigned int max_vec_factor);
+                bool version_loop_for_alignment(
+                        const Nodecl::OpenMP::Simd& simd_node,
+                        const VectorIsaDescriptor& vec_isa_desc);
+
                 bool is_supported_reduction(bool is_builtin,
                         const std::string& reduction_name,
                         const TL::Type& reduction_type,
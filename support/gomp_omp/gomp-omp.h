@@ -64,6 +64,15 @@ extern void GOMP_parallel_loop_runtime (void (*)(void *), void *,
 					unsigned, long, long, long,
 					unsigned);
 
+extern bool GOMP_loop_doacross_static_start (unsigned, long *, long, long *,
+					     long *);
+extern bool GOMP_loop_doacross_dynamic_start (unsigned, long *, long, long *,
+					      long *);
+extern bool GOMP_loop_doacross_guided_start (unsigned, long *, long, long *,
+					     long *);
+extern bool GOMP_loop_doacross_runtime_start (unsigned, long *, long *,
+					      long *);
+
 extern void GOMP_loop_end (void);
 extern void GOMP_loop_end_nowait (void);
 extern bool GOMP_loop_end_cancel (void);
@@ -140,6 +149,8 @@ extern bool GOMP_loop_ull_ordered_runtime_next (unsigned long long *,
 
 extern void GOMP_ordered_start (void);
 extern void GOMP_ordered_end (void);
+extern void GOMP_doacross_post (long *);
+extern void GOMP_doacross_wait (long, ...);
 
 /* parallel.c */
 
@@ -157,10 +168,22 @@ enum GOMP_task_flags
     GOMP_TASK_FINAL = 2,
     GOMP_TASK_MERGEABLE = 4,
     GOMP_TASK_DEPEND = 8,
+    GOMP_TASK_PRIORITY = 16,
+    GOMP_TASK_UP = 256,
+    GOMP_TASK_GRAINSIZE = 512,
+    GOMP_TASK_IF = 1024,
+    GOMP_TASK_NOGROUP = 2048,
 };
 
 extern void GOMP_task (void (*) (void *), void *, void (*) (void *, void *),
 		       long, long, bool, unsigned, void **);
+extern void GOMP_taskloop (void (*) (void *), void *,
+			   void (*) (void *, void *), long, long, unsigned,
+			   unsigned long, int, long, long, long);
+extern void GOMP_taskloop_ull (void (*) (void *), void *,
+			       void (*) (void *, void *), long, long, unsigned,
+			       unsigned long, int, unsigned long long,
+			       unsigned long long, unsigned long long);
 extern void GOMP_taskwait (void);
 extern void GOMP_taskyield (void);
 extern void GOMP_taskgroup_start (void);
@@ -0,0 +1,31 @@
+/*
+<testinfo>
+test_generator=config/mercurium
+test_CFLAGS="--pp=off"
+</testinfo>
+*/
+
+// Comments are not removed by the preprocessor in this test \
+   so they reach the lexer, this line is still part of the comment
+
+/* A long comment
+ * spanning ** several lines ***/
+int a; /**/ int b; /***/ int c;
+
+/* The closing tag of this comment is split *\
+/
+int d;
+
+// A directive right after a line comment
+# 21 "success_243.c"
+int e; // Trailing comment
+int f; /* Trailing comment */ int g;
+
+void h(void)
+{
+    int i = a /* inside an expression */ + b // and at the end
+        + c;
+    int *p = &i;
+    int j = i / *p; // a division is not a comment
+}
+// No newline at the end of the file
\ No newline at end of file
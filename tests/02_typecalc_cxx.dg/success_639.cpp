@@ -0,0 +1,65 @@
+/*
+<testinfo>
+test_generator="config/mercurium run"
+test_CXXFLAGS="--compile-stats=${tmpdir}/success_639.json"
+test_ARGS="${tmpdir}/success_639.json"
+</testinfo>
+*/
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+template <typename T>
+struct A
+{
+    T x;
+    T get() const { return x; }
+
+    struct B
+    {
+        T y;
+    };
+};
+
+template <typename T>
+T add(T a, T b)
+{
+    return a + b;
+}
+
+int f(void)
+{
+    A<int> a;
+    A<int>::B b;
+    a.x = 1;
+    b.y = 2;
+
+    return add(a.get(), b.y) + (int)add(1.0, 2.0);
+}
+
+int main(int argc, char *argv[])
+{
+    // The path of the report is passed by the test
+    if (argc != 2)
+        std::abort();
+
+    std::FILE* report_file = std::fopen(argv[1], "r");
+    if (report_file == NULL)
+        std::abort();
+
+    std::string contents;
+    char buffer[4096];
+    std::size_t n;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), report_file)) > 0)
+        contents.append(buffer, n);
+    std::fclose(report_file);
+
+    if (contents.find("\"translation_units\"") == std::string::npos
+            || contents.find("success_639.cpp\"") == std::string::npos
+            || contents.find("\"kind\": \"class_instantiation\"") == std::string::npos
+            || contents.find("\"kind\": \"function_instantiation\"") == std::string::npos)
+        std::abort();
+
+    return 0;
+}
@@ -0,0 +1,15 @@
+/*
+<testinfo>
+test_generator="config/mercurium-fe-only"
+test_CXXFLAGS="-std=c++11"
+test_compile_fail=yes
+</testinfo>
+*/
+
+// The evaluation never ends, the depth limit must stop it
+constexpr int f(int n)
+{
+    return f(n + 1);
+}
+
+static_assert(f(0) == 0, "");
@@ -0,0 +1,24 @@
+/*
+<testinfo>
+test_generator="config/mercurium-cxx11"
+test_nolink=yes
+</testinfo>
+*/
+
+// Without memoization of constexpr calls these take exponential time
+constexpr unsigned long long fib(int n)
+{
+    return n < 2 ? n : fib(n - 1) + fib(n - 2);
+}
+
+static_assert(fib(60) == 1548008755920ULL, "Invalid fib");
+
+constexpr int binomial(int n, int k)
+{
+    return (k == 0 || k == n) ? 1 : binomial(n - 1, k - 1) + binomial(n - 1, k);
+}
+
+static_assert(binomial(30, 15) == 155117520, "Invalid binomial");
+
+int v[fib(10)];
+static_assert(sizeof(v) == 55 * sizeof(int), "Invalid size");
@@ -0,0 +1,50 @@
+/*
+<testinfo>
+test_generator="config/mercurium-valgrind c++11"
+</testinfo>
+*/
+
+// Ambiguities nested inside other ambiguities. The discarded
+// interpretations share nodes with the chosen ones and must be freed once
+struct A
+{
+    A();
+    A(int);
+    int operator()(int) const;
+};
+
+typedef int T;
+int b, c;
+
+template <typename X>
+struct W
+{
+    W(X);
+    X operator()(X) const;
+};
+
+void f1()
+{
+    A(x);
+    T(y)(T(b));
+    A z(A(T(c)));
+    A w((A(T(c))));
+    int n = sizeof(T(b)) + sizeof(A(T(1)));
+    W<A>(v)(A(T(b)));
+    for (A(i); b < c; )
+        A(j)(T(i(c)));
+}
+
+template <typename X>
+void f2(X k)
+{
+    X(m)(X(k));
+    W<X>(q)(X(T(k)));
+    X(s)[2] = { X(k), X(X(k)) };
+}
+
+void f3()
+{
+    f2(A());
+    f2(T());
+}
@@ -0,0 +1,47 @@
+/*
+<testinfo>
+test_generator="config/mercurium-valgrind c++11"
+</testinfo>
+*/
+
+// Default arguments of member functions are analyzed once the class is
+// complete. Their ambiguities are solved then and the discarded
+// interpretations freed with them
+typedef int T;
+
+struct B
+{
+    B(int = 0);
+};
+
+struct S
+{
+    void f1(int a = T(g(1)) + T(h<T>(T(2))));
+    void f2(B b = B(T(k)), int c = sizeof(T(k)));
+    void f3(T (t) = T(T(k) < T(k)), T u = (T(k)) + (T(k)));
+
+    template <typename X>
+    void f4(X x = X(T(k)), B y = B(X(T(k))));
+
+    struct Inner
+    {
+        void f5(T v = S::k + T(S::g(T(k))));
+    };
+
+    static T g(T);
+    template <typename X>
+    static X h(X);
+    static const T k = 3;
+};
+
+void use()
+{
+    S s;
+    s.f1();
+    s.f2();
+    s.f3();
+    s.f4<T>();
+    s.f4<B>(B(1));
+    S::Inner i;
+    i.f5();
+}
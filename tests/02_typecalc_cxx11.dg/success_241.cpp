@@ -0,0 +1,43 @@
+/*
+<testinfo>
+test_generator="config/mercurium-valgrind c++11"
+</testinfo>
+*/
+
+// noexcept specifiers of member functions are analyzed once the class is
+// complete, like default arguments. Their ambiguities are solved then and
+// the discarded interpretations freed with them
+typedef int T;
+
+struct S
+{
+    void f1() noexcept(noexcept(T(g(T(1)))));
+    void f2(T a = T(k)) noexcept(sizeof(T(k)) == sizeof(T));
+    void f3() noexcept(noexcept(S(T(k))) && noexcept(T(h<T>(T(k)))));
+
+    template <typename X>
+    void f4() noexcept(noexcept(X(T(k))));
+
+    struct Inner
+    {
+        void f5() noexcept(noexcept(S::g(T(S::k))));
+    };
+
+    S(T = T(k)) noexcept(noexcept(T(g(k))));
+
+    static T g(T) noexcept;
+    template <typename X>
+    static X h(X);
+    static const T k = 3;
+};
+
+void use()
+{
+    S s;
+    s.f1();
+    s.f2();
+    s.f3();
+    s.f4<T>();
+    S::Inner i;
+    i.f5();
+}
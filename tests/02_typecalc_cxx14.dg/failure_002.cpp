@@ -0,0 +1,25 @@
+/*
+<testinfo>
+test_generator="config/mercurium-cxx14"
+test_compile_fail=yes
+</testinfo>
+*/
+
+// The labels of the switch are nested in the loop, so the call is not
+// evaluated instead of skipping them
+constexpr int count_duff(int n)
+{
+    int c = 0;
+    int k = (n + 3) / 4;
+    switch (n % 4)
+    {
+        case 0: do { c++;
+        case 3:      c++;
+        case 2:      c++;
+        case 1:      c++;
+                } while (--k > 0);
+    }
+    return c;
+}
+
+static_assert(count_duff(6) == 6, "");
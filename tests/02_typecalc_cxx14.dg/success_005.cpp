@@ -0,0 +1,97 @@
+/*
+<testinfo>
+test_generator="config/mercurium-cxx14"
+</testinfo>
+*/
+
+constexpr int sum_to(int n)
+{
+    int s = 0;
+    for (int i = 1; i <= n; i++)
+        s += i;
+    return s;
+}
+
+constexpr int gcd(int a, int b)
+{
+    while (b != 0)
+    {
+        int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+constexpr unsigned int popcount(unsigned int x)
+{
+    unsigned int c = 0;
+    do
+    {
+        if (x & 1u)
+            c++;
+        x >>= 1;
+    } while (x != 0);
+    return c;
+}
+
+constexpr int first_multiple(int n, int m)
+{
+    int i = 1;
+    for (;;)
+    {
+        if (i % m != 0)
+        {
+            i++;
+            continue;
+        }
+        if (i >= n)
+            break;
+        i++;
+    }
+    return i;
+}
+
+constexpr int classify(int x)
+{
+    int r = 0;
+    switch (x)
+    {
+        case 0:
+            r = 10;
+            break;
+        case 1:
+        case 2:
+            r = 20;
+            // fall through
+        case 3:
+            r += 1;
+            break;
+        default:
+            r = -1;
+    }
+    return r;
+}
+
+template <typename T>
+constexpr T power(T b, int e)
+{
+    T r = 1;
+    for (int i = 0; i < e; ++i)
+        r *= b;
+    return r;
+}
+
+static_assert(sum_to(100) == 5050, "");
+static_assert(gcd(84, 36) == 12, "");
+static_assert(popcount(0xF0F0u) == 8, "");
+static_assert(first_multiple(20, 7) == 21, "");
+static_assert(classify(0) == 10, "");
+static_assert(classify(2) == 21, "");
+static_assert(classify(3) == 1, "");
+static_assert(classify(7) == -1, "");
+static_assert(power(3, 4) == 81, "");
+static_assert(power(2L, 40) == 1099511627776L, "");
+
+int a[sum_to(4)];
+static_assert(sizeof(a) == 10 * sizeof(int), "");
@@ -29,12 +29,11 @@
 /*
 <testinfo>
 test_generator=config/mercurium-hlt
-test_ignore=yes
 </testinfo>
 */
 
 void f(void)
 {
-#pragma hlt block
+#pragma hlt tile(4)
     while (1);
 }
@@ -29,13 +29,12 @@
 /*
 <testinfo>
 test_generator=config/mercurium-hlt
-test_ignore=yes
 </testinfo>
 */
 
 void f(int i, int j)
 {
-#pragma hlt block factors(20)
+#pragma hlt tile(20)
     for (i = 0; i < 100 && j > 20; i++, j--)
     {
     }
@@ -29,7 +29,6 @@
 /*
 <testinfo>
 test_generator=config/mercurium-hlt
-test_ignore=yes
 </testinfo>
 */
 
@@ -29,7 +29,6 @@
 /*
 <testinfo>
 test_generator=config/mercurium-hlt
-test_ignore=yes
 </testinfo>
 */
 
@@ -37,7 +36,7 @@ void f(void)
 {
     int a;
 
-#pragma hlt fusion
+#pragma hlt fuse
     {
         a = 3;
     }
@@ -29,14 +29,13 @@
 /*
 <testinfo>
 test_generator=config/mercurium-hlt
-test_ignore=yes
 </testinfo>
 */
 
 void f(void)
 {
 
-#pragma hlt fusion
+#pragma hlt fuse
     {
         for ( ; ; )
         {
@@ -29,7 +29,6 @@
 /*
 <testinfo>
 test_generator=config/mercurium-hlt
-test_ignore=yes
 </testinfo>
 */
 
@@ -38,7 +37,7 @@ void f(void)
     int i, j, k;
     int **a;
 
-#pragma hlt interchange permutation(2, 1)
+#pragma hlt interchange(2, 1)
     for (i = 0; i < 100; i++)
     {
         k = 3;
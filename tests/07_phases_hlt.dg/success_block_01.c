@@ -29,7 +29,6 @@
 /*
 <testinfo>
 test_generator=config/mercurium-hlt
-test_ignore=yes
 </testinfo>
 */
 
@@ -40,7 +39,7 @@ void f(void)
     int i;
     int j;
 
-#pragma hlt block factors(10, 20)
+#pragma hlt tile(10, 20)
     for (i = 0; i < 100; i++)
     {
         for (j = 0; j < 100; j++)
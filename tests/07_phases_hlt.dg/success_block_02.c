@@ -29,7 +29,6 @@
 /*
 <testinfo>
 test_generator=config/mercurium-hlt
-test_ignore=yes
 </testinfo>
 */
 
@@ -37,7 +36,7 @@ void f(void)
 {
     int a[100][100];
 
-#pragma hlt block factors(10, 20)
+#pragma hlt tile(10, 20)
     for (int i = 0; i < 100; i++)
     {
         for (int j = 0; j < 100; j++)
@@ -29,7 +29,6 @@
 /*
 <testinfo>
 test_generator=config/mercurium-hlt
-test_ignore=yes
 </testinfo>
 */
 
@@ -39,7 +38,7 @@ void f(void)
 
     int n = 10;
     int m = 20;
-#pragma hlt block factors(n, m)
+#pragma hlt tile(n, m)
     for (int i = 0; i < 100; i++)
     {
         for (int j = 0; j < 100; j++)
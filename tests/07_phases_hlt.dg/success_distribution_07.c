@@ -0,0 +1,70 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2012 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+/*
+<testinfo>
+test_generator="config/mercurium-hlt run"
+</testinfo>
+*/
+
+#include <stdlib.h>
+
+enum { N = 100 };
+
+int a[N], b[N], c[N];
+
+int main(int argc, char *argv[])
+{
+    int i, t;
+
+    for (i = 0; i < N; i++)
+    {
+        a[i] = i;
+        b[i] = 0;
+    }
+
+#pragma hlt distribute expand(t)
+    for (i = 1; i < N; i++)
+    {
+        t = a[i] + 1;
+        b[i] = t * 2;
+        c[i] = b[i - 1] + t;
+    }
+
+    if (t != N)
+        abort();
+
+    for (i = 1; i < N; i++)
+    {
+        if (b[i] != 2 * (i + 1)
+                || c[i] != ((i > 1) ? 2 * i : 0) + i + 1)
+            abort();
+    }
+
+    return 0;
+}
@@ -29,7 +29,6 @@
 /*
 <testinfo>
 test_generator=config/mercurium-hlt
-test_ignore=yes
 </testinfo>
 */
 
@@ -41,7 +40,7 @@ void f(void)
 
     int i;
 
-#pragma hlt fusion
+#pragma hlt fuse
     {
         for (i = 0; i < 100; i++)
         {
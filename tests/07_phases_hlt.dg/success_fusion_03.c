@@ -0,0 +1,73 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2012 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+/*
+<testinfo>
+test_generator="config/mercurium-hlt run"
+</testinfo>
+*/
+
+#include <stdlib.h>
+
+enum { N = 100 };
+
+int a[N], b[N], c[N];
+
+int main(int argc, char *argv[])
+{
+    int i, j;
+
+#pragma hlt fuse
+    {
+        for (i = 0; i < N; i++)
+        {
+            a[i] = i;
+        }
+        for (j = 0; j < N; j++)
+        {
+            b[j] = a[j] * 2;
+        }
+        for (i = 0; i < N; i++)
+        {
+            c[i] = (i > 0) ? a[i - 1] + b[i] : b[i];
+        }
+    }
+
+    if (i != N || j != N)
+        abort();
+
+    for (i = 0; i < N; i++)
+    {
+        if (a[i] != i
+                || b[i] != 2 * i
+                || c[i] != ((i > 0) ? 3 * i - 1 : 0))
+            abort();
+    }
+
+    return 0;
+}
@@ -0,0 +1,72 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2012 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+/*
+<testinfo>
+test_generator="config/mercurium-hlt run"
+</testinfo>
+*/
+
+#include <stdlib.h>
+
+enum { N = 100 };
+
+int a[N], b[N], c[N];
+
+int main(int argc, char *argv[])
+{
+    int i, k = 0, last = -1;
+
+    // 'c[0]' and 'k' do not depend on the first loop, so they are moved
+    // before the fused loop. 'last' is updated after it
+#pragma hlt fuse
+    {
+        for (i = 0; i < N; i++)
+        {
+            a[i] = i;
+        }
+        c[0] = 7;
+        k = 3;
+        for (i = 0; i < N; i++)
+        {
+            b[i] = a[i] + 1;
+        }
+        last = a[N - 1] + b[N - 1];
+    }
+
+    if (i != N || k != 3 || c[0] != 7 || last != 2 * N - 1)
+        abort();
+
+    for (i = 0; i < N; i++)
+    {
+        if (a[i] != i || b[i] != i + 1)
+            abort();
+    }
+
+    return 0;
+}
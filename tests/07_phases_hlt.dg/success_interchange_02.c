@@ -0,0 +1,65 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2012 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+/*
+<testinfo>
+test_generator="config/mercurium-hlt run"
+</testinfo>
+*/
+
+#include <stdlib.h>
+
+enum { N = 30, M = 40 };
+
+double a[N][M], b[N][M];
+
+int main(int argc, char *argv[])
+{
+    int i, j;
+
+    for (i = 0; i < N; i++)
+        for (j = 0; j < M; j++)
+            a[i][j] = b[i][j] = i * M + j;
+
+    // Dependence (<, <) stays lexicographically positive
+    for (i = 1; i < N; i++)
+        for (j = 1; j < M; j++)
+            a[i][j] = a[i - 1][j - 1] * 0.5 + 1.0;
+
+#pragma hlt interchange(2, 1)
+    for (i = 1; i < N; i++)
+        for (j = 1; j < M; j++)
+            b[i][j] = b[i - 1][j - 1] * 0.5 + 1.0;
+
+    for (i = 0; i < N; i++)
+        for (j = 0; j < M; j++)
+            if (a[i][j] != b[i][j])
+                abort();
+
+    return 0;
+}
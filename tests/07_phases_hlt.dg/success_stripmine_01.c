@@ -0,0 +1,70 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2012 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+/*
+<testinfo>
+test_generator="config/mercurium-hlt run"
+</testinfo>
+*/
+
+#include <stdlib.h>
+
+enum { N = 100 };
+
+int a[N];
+
+int main(int argc, char *argv[])
+{
+    int i;
+
+#pragma hlt stripmine(8)
+    for (i = 0; i < N; i += 3)
+    {
+        a[i] = i;
+    }
+
+    if (i != 102)
+        abort();
+
+#pragma hlt stripmine(7)
+    for (int k = N - 1; k > 0; k--)
+    {
+        a[k] += a[k - 1];
+    }
+
+    for (i = 0; i < N; i++)
+    {
+        int expected = (i % 3 == 0) ? i : 0;
+        if (i > 0 && (i - 1) % 3 == 0)
+            expected += i - 1;
+        if (a[i] != expected)
+            abort();
+    }
+
+    return 0;
+}
@@ -0,0 +1,75 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2012 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+/*
+<testinfo>
+test_generator="config/mercurium-hlt run"
+</testinfo>
+*/
+
+#include <stdlib.h>
+
+enum { N = 37, M = 23 };
+
+int a[N][M], b[N][M];
+
+void init(int x[N][M])
+{
+    int i, j;
+    for (i = 0; i < N; i++)
+        for (j = 0; j < M; j++)
+            x[i][j] = i + 2 * j;
+}
+
+int main(int argc, char *argv[])
+{
+    int i, j;
+    int ts = 5;
+
+    init(a);
+    init(b);
+
+    for (i = 1; i < N; i++)
+        for (j = 1; j < M; j++)
+            a[i][j] = a[i - 1][j] + a[i][j - 1] + 1;
+
+#pragma hlt tile(ts, 4)
+    for (i = 1; i < N; i++)
+        for (j = 1; j < M; j++)
+            b[i][j] = b[i - 1][j] + b[i][j - 1] + 1;
+
+    if (i != N || j != M)
+        abort();
+
+    for (i = 0; i < N; i++)
+        for (j = 0; j < M; j++)
+            if (a[i][j] != b[i][j])
+                abort();
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2012 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+/*
+<testinfo>
+test_generator=config/mercurium-omp
+test_CFLAGS="--nodecl-index"
+</testinfo>
+*/
+
+#include <stdlib.h>
+
+static int fib(int n)
+{
+    int x, y;
+    if (n < 2)
+        return n;
+
+#pragma omp task shared(x) firstprivate(n)
+    x = fib(n - 1);
+#pragma omp task shared(y) firstprivate(n)
+    y = fib(n - 2);
+#pragma omp taskwait
+
+    return x + y;
+}
+
+int main(int argc, char *argv[])
+{
+    int v[100];
+    int i, s = 0;
+
+#pragma omp parallel for
+    for (i = 0; i < 100; i++)
+        v[i] = i;
+
+#pragma omp parallel for reduction(+:s)
+    for (i = 0; i < 100; i++)
+        s += v[i];
+
+    if (s != 4950)
+        abort();
+
+    int f = 0;
+#pragma omp parallel shared(f)
+    {
+#pragma omp single
+        f = fib(10);
+    }
+
+    if (f != 55)
+        abort();
+
+    return 0;
+}
@@ -0,0 +1,70 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2013 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+/*
+<testinfo>
+test_generator=config/mercurium-gomp
+</testinfo>
+*/
+
+#include <assert.h>
+
+#define N 1000
+
+int a[N], b[N];
+
+int main(int argc, char *argv[])
+{
+    int i;
+
+    a[0] = 0;
+    #pragma omp parallel for ordered(1) schedule(static, 1)
+    for (i = 1; i < N; i++)
+    {
+        #pragma omp ordered depend(sink: i - 1)
+        a[i] = a[i - 1] + 1;
+        #pragma omp ordered depend(source)
+    }
+
+    for (i = 0; i < N; i++)
+        assert(a[i] == i);
+
+    // The sink 'i - 1' is never an iteration of this loop and is ignored
+    b[0] = 0;
+    #pragma omp parallel for ordered(1) schedule(static, 1)
+    for (i = 2; i < N; i += 2)
+    {
+        #pragma omp ordered depend(sink: i - 1) depend(sink: i - 2)
+        b[i] = b[i - 2] + 1;
+        #pragma omp ordered depend(source)
+    }
+
+    for (i = 0; i < N; i += 2)
+        assert(b[i] == i / 2);
+
+    return 0;
+}
@@ -0,0 +1,67 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2013 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+/*
+<testinfo>
+test_generator=config/mercurium-gomp
+</testinfo>
+*/
+
+#include <assert.h>
+
+#define N 1000
+
+int main(int argc, char *argv[])
+{
+    int i, j;
+
+    // Combined with atomic builtins
+    int sum = 0;
+    double prod = 1.0;
+    // Combined pairwise across the team
+    long double lsum = 0.0L;
+    // Combined element by element
+    int hist[4] = { 0, 0, 0, 0 };
+
+    #pragma omp parallel for reduction(+:sum, lsum) reduction(*:prod) reduction(+:hist)
+    for (i = 0; i < N; i++)
+    {
+        sum += i;
+        lsum += (long double)i;
+        if (i % 100 == 0)
+            prod *= 2.0;
+        hist[i % 4]++;
+    }
+
+    assert(sum == N * (N - 1) / 2);
+    assert(lsum == (long double)(N * (N - 1) / 2));
+    assert(prod == 1024.0);
+    for (j = 0; j < 4; j++)
+        assert(hist[j] == N / 4);
+
+    return 0;
+}
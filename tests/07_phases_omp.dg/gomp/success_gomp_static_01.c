@@ -0,0 +1,81 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2013 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+/*
+<testinfo>
+test_generator=config/mercurium-gomp
+</testinfo>
+*/
+
+#include <assert.h>
+#include <omp.h>
+
+#define N 1000
+
+int lower_calls, upper_calls;
+
+int lower(void)
+{
+    #pragma omp atomic
+    lower_calls++;
+    return 3;
+}
+
+int upper(void)
+{
+    #pragma omp atomic
+    upper_calls++;
+    return N;
+}
+
+int main(int argc, char *argv[])
+{
+    int i, num_threads = 1;
+    int v[N];
+
+    for (i = 0; i < N; i++)
+        v[i] = 0;
+
+    #pragma omp parallel
+    {
+        #pragma omp single
+        num_threads = omp_get_num_threads();
+
+        #pragma omp for schedule(static)
+        for (i = lower(); i < upper(); i += 2)
+            v[i]++;
+    }
+
+    for (i = 0; i < N; i++)
+        assert(v[i] == (i >= 3 && i % 2 == 1));
+
+    // Each thread evaluates the bounds once
+    assert(lower_calls == num_threads);
+    assert(upper_calls == num_threads);
+
+    return 0;
+}
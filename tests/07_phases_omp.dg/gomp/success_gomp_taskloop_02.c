@@ -0,0 +1,80 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2013 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+/*
+<testinfo>
+test_generator=config/mercurium-gomp
+</testinfo>
+*/
+
+#include <assert.h>
+
+#define N 1000
+
+// Bounds that do not fit in a long use GOMP_taskloop_ull
+#define BASE 0xFFFFFFFFFFFFF000ULL
+
+int main(int argc, char *argv[])
+{
+    unsigned long long i, last = 0;
+    int v[N];
+    int k;
+
+    for (k = 0; k < N; k++)
+        v[k] = 0;
+
+    #pragma omp parallel
+    #pragma omp single
+    #pragma omp taskloop grainsize(7) lastprivate(last)
+    for (i = BASE; i < BASE + N; i += 3)
+    {
+        v[i - BASE]++;
+        last = i;
+    }
+
+    for (k = 0; k < N; k++)
+        assert(v[k] == (k % 3 == 0));
+    assert(last == BASE + N - 1);
+
+    for (k = 0; k < N; k++)
+        v[k] = 0;
+
+    #pragma omp parallel
+    #pragma omp single
+    #pragma omp taskloop num_tasks(5) lastprivate(last)
+    for (i = BASE + N - 1; i >= BASE; i -= 2)
+    {
+        v[i - BASE]++;
+        last = i;
+    }
+
+    for (k = 0; k < N; k++)
+        assert(v[k] == ((N - 1 - k) % 2 == 0));
+    assert(last == BASE + 1);
+
+    return 0;
+}
@@ -0,0 +1,83 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2012 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+/*
+<testinfo>
+test_generator=config/mercurium-intel
+compile_versions="unfused fused"
+test_CFLAGS_fused="--fuse-phases"
+test_CXXFLAGS_fused="--fuse-phases"
+</testinfo>
+*/
+
+// The RTL call caching phase is fusable: compiled with and without
+// --fuse-phases, both versions must compute the same results
+#include <stdlib.h>
+
+#define N 1000
+
+int v[N];
+
+static int sum_and_count(int *count)
+{
+    int i, sum = 0;
+
+    *count = 0;
+#pragma omp parallel
+    {
+#pragma omp for
+        for (i = 0; i < N; i++)
+            v[i] = i;
+
+#pragma omp for reduction(+:sum)
+        for (i = 0; i < N; i++)
+            sum += v[i];
+
+#pragma omp single
+        (*count)++;
+
+#pragma omp barrier
+
+#pragma omp critical
+        v[0]++;
+    }
+
+    return sum;
+}
+
+int main(int argc, char *argv[])
+{
+    int count;
+    int sum = sum_and_count(&count);
+
+    if (sum != N * (N - 1) / 2)
+        abort();
+    if (count != 1)
+        abort();
+    if (v[0] < 1)
+        abort();
+
+    return 0;
+}
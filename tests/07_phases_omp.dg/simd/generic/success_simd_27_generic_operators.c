@@ -0,0 +1,144 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2013 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+/*
+<testinfo>
+test_generator=config/mercurium-serial-simd-generic
+</testinfo>
+*/
+
+// Every operator the generic backend lowers to a GNU C vector operator.
+// The generated code must compile and give the scalar results
+#include <stdio.h>
+#include <stdlib.h>
+
+#define VECTOR_SIZE 64
+#define N 64
+
+void __attribute__((noinline)) int_ops(int *a, int *b, int *z)
+{
+    int j;
+#pragma omp simd
+    for (j=0; j<N; j++)
+    {
+        int t = a[j] + b[j];
+        t = t - (a[j] * b[j]);
+        t = t + a[j] / b[j] + a[j] % b[j];
+        t = t ^ ((a[j] & b[j]) | (a[j] << 2));
+        t = t + (a[j] >> 1) + ((a[j] < b[j]) ? 3 : 5);
+        z[j] = (a[j] != b[j]) ? t : -t;
+    }
+}
+
+void __attribute__((noinline)) unsigned_ops(unsigned int *a, unsigned int *b, unsigned int *z)
+{
+    int j;
+#pragma omp simd
+    for (j=0; j<N; j++)
+    {
+        z[j] = ((a[j] >> 3) | (b[j] << 1)) + ((a[j] >= b[j]) ? a[j] : b[j]);
+    }
+}
+
+void __attribute__((noinline)) float_ops(float *x, float *y, float *z)
+{
+    int j;
+#pragma omp simd
+    for (j=0; j<N; j++)
+    {
+        float t = (x[j] - y[j]) / (y[j] + 1.0f);
+        z[j] = (x[j] <= y[j]) ? t : -t * x[j];
+    }
+}
+
+static int check_int(int a, int b)
+{
+    int t = a + b;
+    t = t - (a * b);
+    t = t + a / b + a % b;
+    t = t ^ ((a & b) | (a << 2));
+    t = t + (a >> 1) + ((a < b) ? 3 : 5);
+    return (a != b) ? t : -t;
+}
+
+int main (int argc, char * argv[])
+{
+    int *a, *b, *zi;
+    unsigned int *ua, *ub, *zu;
+    float *x, *y, *zf;
+
+    posix_memalign((void **)&a, VECTOR_SIZE, N*sizeof(int));
+    posix_memalign((void **)&b, VECTOR_SIZE, N*sizeof(int));
+    posix_memalign((void **)&zi, VECTOR_SIZE, N*sizeof(int));
+    posix_memalign((void **)&ua, VECTOR_SIZE, N*sizeof(unsigned int));
+    posix_memalign((void **)&ub, VECTOR_SIZE, N*sizeof(unsigned int));
+    posix_memalign((void **)&zu, VECTOR_SIZE, N*sizeof(unsigned int));
+    posix_memalign((void **)&x, VECTOR_SIZE, N*sizeof(float));
+    posix_memalign((void **)&y, VECTOR_SIZE, N*sizeof(float));
+    posix_memalign((void **)&zf, VECTOR_SIZE, N*sizeof(float));
+
+    int i;
+    for (i=0; i<N; i++)
+    {
+        a[i] = i - N/2;
+        b[i] = (i % 7) + 1;
+        ua[i] = 0xF0000000u + i * 977u;
+        ub[i] = i * 31u;
+        x[i] = i;
+        y[i] = N - i;
+    }
+
+    int_ops(a, b, zi);
+    unsigned_ops(ua, ub, zu);
+    float_ops(x, y, zf);
+
+    for (i=0; i<N; i++)
+    {
+        if (zi[i] != check_int(a[i], b[i]))
+        {
+            printf("Error int %d: %d != %d\n", i, zi[i], check_int(a[i], b[i]));
+            return 1;
+        }
+
+        unsigned int u = ((ua[i] >> 3) | (ub[i] << 1)) + ((ua[i] >= ub[i]) ? ua[i] : ub[i]);
+        if (zu[i] != u)
+        {
+            printf("Error unsigned %d: %u != %u\n", i, zu[i], u);
+            return 1;
+        }
+
+        float t = (x[i] - y[i]) / (y[i] + 1.0f);
+        float f = (x[i] <= y[i]) ? t : -t * x[i];
+        if (zf[i] != f)
+        {
+            printf("Error float %d: %f != %f\n", i, zf[i], f);
+            return 1;
+        }
+    }
+
+    printf("SUCCESS!\n");
+    return 0;
+}
@@ -0,0 +1,163 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2013 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+/*
+<testinfo>
+test_CFLAGS="--simd-cost-model -k --output-dir=${tmpdir}"
+test_ARGS="${tmpdir}/*_success_simd_23_cost_model.c"
+test_generator=config/mercurium-serial-simd
+</testinfo>
+*/
+
+// The generated code is kept and passed to the test, which checks that
+// the cost model left 'permute' scalar
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define VECTOR_SIZE 16
+#define N 1024
+
+// Profitable: contiguous accesses, vectorized and interleaved
+void __attribute__((noinline)) saxpy(float *x, float *y, float *z, float a)
+{
+    int j;
+#pragma omp simd
+    for (j=0; j<N; j++)
+    {
+        z[j] = a * x[j] + y[j];
+    }
+}
+
+// Profitable: reduction
+float __attribute__((noinline)) sum(float *x)
+{
+    int j;
+    float s = 0.0f;
+#pragma omp simd reduction(+:s)
+    for (j=0; j<N; j++)
+    {
+        s += x[j];
+    }
+    return s;
+}
+
+// Not profitable: only gathers and fewer iterations than a vector
+void __attribute__((noinline)) permute(float *x, float *z, int *idx)
+{
+    int j;
+#pragma omp simd
+    for (j=0; j<3; j++)
+    {
+        z[idx[j]] = x[idx[j]];
+    }
+}
+
+// Whether the definition of 'function' in the generated code has no vector
+// types nor intrinsics
+static int is_scalar_function(const char *filename, const char *function)
+{
+    FILE *f = fopen(filename, "r");
+    if (f == NULL)
+    {
+        printf("Cannot open '%s'\n", filename);
+        return 0;
+    }
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    char *code = malloc(size + 1);
+    size_t read = fread(code, 1, size, f);
+    code[read] = '\0';
+    fclose(f);
+
+    int result = 0;
+    char *start = strstr(code, function);
+    char *end = start != NULL ? strstr(start, "\n}\n") : NULL;
+    if (end != NULL)
+    {
+        *end = '\0';
+        result = strstr(start, "_mm") == NULL
+            && strstr(start, "vector_size") == NULL;
+    }
+
+    free(code);
+    return result;
+}
+
+int main (int argc, char * argv[])
+{
+    float *x, *y, *z;
+    int idx[3] = { 2, 0, 1 };
+    int i;
+
+    posix_memalign((void **)&x, VECTOR_SIZE, N*sizeof(float));
+    posix_memalign((void **)&y, VECTOR_SIZE, N*sizeof(float));
+    posix_memalign((void **)&z, VECTOR_SIZE, N*sizeof(float));
+
+    for (i=0; i<N; i++)
+    {
+        x[i] = i+1;
+        y[i] = i-1;
+        z[i] = 0.0f;
+    }
+
+    saxpy(x, y, z, 2.0f);
+
+    for (i=0; i<N; i++)
+    {
+        if (z[i] != (2.0f * x[i] + y[i]))
+        {
+            printf("Error saxpy\n");
+            return (1);
+        }
+    }
+
+    if (sum(x) != (float)(N * (N + 1) / 2))
+    {
+        printf("Error sum\n");
+        return (1);
+    }
+
+    permute(x, z, idx);
+
+    if (z[2] != x[2] || z[0] != x[0] || z[1] != x[1])
+    {
+        printf("Error permute\n");
+        return (1);
+    }
+
+    if (argc != 2 || !is_scalar_function(argv[1], "permute("))
+    {
+        printf("Error permute was vectorized\n");
+        return (1);
+    }
+
+    printf("SUCCESS!\n");
+    return 0;
+}
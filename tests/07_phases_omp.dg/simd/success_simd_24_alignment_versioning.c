@@ -0,0 +1,140 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2013 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+/*
+<testinfo>
+test_CFLAGS=--simd-alignment-versioning
+test_generator=config/mercurium-serial-simd
+</testinfo>
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define VECTOR_SIZE 64
+#define N 1024
+
+// Runtime lower bound: peeled until j is aligned
+void __attribute__((noinline)) add(float *x, float *y, float *z, int lb, int ub)
+{
+    int j;
+#pragma omp simd
+    for (j=lb; j<ub; j++)
+    {
+        z[j] = x[j] + y[j];
+    }
+}
+
+// Mixed element sizes and the induction variable declared in the loop
+void __attribute__((noinline)) widen(float *x, double *d, int lb)
+{
+#pragma omp simd
+    for (int j=lb; j<N; j++)
+    {
+        d[j] = x[j] * 2.0;
+    }
+}
+
+int check(float *x, float *y, float *z, int lb, int ub)
+{
+    int i;
+    for (i=0; i<N; i++)
+    {
+        float expected = (i >= lb && i < ub) ? x[i] + y[i] : -1.0f;
+        if (z[i] != expected)
+            return 1;
+        z[i] = -1.0f;
+    }
+    return 0;
+}
+
+int main (int argc, char * argv[])
+{
+    float *x, *y, *z;
+    double *d;
+    int i;
+
+    posix_memalign((void **)&x, VECTOR_SIZE, (N+1)*sizeof(float));
+    posix_memalign((void **)&y, VECTOR_SIZE, (N+1)*sizeof(float));
+    posix_memalign((void **)&z, VECTOR_SIZE, (N+1)*sizeof(float));
+    posix_memalign((void **)&d, VECTOR_SIZE, N*sizeof(double));
+
+    for (i=0; i<N+1; i++)
+    {
+        x[i] = i+1;
+        y[i] = i-1;
+        z[i] = -1.0f;
+    }
+
+    // Aligned pointers, peeling needed
+    add(x, y, z, 3, N);
+    if (check(x, y, z, 3, N))
+    {
+        printf("Error peeled\n");
+        return (1);
+    }
+
+    // Fewer iterations than the peeling
+    add(x, y, z, 5, 7);
+    if (check(x, y, z, 5, 7))
+    {
+        printf("Error short\n");
+        return (1);
+    }
+
+    // Misaligned but congruent pointers, peeled until aligned
+    add(x+1, y+1, z+1, 0, N-1);
+    if (check(x+1, y+1, z+1, 0, N-1))
+    {
+        printf("Error congruent\n");
+        return (1);
+    }
+
+    // Misaligned pointer, fallback version
+    add(x+1, y, z, 0, N-1);
+    for (i=0; i<N-1; i++)
+    {
+        if (z[i] != x[i+1] + y[i])
+        {
+            printf("Error fallback\n");
+            return (1);
+        }
+    }
+
+    widen(x, d, 1);
+    for (i=1; i<N; i++)
+    {
+        if (d[i] != x[i] * 2.0)
+        {
+            printf("Error widen\n");
+            return (1);
+        }
+    }
+
+    printf("SUCCESS!\n");
+    return 0;
+}
@@ -0,0 +1,181 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2013 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+/*
+<testinfo>
+test_generator=config/mercurium-serial-simd
+</testinfo>
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define VECTOR_SIZE 64
+#define ROWS 1021
+
+// Outer loop vectorized, inner trip count differs for each row
+void __attribute__((noinline)) spmv(int *row_ptr, int *col, float *val,
+        float *x, float *y)
+{
+    int i, k;
+#pragma omp simd
+    for (i=0; i<ROWS; i++)
+    {
+        float s = 0.0f;
+        for (k=row_ptr[i]; k<row_ptr[i+1]; k++)
+        {
+            s += val[k] * x[col[k]];
+        }
+        y[i] = s;
+    }
+}
+
+// Divergent while loop in the outer loop body
+void __attribute__((noinline)) collatz(int *v, int *steps)
+{
+    int i;
+#pragma omp simd
+    for (i=0; i<ROWS; i++)
+    {
+        int n = v[i];
+        int c = 0;
+        while (n > 1)
+        {
+            if (n % 2 == 0)
+                n = n / 2;
+            else
+                n = 3 * n + 1;
+            c++;
+        }
+        steps[i] = c;
+    }
+}
+
+// The lanes exit at different iterations and the condition has a side
+// effect, the lanes that already exited must not evaluate it again
+void __attribute__((noinline)) count_up(int *limit, int *count, int *sum)
+{
+    int i;
+#pragma omp simd
+    for (i=0; i<ROWS; i++)
+    {
+        int lim = limit[i];
+        int c = 0;
+        int s = 0;
+        while ((c = c + 1) <= lim)
+        {
+            s = s + c;
+        }
+        count[i] = c;
+        sum[i] = s;
+    }
+}
+
+int main (int argc, char * argv[])
+{
+    int *row_ptr, *col, *v, *steps;
+    float *val, *x, *y;
+    int i, k, nnz;
+
+    posix_memalign((void **)&row_ptr, VECTOR_SIZE, (ROWS+1)*sizeof(int));
+    posix_memalign((void **)&v, VECTOR_SIZE, ROWS*sizeof(int));
+    posix_memalign((void **)&steps, VECTOR_SIZE, ROWS*sizeof(int));
+    posix_memalign((void **)&x, VECTOR_SIZE, ROWS*sizeof(float));
+    posix_memalign((void **)&y, VECTOR_SIZE, ROWS*sizeof(float));
+
+    row_ptr[0] = 0;
+    for (i=0; i<ROWS; i++)
+        row_ptr[i+1] = row_ptr[i] + (i % 7);
+    nnz = row_ptr[ROWS];
+
+    posix_memalign((void **)&col, VECTOR_SIZE, nnz*sizeof(int));
+    posix_memalign((void **)&val, VECTOR_SIZE, nnz*sizeof(float));
+
+    for (i=0; i<ROWS; i++)
+    {
+        x[i] = i % 5;
+        y[i] = -1.0f;
+        v[i] = i + 1;
+        for (k=row_ptr[i]; k<row_ptr[i+1]; k++)
+        {
+            col[k] = (i + k) % ROWS;
+            val[k] = k % 3;
+        }
+    }
+
+    spmv(row_ptr, col, val, x, y);
+
+    for (i=0; i<ROWS; i++)
+    {
+        float s = 0.0f;
+        for (k=row_ptr[i]; k<row_ptr[i+1]; k++)
+            s += val[k] * x[col[k]];
+
+        if (y[i] != s)
+        {
+            printf("Error spmv %d: %f != %f\n", i, y[i], s);
+            return (1);
+        }
+    }
+
+    collatz(v, steps);
+
+    for (i=0; i<ROWS; i++)
+    {
+        int n = v[i];
+        int c = 0;
+        while (n > 1)
+        {
+            n = (n % 2 == 0) ? n / 2 : 3 * n + 1;
+            c++;
+        }
+
+        if (steps[i] != c)
+        {
+            printf("Error collatz %d: %d != %d\n", i, steps[i], c);
+            return (1);
+        }
+    }
+
+    for (i=0; i<ROWS; i++)
+        v[i] = i % 9;
+
+    count_up(v, steps, row_ptr);
+
+    for (i=0; i<ROWS; i++)
+    {
+        if (steps[i] != v[i] + 1
+                || row_ptr[i] != v[i] * (v[i] + 1) / 2)
+        {
+            printf("Error count_up %d: %d %d\n", i, steps[i], row_ptr[i]);
+            return (1);
+        }
+    }
+
+    printf("SUCCESS!\n");
+    return 0;
+}
@@ -0,0 +1,126 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2013 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+/*
+<testinfo>
+test_CFLAGS=--simd-dispatch
+test_generator=config/mercurium-serial-simd
+</testinfo>
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define VECTOR_SIZE 64
+#define N 1024
+
+// Every function below has one version per instruction set and the best one
+// for the running CPU is picked by the original function
+void __attribute__((noinline)) saxpy(float a, float *x, float *y)
+{
+    int j;
+#pragma omp simd
+    for (j=0; j<N; j++)
+    {
+        y[j] = a * x[j] + y[j];
+    }
+}
+
+float __attribute__((noinline)) dot(float *x, float *y, int n)
+{
+    int j;
+    float s = 0.0f;
+#pragma omp simd reduction(+:s)
+    for (j=0; j<n; j++)
+    {
+        s += x[j] * y[j];
+    }
+    return s;
+}
+
+// Static locals cannot be cloned, only the baseline version is generated
+int __attribute__((noinline)) count_calls(float *x)
+{
+    static int calls = 0;
+    int j;
+#pragma omp simd
+    for (j=0; j<N; j++)
+    {
+        x[j] = x[j] + 1.0f;
+    }
+    return ++calls;
+}
+
+int main (int argc, char * argv[])
+{
+    float *x, *y;
+    int i;
+
+    posix_memalign((void **)&x, VECTOR_SIZE, N*sizeof(float));
+    posix_memalign((void **)&y, VECTOR_SIZE, N*sizeof(float));
+
+    for (i=0; i<N; i++)
+    {
+        x[i] = i % 16;
+        y[i] = 1.0f;
+    }
+
+    saxpy(2.0f, x, y);
+    for (i=0; i<N; i++)
+    {
+        if (y[i] != 2.0f * (i % 16) + 1.0f)
+        {
+            printf("Error saxpy\n");
+            return (1);
+        }
+    }
+
+    // Second call goes through the already resolved version
+    saxpy(-2.0f, x, y);
+    for (i=0; i<N; i++)
+    {
+        if (y[i] != 1.0f)
+        {
+            printf("Error saxpy resolved\n");
+            return (1);
+        }
+    }
+
+    if (dot(x, y, N) != (N / 16) * 120.0f)
+    {
+        printf("Error dot\n");
+        return (1);
+    }
+
+    if (count_calls(x) != 1 || count_calls(x) != 2)
+    {
+        printf("Error static\n");
+        return (1);
+    }
+
+    printf("SUCCESS!\n");
+    return 0;
+}
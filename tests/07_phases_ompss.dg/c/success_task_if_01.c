@@ -0,0 +1,61 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2012 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+/*
+<testinfo>
+test_generator=(config/mercurium-ompss "config/mercurium-ompss-2 openmp-compatibility")
+</testinfo>
+*/
+
+#include <assert.h>
+
+int main(int argc, char*argv[])
+{
+    void *creator_frame = __builtin_frame_address(0);
+    void *task_frame = 0;
+
+    // Executed directly: the statements run in the frame of the creator
+    #pragma omp task shared(task_frame) if(0)
+    {
+        task_frame = __builtin_frame_address(0);
+    }
+    #pragma omp taskwait
+    assert(task_frame == creator_frame);
+
+    // The firstprivate 'a' is modified, so the task goes through the runtime
+    int a = argc;
+    task_frame = 0;
+    #pragma omp task shared(task_frame) firstprivate(a) if(0)
+    {
+        a++;
+        task_frame = __builtin_frame_address(0);
+    }
+    #pragma omp taskwait
+    assert(task_frame != 0 && task_frame != creator_frame);
+
+    return 0;
+}
@@ -0,0 +1,45 @@
+/*
+<testinfo>
+test_generator="config/mercurium-ompss-2"
+test_CFLAGS="--variable=coalesce_multidependences:1"
+test_nolink=yes
+</testinfo>
+*/
+
+#define N 64
+#define M 32
+
+void f(int n, int m, int a[N][M], int *v)
+{
+    // Coalesced into a[0:n-1][0:M-1]
+    #pragma oss task in({a[i][0:M-1], i = 0;n})
+    {
+    }
+
+    // Coalesced into v[1:n] and guarded against n < 1
+    #pragma oss task out({v[i + 1], i = 0:n-1})
+    {
+    }
+
+    // Coalesced into a[0:N-1][2] (strided)
+    #pragma oss task inout({a[i][2], i = 0:N-1})
+    {
+    }
+
+    // 'j' is coalesced into a[i][0:m-1], 'i' is kept
+    #pragma oss task in({a[i][j], i = 0:n-1:2, j = 0:m-1})
+    {
+    }
+
+    // Not coalesced because the range of 'j' depends on 'i'
+    #pragma oss task in({a[i][j], i = 0:n-1, j = 0:i})
+    {
+    }
+
+    // Not coalesced because of the stride
+    #pragma oss task in({v[i], i = 0:m:2})
+    {
+    }
+
+    #pragma oss taskwait
+}
@@ -0,0 +1,51 @@
+/*
+<testinfo>
+test_generator="config/mercurium-ompss-2"
+</testinfo>
+*/
+
+#include <assert.h>
+
+int fib(int n, int cutoff)
+{
+    if (n < 2)
+        return n;
+
+    int x, y;
+    // Executed directly by the current thread once n <= cutoff
+    #pragma oss task shared(x) if(n > cutoff)
+    x = fib(n - 1, cutoff);
+
+    #pragma oss task shared(y) if(n > cutoff)
+    y = fib(n - 2, cutoff);
+
+    #pragma oss taskwait
+    return x + y;
+}
+
+int main(int argc, char *argv[])
+{
+    int a = 1;
+    int b = 0;
+
+    // The firstprivate 'a' is modified, so this task goes through the runtime
+    #pragma oss task firstprivate(a) shared(b) if(0)
+    {
+        a++;
+        b = a;
+    }
+    #pragma oss taskwait
+    assert(a == 1 && b == 2);
+
+    int v[10];
+    #pragma oss task shared(v) if(argc < 0)
+    {
+        for (int i = 0; i < 10; i++)
+            v[i] = i;
+    }
+    #pragma oss taskwait
+    assert(v[9] == 9);
+
+    assert(fib(20, 10) == 6765);
+    return 0;
+}
@@ -0,0 +1,129 @@
+/*
+<testinfo>
+test_generator="config/mercurium-ompss-2"
+test_CFLAGS="--variable=task_aggregation:1 -k --output-dir=${tmpdir}"
+test_ARGS="${tmpdir}/*_success_task_04.c"
+</testinfo>
+*/
+
+// The generated code is kept and passed to the test, which checks that
+// the loops were bundled
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define N 1000
+#define BS 16
+
+int a[N], b[N], c[N], d[N];
+
+// Number of bundle loops over 'var' in the generated code
+static int count_bundles(const char *filename, const char *var)
+{
+    FILE *f = fopen(filename, "r");
+    if (f == NULL)
+    {
+        printf("Cannot open '%s'\n", filename);
+        return -1;
+    }
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    char *code = malloc(size + 1);
+    size_t read = fread(code, 1, size, f);
+    code[read] = '\0';
+    fclose(f);
+
+    // The bundle increments its own copy of the induction variable
+    //     var_bundle = var_bundle + S
+    char pattern[64];
+    snprintf(pattern, sizeof(pattern), "%s_bundle = %s_bundle +", var, var);
+
+    int result = 0;
+    for (char *p = strstr(code, pattern); p != NULL; p = strstr(p + 1, pattern))
+        result++;
+
+    free(code);
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    int i, m;
+
+    // a[i] and b[i] become array sections over the iterations of a bundle
+    for (i = 0; i < N; i++)
+    {
+        #pragma oss task out(a[i])
+        a[i] = i;
+    }
+    assert(i == N);
+
+    for (i = 0; i < N; i++)
+    {
+        #pragma oss task in(a[i]) out(b[i])
+        b[i] = a[i] + 1;
+    }
+
+    // Array sections that depend on the induction variable
+    for (int k = 0; k < N; k += BS)
+    {
+        #pragma oss task in(b[k;BS]) out(c[k;BS])
+        {
+            for (int j = k; j < k + BS && j < N; j++)
+                c[j] = 2 * b[j];
+        }
+    }
+
+    // Not a unit step: a[i] becomes a multidependence
+    for (i = N - 1; i >= 0; i -= 3)
+    {
+        #pragma oss task inout(a[i])
+        a[i] = -a[i];
+    }
+    assert(i == -3);
+
+    // The cost clause makes the bundles smaller
+    for (i = 1; i < N; i++)
+    {
+        #pragma oss task in(c[i - 1]) inout(b[i]) cost(1000)
+        b[i] += c[i - 1];
+    }
+
+    // Writes a firstprivate, which would leak into the next iteration of a
+    // bundle, so it is not bundled
+    int base = 0;
+    for (m = 0; m < N; m++)
+    {
+        #pragma oss task firstprivate(base) out(d[m])
+        {
+            base += m;
+            d[m] = base;
+        }
+    }
+
+    #pragma oss taskwait
+
+    for (i = 0; i < N; i++)
+    {
+        int expected_a = ((N - 1 - i) % 3 == 0) ? -i : i;
+        int expected_b = i + 1;
+        if (i > 0)
+            expected_b += 2 * i;
+
+        assert(a[i] == expected_a);
+        assert(b[i] == expected_b);
+        assert(c[i] == 2 * (i + 1));
+        assert(d[i] == i);
+    }
+
+    assert(argc == 2);
+    assert(count_bundles(argv[1], "i") == 4);
+    assert(count_bundles(argv[1], "k") == 1);
+    assert(count_bundles(argv[1], "m") == 0);
+
+    return 0;
+}
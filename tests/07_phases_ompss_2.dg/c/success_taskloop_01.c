@@ -0,0 +1,56 @@
+/*
+<testinfo>
+test_generator="config/mercurium-ompss-2"
+</testinfo>
+*/
+
+#include <assert.h>
+
+#define N 1000
+
+int v[N];
+
+int main(int argc, char *argv[])
+{
+    // No chunksize: it is computed from the cost of the loop body
+    #pragma oss task loop
+    for (int i = 0; i < N; ++i)
+    {
+        v[i] = i;
+    }
+
+    #pragma oss taskwait
+
+    // An explicit chunksize is honoured
+    #pragma oss task loop chunksize(7)
+    for (int i = 0; i < N; ++i)
+    {
+        for (int j = 0; j < 10; ++j)
+            v[i] += j;
+    }
+
+    #pragma oss taskwait
+
+    // An empty iteration space gets the minimum chunksize
+    #pragma oss task loop
+    for (int i = N; i < argc - 1; ++i)
+    {
+        v[0] = -1;
+    }
+
+    #pragma oss taskwait
+
+    // A decreasing loop is counted with the absolute value of its step
+    #pragma oss task loop
+    for (int i = N - 1; i >= 0; i -= 3)
+    {
+        v[i]++;
+    }
+
+    #pragma oss taskwait
+
+    for (int i = 0; i < N; ++i)
+        assert(v[i] == i + 45 + ((N - 1 - i) % 3 == 0));
+
+    return 0;
+}
@@ -0,0 +1,25 @@
+! <testinfo>
+! test_generator=config/mercurium-ompss-2
+! test_FFLAGS="--variable=coalesce_multidependences:1"
+! test_nolink=yes
+! </testinfo>
+
+subroutine f(n, a, v)
+    implicit none
+    integer :: n, i
+    integer :: a(64, 32), v(64)
+
+    ! Coalesced into a(1:64, 1:n), guarded against n < 1
+    !$oss task in({/ a(:, i), i = 1, n /})
+    !$oss end task
+
+    ! Coalesced into v(2:n+1), guarded against n < 1
+    !$oss task out({/ v(i + 1), i = 1, n /})
+    !$oss end task
+
+    ! Coalesced into a(3, 1:32), never empty
+    !$oss task inout({/ a(3, i), i = 1, 32 /})
+    !$oss end task
+
+    !$oss taskwait
+end subroutine f
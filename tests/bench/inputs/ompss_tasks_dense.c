@@ -0,0 +1,342 @@
+/*
+ * Compile-time benchmark input: many tasks with dependences in the same
+ * translation unit. This file is not run, it only has to be lowered.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define NB 16
+#define BS 64
+
+typedef double block_t[BS][BS];
+
+static void potrf(block_t a)
+{
+    int i, j, k;
+    for (k = 0; k < BS; k++)
+    {
+        a[k][k] = sqrt(a[k][k]);
+        for (i = k + 1; i < BS; i++)
+            a[i][k] /= a[k][k];
+        for (j = k + 1; j < BS; j++)
+            for (i = j; i < BS; i++)
+                a[i][j] -= a[i][k] * a[j][k];
+    }
+}
+
+static void trsm(block_t a, block_t b)
+{
+    int i, j, k;
+    for (i = 0; i < BS; i++)
+        for (j = 0; j < BS; j++)
+        {
+            for (k = 0; k < j; k++)
+                b[i][j] -= b[i][k] * a[j][k];
+            b[i][j] /= a[j][j];
+        }
+}
+
+static void syrk(block_t a, block_t c)
+{
+    int i, j, k;
+    for (i = 0; i < BS; i++)
+        for (j = 0; j <= i; j++)
+            for (k = 0; k < BS; k++)
+                c[i][j] -= a[i][k] * a[j][k];
+}
+
+static void gemm(block_t a, block_t b, block_t c)
+{
+    int i, j, k;
+    for (i = 0; i < BS; i++)
+        for (j = 0; j < BS; j++)
+            for (k = 0; k < BS; k++)
+                c[i][j] -= a[i][k] * b[j][k];
+}
+
+void cholesky(block_t *m[NB][NB])
+{
+    int i, j, k;
+    for (k = 0; k < NB; k++)
+    {
+        #pragma omp task inout(*m[k][k])
+        potrf(*m[k][k]);
+
+        for (i = k + 1; i < NB; i++)
+        {
+            #pragma omp task in(*m[k][k]) inout(*m[i][k])
+            trsm(*m[k][k], *m[i][k]);
+        }
+
+        for (i = k + 1; i < NB; i++)
+        {
+            for (j = k + 1; j < i; j++)
+            {
+                #pragma omp task in(*m[i][k], *m[j][k]) inout(*m[i][j])
+                gemm(*m[i][k], *m[j][k], *m[i][j]);
+            }
+
+            #pragma omp task in(*m[i][k]) inout(*m[i][i])
+            syrk(*m[i][k], *m[i][i]);
+        }
+    }
+    #pragma omp taskwait
+}
+
+void lu(block_t *m[NB][NB])
+{
+    int i, j, k;
+    for (k = 0; k < NB; k++)
+    {
+        #pragma omp task inout(*m[k][k])
+        {
+            int ii, jj, kk;
+            for (kk = 0; kk < BS; kk++)
+                for (ii = kk + 1; ii < BS; ii++)
+                {
+                    (*m[k][k])[ii][kk] /= (*m[k][k])[kk][kk];
+                    for (jj = kk + 1; jj < BS; jj++)
+                        (*m[k][k])[ii][jj] -= (*m[k][k])[ii][kk] * (*m[k][k])[kk][jj];
+                }
+        }
+
+        for (j = k + 1; j < NB; j++)
+        {
+            #pragma omp task in(*m[k][k]) inout(*m[k][j]) firstprivate(j, k)
+            {
+                int ii, jj, kk;
+                for (kk = 0; kk < BS; kk++)
+                    for (ii = kk + 1; ii < BS; ii++)
+                        for (jj = 0; jj < BS; jj++)
+                            (*m[k][j])[ii][jj] -= (*m[k][k])[ii][kk] * (*m[k][j])[kk][jj];
+            }
+        }
+
+        for (i = k + 1; i < NB; i++)
+        {
+            #pragma omp task in(*m[k][k]) inout(*m[i][k]) firstprivate(i, k)
+            {
+                int ii, jj, kk;
+                for (kk = 0; kk < BS; kk++)
+                    for (ii = 0; ii < BS; ii++)
+                    {
+                        (*m[i][k])[ii][kk] /= (*m[k][k])[kk][kk];
+                        for (jj = kk + 1; jj < BS; jj++)
+                            (*m[i][k])[ii][jj] -= (*m[i][k])[ii][kk] * (*m[k][k])[kk][jj];
+                    }
+            }
+
+            for (j = k + 1; j < NB; j++)
+            {
+                #pragma omp task in(*m[i][k], *m[k][j]) inout(*m[i][j])
+                gemm(*m[i][k], *m[k][j], *m[i][j]);
+            }
+        }
+    }
+    #pragma omp taskwait
+}
+
+void gauss_seidel(int n, double (*u)[n], int iterations)
+{
+    int it, i, j;
+    for (it = 0; it < iterations; it++)
+    {
+        for (i = BS; i < n - BS; i += BS)
+        {
+            for (j = BS; j < n - BS; j += BS)
+            {
+                #pragma omp task in(u[i - BS][j;BS], u[i + BS][j;BS], u[i;BS][j - BS], u[i;BS][j + BS]) \
+                    inout(u[i;BS][j;BS]) firstprivate(i, j)
+                {
+                    int ii, jj;
+                    for (ii = i; ii < i + BS; ii++)
+                        for (jj = j; jj < j + BS; jj++)
+                            u[ii][jj] = 0.25 * (u[ii - 1][jj] + u[ii + 1][jj]
+                                    + u[ii][jj - 1] + u[ii][jj + 1]);
+                }
+            }
+        }
+    }
+    #pragma omp taskwait
+}
+
+void dot_blocks(int n, double *x, double *y, double *partial)
+{
+    int i;
+    for (i = 0; i < n / BS; i++)
+    {
+        #pragma omp task in(x[i * BS; BS], y[i * BS; BS]) out(partial[i])
+        {
+            int k;
+            double s = 0.0;
+            for (k = i * BS; k < (i + 1) * BS; k++)
+                s += x[k] * y[k];
+            partial[i] = s;
+        }
+    }
+
+    #pragma omp task in(partial[1; n / BS - 1]) inout(partial[0])
+    {
+        int k;
+        for (k = 1; k < n / BS; k++)
+            partial[0] += partial[k];
+    }
+    #pragma omp taskwait
+}
+
+void axpy_chain(int n, double a, double *x, double *y, double *z, double *w)
+{
+    int i;
+    for (i = 0; i < n; i += BS)
+    {
+        #pragma omp task in(x[i; BS]) inout(y[i; BS])
+        {
+            int k;
+            for (k = i; k < i + BS; k++)
+                y[k] += a * x[k];
+        }
+        #pragma omp task in(y[i; BS]) inout(z[i; BS])
+        {
+            int k;
+            for (k = i; k < i + BS; k++)
+                z[k] += a * y[k];
+        }
+        #pragma omp task in(z[i; BS]) inout(w[i; BS])
+        {
+            int k;
+            for (k = i; k < i + BS; k++)
+                w[k] += a * z[k];
+        }
+        #pragma omp task in(w[i; BS]) inout(x[i; BS])
+        {
+            int k;
+            for (k = i; k < i + BS; k++)
+                x[k] += a * w[k];
+        }
+    }
+    #pragma omp taskwait
+}
+
+static int fib(int n)
+{
+    int x, y;
+    if (n < 2)
+        return n;
+
+    #pragma omp task shared(x) firstprivate(n) if(n > 20)
+    x = fib(n - 1);
+    #pragma omp task shared(y) firstprivate(n) if(n > 20)
+    y = fib(n - 2);
+    #pragma omp taskwait
+
+    return x + y;
+}
+
+static void quicksort(int *v, int lo, int hi)
+{
+    if (lo >= hi)
+        return;
+
+    int pivot = v[(lo + hi) / 2];
+    int i = lo, j = hi;
+    while (i <= j)
+    {
+        while (v[i] < pivot) i++;
+        while (v[j] > pivot) j--;
+        if (i <= j)
+        {
+            int t = v[i];
+            v[i] = v[j];
+            v[j] = t;
+            i++;
+            j--;
+        }
+    }
+
+    #pragma omp task inout(v[lo:j]) final(j - lo < 1024)
+    quicksort(v, lo, j);
+    #pragma omp task inout(v[i:hi]) final(hi - i < 1024)
+    quicksort(v, i, hi);
+    #pragma omp taskwait
+}
+
+void histogram(int n, const int *data, int *bins, int num_bins)
+{
+    int i;
+    for (i = 0; i < n; i += BS)
+    {
+        #pragma omp task in(data[i; BS]) commutative(bins[0; num_bins])
+        {
+            int k;
+            for (k = i; k < i + BS && k < n; k++)
+            {
+                #pragma omp atomic
+                bins[data[k] % num_bins]++;
+            }
+        }
+    }
+    #pragma omp taskwait
+}
+
+void pipeline(int n, double *stage0, double *stage1, double *stage2, double *stage3)
+{
+    int i;
+    for (i = 0; i < n; i++)
+    {
+        #pragma omp task out(stage0[i])
+        stage0[i] = i;
+        #pragma omp task in(stage0[i]) out(stage1[i])
+        stage1[i] = stage0[i] * 2.0;
+        #pragma omp task in(stage1[i]) out(stage2[i])
+        stage2[i] = stage1[i] + 1.0;
+        #pragma omp task in(stage2[i]) out(stage3[i])
+        stage3[i] = sqrt(stage2[i]);
+        #pragma omp task in(stage3[i]) inout(stage0[i])
+        stage0[i] += stage3[i];
+    }
+    #pragma omp taskwait
+}
+
+int main(int argc, char *argv[])
+{
+    int n = NB * BS;
+    double *x = malloc(n * sizeof(double));
+    double *y = malloc(n * sizeof(double));
+    double *z = malloc(n * sizeof(double));
+    double *w = malloc(n * sizeof(double));
+    double *partial = malloc((n / BS) * sizeof(double));
+    int *v = malloc(n * sizeof(int));
+    int bins[16];
+    int i;
+
+    memset(bins, 0, sizeof(bins));
+    for (i = 0; i < n; i++)
+    {
+        x[i] = y[i] = z[i] = w[i] = i;
+        v[i] = n - i;
+    }
+
+    axpy_chain(n, 2.0, x, y, z, w);
+    dot_blocks(n, x, y, partial);
+    pipeline(n, x, y, z, w);
+    histogram(n, v, bins, 16);
+
+    #pragma omp task inout(v[0:n-1])
+    quicksort(v, 0, n - 1);
+
+    int r;
+    #pragma omp task out(r)
+    r = fib(argc + 20);
+    #pragma omp taskwait
+
+    free(x);
+    free(y);
+    free(z);
+    free(w);
+    free(partial);
+    free(v);
+
+    return r == 0;
+}